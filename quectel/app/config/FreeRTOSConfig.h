@@ -50,6 +50,7 @@ extern uint32_t SystemCoreClock;
 #define configUSE_COUNTING_SEMAPHORES                 1
 #define configQUEUE_REGISTRY_SIZE                     8
 #define configUSE_QUEUE_SETS                          0
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES         2        /* index 1: SD transfer completion */
 #define configUSE_APPLICATION_TASK_TAG                0
 
 
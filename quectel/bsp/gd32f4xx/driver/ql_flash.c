@@ -20,7 +20,17 @@ limitations under the License.
     v1.0     2024-0908    Hayden   Create file
 */
 
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "ql_flash.h"
+#include "ql_check.h"
+
+#define LOG_TAG "flash"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
 
 /* base address of the flash sectors */
 #define ADDR_FLASH_SECTOR_0      ((uint32_t)0x08000000) /* Base address of Sector 0,   16 K bytes */
@@ -54,91 +64,237 @@ limitations under the License.
 #define ADDR_FLASH_SECTOR_26     ((uint32_t)0x08280000) /* Base address of Sector 26, 256 K bytes */
 #define ADDR_FLASH_SECTOR_27     ((uint32_t)0x082C0000) /* Base address of Sector 27, 256 K bytes */
 
+static const uint32_t Ql_Flash_Sector_Base[QL_FLASH_SECTORS + 1] =
+{
+    ADDR_FLASH_SECTOR_0,  ADDR_FLASH_SECTOR_1,  ADDR_FLASH_SECTOR_2,  ADDR_FLASH_SECTOR_3,
+    ADDR_FLASH_SECTOR_4,  ADDR_FLASH_SECTOR_5,  ADDR_FLASH_SECTOR_6,  ADDR_FLASH_SECTOR_7,
+    ADDR_FLASH_SECTOR_8,  ADDR_FLASH_SECTOR_9,  ADDR_FLASH_SECTOR_10, ADDR_FLASH_SECTOR_11,
+    ADDR_FLASH_SECTOR_12, ADDR_FLASH_SECTOR_13, ADDR_FLASH_SECTOR_14, ADDR_FLASH_SECTOR_15,
+    ADDR_FLASH_SECTOR_16, ADDR_FLASH_SECTOR_17, ADDR_FLASH_SECTOR_18, ADDR_FLASH_SECTOR_19,
+    ADDR_FLASH_SECTOR_20, ADDR_FLASH_SECTOR_21, ADDR_FLASH_SECTOR_22, ADDR_FLASH_SECTOR_23,
+    ADDR_FLASH_SECTOR_24, ADDR_FLASH_SECTOR_25, ADDR_FLASH_SECTOR_26, ADDR_FLASH_SECTOR_27,
+    ADDR_FLASH_SECTOR_27 + 256 * 1024,
+};
+
 /**
- * Get the sector of a given address
+ * Get the sector index of a given address
  *
  * @param address flash address
  *
- * @return The sector of a given address
+ * @return sector 0..27
  */
 static uint32_t Ql_Flash_Sector(uint32_t Addr)
 {
     uint32_t sector = 0;
 
-    if (Addr < ADDR_FLASH_SECTOR_0) {  }
-    else if (Addr < ADDR_FLASH_SECTOR_1)  { sector =  CTL_SECTOR_NUMBER_0;  }
-    else if (Addr < ADDR_FLASH_SECTOR_2)  { sector =  CTL_SECTOR_NUMBER_1;  }
-    else if (Addr < ADDR_FLASH_SECTOR_3)  { sector =  CTL_SECTOR_NUMBER_2;  }
-    else if (Addr < ADDR_FLASH_SECTOR_4)  { sector =  CTL_SECTOR_NUMBER_3;  }
-    else if (Addr < ADDR_FLASH_SECTOR_5)  { sector =  CTL_SECTOR_NUMBER_4;  }
-    else if (Addr < ADDR_FLASH_SECTOR_6)  { sector =  CTL_SECTOR_NUMBER_5;  }
-    else if (Addr < ADDR_FLASH_SECTOR_7)  { sector =  CTL_SECTOR_NUMBER_6;  }
-    else if (Addr < ADDR_FLASH_SECTOR_8)  { sector =  CTL_SECTOR_NUMBER_7;  }
-    else if (Addr < ADDR_FLASH_SECTOR_9)  { sector =  CTL_SECTOR_NUMBER_8;  }
-    else if (Addr < ADDR_FLASH_SECTOR_10) { sector =  CTL_SECTOR_NUMBER_9;  }
-    else if (Addr < ADDR_FLASH_SECTOR_11) { sector =  CTL_SECTOR_NUMBER_10; }
-    else if (Addr < ADDR_FLASH_SECTOR_12) { sector =  CTL_SECTOR_NUMBER_11; }
-    else if (Addr < ADDR_FLASH_SECTOR_13) { sector =  CTL_SECTOR_NUMBER_12; }
-    else if (Addr < ADDR_FLASH_SECTOR_14) { sector =  CTL_SECTOR_NUMBER_13; }
-    else if (Addr < ADDR_FLASH_SECTOR_15) { sector =  CTL_SECTOR_NUMBER_14; }
-    else if (Addr < ADDR_FLASH_SECTOR_16) { sector =  CTL_SECTOR_NUMBER_15; }
-    else if (Addr < ADDR_FLASH_SECTOR_17) { sector =  CTL_SECTOR_NUMBER_16; }
-    else if (Addr < ADDR_FLASH_SECTOR_18) { sector =  CTL_SECTOR_NUMBER_17; }
-    else if (Addr < ADDR_FLASH_SECTOR_19) { sector =  CTL_SECTOR_NUMBER_18; }
-    else if (Addr < ADDR_FLASH_SECTOR_20) { sector =  CTL_SECTOR_NUMBER_19; }
-    else if (Addr < ADDR_FLASH_SECTOR_21) { sector =  CTL_SECTOR_NUMBER_20; }
-    else if (Addr < ADDR_FLASH_SECTOR_22) { sector =  CTL_SECTOR_NUMBER_21; }
-    else if (Addr < ADDR_FLASH_SECTOR_23) { sector =  CTL_SECTOR_NUMBER_22; }
-    else if (Addr < ADDR_FLASH_SECTOR_24) { sector =  CTL_SECTOR_NUMBER_23; }
-    else if (Addr < ADDR_FLASH_SECTOR_25) { sector =  CTL_SECTOR_NUMBER_24; }
-    else if (Addr < ADDR_FLASH_SECTOR_26) { sector =  CTL_SECTOR_NUMBER_25; }
-    else if (Addr < ADDR_FLASH_SECTOR_27) { sector =  CTL_SECTOR_NUMBER_26; }
-    else { sector =  CTL_SECTOR_NUMBER_27; }
+    while ((sector < QL_FLASH_SECTORS - 1) && (Addr >= Ql_Flash_Sector_Base[sector + 1]))
+    {
+        sector++;
+    }
 
     return sector;
 }
 
-/**
- * Get the sector size
- *
- * @param sector sector
- *
- * @return sector size
- */
 static uint32_t Ql_Flash_Sector_Size(uint32_t Sector)
 {
-    switch (Sector)
-    {
-        case CTL_SECTOR_NUMBER_0:  return  16 * 1024;
-        case CTL_SECTOR_NUMBER_1:  return  16 * 1024;
-        case CTL_SECTOR_NUMBER_2:  return  16 * 1024;
-        case CTL_SECTOR_NUMBER_3:  return  16 * 1024;
-        case CTL_SECTOR_NUMBER_4:  return  64 * 1024;
-        case CTL_SECTOR_NUMBER_5:  return 128 * 1024;
-        case CTL_SECTOR_NUMBER_6:  return 128 * 1024;
-        case CTL_SECTOR_NUMBER_7:  return 128 * 1024;
-        case CTL_SECTOR_NUMBER_8:  return 128 * 1024;
-        case CTL_SECTOR_NUMBER_9:  return 128 * 1024;
-        case CTL_SECTOR_NUMBER_10: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_11: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_12: return  16 * 1024;
-        case CTL_SECTOR_NUMBER_13: return  16 * 1024;
-        case CTL_SECTOR_NUMBER_14: return  16 * 1024;
-        case CTL_SECTOR_NUMBER_15: return  16 * 1024;
-        case CTL_SECTOR_NUMBER_16: return  64 * 1024;
-        case CTL_SECTOR_NUMBER_17: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_18: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_19: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_20: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_21: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_22: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_23: return 128 * 1024;
-        case CTL_SECTOR_NUMBER_24: return 256 * 1024;
-        case CTL_SECTOR_NUMBER_25: return 256 * 1024;
-        case CTL_SECTOR_NUMBER_26: return 256 * 1024;
-        case CTL_SECTOR_NUMBER_27: return 256 * 1024;
-        default: return 256 * 1024;
+    return Ql_Flash_Sector_Base[Sector + 1] - Ql_Flash_Sector_Base[Sector];
+}
+
+#if defined(QL_FLASH_HOST)
+/* GD32F4 typical figures: a byte or a word program takes the same time */
+#define QL_FLASH_SIM_PROG_US        (16U)
+#define QL_FLASH_SIM_ERASE_US       (1000000U)  // per 128 KB
+#define QL_FLASH_SIM_SIZE           (ADDR_FLASH_SECTOR_24 - ADDR_FLASH_SECTOR_0)
+#define QL_FLASH_PTR(Addr)          (&Ql_Flash_Sim_Mem[(Addr) - ADDR_FLASH_SECTOR_0])
+
+static uint8_t Ql_Flash_Sim_Mem[QL_FLASH_SIM_SIZE];
+static Ql_Flash_Sim_TypeDef Ql_Flash_Sim_State;
+static uint8_t Ql_Flash_Sim_Ready = 0;
+
+Ql_Flash_Sim_TypeDef *Ql_Flash_Sim(void)
+{
+    if (!Ql_Flash_Sim_Ready)
+    {
+        Ql_Flash_Sim_Reset();
+    }
+    return &Ql_Flash_Sim_State;
+}
+
+/*****************************************************************************
+* @brief  A blank chip: all bytes erased, counters cleared
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+void Ql_Flash_Sim_Reset(void)
+{
+    memset(Ql_Flash_Sim_Mem, 0xFF, sizeof(Ql_Flash_Sim_Mem));
+    memset(&Ql_Flash_Sim_State, 0, sizeof(Ql_Flash_Sim_State));
+    Ql_Flash_Sim_State.Cut_After = -1;
+    Ql_Flash_Sim_Ready = 1;
+}
+
+static void Ql_Flash_Unlock(void)
+{
+    Ql_Flash_Sim();
+}
+
+static void Ql_Flash_Lock(void)
+{
+}
+
+/* Programming can only clear bits. Once Cut_After bytes are done the power
+   is gone and nothing else reaches the array */
+static int32_t Ql_Flash_Prog(uint32_t Addr, uint32_t Data, uint32_t Width)
+{
+    Ql_Flash_Sim_TypeDef *sim = &Ql_Flash_Sim_State;
+    uint8_t *dst = QL_FLASH_PTR(Addr);
+
+    if ((Addr < ADDR_FLASH_SECTOR_0) || (Addr + Width > ADDR_FLASH_SECTOR_24) || (Addr % Width != 0) ||
+        ((sim->Cut_After >= 0) && (sim->Cut_After < (int32_t)Width)))
+    {
+        sim->Cut_After = (sim->Cut_After >= 0) ? 0 : sim->Cut_After;
+        return -1;
+    }
+    sim->Cut_After -= (sim->Cut_After > 0) ? (int32_t)Width : 0;
+
+    for (uint32_t i = 0; i < Width; i++, Data >>= 8)
+    {
+        sim->Prog_Errors += ((dst[i] & (uint8_t)Data) != (uint8_t)Data) ? 1 : 0;
+        dst[i] &= (uint8_t)Data;
+    }
+    sim->Prog_Ops++;
+    sim->Prog_Bytes += Width;
+    sim->Busy_Us    += QL_FLASH_SIM_PROG_US;
+
+    return 0;
+}
+
+static int32_t Ql_Flash_Erase_Sector(uint32_t Sector)
+{
+    Ql_Flash_Sim_TypeDef *sim = &Ql_Flash_Sim_State;
+
+    if ((Ql_Flash_Sector_Base[Sector] >= ADDR_FLASH_SECTOR_24) || (sim->Cut_After == 0))
+    {
+        return -1;
     }
+
+    memset(QL_FLASH_PTR(Ql_Flash_Sector_Base[Sector]), 0xFF, Ql_Flash_Sector_Size(Sector));
+    sim->Erases[Sector]++;
+    sim->Busy_Us += QL_FLASH_SIM_ERASE_US / 128U * (Ql_Flash_Sector_Size(Sector) / 1024U);
+
+    return 0;
+}
+
+static uint32_t Ql_Flash_Bench_Stamp(void)
+{
+    return Ql_Flash_Sim_State.Busy_Us;
+}
+
+static uint32_t Ql_Flash_Bench_Us(uint32_t Start)
+{
+    return Ql_Flash_Sim_State.Busy_Us - Start;
+}
+#else
+#define QL_FLASH_PTR(Addr)          ((uint8_t *)(Addr))
+#define QL_FLASH_STAT_ERR           (FMC_STAT_OPERR | FMC_STAT_WPERR | FMC_STAT_PGMERR | FMC_STAT_PGSERR)
+
+static void Ql_Flash_Unlock(void)
+{
+    fmc_unlock();
+    fmc_flag_clear(FMC_FLAG_END | FMC_FLAG_OPERR | FMC_FLAG_WPERR | FMC_FLAG_PGMERR | FMC_FLAG_PGSERR);
+}
+
+static void Ql_Flash_Lock(void)
+{
+    FMC_CTL &= ~(FMC_CTL_PG | FMC_CTL_PSZ);
+    fmc_lock();
+}
+
+/*****************************************************************************
+* @brief  Program one byte or one aligned word
+* ex:
+* @par
+* PG and the program size stay set between calls of the same width, a run
+* of words only waits for BUSY; fmc_word_program() also waits before each
+* word and sets PSZ and PG again.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_Flash_Prog(uint32_t Addr, uint32_t Data, uint32_t Width)
+{
+    const uint32_t psz = (Width == 4U) ? CTL_PSZ_WORD : CTL_PSZ_BYTE;
+
+    if ((FMC_CTL & (FMC_CTL_PG | FMC_CTL_PSZ)) != (FMC_CTL_PG | psz))
+    {
+        FMC_CTL &= ~(FMC_CTL_PG | FMC_CTL_PSZ);
+        FMC_CTL |= psz;
+        FMC_CTL |= FMC_CTL_PG;
+    }
+
+    if (Width == 4U)
+    {
+        REG32(Addr) = Data;
+    }
+    else
+    {
+        REG8(Addr) = (uint8_t)Data;
+    }
+    __DSB();
+
+    while (FMC_STAT & FMC_STAT_BUSY)
+    {
+    }
+
+    if (FMC_STAT & QL_FLASH_STAT_ERR)
+    {
+        FMC_CTL &= ~FMC_CTL_PG;
+        return -1;
+    }
+
+    return 0;
+}
+
+static int32_t Ql_Flash_Erase_Sector(uint32_t Sector)
+{
+    const uint32_t ctl = (Sector < 12) ? CTL_SN(Sector) : ((Sector < 24) ? CTL_SN(Sector + 4) : CTL_SN(Sector - 12));
+
+    FMC_CTL &= ~(FMC_CTL_PG | FMC_CTL_PSZ);
+    return (fmc_sector_erase(ctl) == FMC_READY) ? 0 : -1;
+}
+
+/* CYCCNT is shared with the other benches and the storage task stats, only
+   deltas are taken, it is never reset */
+static uint32_t Ql_Flash_Bench_Stamp(void)
+{
+    return DWT->CYCCNT;
+}
+
+static uint32_t Ql_Flash_Bench_Us(uint32_t Start)
+{
+    return (DWT->CYCCNT - Start) / (SystemCoreClock / 1000000U);
+}
+#endif
+
+/*****************************************************************************
+* @brief  Let other tasks run between chunks of a long flash operation
+* ex:
+* @par
+* The CPU stalls on every instruction fetch from the bank being programmed
+* or erased, a chunk bounds that stall. Nothing is done before the
+* scheduler runs or from an ISR.
+* @retval
+*****************************************************************************/
+static void Ql_Flash_Yield(void)
+{
+#if !defined(QL_FLASH_HOST)
+    if ((xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) && (__get_IPSR() == 0))
+    {
+        Ql_Flash_Lock();
+        vTaskDelay(QL_FLASH_CHUNK_DELAY);
+        Ql_Flash_Unlock();
+    }
+#endif
 }
 
 int32_t Ql_Flash_Read(uint32_t Addr, uint8_t *Buf, uint32_t Size)
@@ -147,70 +303,173 @@ int32_t Ql_Flash_Read(uint32_t Addr, uint8_t *Buf, uint32_t Size)
     {
         return 0;
     }
-    
-    for (uint32_t i = 0; i < Size; i++, Addr++, Buf++)
-    {
-        *Buf = *(uint8_t *)Addr;
-    }
+
+    memcpy(Buf, QL_FLASH_PTR(Addr), Size);
     return Size;
 }
 
-int32_t Ql_Flash_Write(uint32_t Addr, const uint8_t *Buf, uint32_t Size)
+/*****************************************************************************
+* @brief  Program Size bytes at Addr, the area has to be erased
+* ex:
+* @par
+* Bytes up to the first word boundary and after the last one are
+* programmed one by one, the words between with one program each (the
+* GD32F4 has no x64 mode). Flags:
+* QL_FLASH_WRITE_BYTE   byte programming only
+* QL_FLASH_WRITE_CHUNK  yield after every QL_FLASH_CHUNK_SIZE bytes
+* QL_FLASH_WRITE_CRC    compare a CRC32 of the area at the end instead of
+*                       reading back every byte or word
+* @retval Size, -1: program or verify error
+*****************************************************************************/
+int32_t Ql_Flash_Write_Ex(uint32_t Addr, const uint8_t *Buf, uint32_t Size, uint32_t Flags)
 {
-    uint8_t read_data;
-    
+    const uint32_t start = Addr;
+    const uint8_t *src = Buf;
+    uint32_t left = Size;
+    uint32_t chunk = QL_FLASH_CHUNK_SIZE;
+    uint32_t width;
+    uint32_t data;
+    int32_t ret = 0;
+
     if (Size == 0)
     {
         return 0;
     }
-    
-    fmc_unlock();
-    fmc_flag_clear(FMC_FLAG_END | FMC_FLAG_OPERR | FMC_FLAG_WPERR | FMC_FLAG_PGMERR | FMC_FLAG_PGSERR);
-    
-    for (uint32_t i = 0; i < Size; i++, Addr++, Buf++)
-    {
-        /* write data */
-        fmc_byte_program(Addr, *Buf);
-        /* check data */
-        read_data = *(uint8_t *)Addr;
-        if (read_data != *Buf)
+
+    Ql_Flash_Unlock();
+
+    while ((left > 0) && (ret == 0))
+    {
+        width = (!(Flags & QL_FLASH_WRITE_BYTE) && ((Addr & 3U) == 0) && (left >= 4U)) ? 4U : 1U;
+        data  = src[0];
+        if (width == 4U)
         {
-            return -1;
+            memcpy(&data, src, 4);
+        }
+
+        ret = Ql_Flash_Prog(Addr, data, width);
+        if ((ret == 0) && !(Flags & QL_FLASH_WRITE_CRC) && (memcmp(QL_FLASH_PTR(Addr), src, width) != 0))
+        {
+            ret = -1;
+        }
+
+        Addr += width;
+        src  += width;
+        left -= width;
+
+        if ((Flags & QL_FLASH_WRITE_CHUNK) && (left > 0) && ((chunk -= width) == 0))
+        {
+            Ql_Flash_Yield();
+            chunk = QL_FLASH_CHUNK_SIZE;
         }
     }
-    
-    fmc_lock();
-    
-    return Size;
+
+    Ql_Flash_Lock();
+
+    if ((ret == 0) && (Flags & QL_FLASH_WRITE_CRC) &&
+        (Ql_Check_CRC32(0, QL_FLASH_PTR(start), Size) != Ql_Check_CRC32(0, Buf, Size)))
+    {
+        ret = -1;
+    }
+
+    return (ret == 0) ? (int32_t)Size : -1;
+}
+
+int32_t Ql_Flash_Write(uint32_t Addr, const uint8_t *Buf, uint32_t Size)
+{
+    return Ql_Flash_Write_Ex(Addr, Buf, Size, QL_FLASH_WRITE_CHUNK);
 }
 
+/*****************************************************************************
+* @brief  Erase every sector touched by Addr .. Addr + Size
+* ex:
+* @par
+* Yields between sectors.
+* @retval Size, -1: erase error
+*****************************************************************************/
 int32_t Ql_Flash_Erase(uint32_t Addr, uint32_t Size)
 {
-    uint32_t erased_size = 0;
-    uint32_t cur_erase_sector;
-    fmc_state_enum flash_status;
-    
+    uint32_t sector;
+    uint32_t last;
+    int32_t ret = 0;
+
     if (Size == 0)
     {
         return 0;
     }
-    
-    fmc_unlock();
-    fmc_flag_clear(FMC_FLAG_END | FMC_FLAG_OPERR | FMC_FLAG_WPERR | FMC_FLAG_PGMERR | FMC_FLAG_PGSERR);
-    
-    /* it will stop when erased size is greater than setting size */
-    while (erased_size < Size)
+
+    sector = Ql_Flash_Sector(Addr);
+    last   = Ql_Flash_Sector(Addr + Size - 1);
+
+    Ql_Flash_Unlock();
+
+    for ( ; (sector <= last) && (ret == 0); sector++)
     {
-        cur_erase_sector = Ql_Flash_Sector(Addr + erased_size);
-        flash_status = fmc_sector_erase(cur_erase_sector);
-        if (flash_status != FMC_READY)
+        ret = Ql_Flash_Erase_Sector(sector);
+        if ((ret == 0) && (sector < last))
         {
-            return -1;
+            Ql_Flash_Yield();
         }
-        erased_size += Ql_Flash_Sector_Size(cur_erase_sector);
     }
-    
-    fmc_lock();
-    
-    return Size;
+
+    Ql_Flash_Lock();
+
+    return (ret == 0) ? (int32_t)Size : -1;
+}
+
+/*****************************************************************************
+* @brief  Programming speed of byte, word, chunked and CRC verified writes
+* ex:
+* @par
+* Erases the sector at Addr and writes 4 KB into it per mode, leaves it
+* erased afterwards. The time includes the stall of the fetches when the
+* code runs from the same bank; on a host build it is the simulated flash
+* busy time.
+* @retval
+*****************************************************************************/
+void Ql_Flash_Bench(uint32_t Addr)
+{
+    static const char *name[] = { "byte", "word", "word chunked", "word crc verify" };
+    static const uint32_t flags[] = { QL_FLASH_WRITE_BYTE, 0, QL_FLASH_WRITE_CHUNK, QL_FLASH_WRITE_CRC };
+    const uint32_t size = 4096;
+    uint8_t *buf;
+    uint32_t start;
+    uint32_t us;
+
+    buf = pvPortMalloc(size);
+    if (buf == NULL)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < size; i++)
+    {
+        buf[i] = (uint8_t)(i * 7U);
+    }
+
+#if !defined(QL_FLASH_HOST)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    /* One unaligned byte in front so the head and tail paths run as well */
+    for (uint32_t m = 0; m < sizeof(flags) / sizeof(flags[0]); m++)
+    {
+        if (Ql_Flash_Erase(Addr, size + 1) < 0)
+        {
+            QL_LOG_E("bench erase fail");
+            break;
+        }
+        start = Ql_Flash_Bench_Stamp();
+        if (Ql_Flash_Write_Ex(Addr + 1, buf, size, flags[m]) < 0)
+        {
+            QL_LOG_E("bench %s write fail", name[m]);
+            break;
+        }
+        us = Ql_Flash_Bench_Us(start);
+        QL_LOG_I("%s: %u bytes in %u us, %u KB/s", name[m], size, us,
+                  (us > 0) ? (uint32_t)((uint64_t)size * 1000000U / 1024U / us) : 0);
+    }
+
+    Ql_Flash_Erase(Addr, size + 1);
+    vPortFree(buf);
 }
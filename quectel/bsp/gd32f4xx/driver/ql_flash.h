@@ -25,8 +25,46 @@ limitations under the License.
 
 #include "gd32f4xx.h"
 
+/* Sector 23 for persistent parameters. The IROM1 region of the Keil project
+   ends at QL_FLASH_LOG_ADDR, so the linker never places code in it */
+#define QL_FLASH_PARAM_ADDR     (0x081E0000U)
+#define QL_FLASH_PARAM_SIZE     (128U * 1024U)
+
+/* Sectors 20..22 below it, the circular event log of ql_flash_log.c */
+#define QL_FLASH_LOG_ADDR       (0x08180000U)
+#define QL_FLASH_LOG_SIZE       (3U * 128U * 1024U)
+
+#define QL_FLASH_SECTORS        (28U)
+
+/* Ql_Flash_Write_Ex flags */
+#define QL_FLASH_WRITE_BYTE     (0x01U)     // byte programming only
+#define QL_FLASH_WRITE_CHUNK    (0x02U)     // let other tasks run between chunks
+#define QL_FLASH_WRITE_CRC      (0x04U)     // one CRC32 over the area instead of a read back per word
+
+#define QL_FLASH_CHUNK_SIZE     (1024U)     // bytes, about 4 ms of word programming
+#define QL_FLASH_CHUNK_DELAY    (1U)        // ticks between chunks and between erased sectors
+
+#if defined(QL_FLASH_HOST)
+/* Host build: sectors 0..23 are a RAM array with flash semantics, erased
+   to 0xFF, programming only clears bits */
+typedef struct
+{
+    uint32_t    Erases[QL_FLASH_SECTORS];
+    uint32_t    Prog_Ops;
+    uint32_t    Prog_Bytes;
+    uint32_t    Prog_Errors;    // bits that would have to go from 0 to 1
+    uint32_t    Busy_Us;        // flash time at the GD32F4 typical figures
+    int32_t     Cut_After;      // bytes programmed until the power fails, -1: never
+} Ql_Flash_Sim_TypeDef;
+
+Ql_Flash_Sim_TypeDef *Ql_Flash_Sim(void);
+void    Ql_Flash_Sim_Reset(void);
+#endif
+
 int32_t Ql_Flash_Read(uint32_t Addr, uint8_t *Buf, uint32_t Size);
 int32_t Ql_Flash_Write(uint32_t Addr, const uint8_t *Buf, uint32_t Size);
+int32_t Ql_Flash_Write_Ex(uint32_t Addr, const uint8_t *Buf, uint32_t Size, uint32_t Flags);
 int32_t Ql_Flash_Erase(uint32_t Addr, uint32_t Size);
+void    Ql_Flash_Bench(uint32_t Addr);
 
 #endif
@@ -24,6 +24,7 @@ limitations under the License.
 #include "gd32f4xx.h"
 #include "ql_iic.h"
 #include "ql_delay.h"
+#include "ql_uart.h"
 #include <stdbool.h>
 
 #define LOG_TAG "ql_iic"
@@ -38,6 +39,11 @@ limitations under the License.
 #define QL_I2C0_SCL_GPIO_PIN                    GPIO_PIN_6
 #define QL_I2C0_SDA_GPIO_PIN                    GPIO_PIN_7
 #define QL_I2C0_DMA0_CH0_IRQ_PRI                configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0
+#define QL_I2C0_DMA0_CH7_IRQ_PRI                configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0
+#define QL_I2C0_DMA                             DMA0
+#define QL_I2C0_DMA_RX_CH                       DMA_CH0              //I2C0_RX, shared with UART4_RX
+#define QL_I2C0_DMA_TX_CH                       DMA_CH7              //I2C0_TX, shared with UART4_TX
+#define QL_I2C0_DMA_SUBPERI                     DMA_SUBPERI1
 
 #define I2C0_SLAVE_ADDRESS7                     0x50 >> 1            //address format is 7 bits 
 
@@ -45,6 +51,7 @@ limitations under the License.
 #define QL_I2C_DELAY                            0x0000FFFF
 #define QL_I2C_SEM_TIMEOUT                      1000                //unit = 1ms
 #define VN_I2C_EVENT_TIMEOUT                    1000                //unit = 1ms
+#define QL_IIC_BENCH_IDLE_MS                    200                 //calibration window of the idle loop of Ql_IIC_Bench
 
 #define QL_IIC_READ_FLAG                        0x01                // Read Flag
 #define QL_IIC_WRITE_FLAG                       0xFE                // Write Flag
@@ -60,6 +67,8 @@ limitations under the License.
 //-----static global variable-----
 static uint32_t simmulate_delay = 5;                                 //IIC delay time (us)
 static IIC_Ins_TypeDef iic_ins;                                      //IIC  instance
+static volatile uint32_t iic_bench_loops;                            //idle loop count of Ql_IIC_Bench
+static volatile uint8_t iic_bench_run;
 // static IIC_CFG_TypeDef iic_cfg;                                      //IIC  config
 
 //-----static function declare-----
@@ -334,7 +343,7 @@ static Ql_IIC_Status_TypeDef Ql_IIC_SwSimulateDeInit(IIC_Mode_TypeDef mode)
 static uint32_t Ql_IIC_HwGetPort(IIC_Mode_TypeDef mode)
 {
     uint32_t iic_periph = 0;
-    if ((IIC_MODE_HW0_INTERRUPT == mode) || (IIC_MODE_HW0_POLLING == mode))
+    if ((IIC_MODE_HW0_INTERRUPT == mode) || (IIC_MODE_HW0_POLLING == mode) || (IIC_MODE_HW0_DMA == mode))
     {
         iic_periph = I2C0;
     }
@@ -439,6 +448,80 @@ static void Ql_IIC_HwFlagClear(void)
     i2c_flag_clear(iic_periph, I2C_FLAG_RFR);
 }
 /*******************************************************************************
+* Name: void Ql_IIC_HwDmaConfig(void)
+* Brief: Set up the DMA0 channels of I2C0. Each transfer sets the memory address
+*        and the count, the full transfer finish interrupt wakes the caller.
+*        CH0 and CH7 are the channels of UART4 as well, the handlers in
+*        ql_uart.c pass them on here while UART4 is closed.
+* Input: 
+*   none.
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_HwDmaConfig(void)
+{
+    dma_single_data_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_DMA0);
+    dma_single_data_para_struct_init(&dma_init_struct);
+
+    dma_deinit(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH);
+    dma_init_struct.direction           = DMA_MEMORY_TO_PERIPH;
+    dma_init_struct.memory_inc          = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.periph_memory_width = DMA_PERIPH_WIDTH_8BIT;
+    dma_init_struct.periph_addr         = ((uint32_t)&I2C_DATA(I2C0));
+    dma_init_struct.periph_inc          = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.priority            = DMA_PRIORITY_HIGH;
+    dma_single_data_mode_init(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, &dma_init_struct);
+    dma_circulation_disable(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH);
+    dma_channel_subperipheral_select(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, QL_I2C0_DMA_SUBPERI);
+
+    dma_deinit(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH);
+    dma_init_struct.direction           = DMA_PERIPH_TO_MEMORY;
+    dma_single_data_mode_init(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, &dma_init_struct);
+    dma_circulation_disable(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH);
+    dma_channel_subperipheral_select(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, QL_I2C0_DMA_SUBPERI);
+
+    nvic_irq_enable(DMA0_Channel0_IRQn, QL_I2C0_DMA0_CH0_IRQ_PRI);
+    nvic_irq_enable(DMA0_Channel7_IRQn, QL_I2C0_DMA0_CH7_IRQ_PRI);
+}
+/*******************************************************************************
+* Name: void Ql_IIC_HwDmaStop(uint32_t iic_periph)
+* Brief: Stop the DMA of a transfer, whichever way it ended.
+* Input: 
+*   iic_periph: I2C peripheral
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_HwDmaStop(uint32_t iic_periph)
+{
+    dma_interrupt_disable(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_CHXCTL_FTFIE);
+    dma_interrupt_disable(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_CHXCTL_FTFIE);
+    dma_channel_disable(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH);
+    dma_channel_disable(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH);
+    dma_flag_clear(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_FLAG_FTF);
+    dma_flag_clear(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_FLAG_FTF);
+    i2c_dma_config(iic_periph, I2C_DMA_OFF);
+    i2c_dma_last_transfer_config(iic_periph, I2C_DMALST_OFF);
+}
+/*******************************************************************************
+* Name: void Ql_IIC_HwDmaDeInit(void)
+* Brief: Release the DMA0 channels of I2C0 for UART4.
+* Input: 
+*   none.
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_HwDmaDeInit(void)
+{
+    Ql_IIC_HwDmaStop(I2C0);
+    nvic_irq_disable(DMA0_Channel0_IRQn);
+    nvic_irq_disable(DMA0_Channel7_IRQn);
+    dma_deinit(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH);
+    dma_deinit(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH);
+    Ql_Uart_Dma0_Release(QL_DMA0_SHARED_IIC0);
+}
+/*******************************************************************************
 * Name: void Ql_IIC_HwInit(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef speed_type)
 * Brief: IIC hardware controller initialization.
 * Input: 
@@ -461,7 +544,7 @@ static void Ql_IIC_HwInit(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef speed_type)
         return ;
     }
 
-    if((IIC_MODE_HW0_INTERRUPT == mode) || (IIC_MODE_HW0_POLLING == mode))
+    if((IIC_MODE_HW0_INTERRUPT == mode) || (IIC_MODE_HW0_POLLING == mode) || (IIC_MODE_HW0_DMA == mode))
     {
         rcu_periph_clock_enable(QL_I2C0_RCU_PORT);
         rcu_periph_clock_enable(RCU_I2C0);
@@ -491,7 +574,10 @@ static void Ql_IIC_HwInit(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef speed_type)
         i2c_clock_config(iic_periph, speed, I2C_DTCY_2);
         i2c_mode_addr_config(iic_periph, I2C_I2CMODE_ENABLE, I2C_ADDFORMAT_7BITS, I2C0_SLAVE_ADDRESS7);
 
-        //Ql_IIC_HwDmaConfig(&iic_ins);
+        if(IIC_MODE_HW0_DMA == mode)
+        {
+            Ql_IIC_HwDmaConfig();
+        }
 
         i2c_enable(iic_periph);
         i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
@@ -524,9 +610,13 @@ static void Ql_IIC_HwDeInit(IIC_Mode_TypeDef mode)
         QL_LOG_E("wait iic port sem failed");
         return ;
     }
-    if((IIC_MODE_HW0_INTERRUPT == mode) || (IIC_MODE_HW0_POLLING == mode))
+    if((IIC_MODE_HW0_INTERRUPT == mode) || (IIC_MODE_HW0_POLLING == mode) || (IIC_MODE_HW0_DMA == mode))
     {
         iic_periph = Ql_IIC_HwGetPort(iic->mode);
+        if(IIC_MODE_HW0_DMA == mode)
+        {
+            Ql_IIC_HwDmaDeInit();
+        }
         Ql_IIC_HwItDisable();
         Ql_IIC_HwFlagClear();
         i2c_software_reset_config(iic_periph, I2C_SRESET_SET);
@@ -690,6 +780,33 @@ static Ql_IIC_Status_TypeDef Ql_IIC_WaitForFlagUntilTimeout(uint32_t I2C_Port, i
     return status;
 }
 
+/*******************************************************************************
+* Name: void Ql_IIC_HwAddrNack(uint32_t iic_periph)
+* Brief: The slave did not acknowledge its address, the master has to end the
+*        transaction itself: clear AERR and send a STOP so that the bus is free
+*        for the next start.
+* Input: 
+*   iic_periph: I2C peripheral
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_HwAddrNack(uint32_t iic_periph)
+{
+    uint32_t delay = QL_I2C_DELAY;
+
+    if(RESET == i2c_flag_get(iic_periph, I2C_FLAG_AERR))
+    {
+        return;
+    }
+
+    i2c_flag_clear(iic_periph, I2C_FLAG_AERR);
+    i2c_stop_on_bus(iic_periph);
+    while((I2C_CTL0(iic_periph) & I2C_CTL0_STOP) && (0 != delay--))
+    {
+    }
+    iic_ins.err_nck++;
+}
+
 /*******************************************************************************
 * Name:  Ql_IIC_Status_TypeDef Ql_IIC_LowLevelInit(Ql_IIC_Port_TypeDef port, IIC_Speed_TypeDef IIC_Mode)
 * Brief: This function initialize the configurations for an port. including SW IIC or HW IIC.
@@ -753,6 +870,14 @@ static Ql_IIC_Status_TypeDef Ql_IIC_LowLevelInit(IIC_Mode_TypeDef mode, IIC_Spee
     {
         Ql_IIC_HwInit(mode,iic->speed);
     }
+    else if (IIC_MODE_HW0_DMA == mode)
+    {
+        if (NULL == iic->event)
+        {
+            iic->event = xEventGroupCreate();
+        }
+        Ql_IIC_HwInit(mode,iic->speed);
+    }
     else
     {
         return QL_IIC_STATUS_PARAM_ERROR;
@@ -1192,6 +1317,7 @@ static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterTransmit(uint16_t DevAddr, uint8_t R
 
     do
     {
+        iic->status = QL_IIC_STATUS_OK;
         i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
         if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_I2CBSY, SET, QL_I2C_DELAY))
         {
@@ -1209,6 +1335,7 @@ static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterTransmit(uint16_t DevAddr, uint8_t R
         i2c_master_addressing(iic_periph, DevAddr, I2C_TRANSMITTER);
         if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_ADDSEND, RESET, QL_I2C_DELAY))
         {
+            Ql_IIC_HwAddrNack(iic_periph);
             iic->status = QL_IIC_STATUS_ADDSEND_ERROR;
             break;
         }
@@ -1345,6 +1472,7 @@ static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterReceive(uint16_t DevAddr, uint8_t Re
             i2c_master_addressing(iic_periph, DevAddr, I2C_TRANSMITTER);
             if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_ADDSEND, RESET, QL_I2C_DELAY))
             {
+                Ql_IIC_HwAddrNack(iic_periph);
                 iic->status = QL_IIC_STATUS_ADDSEND_ERROR;
                 break;
             }
@@ -1377,6 +1505,7 @@ static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterReceive(uint16_t DevAddr, uint8_t Re
         i2c_master_addressing(iic_periph, DevAddr, I2C_RECEIVER);
         if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_ADDSEND, RESET, QL_I2C_DELAY))
         {
+            Ql_IIC_HwAddrNack(iic_periph);
             iic->status = QL_IIC_STATUS_ADDSEND_ERROR;
             break;
         }
@@ -1497,171 +1626,508 @@ static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterReceive(uint16_t DevAddr, uint8_t Re
 }
 
 /*******************************************************************************
-* Hayden @ 20240912
-* Name: void Ql_IIC_I2C0_EV_IRQHandler(void)
-* Brief: This function handle the I2C event interrupt.
+* Name: Ql_IIC_HwMasterDmaTransmit(uint16_t DevAddr, uint8_t Reg_Addr,uint8_t *Data, uint32_t Size, uint32_t Timeout)
+* Brief: hardware IIC master mode transmit data through DMA. The address phase
+*        is polled, the data goes out by DMA0 CH7 from tx_buf while the caller
+*        sleeps on the event group. The STOP waits for BTC of the last byte,
+*        the event interrupt sends it and sets VN_IIC_IT_TX_COMPLETE.
 * Input: 
-*   none.
+*   DevAddr: i2c device address
+*   Reg_Addr: i2c register address
+*   Data: data buffer
+*   Size: data size
+*   Timeout: timeout period unit:ms
 * Return:
-*   none.
+*   Ql_IIC_Status_TypeDef: QL_IIC_STATUS_OK or QL_IIC_STATUS_ERROR
 *******************************************************************************/
-void Ql_IIC_I2C0_EV_IRQHandler(void)
+static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterDmaTransmit(uint16_t DevAddr, uint8_t Reg_Addr,uint8_t *Data, uint32_t Size, uint32_t Timeout)
 {
+    uint32_t iic_periph = 0;
     IIC_Ins_TypeDef* iic = &iic_ins;
-    uint32_t  iic_periph = Ql_IIC_HwGetPort(iic->mode);
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    BaseType_t xReturn;
+    EventBits_t waitEventBits = 0;
+    uint32_t delay = QL_I2C_DELAY;
+    Ql_IIC_Status_TypeDef status = QL_IIC_STATUS_OK;
 
-    /* flag to sign whether the register address has been sent or not*/
-    static bool is_reg_addr_sent = false;
+    xReturn = xSemaphoreTake(iic->sem, Timeout);
+    if (xReturn == pdFAIL)
+    {
+        iic->status = QL_IIC_STATUS_SEM_ERROR;
+        return QL_IIC_STATUS_SEM_ERROR;
+    }
+
+    iic_periph = Ql_IIC_HwGetPort(iic->mode);
 
     if (0 == iic_periph)
     {
         iic->status = QL_IIC_STATUS_MODE_ERROR;
-        return;
+        xSemaphoreGive(iic->sem);
+        return QL_IIC_STATUS_MODE_ERROR;
     }
-    
-    if( iic->rw == QL_IIC_READ)
+
+    if(iic->tx_size < Size)
     {
-        /* if register address isn't 0 and hasn't been sent yet */
-        if((iic->reg_addr > 0) && (false == is_reg_addr_sent))
-        {
-            if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_SBSEND))
-            {
-                i2c_master_addressing(iic_periph, iic->dev_addr, I2C_TRANSMITTER);
-            }
-            else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_ADDSEND))
-            {
-                i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_ADDSEND);
-            }
-            else if((i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_TBE)) && (!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_AERR)))
-            {
-                i2c_data_transmit(iic_periph, iic->reg_addr);
-                is_reg_addr_sent = true;
-            }
-        }
+        iic->status = QL_IIC_STATUS_MEMORY_ERROR;
+        xSemaphoreGive(iic->sem);
+        return QL_IIC_STATUS_MEMORY_ERROR;
+    }
 
-        else if((i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_TBE)) && (!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_AERR)))
+    /* the DMA can not reach a caller buffer in TCM SRAM */
+    memcpy(iic->tx_buf, Data, Size);
+    iic->dev_addr = DevAddr;
+    iic->reg_addr = Reg_Addr;
+    iic->rw_size = Size;
+    iic->rw_nbytes = Size;
+    iic->rw = QL_IIC_WRITE;
+    xEventGroupClearBits(iic->event, VN_IIC_IT_RX_COMPLETE|VN_IIC_IT_TX_COMPLETE|VN_IIC_IT_RXTX_ERROR);
+
+    do
+    {
+        iic->status = QL_IIC_STATUS_OK;
+        i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
+        if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_I2CBSY, SET, QL_I2C_DELAY))
         {
-            i2c_start_on_bus(iic_periph);
+            iic->status = QL_IIC_STATUS_BUSY;
+            break;
         }
 
-        else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_SBSEND))
+        i2c_start_on_bus(iic_periph);
+        if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_SBSEND, RESET, QL_I2C_DELAY))
         {
-            i2c_master_addressing(iic_periph, iic->dev_addr, I2C_RECEIVER);
+            iic->status = QL_IIC_STATUS_SBSEND_ERROR;
+            break;
         }
-        else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_ADDSEND))
+
+        i2c_master_addressing(iic_periph, DevAddr, I2C_TRANSMITTER);
+        if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_ADDSEND, RESET, QL_I2C_DELAY))
         {
-            if((1 == iic->rw_size) || (2 == iic->rw_size)) {
-                /* clear the ACKEN before the ADDSEND is cleared */
-                i2c_ack_config(iic_periph, I2C_ACK_DISABLE);
-            }
-            /* clear the ADDSEND bit */
-            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_ADDSEND);
+            Ql_IIC_HwAddrNack(iic_periph);
+            iic->status = QL_IIC_STATUS_ADDSEND_ERROR;
+            break;
         }
-        else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_RBNE))
+
+        i2c_flag_clear(iic_periph, I2C_FLAG_ADDSEND);
+
+        /* if Reg_Addr > 0, send register address ahead of the DMA */
+        if(Reg_Addr > 0)
         {
-            if( iic->rw_nbytes > 0){
-                if(3 ==  iic->rw_nbytes) {
-                    /* wait until the second last data byte is received into the shift register */
-                    while(!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_BTC));
-                    /* send a NACK for the last data byte */
-                    i2c_ack_config(iic_periph, I2C_ACK_DISABLE);
-                }
-                /* read a data byte from I2C_DATA*/
-                iic->rx_buf[iic->rw_size - iic->rw_nbytes] = i2c_data_receive(iic_periph);
-                iic->rw_nbytes--;
-                iic->rx_index++;
-                if(1 == iic->rw_nbytes)
-                {
-                    i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_BTC);
-                }
-                if(0 == iic->rw_nbytes){
-                    /* send a stop condition */
-                    i2c_stop_on_bus(iic_periph);
-                    i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
-                    i2c_ackpos_config(iic_periph, I2C_ACKPOS_CURRENT);
-                    i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_BTC);
-                    i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_RBNE);
-                    /* disable the I2CX interrupt */
-                    Ql_IIC_HwItDisable();
-                    iic->rw = QL_IIC_STOP;
-                    iic->status = QL_IIC_STATUS_OK;
-                    xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_RX_COMPLETE,xHigherPriorityTaskWoken);
-                    is_reg_addr_sent = false;
-                }
+            if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_TBE, RESET, QL_I2C_DELAY))
+            {
+                i2c_stop_on_bus(iic_periph);
+                iic->status = QL_IIC_STATUS_TBE_ERROR;
+                break;
             }
+            i2c_data_transmit(iic_periph, Reg_Addr);
         }
-        else if (SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_STPDET))
+
+        dma_memory_address_config(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_MEMORY_0, (uint32_t)iic->tx_buf);
+        dma_transfer_number_config(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, Size);
+        dma_flag_clear(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_FLAG_FTF);
+        dma_interrupt_enable(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_CHXCTL_FTFIE);
+        i2c_interrupt_enable(iic_periph, I2C_INT_ERR);
+        i2c_dma_config(iic_periph, I2C_DMA_ON);
+        dma_channel_enable(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH);
+
+        waitEventBits = xEventGroupWaitBits(iic->event, VN_IIC_IT_TX_COMPLETE|VN_IIC_IT_RXTX_ERROR, pdTRUE, pdFALSE, VN_I2C_EVENT_TIMEOUT);
+        if(0 == waitEventBits)
         {
-            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_STPDET);
-            /* send a stop condition */
             i2c_stop_on_bus(iic_periph);
-            i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
-            i2c_ackpos_config(iic_periph, I2C_ACKPOS_CURRENT);
-            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_BTC);
-            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_RBNE);
-            /* disable the I2CX interrupt */
-            Ql_IIC_HwItDisable();
-            iic->rw = QL_IIC_STOP;
-            iic->status = QL_IIC_STATUS_OK;
-            xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_RX_COMPLETE,xHigherPriorityTaskWoken);
-            is_reg_addr_sent = false;
-        }
-        else
-        {
-            iic->err_ev++;
-            Ql_IIC_HwItDisable();
+            iic->status = QL_IIC_STATUS_TIMEOUT;
+            QL_LOG_E("iic dma transmit timeout, left:%d,total:%d", dma_transfer_number_get(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH), Size);
+            break;
         }
-    }
-    else if (iic->rw == QL_IIC_WRITE)
-    {
-        if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_SBSEND))
+        if(waitEventBits & VN_IIC_IT_RXTX_ERROR)
         {
-             i2c_master_addressing(iic_periph, iic->dev_addr, I2C_TRANSMITTER);
+            /* the error interrupt sent the STOP and set the status */
+            break;
         }
-        else if(i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_ADDSEND)) 
-        {
-            /* clear the ADDSEND bit */
-            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_ADDSEND);
-        } 
-        else if((i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_TBE)) && (!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_AERR)))  
+
+        while(I2C_CTL0(iic_periph) & I2C_CTL0_STOP)
         {
-            if((iic->reg_addr > 0) && (false == is_reg_addr_sent))
-            {
-                /* send the register address that need to be written to */
-                i2c_data_transmit(iic_periph, iic->reg_addr);
-                is_reg_addr_sent = true;
-            }
-            else if ((iic->rw_nbytes > 0))
-            {
-                /* send a data byte */
-                i2c_data_transmit(iic_periph, iic->tx_buf[iic->rw_size - iic->rw_nbytes]);
-                iic->rw_nbytes--;
-            }
-            else
+            if(0 == delay--)
             {
-                /* send a stop condition */
-                i2c_stop_on_bus(iic_periph);
-                /* disable the I2CX interrupt */
-                Ql_IIC_HwItDisable();
-                iic->rw = QL_IIC_STOP;
-                iic->status = QL_IIC_STATUS_OK;
-                xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_TX_COMPLETE,xHigherPriorityTaskWoken);
-                /* restore the flag to default when finish operation */
-                is_reg_addr_sent = false;
+                iic->status = QL_IIC_STATUS_TIMEOUT;
+                break;
             }
         }
-        else
-        {
-            iic->err_ev++;
-            Ql_IIC_HwItDisable();
-        }
-    }
-    else 
-    {
-        iic->err_ev++;
-        Ql_IIC_HwItDisable();
-    }
+    }while(0);
+
+    Ql_IIC_HwDmaStop(iic_periph);
+    Ql_IIC_HwItDisable();
+    iic->rw = QL_IIC_STOP;
+
+    if(QL_IIC_STATUS_OK == iic->status)
+    {
+        iic->tx_cnt += Size;
+    }
+    else if(0 == (waitEventBits & VN_IIC_IT_RXTX_ERROR))
+    {
+        iic->err_er++;
+    }
+    status = iic->status;
+    xSemaphoreGive(iic->sem);
+    return status;
+}
+/*******************************************************************************
+* Name: Ql_IIC_HwMasterDmaReceive(uint16_t DevAddr, uint8_t Reg_Addr,uint8_t *Data, uint32_t Size, uint32_t Timeout)
+* Brief: hardware IIC master mode receive data through DMA. The address phase
+*        is polled, DMA0 CH0 fills rx_buf while the caller sleeps on the event
+*        group. With DMALST the I2C NACKs the last byte by itself, the DMA
+*        interrupt sends the STOP and sets VN_IIC_IT_RX_COMPLETE. A single
+*        byte has to be NACKed before ADDSEND is cleared, it is polled.
+* Input: 
+*   DevAddr: i2c device address
+*   Reg_Addr: i2c register address
+*   Data: data buffer
+*   Size: data size
+*   Timeout: timeout period unit:ms
+* Return:
+*   Ql_IIC_Status_TypeDef: QL_IIC_STATUS_OK or QL_IIC_STATUS_ERROR
+*******************************************************************************/
+static Ql_IIC_Status_TypeDef Ql_IIC_HwMasterDmaReceive(uint16_t DevAddr, uint8_t Reg_Addr,uint8_t *Data, uint32_t Size, uint32_t Timeout)
+{
+    uint32_t iic_periph = 0;
+    IIC_Ins_TypeDef* iic = &iic_ins;
+    BaseType_t xReturn;
+    EventBits_t waitEventBits = 0;
+    uint32_t delay = QL_I2C_DELAY;
+    Ql_IIC_Status_TypeDef status = QL_IIC_STATUS_OK;
+
+    if(Size < 2)
+    {
+        return Ql_IIC_HwMasterReceive(DevAddr, Reg_Addr, Data, Size, Timeout);
+    }
+
+    xReturn = xSemaphoreTake(iic->sem, Timeout);
+    if (xReturn == pdFAIL)
+    {
+        iic->status = QL_IIC_STATUS_SEM_ERROR;
+        return QL_IIC_STATUS_SEM_ERROR;
+    }
+
+    iic_periph = Ql_IIC_HwGetPort(iic->mode);
+
+    if (0 == iic_periph)
+    {
+        iic->status = QL_IIC_STATUS_MODE_ERROR;
+        xSemaphoreGive(iic->sem);
+        return QL_IIC_STATUS_MODE_ERROR;
+    }
+
+    if(iic->rx_size < Size)
+    {
+        iic->status = QL_IIC_STATUS_MEMORY_ERROR;
+        xSemaphoreGive(iic->sem);
+        return QL_IIC_STATUS_MEMORY_ERROR;
+    }
+
+    iic->dev_addr = DevAddr;
+    iic->reg_addr = Reg_Addr;
+    iic->rw_size = Size;
+    iic->rw_nbytes = Size;
+    iic->rw = QL_IIC_READ;
+    xEventGroupClearBits(iic->event, VN_IIC_IT_RX_COMPLETE|VN_IIC_IT_TX_COMPLETE|VN_IIC_IT_RXTX_ERROR);
+
+    do
+    {
+        iic->status = QL_IIC_STATUS_OK;
+        i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
+        if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_I2CBSY, SET, QL_I2C_DELAY))
+        {
+            iic->status = QL_IIC_STATUS_BUSY;
+            break;
+        }
+
+        if(Reg_Addr > 0)
+        {
+            i2c_start_on_bus(iic_periph);
+            if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_SBSEND, RESET, QL_I2C_DELAY))
+            {
+                iic->status = QL_IIC_STATUS_SBSEND_ERROR;
+                break;
+            }
+
+            i2c_master_addressing(iic_periph, DevAddr, I2C_TRANSMITTER);
+            if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_ADDSEND, RESET, QL_I2C_DELAY))
+            {
+                Ql_IIC_HwAddrNack(iic_periph);
+                iic->status = QL_IIC_STATUS_ADDSEND_ERROR;
+                break;
+            }
+
+            i2c_flag_clear(iic_periph, I2C_FLAG_ADDSEND);
+
+            if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_TBE, RESET, QL_I2C_DELAY))
+            {
+                i2c_stop_on_bus(iic_periph);
+                iic->status = QL_IIC_STATUS_TBE_ERROR;
+                break;
+            }
+
+            i2c_data_transmit(iic_periph, Reg_Addr);
+            if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_BTC, RESET, QL_I2C_DELAY))
+            {
+                i2c_stop_on_bus(iic_periph);
+                iic->status = QL_IIC_STATUS_BTC_ERROR;
+                break;
+            }
+        }
+
+        dma_memory_address_config(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_MEMORY_0, (uint32_t)iic->rx_buf);
+        dma_transfer_number_config(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, Size);
+        dma_flag_clear(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_FLAG_FTF);
+        dma_interrupt_enable(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_CHXCTL_FTFIE);
+        dma_channel_enable(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH);
+        /* the next DMA EOT is the last transfer, the I2C NACKs the last byte */
+        i2c_dma_last_transfer_config(iic_periph, I2C_DMALST_ON);
+        i2c_dma_config(iic_periph, I2C_DMA_ON);
+
+        i2c_start_on_bus(iic_periph);
+        if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_SBSEND, RESET, QL_I2C_DELAY))
+        {
+            iic->status = QL_IIC_STATUS_SBSEND_ERROR;
+            break;
+        }
+
+        i2c_master_addressing(iic_periph, DevAddr, I2C_RECEIVER);
+        if(QL_IIC_STATUS_TIMEOUT == Ql_IIC_WaitForFlagUntilTimeout(iic_periph, I2C_FLAG_ADDSEND, RESET, QL_I2C_DELAY))
+        {
+            Ql_IIC_HwAddrNack(iic_periph);
+            iic->status = QL_IIC_STATUS_ADDSEND_ERROR;
+            break;
+        }
+
+        i2c_interrupt_enable(iic_periph, I2C_INT_ERR);
+        /* clear ADDSEND bit, the slave starts to send */
+        i2c_flag_clear(iic_periph, I2C_FLAG_ADDSEND);
+
+        waitEventBits = xEventGroupWaitBits(iic->event, VN_IIC_IT_RX_COMPLETE|VN_IIC_IT_RXTX_ERROR, pdTRUE, pdFALSE, VN_I2C_EVENT_TIMEOUT);
+        if(0 == waitEventBits)
+        {
+            i2c_stop_on_bus(iic_periph);
+            iic->status = QL_IIC_STATUS_TIMEOUT;
+            QL_LOG_E("iic dma receive timeout, left:%d,total:%d", dma_transfer_number_get(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH), Size);
+            break;
+        }
+        if(waitEventBits & VN_IIC_IT_RXTX_ERROR)
+        {
+            /* the error interrupt sent the STOP and set the status */
+            break;
+        }
+
+        while(I2C_CTL0(iic_periph) & I2C_CTL0_STOP)
+        {
+            if(0 == delay--)
+            {
+                iic->status = QL_IIC_STATUS_TIMEOUT;
+                break;
+            }
+        }
+        memcpy(Data, iic->rx_buf, Size);
+    }while(0);
+
+    Ql_IIC_HwDmaStop(iic_periph);
+    Ql_IIC_HwItDisable();
+    i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
+    iic->rw = QL_IIC_STOP;
+
+    if (QL_IIC_STATUS_OK == iic->status)
+    {
+        iic->rx_cnt += Size;
+    }
+    else if(0 == (waitEventBits & VN_IIC_IT_RXTX_ERROR))
+    {
+        iic->err_er++;
+    }
+    status = iic->status;
+    xSemaphoreGive(iic->sem);
+    return status;
+}
+
+/*******************************************************************************
+* Hayden @ 20240912
+* Name: void Ql_IIC_I2C0_EV_IRQHandler(void)
+* Brief: This function handle the I2C event interrupt.
+* Input: 
+*   none.
+* Return:
+*   none.
+*******************************************************************************/
+void Ql_IIC_I2C0_EV_IRQHandler(void)
+{
+    IIC_Ins_TypeDef* iic = &iic_ins;
+    uint32_t  iic_periph = Ql_IIC_HwGetPort(iic->mode);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    /* flag to sign whether the register address has been sent or not*/
+    static bool is_reg_addr_sent = false;
+
+    if (0 == iic_periph)
+    {
+        iic->status = QL_IIC_STATUS_MODE_ERROR;
+        return;
+    }
+
+    /* DMA transmit: the last byte has left the shift register */
+    if (IIC_MODE_HW0_DMA == iic->mode)
+    {
+        if((QL_IIC_WRITE == iic->rw) && (SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_BTC)))
+        {
+            i2c_stop_on_bus(iic_periph);
+            iic->rw = QL_IIC_STOP;
+            xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_TX_COMPLETE, &xHigherPriorityTaskWoken);
+        }
+        else
+        {
+            iic->err_ev++;
+        }
+        i2c_interrupt_disable(iic_periph, I2C_INT_EV);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+        return;
+    }
+    
+    if( iic->rw == QL_IIC_READ)
+    {
+        /* if register address isn't 0 and hasn't been sent yet */
+        if((iic->reg_addr > 0) && (false == is_reg_addr_sent))
+        {
+            if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_SBSEND))
+            {
+                i2c_master_addressing(iic_periph, iic->dev_addr, I2C_TRANSMITTER);
+            }
+            else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_ADDSEND))
+            {
+                i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_ADDSEND);
+            }
+            else if((i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_TBE)) && (!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_AERR)))
+            {
+                i2c_data_transmit(iic_periph, iic->reg_addr);
+                is_reg_addr_sent = true;
+            }
+        }
+
+        else if((i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_TBE)) && (!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_AERR)))
+        {
+            i2c_start_on_bus(iic_periph);
+        }
+
+        else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_SBSEND))
+        {
+            i2c_master_addressing(iic_periph, iic->dev_addr, I2C_RECEIVER);
+        }
+        else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_ADDSEND))
+        {
+            if((1 == iic->rw_size) || (2 == iic->rw_size)) {
+                /* clear the ACKEN before the ADDSEND is cleared */
+                i2c_ack_config(iic_periph, I2C_ACK_DISABLE);
+            }
+            /* clear the ADDSEND bit */
+            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_ADDSEND);
+        }
+        else if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_RBNE))
+        {
+            if( iic->rw_nbytes > 0){
+                if(3 ==  iic->rw_nbytes) {
+                    /* wait until the second last data byte is received into the shift register */
+                    while(!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_BTC));
+                    /* send a NACK for the last data byte */
+                    i2c_ack_config(iic_periph, I2C_ACK_DISABLE);
+                }
+                /* read a data byte from I2C_DATA*/
+                iic->rx_buf[iic->rw_size - iic->rw_nbytes] = i2c_data_receive(iic_periph);
+                iic->rw_nbytes--;
+                iic->rx_index++;
+                if(1 == iic->rw_nbytes)
+                {
+                    i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_BTC);
+                }
+                if(0 == iic->rw_nbytes){
+                    /* send a stop condition */
+                    i2c_stop_on_bus(iic_periph);
+                    i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
+                    i2c_ackpos_config(iic_periph, I2C_ACKPOS_CURRENT);
+                    i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_BTC);
+                    i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_RBNE);
+                    /* disable the I2CX interrupt */
+                    Ql_IIC_HwItDisable();
+                    iic->rw = QL_IIC_STOP;
+                    iic->status = QL_IIC_STATUS_OK;
+                    xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_RX_COMPLETE,xHigherPriorityTaskWoken);
+                    is_reg_addr_sent = false;
+                }
+            }
+        }
+        else if (SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_STPDET))
+        {
+            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_STPDET);
+            /* send a stop condition */
+            i2c_stop_on_bus(iic_periph);
+            i2c_ack_config(iic_periph, I2C_ACK_ENABLE);
+            i2c_ackpos_config(iic_periph, I2C_ACKPOS_CURRENT);
+            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_BTC);
+            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_RBNE);
+            /* disable the I2CX interrupt */
+            Ql_IIC_HwItDisable();
+            iic->rw = QL_IIC_STOP;
+            iic->status = QL_IIC_STATUS_OK;
+            xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_RX_COMPLETE,xHigherPriorityTaskWoken);
+            is_reg_addr_sent = false;
+        }
+        else
+        {
+            iic->err_ev++;
+            Ql_IIC_HwItDisable();
+        }
+    }
+    else if (iic->rw == QL_IIC_WRITE)
+    {
+        if(SET == i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_SBSEND))
+        {
+             i2c_master_addressing(iic_periph, iic->dev_addr, I2C_TRANSMITTER);
+        }
+        else if(i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_ADDSEND)) 
+        {
+            /* clear the ADDSEND bit */
+            i2c_interrupt_flag_clear(iic_periph, I2C_INT_FLAG_ADDSEND);
+        } 
+        else if((i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_TBE)) && (!i2c_interrupt_flag_get(iic_periph, I2C_INT_FLAG_AERR)))  
+        {
+            if((iic->reg_addr > 0) && (false == is_reg_addr_sent))
+            {
+                /* send the register address that need to be written to */
+                i2c_data_transmit(iic_periph, iic->reg_addr);
+                is_reg_addr_sent = true;
+            }
+            else if ((iic->rw_nbytes > 0))
+            {
+                /* send a data byte */
+                i2c_data_transmit(iic_periph, iic->tx_buf[iic->rw_size - iic->rw_nbytes]);
+                iic->rw_nbytes--;
+            }
+            else
+            {
+                /* send a stop condition */
+                i2c_stop_on_bus(iic_periph);
+                /* disable the I2CX interrupt */
+                Ql_IIC_HwItDisable();
+                iic->rw = QL_IIC_STOP;
+                iic->status = QL_IIC_STATUS_OK;
+                xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_TX_COMPLETE,xHigherPriorityTaskWoken);
+                /* restore the flag to default when finish operation */
+                is_reg_addr_sent = false;
+            }
+        }
+        else
+        {
+            iic->err_ev++;
+            Ql_IIC_HwItDisable();
+        }
+    }
+    else 
+    {
+        iic->err_ev++;
+        Ql_IIC_HwItDisable();
+    }
 }
 /*******************************************************************************
 * Hayden @ 20240912
@@ -1728,6 +2194,66 @@ void Ql_IIC_I2C0_ER_IRQHandler(void) //                48:I2C0 Error
     xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_RXTX_ERROR,xHigherPriorityTaskWoken);
 }
 /*******************************************************************************
+* Name: void Ql_IIC_DMA0_CH0_IRQHandler(void)
+* Brief: DMA0 CH0 full transfer finish of a DMA receive. The I2C NACKed the
+*        last byte, send the STOP and wake the caller. Called from the handler
+*        of the channel in ql_uart.c while UART4 is closed.
+* Input: 
+*   none.
+* Return:
+*   none.
+*******************************************************************************/
+void Ql_IIC_DMA0_CH0_IRQHandler(void)
+{
+    IIC_Ins_TypeDef* iic = &iic_ins;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if(RESET == dma_interrupt_flag_get(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_INT_FLAG_FTF))
+    {
+        return;
+    }
+    dma_interrupt_flag_clear(QL_I2C0_DMA, QL_I2C0_DMA_RX_CH, DMA_INT_FLAG_FTF);
+
+    if((IIC_MODE_HW0_DMA != iic->mode) || (QL_IIC_READ != iic->rw))
+    {
+        iic->err_ev++;
+        return;
+    }
+
+    i2c_stop_on_bus(I2C0);
+    iic->rw = QL_IIC_STOP;
+    xEventGroupSetBitsFromISR(iic->event, VN_IIC_IT_RX_COMPLETE, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+/*******************************************************************************
+* Name: void Ql_IIC_DMA0_CH7_IRQHandler(void)
+* Brief: DMA0 CH7 full transfer finish of a DMA transmit. The last byte is still
+*        in I2C_DATA, the event interrupt on BTC sends the STOP. Called from
+*        the handler of the channel in ql_uart.c while UART4 is closed.
+* Input: 
+*   none.
+* Return:
+*   none.
+*******************************************************************************/
+void Ql_IIC_DMA0_CH7_IRQHandler(void)
+{
+    IIC_Ins_TypeDef* iic = &iic_ins;
+
+    if(RESET == dma_interrupt_flag_get(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_INT_FLAG_FTF))
+    {
+        return;
+    }
+    dma_interrupt_flag_clear(QL_I2C0_DMA, QL_I2C0_DMA_TX_CH, DMA_INT_FLAG_FTF);
+
+    if((IIC_MODE_HW0_DMA != iic->mode) || (QL_IIC_WRITE != iic->rw))
+    {
+        iic->err_ev++;
+        return;
+    }
+
+    i2c_interrupt_enable(I2C0, I2C_INT_EV);
+}
+/*******************************************************************************
 * Name:  Ql_IIC_Status_TypeDef Ql_IIC_Init(void)
 * Brief: This function initialize the IIC.
 * Input: 
@@ -1746,6 +2272,13 @@ Ql_IIC_Status_TypeDef Ql_IIC_Init(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef speed
         return QL_IIC_STATUS_PARAM_ERROR;
     }
 
+    /* DMA0 CH0/CH7 are the streams of UART4 as well */
+    if ((IIC_MODE_HW0_DMA == mode) && (Ql_Uart_Dma0_Claim(QL_DMA0_SHARED_IIC0) != 0))
+    {
+        QL_LOG_E("DMA mode: DMA0 CH0/CH7 are held by UART4");
+        return QL_IIC_STATUS_BUSY;
+    }
+
     iic->mode = mode;
     iic->speed = speed;
 
@@ -1768,6 +2301,10 @@ Ql_IIC_Status_TypeDef Ql_IIC_Init(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef speed
     }
     xSemaphoreGive(iic->sem);
     status = Ql_IIC_LowLevelInit(iic->mode, iic->speed,tx_size,rx_size);
+    if ((QL_IIC_STATUS_OK != status) && (IIC_MODE_HW0_DMA == mode))
+    {
+        Ql_Uart_Dma0_Release(QL_DMA0_SHARED_IIC0);
+    }
     iic->init_cnt++;
     return status;
 }
@@ -1813,6 +2350,15 @@ void Ql_IIC_DeInit(void)
     {
         Ql_IIC_HwDeInit(iic->mode);
     }
+    else if (IIC_MODE_HW0_DMA == iic->mode)
+    {
+        Ql_IIC_HwDeInit(iic->mode);
+        if (NULL != iic->event)
+        {
+            vEventGroupDelete(iic->event);
+            iic->event = NULL;
+        }
+    }
     else
     {
         QL_LOG_E("Error in IIC mode:%d",iic->mode);
@@ -1886,6 +2432,10 @@ Ql_IIC_Status_TypeDef Ql_IIC_Read(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *p
     {
         status = Ql_IIC_HwMasterReceive(Sla_Addr,Reg_Addr,pData,Length, timeout);
     }
+    else if(IIC_MODE_HW0_DMA == iic->mode)
+    {
+        status = Ql_IIC_HwMasterDmaReceive(Sla_Addr,Reg_Addr,pData,Length, timeout);
+    }
     else if(IIC_MODE_SW_SIMULATE == iic->mode)
     {
         status = Ql_IIC_SwMasterReceive(Sla_Addr,Reg_Addr,pData,Length, timeout);
@@ -1936,6 +2486,10 @@ Ql_IIC_Status_TypeDef Ql_IIC_Write(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *
     {
         status = Ql_IIC_HwMasterTransmit( Sla_Addr,  Reg_Addr,  pData, Length, timeout);
     }
+    else if(IIC_MODE_HW0_DMA == iic->mode)
+    {
+        status = Ql_IIC_HwMasterDmaTransmit( Sla_Addr,  Reg_Addr,  pData, Length, timeout);
+    }
     else if(IIC_MODE_SW_SIMULATE == iic->mode)
     {
         status = Ql_IIC_SwMasterTransmit( Sla_Addr,  Reg_Addr,  pData, Length, timeout);
@@ -1943,3 +2497,329 @@ Ql_IIC_Status_TypeDef Ql_IIC_Write(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *
     
     return status;
 }
+
+/*******************************************************************************
+* Name: void Ql_IIC_PaceInit(IIC_Pace_TypeDef* pace, const char* name, uint32_t min_us, uint32_t max_us)
+* Brief: Pace the transactions with one module type. The gap between two
+*        transactions starts at the turnaround of the module, a NACK makes it
+*        longer, a run of clean transfers tries a shorter one again.
+* Input: 
+*   pace: pacing state, keeps what it learnt as long as it lives
+*   name: module type, for the log
+*   min_us: turnaround of the module, unit:us
+*   max_us: longest gap and backoff, unit:us
+* Return:
+*   none.
+*******************************************************************************/
+void Ql_IIC_PaceInit(IIC_Pace_TypeDef* pace, const char* name, uint32_t min_us, uint32_t max_us)
+{
+    memset(pace, 0, sizeof(IIC_Pace_TypeDef));
+    pace->name = name;
+    pace->min_us = min_us;
+    pace->max_us = (max_us > min_us) ? max_us : min_us;
+    pace->gap_us = min_us;
+    pace->safe_us = min_us;
+    pace->probe = QL_IIC_PACE_PROBE;
+    pace->last_us = (uint32_t)getus() - pace->max_us;
+}
+/*******************************************************************************
+* Name: void Ql_IIC_PaceWait(IIC_Pace_TypeDef* pace)
+* Brief: Wait until gap_us has passed since the last transaction. Whole ticks
+*        are slept, the rest is spun on the microsecond counter.
+* Input: 
+*   pace: pacing state
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_PaceWait(IIC_Pace_TypeDef* pace)
+{
+    uint32_t idle_us = (uint32_t)getus() - pace->last_us;
+    uint32_t left_us;
+
+    if(idle_us >= pace->gap_us)
+    {
+        return;
+    }
+
+    left_us = pace->gap_us - idle_us;
+    pace->wait_us += left_us;
+    if(left_us >= 1000U * portTICK_PERIOD_MS)
+    {
+        vTaskDelay(left_us / (1000U * portTICK_PERIOD_MS));
+    }
+    while(((uint32_t)getus() - pace->last_us) < pace->gap_us)
+    {
+    }
+}
+/*******************************************************************************
+* Name: void Ql_IIC_PaceSlower(IIC_Pace_TypeDef* pace)
+* Brief: A transaction was not acknowledged. A shorter gap on trial goes back
+*        to the last safe one and is tried again twice as late, otherwise the
+*        module got slower and the gap doubles.
+* Input: 
+*   pace: pacing state
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_PaceSlower(IIC_Pace_TypeDef* pace)
+{
+    if(pace->gap_us < pace->safe_us)
+    {
+        pace->gap_us = pace->safe_us;
+        if(pace->probe < QL_IIC_PACE_PROBE_MAX)
+        {
+            pace->probe *= 2;
+        }
+    }
+    else
+    {
+        pace->gap_us = (pace->gap_us < QL_IIC_PACE_STEP_US / 2) ? QL_IIC_PACE_STEP_US : pace->gap_us * 2;
+        if(pace->gap_us > pace->max_us)
+        {
+            pace->gap_us = pace->max_us;
+        }
+        pace->safe_us = pace->gap_us;
+    }
+    pace->clean = 0;
+}
+/*******************************************************************************
+* Name: void Ql_IIC_PaceFaster(IIC_Pace_TypeDef* pace)
+* Brief: A transaction went through at the first try. After probe of them in a
+*        row the gap is kept as safe and an eighth shorter one is tried.
+* Input: 
+*   pace: pacing state
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_PaceFaster(IIC_Pace_TypeDef* pace)
+{
+    uint32_t step;
+
+    if((++pace->clean < pace->probe) || (pace->gap_us <= pace->min_us))
+    {
+        return;
+    }
+
+    pace->safe_us = pace->gap_us;
+    step = (pace->gap_us >= 8) ? (pace->gap_us / 8) : 1;
+    pace->gap_us = (pace->gap_us - step > pace->min_us) ? (pace->gap_us - step) : pace->min_us;
+    pace->clean = 0;
+}
+/*******************************************************************************
+* Name: Ql_IIC_Status_TypeDef Ql_IIC_PaceTransfer(IIC_Pace_TypeDef* pace, uint8_t rw, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+* Brief: One paced transfer. A NACK is a module that was not ready yet, the
+*        transfer is sent again after a gap that doubles each time, up to
+*        QL_IIC_PACE_RETRY times. In hardware polling mode the NACK of the
+*        address shows up as QL_IIC_STATUS_ADDSEND_ERROR.
+* Input: 
+*   pace: pacing state
+*   rw: QL_IIC_READ or QL_IIC_WRITE
+*   others: as Ql_IIC_Read and Ql_IIC_Write
+* Return:
+*   Ql_IIC_Status_TypeDef: status of the last try
+*******************************************************************************/
+static Ql_IIC_Status_TypeDef Ql_IIC_PaceTransfer(IIC_Pace_TypeDef* pace, uint8_t rw, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    Ql_IIC_Status_TypeDef status;
+    uint32_t tries = 0;
+
+    pace->transfers++;
+    while(1)
+    {
+        Ql_IIC_PaceWait(pace);
+        if(QL_IIC_READ == rw)
+        {
+            status = Ql_IIC_Read(Sla_Addr, Reg_Addr, pData, Length, timeout);
+        }
+        else
+        {
+            status = Ql_IIC_Write(Sla_Addr, Reg_Addr, pData, Length, timeout);
+        }
+        pace->last_us = (uint32_t)getus();
+
+        if((QL_IIC_STATUS_NOACK != status) && (QL_IIC_STATUS_ADDSEND_ERROR != status))
+        {
+            break;
+        }
+
+        pace->nacks++;
+        Ql_IIC_PaceSlower(pace);
+        if(tries++ >= QL_IIC_PACE_RETRY)
+        {
+            pace->failures++;
+            return status;
+        }
+        pace->retries++;
+    }
+
+    if((QL_IIC_STATUS_OK == status) && (0 == tries))
+    {
+        Ql_IIC_PaceFaster(pace);
+    }
+    return status;
+}
+/*******************************************************************************
+* Name: Ql_IIC_Status_TypeDef Ql_IIC_PaceWrite(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+* Brief: Ql_IIC_Write paced for the module of pace.
+* Input: 
+*   pace: pacing state
+*   others: as Ql_IIC_Write
+* Return:
+*   Ql_IIC_Status_TypeDef: QL_IIC_STATUS_OK or the error after the retries
+*******************************************************************************/
+Ql_IIC_Status_TypeDef Ql_IIC_PaceWrite(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    return Ql_IIC_PaceTransfer(pace, QL_IIC_WRITE, Sla_Addr, Reg_Addr, pData, Length, timeout);
+}
+/*******************************************************************************
+* Name: Ql_IIC_Status_TypeDef Ql_IIC_PaceRead(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+* Brief: Ql_IIC_Read paced for the module of pace.
+* Input: 
+*   pace: pacing state
+*   others: as Ql_IIC_Read
+* Return:
+*   Ql_IIC_Status_TypeDef: QL_IIC_STATUS_OK or the error after the retries
+*******************************************************************************/
+Ql_IIC_Status_TypeDef Ql_IIC_PaceRead(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    return Ql_IIC_PaceTransfer(pace, QL_IIC_READ, Sla_Addr, Reg_Addr, pData, Length, timeout);
+}
+/*******************************************************************************
+* Name: void Ql_IIC_PacePrint(const IIC_Pace_TypeDef* pace)
+* Brief: Log the gap in use and the NACK rate, in 1/10000 of the tries.
+* Input: 
+*   pace: pacing state
+* Return:
+*   none.
+*******************************************************************************/
+void Ql_IIC_PacePrint(const IIC_Pace_TypeDef* pace)
+{
+    uint32_t tries = pace->transfers + pace->retries;
+    uint32_t rate = (0 == tries) ? 0 : (uint32_t)(((uint64_t)pace->nacks * 10000U) / tries);
+    uint32_t wait = (0 == tries) ? 0 : (uint32_t)(pace->wait_us / tries);
+
+    QL_LOG_I("%s pace: gap %d us (min %d, max %d, safe %d), probe %d", pace->name, pace->gap_us, pace->min_us,
+             pace->max_us, pace->safe_us, pace->probe);
+    QL_LOG_I("%s pace: %d transfers, %d nacks (%d.%02d%%), %d retries, %d failures, wait %d us per try", pace->name,
+             pace->transfers, pace->nacks, rate / 100, rate % 100, pace->retries, pace->failures, wait);
+}
+/*******************************************************************************
+* Name: static void Ql_IIC_BenchIdleTask(void* arg)
+* Brief: Counts loops at the idle priority while Ql_IIC_Bench runs.
+* Input: 
+*   arg: unused
+* Return:
+*   none.
+*******************************************************************************/
+static void Ql_IIC_BenchIdleTask(void* arg)
+{
+    (void)arg;
+
+    while (iic_bench_run)
+    {
+        iic_bench_loops++;
+    }
+    vTaskDelete(NULL);
+}
+/*******************************************************************************
+* Name: void Ql_IIC_Bench(uint8_t Sla_Addr, uint8_t Reg_Addr, uint32_t Length, uint32_t Count)
+* Brief: CPU time and throughput of the polling, interrupt and DMA modes.
+*        Each mode does Count reads of Length bytes at 400 kHz. The CPU time
+*        is the DWT->CYCCNT time of the reads less the time the idle loop
+*        task got, counted at the rate it loops in an idle window first.
+*        The caller must run above the idle priority and keep a mode under
+*        the 17 s the counter spans at 240 MHz. The mode in use is set up
+*        again afterwards.
+* Input: 
+*   Sla_Addr: 8 bits slave address, as Ql_IIC_Read
+*   Reg_Addr: register to read
+*   Length: bytes per read
+*   Count: reads per mode
+* Return:
+*   none.
+*******************************************************************************/
+void Ql_IIC_Bench(uint8_t Sla_Addr, uint8_t Reg_Addr, uint32_t Length, uint32_t Count)
+{
+    static const IIC_Mode_TypeDef mode[] = { IIC_MODE_HW0_POLLING, IIC_MODE_HW0_INTERRUPT, IIC_MODE_HW0_DMA };
+    static const char* name[] = { "polling", "interrupt", "dma" };
+    IIC_Ins_TypeDef* iic = &iic_ins;
+    const IIC_Mode_TypeDef old_mode = iic->mode;
+    const IIC_Speed_TypeDef old_speed = iic->speed;
+    const uint32_t old_tx = iic->tx_size;
+    const uint32_t old_rx = iic->rx_size;
+    const uint32_t mhz = SystemCoreClock / 1000000U;
+    uint64_t bytes = (uint64_t)Length * Count;
+    uint32_t idle_cycles;
+    uint32_t idle_loops;
+    uint32_t start;
+    uint32_t loops;
+    uint32_t cycles;
+    uint32_t busy;
+    uint32_t errors;
+    uint8_t* buf;
+
+    if ((0 == Length) || (0 == Count))
+    {
+        return;
+    }
+    buf = pvPortMalloc(Length);
+    if (NULL == buf)
+    {
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+
+    iic_bench_run = 1;
+    if (pdPASS != xTaskCreate(Ql_IIC_BenchIdleTask, "iic_bench", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL))
+    {
+        vPortFree(buf);
+        return;
+    }
+
+    loops = iic_bench_loops;
+    start = DWT->CYCCNT;
+    vTaskDelay(pdMS_TO_TICKS(QL_IIC_BENCH_IDLE_MS));
+    idle_cycles = DWT->CYCCNT - start;
+    idle_loops = iic_bench_loops - loops;
+
+    for (uint32_t m = 0; m < sizeof(mode) / sizeof(mode[0]); m++)
+    {
+        Ql_IIC_DeInit();
+        if (QL_IIC_STATUS_OK != Ql_IIC_Init(mode[m], IIC_SPEED_FAST, Length, Length))
+        {
+            QL_LOG_E("bench %s: init fail", name[m]);
+            continue;
+        }
+
+        errors = 0;
+        loops = iic_bench_loops;
+        start = DWT->CYCCNT;
+        for (uint32_t i = 0; i < Count; i++)
+        {
+            if (QL_IIC_STATUS_OK != Ql_IIC_Read(Sla_Addr, Reg_Addr, buf, Length, QL_I2C_SEM_TIMEOUT))
+            {
+                errors++;
+            }
+        }
+        cycles = DWT->CYCCNT - start + 1;
+        loops = iic_bench_loops - loops;
+
+        /* Cycles the idle loop got, the rest went to the driver and its interrupts */
+        busy = (0 == idle_loops) ? cycles : (uint32_t)(((uint64_t)loops * idle_cycles) / idle_loops);
+        busy = (busy < cycles) ? (cycles - busy) : 0;
+        QL_LOG_I("%s: %u x %u bytes in %u us, %u B/s, CPU %u us (%u%%), %u us per KB, %u errors", name[m],
+                 Count, Length, cycles / mhz, (uint32_t)(bytes * mhz * 1000000U / cycles), busy / mhz,
+                 (uint32_t)((uint64_t)busy * 100U / cycles), (uint32_t)((uint64_t)busy * 1024U / mhz / bytes), errors);
+    }
+
+    iic_bench_run = 0;
+    vTaskDelay(1);
+    Ql_IIC_DeInit();
+    if (IIC_MODE_INVALID != old_mode)
+    {
+        Ql_IIC_Init(old_mode, old_speed, old_tx, old_rx);
+    }
+    vPortFree(buf);
+}
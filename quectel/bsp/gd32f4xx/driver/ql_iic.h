@@ -43,6 +43,11 @@ limitations under the License.
 #define VN_IIC_IT_TX_COMPLETE    (1 << 1)                            //transmit complete
 #define VN_IIC_IT_RXTX_ERROR     (1 << 2)                            //receive or transmit error
 
+#define QL_IIC_PACE_RETRY        4                                   //sends after the first NACK of a transfer
+#define QL_IIC_PACE_STEP_US      100                                 //smallest gap after a NACK, unit = 1us
+#define QL_IIC_PACE_PROBE        16                                  //clean transfers before a shorter gap is tried
+#define QL_IIC_PACE_PROBE_MAX    1024                                //the probe period doubles each time a try NACKs
+
 //-----enum define-----
 typedef enum
 {
@@ -55,6 +60,7 @@ typedef enum
     IIC_MODE_HW0_INTERRUPT = 0,                                      //I2C0 hardware interrupt
     IIC_MODE_HW0_POLLING,                                            //I2C0 hardware polling
     IIC_MODE_SW_SIMULATE,                                            //software simulate
+    IIC_MODE_HW0_DMA,                                                //I2C0 hardware DMA, on the DMA0 CH0/CH7 of UART4, Ql_IIC_Init fails while UART4 is open
     IIC_MODE_INVALID
 } IIC_Mode_TypeDef;
 
@@ -131,12 +137,33 @@ typedef struct
     uint32_t              init_cnt;
 } IIC_Ins_TypeDef;                                                   // IIC instance
 
+typedef struct
+{
+    const char*           name;                                      //module type
+    uint32_t              min_us;                                    //turnaround of the module, the gap starts here
+    uint32_t              max_us;                                    //longest gap and backoff
+    uint32_t              gap_us;                                    //gap between two transactions in use
+    uint32_t              safe_us;                                   //last gap that went without a NACK
+    uint32_t              probe;                                     //clean transfers before gap_us is shortened
+    uint32_t              clean;                                     //clean transfers at gap_us
+    uint32_t              last_us;                                   //end of the last transaction
+    uint32_t              transfers;
+    uint32_t              nacks;                                     //transactions not acknowledged
+    uint32_t              retries;
+    uint32_t              failures;                                  //transfers still NACKed after the retries
+    uint64_t              wait_us;                                   //spent waiting for the gap
+} IIC_Pace_TypeDef;                                                  // pacing of the transactions with one module
+
 
 //-----function declare-----
 void Ql_IIC_I2C0_EV_IRQHandler(void);
 
 void Ql_IIC_I2C0_ER_IRQHandler(void);
 
+void Ql_IIC_DMA0_CH0_IRQHandler(void);
+
+void Ql_IIC_DMA0_CH7_IRQHandler(void);
+
 Ql_IIC_Status_TypeDef Ql_IIC_Init(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef IIC_Mode,uint32_t tx_size,uint32_t rx_size);
 
 void Ql_IIC_DeInit(void);
@@ -149,5 +176,15 @@ Ql_IIC_Status_TypeDef Ql_IIC_Write(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *
 
 Ql_IIC_Status_TypeDef Ql_IIC_Read(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout);
 
+void Ql_IIC_PaceInit(IIC_Pace_TypeDef* pace, const char* name, uint32_t min_us, uint32_t max_us);
+
+Ql_IIC_Status_TypeDef Ql_IIC_PaceWrite(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout);
+
+Ql_IIC_Status_TypeDef Ql_IIC_PaceRead(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout);
+
+void Ql_IIC_PacePrint(const IIC_Pace_TypeDef* pace);
+
+void Ql_IIC_Bench(uint8_t Sla_Addr, uint8_t Reg_Addr, uint32_t Length, uint32_t Count);
+
 
 #endif /* __QL_IIC_H__ */
@@ -20,6 +20,9 @@ limitations under the License.
     v1.0     2024-0908    Hayden   Create file
 */
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include "ql_sdcard.h"
 #include "gd32f4xx_sdio.h"
 #include "gd32f4xx_dma.h"
@@ -87,6 +90,16 @@ limitations under the License.
   */
 #define SDIO_SEND_IF_COND               ((uint32_t)0x00000008)
 
+/*!< CMD6 mode 1 (switch), function group 1 (access mode) to 1 (high speed) */
+#define SD_SWITCH_HIGH_SPEED            ((uint32_t)0x80FFFFF1)
+#define SD_SDIOCLK_KHZ                  (48000U)
+
+#if SD_HIGH_SPEED_ENABLE
+#define SD_GPIO_SPEED                   GPIO_OSPEED_MAX
+#else
+#define SD_GPIO_SPEED                   GPIO_OSPEED_50MHZ
+#endif
+
 static uint32_t CardType =  SDIO_STD_CAPACITY_SD_CARD_V1_1;
 static uint32_t CSD_Tab[4], CID_Tab[4], RCA = 0;
 __IO uint32_t StopCondition = 0;
@@ -94,6 +107,10 @@ __IO SD_Error TransferError = SD_OK;
 __IO uint32_t TransferEnd = 0, DMAEndOfTransfer = 0;
 SD_CardInfo SDCardInfo;
 
+/*!< Task waiting in SD_WaitTransfer(), NULL before the scheduler runs */
+static TaskHandle_t SD_WaitTask = NULL;
+static SD_BusInfo SD_Bus = { 1, 0, SD_SDIOCLK_KHZ / (SDIO_INIT_CLK_DIV + 2) };
+
 /** @defgroup STM324xG_EVAL_SDIO_SD_Private_Function_Prototypes
   * @{
   */
@@ -105,6 +122,10 @@ static SD_Error CmdResp2Error(void);
 static SD_Error CmdResp6Error(uint8_t cmd, uint16_t *prca);
 static SD_Error SDEnWideBus(ControlStatus NewState);
 static SD_Error FindSCR(uint16_t rca, uint32_t *pscr);
+static void SD_TransferBegin(uint32_t stop);
+static SD_Error SD_WaitTransfer(void);
+static SD_Error SD_WaitCardReady(void);
+static void SD_Notify_FromISR(void);
 
 /**
   * @}
@@ -148,6 +169,9 @@ SD_Error SD_Init(void)
     sdio_clock_config(SDIO_SDIOCLKEDGE_RISING, SDIO_CLOCKBYPASS_DISABLE, SDIO_CLOCKPWRSAVE_DISABLE, SDIO_TRANSFER_CLK_DIV);
     sdio_bus_mode_set(SDIO_BUSMODE_1BIT);
     sdio_hardware_clock_disable();
+    SD_Bus.BusWidth  = 1;
+    SD_Bus.HighSpeed = 0;
+    SD_Bus.ClockKHz  = SD_SDIOCLK_KHZ / (SDIO_TRANSFER_CLK_DIV + 2);
     
     /*----------------- Read CSD/CID MSD registers ------------------*/
     errorstatus = SD_GetCardInfo(&SDCardInfo);
@@ -162,10 +186,139 @@ SD_Error SD_Init(void)
     {
         errorstatus = SD_EnableWideBusOperation(SDIO_BUSMODE_4BIT);
     }
+
+#if SD_HIGH_SPEED_ENABLE
+    if (errorstatus == SD_OK)
+    {
+        /*!< A card without high speed stays at default speed */
+        SD_HighSpeed();
+    }
+#endif
+
+    if (errorstatus == SD_OK)
+    {
+        QL_LOG_I("sd bus %u bit, %s speed, %u kHz", SD_Bus.BusWidth, SD_Bus.HighSpeed ? "high" : "default", SD_Bus.ClockKHz);
+    }
     
     return(errorstatus);
 }
 
+/**
+  * @brief  Returns the negotiated bus width, speed mode and clock.
+  * @param  Info: pointer to the structure that receives them.
+  * @retval None
+  */
+void SD_GetBusInfo(SD_BusInfo *Info)
+{
+    if (Info != NULL)
+    {
+        *Info = SD_Bus;
+    }
+}
+
+/**
+  * @brief  Switches the card to high speed (SDR25) with CMD6 and bypasses
+  *         the SDIO clock divider.
+  * @note   Called once the card is selected and in 4 bit mode.
+  * @param  None
+  * @retval SD_Error: SD Card Error code, SD_UNSUPPORTED_FEATURE: the card
+  *         stays at default speed.
+  */
+SD_Error SD_HighSpeed(void)
+{
+    SD_Error errorstatus = SD_OK;
+    uint32_t scr[2] = {0, 0};
+    uint32_t status[16] = {0};
+    uint32_t index = 0;
+
+    if ((SDIO_STD_CAPACITY_SD_CARD_V1_1 != CardType) && (SDIO_STD_CAPACITY_SD_CARD_V2_0 != CardType) &&
+        (SDIO_HIGH_CAPACITY_SD_CARD != CardType))
+    {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    errorstatus = FindSCR(RCA, scr);
+
+    if (errorstatus != SD_OK)
+    {
+        return(errorstatus);
+    }
+
+    /*!< SD_SPEC 0 (version 1.0x) has no CMD6 */
+    if (((scr[1] >> 24) & 0x0F) == 0)
+    {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    /*!< The switch status is a 64 byte block */
+    sdio_command_response_config(SD_CMD_SET_BLOCKLEN, (uint32_t)64, SDIO_RESPONSETYPE_SHORT);
+    sdio_wait_type_set(SDIO_WAITTYPE_NO);
+    sdio_csm_enable();
+
+    errorstatus = CmdResp1Error(SD_CMD_SET_BLOCKLEN);
+
+    if (errorstatus != SD_OK)
+    {
+        return(errorstatus);
+    }
+
+    sdio_data_config(SD_DATATIMEOUT, (uint32_t)64, SDIO_DATABLOCKSIZE_64BYTES);
+    sdio_data_transfer_config(SDIO_TRANSMODE_BLOCK, SDIO_TRANSDIRECTION_TOSDIO);
+    sdio_dsm_enable();
+
+    /*!< Send CMD6 SWITCH_FUNC */
+    sdio_command_response_config(SD_CMD_HS_SWITCH, SD_SWITCH_HIGH_SPEED, SDIO_RESPONSETYPE_SHORT);
+    sdio_wait_type_set(SDIO_WAITTYPE_NO);
+    sdio_csm_enable();
+
+    errorstatus = CmdResp1Error(SD_CMD_HS_SWITCH);
+
+    if (errorstatus != SD_OK)
+    {
+        return(errorstatus);
+    }
+
+    while (!(SDIO_STAT & (SDIO_FLAG_RXORE | SDIO_FLAG_DTCRCERR | SDIO_FLAG_DTTMOUT | SDIO_FLAG_DTBLKEND | SDIO_FLAG_STBITE)))
+    {
+        if ((sdio_flag_get(SDIO_FLAG_RXDTVAL) != RESET) && (index < 16))
+        {
+            status[index++] = sdio_data_read();
+        }
+    }
+
+    while ((sdio_flag_get(SDIO_FLAG_RXDTVAL) != RESET) && (index < 16))
+    {
+        status[index++] = sdio_data_read();
+    }
+
+    if (SDIO_STAT & (SDIO_FLAG_RXORE | SDIO_FLAG_DTCRCERR | SDIO_FLAG_DTTMOUT | SDIO_FLAG_STBITE))
+    {
+        errorstatus = (SDIO_STAT & SDIO_FLAG_DTTMOUT) ? SD_DATA_TIMEOUT : SD_DATA_CRC_FAIL;
+    }
+
+    /*!< Clear all the static flags */
+    sdio_flag_clear(SDIO_STATIC_FLAGS);
+
+    if (errorstatus != SD_OK)
+    {
+        return(errorstatus);
+    }
+
+    /*!< Bits 379:376, the function selected in group 1, 0xF: switch refused */
+    if ((status[4] & 0x0F) != 0x01)
+    {
+        return(SD_UNSUPPORTED_FEATURE);
+    }
+
+    /*!< The card uses the new timing 8 clocks after the status block */
+    sdio_clock_config(SDIO_SDIOCLKEDGE_RISING, SDIO_CLOCKBYPASS_ENABLE, SDIO_CLOCKPWRSAVE_DISABLE, 0);
+    sdio_hardware_clock_disable();
+    SD_Bus.HighSpeed = 1;
+    SD_Bus.ClockKHz  = SD_SDIOCLK_KHZ;
+
+    return(errorstatus);
+}
+
 /**
   * @brief  Gets the cuurent sd card data transfer status.
   * @param  None
@@ -684,6 +837,7 @@ SD_Error SD_EnableWideBusOperation(uint32_t WideMode)
                                   SDIO_CLOCKPWRSAVE_DISABLE, SDIO_TRANSFER_CLK_DIV);
                 sdio_bus_mode_set(WideMode);
                 sdio_hardware_clock_disable();
+                SD_Bus.BusWidth = 4;
             }
         }
         else
@@ -697,6 +851,7 @@ SD_Error SD_EnableWideBusOperation(uint32_t WideMode)
                                   SDIO_CLOCKPWRSAVE_DISABLE, SDIO_TRANSFER_CLK_DIV);
                 sdio_bus_mode_set(WideMode);
                 sdio_hardware_clock_disable();
+                SD_Bus.BusWidth = 1;
             }
         }
     }
@@ -744,9 +899,7 @@ SD_Error SD_ReadBlock(uint8_t *readbuff, uint64_t ReadAddr, uint16_t BlockSize)
   uint32_t count = 0, *tempbuff = (uint32_t *)readbuff;
 #endif
     
-    TransferError = SD_OK;
-    TransferEnd = 0;
-    StopCondition = 0;
+    SD_TransferBegin(0);
     
     SDIO_DATACTL = 0x0;
 #if defined (SD_DMA_MODE)
@@ -814,9 +967,7 @@ SD_Error SD_ReadBlock(uint8_t *readbuff, uint64_t ReadAddr, uint16_t BlockSize)
 SD_Error SD_ReadMultiBlocks(uint8_t *readbuff, uint64_t ReadAddr, uint16_t BlockSize, uint32_t NumberOfBlocks)
 {
     SD_Error errorstatus = SD_OK;
-    TransferError = SD_OK;
-    TransferEnd = 0;
-    StopCondition = 1;
+    SD_TransferBegin(1);
     
     SDIO_DATACTL = 0x0;
     sdio_interrupt_enable(SDIO_INT_DTCRCERR | SDIO_INT_DTTMOUT | SDIO_INT_DTEND | SDIO_INT_RXORE | SDIO_INT_STBITE);
@@ -873,15 +1024,22 @@ SD_Error SD_WaitReadOperation(void)
     SD_Error errorstatus = SD_OK;
     uint32_t timeout;
 
-    timeout = SD_DATATIMEOUT;
-    
-    while ((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK) && (timeout > 0))
+    errorstatus = SD_WaitTransfer();
+
+    if (errorstatus != SD_OK)
     {
-        timeout--;
+        if (StopCondition == 1)
+        {
+            SD_StopTransfer();
+        }
+        StopCondition = 0;
+        sdio_flag_clear(SDIO_STATIC_FLAGS);
+        return(errorstatus);
     }
-    
+
     DMAEndOfTransfer = 0x00;
-    
+
+    /*!< Only the FIFO drain after the last block is left */
     timeout = SD_DATATIMEOUT;
     
     while(((SDIO_STAT & SDIO_FLAG_RXRUN)) && (timeout > 0))
@@ -936,9 +1094,7 @@ SD_Error SD_WriteBlock(uint8_t *writebuff, uint64_t WriteAddr, uint16_t BlockSiz
   uint32_t *tempbuff = (uint32_t *)writebuff;
 #endif
     
-    TransferError = SD_OK;
-    TransferEnd = 0;
-    StopCondition = 0;
+    SD_TransferBegin(0);
     
     SDIO_DATACTL = 0x0;
     
@@ -1009,9 +1165,7 @@ SD_Error SD_WriteMultiBlocks(uint8_t *writebuff, uint64_t WriteAddr, uint16_t Bl
 {
     SD_Error errorstatus = SD_OK;
 
-    TransferError = SD_OK;
-    TransferEnd = 0;
-    StopCondition = 1;
+    SD_TransferBegin(1);
     SDIO_DATACTL = 0x0;
     
     sdio_interrupt_enable(SDIO_INT_DTCRCERR | SDIO_INT_DTTMOUT | SDIO_INT_DTEND | SDIO_INT_RXORE | SDIO_INT_STBITE);
@@ -1092,17 +1246,24 @@ SD_Error SD_WaitWriteOperation(void)
     SD_Error errorstatus = SD_OK;
     uint32_t timeout;
 
-    timeout = SD_DATATIMEOUT;
+    errorstatus = SD_WaitTransfer();
 
-    while ((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK) && (timeout > 0))
+    if (errorstatus != SD_OK)
     {
-        timeout--;
+        if (StopCondition == 1)
+        {
+            SD_StopTransfer();
+        }
+        StopCondition = 0;
+        sdio_flag_clear(SDIO_STATIC_FLAGS);
+        return(errorstatus);
     }
 
     DMAEndOfTransfer = 0x00;
 
+    /*!< Only the FIFO drain after the last block is left */
     timeout = SD_DATATIMEOUT;
-
+    
     while(((SDIO_STAT & SDIO_FLAG_TXRUN)) && (timeout > 0))
     {
         timeout--;
@@ -1225,6 +1386,8 @@ SD_Error SD_ProcessIRQSrc(void)
     sdio_interrupt_disable(SDIO_INT_DTCRCERR | SDIO_INT_DTTMOUT | SDIO_INT_DTEND |
                            SDIO_INT_TFH      | SDIO_INT_RFH     | SDIO_INT_TXURE |
                            SDIO_INT_RXORE    | SDIO_INT_STBITE);
+
+    SD_Notify_FromISR();
     
     return(TransferError);
 }
@@ -1241,9 +1404,130 @@ void SD_ProcessDMAIRQ(void)
         DMAEndOfTransfer = 0x01;
         dma_flag_clear(DMA1, DMA_CH3, DMA_FLAG_FEE);
         dma_flag_clear(DMA1, DMA_CH3, DMA_FLAG_FTF);
+        SD_Notify_FromISR();
     }
 }
 
+/**
+  * @brief  Arms the completion notification for a new data transfer.
+  * @param  stop: 1: the transfer ends with CMD12 (multi block).
+  * @retval None
+  */
+static void SD_TransferBegin(uint32_t stop)
+{
+    TransferError = SD_OK;
+    TransferEnd = 0;
+    DMAEndOfTransfer = 0;
+    StopCondition = stop;
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+    {
+        SD_WaitTask = xTaskGetCurrentTaskHandle();
+        /*!< Drop a notification left by an aborted transfer */
+        ulTaskNotifyValueClearIndexed(SD_WaitTask, SD_NOTIFY_INDEX, 0xFFFFFFFFU);
+    }
+    else
+    {
+        SD_WaitTask = NULL;
+    }
+}
+
+/**
+  * @brief  Wakes the task waiting in SD_WaitTransfer(), called from the SDIO
+  *         and DMA interrupts.
+  * @param  None
+  * @retval None
+  */
+static void SD_Notify_FromISR(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (SD_WaitTask != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(SD_WaitTask, SD_NOTIFY_INDEX, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+/**
+  * @brief  Blocks until the DMA or the SDIO data path reports the end of the
+  *         transfer or an error. The task sleeps meanwhile, before the
+  *         scheduler runs the flags are polled.
+  * @param  None
+  * @retval SD_Error: SD_OK, SD_DATA_TIMEOUT: transfer aborted.
+  */
+static SD_Error SD_WaitTransfer(void)
+{
+    uint32_t timeout = SD_DATATIMEOUT;
+    TickType_t start = 0;
+
+    if (SD_WaitTask != NULL)
+    {
+        start = xTaskGetTickCount();
+    }
+
+    while ((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK))
+    {
+        if (SD_WaitTask != NULL)
+        {
+            TickType_t spent = xTaskGetTickCount() - start;
+
+            if (spent >= pdMS_TO_TICKS(SD_TRANSFER_TIMEOUT_MS))
+            {
+                break;
+            }
+
+            ulTaskNotifyTakeIndexed(SD_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(SD_TRANSFER_TIMEOUT_MS) - spent);
+        }
+        else if (timeout-- == 0)
+        {
+            break;
+        }
+    }
+
+    SD_WaitTask = NULL;
+
+    if ((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK))
+    {
+        sdio_interrupt_disable(SDIO_INT_DTCRCERR | SDIO_INT_DTTMOUT | SDIO_INT_DTEND |
+                               SDIO_INT_TXURE    | SDIO_INT_RXORE   | SDIO_INT_STBITE);
+        dma_channel_disable(DMA1, DMA_CH3);
+        sdio_flag_clear(SDIO_STATIC_FLAGS);
+        QL_LOG_E("sd transfer timeout");
+        return(SD_DATA_TIMEOUT);
+    }
+
+    return(SD_OK);
+}
+
+/**
+  * @brief  Waits until the card has left the programming state, polling
+  *         CMD13 once per tick instead of spinning on it.
+  * @param  None
+  * @retval SD_Error: SD_OK, SD_ERROR: card error or still busy after
+  *         SD_BUSY_TIMEOUT_MS.
+  */
+static SD_Error SD_WaitCardReady(void)
+{
+    SDTransferState state;
+    uint32_t waited = 0;
+
+    while ((state = SD_GetStatus()) == SD_TRANSFER_BUSY)
+    {
+        if (waited++ >= SD_BUSY_TIMEOUT_MS)
+        {
+            break;
+        }
+
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+        {
+            vTaskDelay(1);
+        }
+    }
+
+    return (state == SD_TRANSFER_OK) ? SD_OK : SD_ERROR;
+}
+
 /**
   * @brief  Checks for error conditions for CMD0.
   * @param  None
@@ -1823,13 +2107,13 @@ void SD_LowLevel_Init(void)
     gpio_af_set(GPIOD, GPIO_AF_12, GPIO_PIN_2);
     
     gpio_mode_set(GPIOC, GPIO_MODE_AF, GPIO_PUPD_PULLUP, GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11);
-    gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11);
+    gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, SD_GPIO_SPEED, GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11);
     
     gpio_mode_set(GPIOC, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_12);
-    gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_12);
+    gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, SD_GPIO_SPEED, GPIO_PIN_12);
     
     gpio_mode_set(GPIOD, GPIO_MODE_AF, GPIO_PUPD_PULLUP, GPIO_PIN_2);
-    gpio_output_options_set(GPIOD, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_2);
+    gpio_output_options_set(GPIOD, GPIO_OTYPE_PP, SD_GPIO_SPEED, GPIO_PIN_2);
     
     rcu_periph_clock_enable(RCU_SDIO);
     rcu_periph_clock_enable(RCU_DMA1);
@@ -1966,8 +2250,9 @@ int MMC_disk_initialize(void)
     rcu_periph_reset_disable(RCU_SDIORST);
     rcu_periph_clock_disable(RCU_SDIO);
     
-    nvic_irq_enable(SDIO_IRQn, 3, 0);
-    nvic_irq_enable(DMA1_Channel3_IRQn, 3, 0);
+    /*!< Both handlers notify the waiting task, keep them under the syscall priority */
+    nvic_irq_enable(SDIO_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0);
+    nvic_irq_enable(DMA1_Channel3_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0);
     
     Status = SD_Init();
     
@@ -1984,6 +2269,14 @@ int MMC_disk_read(uint8_t *buff, uint32_t sector, uint32_t count)
     int result = 0;
     SD_Error Status = SD_OK;
     
+    /*!< The previous write programs the card while the caller works */
+    Status = SD_WaitCardReady();
+    if (Status != SD_OK)
+    {
+        QL_LOG_E("SD Busy %d", Status);
+        return 1;
+    }
+    
     if(count == 1)
     {
         Status = SD_ReadBlock(buff, (uint64_t)sector << 9 , MMC_sector_size());
@@ -1996,7 +2289,7 @@ int MMC_disk_read(uint8_t *buff, uint32_t sector, uint32_t count)
     if (Status != SD_OK)
     {
         QL_LOG_E("SD Read Fail %d", Status);
-        result = 1;
+        return 1;
     }
     
 #ifdef SD_DMA_MODE
@@ -2006,7 +2299,6 @@ int MMC_disk_read(uint8_t *buff, uint32_t sector, uint32_t count)
         QL_LOG_E("SD Read Fail %d", Status);
         result = 1;
     }
-    while (SD_GetStatus() != SD_TRANSFER_OK);
 #endif
     
     return result;
@@ -2017,6 +2309,13 @@ int MMC_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count)
     int result = 0;
     SD_Error Status = SD_OK;
     
+    Status = SD_WaitCardReady();
+    if (Status != SD_OK)
+    {
+        QL_LOG_E("SD Busy %d", Status);
+        return 1;
+    }
+    
     if (count == 1)
     {
         Status = SD_WriteBlock((uint8_t *)buff, (uint64_t)sector << 9 ,MMC_sector_size());
@@ -2029,22 +2328,28 @@ int MMC_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count)
     if (Status != SD_OK)
     {
         QL_LOG_E("SD Write Fail %d", Status);
-        result = 1;
+        return 1;
     }
     
 #ifdef SD_DMA_MODE
+    /*!< Returns once the data is on the card, programming finishes in the
+         background and is waited for by the next access or MMC_disk_sync() */
     Status = SD_WaitWriteOperation();
     if (Status != SD_OK)
     {
         QL_LOG_E("SD Write Fail %d", Status);
         result = 1;
     }
-    while(SD_GetStatus() != SD_TRANSFER_OK);
 #endif
     
     return result;
 }
 
+int MMC_disk_sync(void)
+{
+    return (SD_WaitCardReady() == SD_OK) ? 0 : 1;
+}
+
 uint32_t MMC_sector_count(void)
 {
     return (SDCardInfo.CardCapacity / 512);
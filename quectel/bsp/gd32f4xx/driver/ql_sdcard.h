@@ -37,9 +37,23 @@ limitations under the License.
 #define SDIO_INIT_CLK_DIV          ((uint16_t)0x0076)
 
 /**
-  * @brief  SDIO Data Transfer Frequency (25MHz max)
+  * @brief  SDIO Data Transfer Frequency (25MHz max), SDIOCLK / (0 + 2) = 24MHz
   */
-#define SDIO_TRANSFER_CLK_DIV      ((uint8_t)0x2)
+#define SDIO_TRANSFER_CLK_DIV      ((uint8_t)0x0)
+
+/**
+  * @brief  Switch to high speed (SDR25, 50MHz max) when the card supports it,
+  *         SDIOCLK is then bypassed: 48MHz
+  */
+#define SD_HIGH_SPEED_ENABLE       1
+
+/**
+  * @brief  Task notification index the transfer IRQs wake the caller with,
+  *         index 0 stays free for the tasks themselves
+  */
+#define SD_NOTIFY_INDEX            1
+#define SD_TRANSFER_TIMEOUT_MS     (1000U)
+#define SD_BUSY_TIMEOUT_MS         (500U)     /* card programming, spec max 250ms for SDHC */
 
 /** @defgroup STM324xG_EVAL_SDIO_SD_Exported_Types
   * @{
@@ -199,6 +213,16 @@ typedef struct
 
 extern SD_CardInfo SDCardInfo;
 
+/** 
+  * @brief Negotiated bus mode
+  */
+typedef struct
+{
+    uint8_t  BusWidth;      /*!< 1 or 4 */
+    uint8_t  HighSpeed;     /*!< CMD6 switch to high speed accepted */
+    uint32_t ClockKHz;
+} SD_BusInfo;
+
 /** 
   * @brief SDIO Commands  Index 
   */
@@ -206,6 +230,7 @@ extern SD_CardInfo SDCardInfo;
 
 #define SD_CMD_ALL_SEND_CID                        ((uint8_t)2)
 #define SD_CMD_SET_REL_ADDR                        ((uint8_t)3) /*!< SDIO_SEND_REL_ADDR for SD Card */
+#define SD_CMD_HS_SWITCH                           ((uint8_t)6)
 #define SD_CMD_SEL_DESEL_CARD                      ((uint8_t)7)
 #define SD_CMD_HS_SEND_EXT_CSD                     ((uint8_t)8)
 #define SD_CMD_SEND_CSD                            ((uint8_t)9)
@@ -295,7 +320,8 @@ SD_Error SD_ProcessIRQSrc(void);
 void     SD_ProcessDMAIRQ(void);
 SD_Error SD_WaitReadOperation(void);
 SD_Error SD_WaitWriteOperation(void);
-// SD_Error SD_HighSpeed(void);
+SD_Error SD_HighSpeed(void);
+void     SD_GetBusInfo(SD_BusInfo *Info);
 
 //////////////////////////////////////////////////////////
 
@@ -309,6 +335,7 @@ int      MMC_disk_status(void);
 int      MMC_disk_initialize(void);
 int      MMC_disk_read(uint8_t *buff, uint32_t sector, uint32_t count);
 int      MMC_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count);
+int      MMC_disk_sync(void);
 uint32_t MMC_sector_count(void);
 uint32_t MMC_sector_size(void);
 uint32_t MMC_block_size(void);
@@ -23,17 +23,140 @@ limitations under the License.
 #include <string.h>
 #include <stdio.h>
 #include "ql_uart.h"
+#include "ql_iic.h"
 #include "ql_delay.h"
+#include "timers.h"
 
 #define LOG_TAG "uart"
 #define LOG_LVL QL_LOG_INFO
 #include "ql_log.h"
 
+/* DMA address registers are 32 bit, a host build links below 4 GB */
+#define QL_UART_DMA_ADDR(Ptr)   ((uint32_t)(uintptr_t)(Ptr))
+
 static usart_cfg_t Ql_Usart_Cfg[7];
 static usart_manage_t *Ql_Usart_Manage[7] = { NULL };
+static volatile uint8_t Ql_Dma0_Shared_Owner = QL_DMA0_SHARED_FREE;
+static TimerHandle_t Ql_Uart_Bridge_Timer = NULL;
 
 static int32_t Ql_GetUsartID(uint32_t UsartPeriph);
 
+#if QL_UART_STATS_ENABLE
+#define QL_UART_STATS_ADD(Usart, Field, N)     ((Usart)->Stats.Field += (N))
+
+/*****************************************************************************
+* @brief  Account what the RX DMA wrote since the previous sample
+* ex:
+* @par
+* Sampled from the IDLE/HT/FT interrupts, so the DMA never moves more than
+* half a ring between two samples and a lap cannot be missed. Task context
+* must call it with interrupts masked.
+* @retval
+*****************************************************************************/
+static inline void Ql_Uart_Stats_Rx_Sample(usart_manage_t *Usart)
+{
+    const uint32_t pos = (Usart->Recv_Buf_Size - dma_transfer_number_get(Usart->rx->dma_periph, Usart->rx->channelx)) % Usart->Recv_Buf_Size;
+
+    Usart->Stats.Rx_Bytes += (pos + Usart->Recv_Buf_Size - Usart->Stats_Rx_Pos) % Usart->Recv_Buf_Size;
+    Usart->Stats_Rx_Pos    = pos;
+}
+
+/*****************************************************************************
+* @brief  Count the receive errors flagged in STAT0
+* ex:
+* @par
+* Only STAT0 is read: a DATA read would race the RX DMA for the byte. The
+* flags stay set until the IDLE path does its STAT0 then DATA read, so a
+* bit is counted when it comes up, and the error interrupts are masked
+* until then instead of firing on the flag that is still set.
+* @retval
+*****************************************************************************/
+static inline void Ql_Uart_Stats_Err(usart_manage_t *Usart)
+{
+    const uint32_t stat = USART_STAT0(Usart->usart_periph) & (USART_STAT0_ORERR | USART_STAT0_FERR | USART_STAT0_NERR | USART_STAT0_PERR);
+    const uint32_t rise = stat & ~Usart->Stats_Err_Seen;
+
+    if (rise == 0)
+    {
+        return;
+    }
+    Usart->Stats_Err_Seen = stat;
+
+    if (rise & USART_STAT0_ORERR) Usart->Stats.Overrun++;
+    if (rise & USART_STAT0_FERR)  Usart->Stats.Framing++;
+    if (rise & USART_STAT0_NERR)  Usart->Stats.Noise++;
+    if (rise & USART_STAT0_PERR)  Usart->Stats.Parity++;
+
+    usart_interrupt_disable(Usart->usart_periph, USART_INT_ERR);
+    usart_interrupt_disable(Usart->usart_periph, USART_INT_PERR);
+}
+
+/* The IDLE path has cleared the flags, count the next errors again */
+static inline void Ql_Uart_Stats_Err_Rearm(usart_manage_t *Usart)
+{
+    if (Usart->Stats_Err_Seen != 0)
+    {
+        Usart->Stats_Err_Seen = 0;
+        usart_interrupt_enable(Usart->usart_periph, USART_INT_ERR);
+        usart_interrupt_enable(Usart->usart_periph, USART_INT_PERR);
+    }
+}
+
+/*****************************************************************************
+* @brief  Called by the reading task after each successful read
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+static void Ql_Uart_Stats_Read(usart_manage_t *Usart, uint32_t Recv_Count, uint32_t Read_Bytes)
+{
+    uint32_t unread;
+    uint32_t latency;
+    uint8_t  bucket = 0;
+
+    taskENTER_CRITICAL();
+    Ql_Uart_Stats_Rx_Sample(Usart);
+    taskEXIT_CRITICAL();
+
+    unread = Usart->Stats.Rx_Bytes - Usart->Stats_Read_Total;
+    if (unread >= Usart->Recv_Buf_Size)
+    {
+        /* The index math only sees the ring modulo its size, resync on it */
+        Usart->Stats.Ring_Lapped++;
+        Usart->Stats_Read_Total = Usart->Stats.Rx_Bytes - Recv_Count;
+        unread = Recv_Count;
+    }
+
+    if (unread > Usart->Stats.Ring_High_Water)
+    {
+        Usart->Stats.Ring_High_Water = unread;
+    }
+    Usart->Stats_Read_Total += Read_Bytes;
+
+    if (Usart->Stats_Rx_Stamp != 0)
+    {
+        /* The stamp is made odd to tell it from none, so it can be 1 us
+           ahead of a read right after the interrupt */
+        latency = (uint32_t)getus() - Usart->Stats_Rx_Stamp;
+        latency = ((int32_t)latency > 0) ? (latency >> 6) : 0;
+        if (latency != 0)
+        {
+            bucket = 32 - __CLZ(latency);
+            bucket = (bucket < QL_UART_LATENCY_BUCKETS) ? bucket : (QL_UART_LATENCY_BUCKETS - 1);
+        }
+        Usart->Stats.Read_Latency[bucket]++;
+        Usart->Stats_Rx_Stamp = 0;
+    }
+}
+#else
+#define QL_UART_STATS_ADD(Usart, Field, N)
+#define Ql_Uart_Stats_Rx_Sample(Usart)
+#define Ql_Uart_Stats_Err(Usart)
+#define Ql_Uart_Stats_Err_Rearm(Usart)
+#define Ql_Uart_Stats_Read(Usart, Recv_Count, Read_Bytes)
+#endif
+
 #if 0
 static uint32_t (*Ql_Log_Uart_RxCB)(const uint8_t *Str, uint32_t Len) = NULL;
 #endif 
@@ -68,6 +191,9 @@ int32_t Ql_Log_Uart_Init(const char *Name, uint32_t Baud)
         {
             return 0;
         }
+        /* Closed by Ql_Uart_DeInit, reopen with the buffers already there */
+        usart = Ql_Usart_Manage[usart_id];
+        usart->Init = 1;
     }
 
     usart->Name = Name;
@@ -190,6 +316,9 @@ int32_t Ql_Uart2_Init(const char *Name, uint32_t Baud)
         {
             return 0;
         }
+        /* Closed by Ql_Uart_DeInit, reopen with the buffers already there */
+        usart = Ql_Usart_Manage[usart_id];
+        usart->Init = 1;
     }
 
     usart->Name = Name;
@@ -299,7 +428,7 @@ static int32_t Ql_GetUsartID(uint32_t UsartPeriph)
     return -1;
 }
 
-int8_t *Ql_Uart_NameGet(uint32_t UsartPeriph)
+const char *Ql_Uart_NameGet(uint32_t UsartPeriph)
 {
     if (UsartPeriph == USART0) return "USART0";
     if (UsartPeriph == USART1) return "USART1";
@@ -311,6 +440,43 @@ int8_t *Ql_Uart_NameGet(uint32_t UsartPeriph)
     return NULL;
 }
 
+/*****************************************************************************
+* @brief  Take DMA0 CH0/CH7 for UART4 or for I2C0 in IIC_MODE_HW0_DMA
+* ex:
+* @par
+* The two drivers program the same streams, only one may hold them. Taking
+* them again with the same owner succeeds.
+* @retval
+* 0: held by Owner, -1: held by the other driver
+*****************************************************************************/
+int32_t Ql_Uart_Dma0_Claim(uint8_t Owner)
+{
+    int32_t ret = 0;
+
+    taskENTER_CRITICAL();
+    if (Ql_Dma0_Shared_Owner == QL_DMA0_SHARED_FREE)
+    {
+        Ql_Dma0_Shared_Owner = Owner;
+    }
+    else if (Ql_Dma0_Shared_Owner != Owner)
+    {
+        ret = -1;
+    }
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+void Ql_Uart_Dma0_Release(uint8_t Owner)
+{
+    taskENTER_CRITICAL();
+    if (Ql_Dma0_Shared_Owner == Owner)
+    {
+        Ql_Dma0_Shared_Owner = QL_DMA0_SHARED_FREE;
+    }
+    taskEXIT_CRITICAL();
+}
+
 /*****************************************************************************
 * @brief  
 * ex:
@@ -329,12 +495,18 @@ int32_t Ql_Uart_Init(const char *Name, uint32_t UsartPeriph, uint32_t Baud,
         return -1;
     }
 
+    if ((UsartPeriph == UART4) && (Ql_Uart_Dma0_Claim(QL_DMA0_SHARED_UART4) != 0))
+    {
+        QL_LOG_E("UART4 DMA0 CH0/CH7 are held by I2C0");
+        return -1;
+    }
+
     if (Ql_Usart_Manage[usart_id] == NULL)
     {
         usart = (usart_manage_t *)USART_MALLOC(sizeof(usart_manage_t));
         if (usart == NULL)
         {
-            return -1;
+            goto _fail_malloc_manage;
         }
 
         memset(usart, 0, sizeof(usart_manage_t));
@@ -388,6 +560,12 @@ int32_t Ql_Uart_Init(const char *Name, uint32_t UsartPeriph, uint32_t Baud,
         {
             return 0;
         }
+        /* Closed by Ql_Uart_DeInit, reopen with the buffers already there.
+           RX DMA restarts at the head of Recv_Buf, so drop what was unread */
+        usart = Ql_Usart_Manage[usart_id];
+        usart->Init     = 1;
+        usart->Read_Idx = 0;
+        xSemaphoreTake(usart->Recv_Sem, 0);
     }
 
     usart->Name = Name;
@@ -570,7 +748,7 @@ int32_t Ql_Uart_Init(const char *Name, uint32_t UsartPeriph, uint32_t Baud,
     dma_init_struct.direction           = DMA_MEMORY_TO_PERIPH;
     dma_init_struct.memory_inc          = DMA_MEMORY_INCREASE_ENABLE;
     dma_init_struct.periph_memory_width = DMA_PERIPH_WIDTH_8BIT;
-    dma_init_struct.periph_addr         = ((uint32_t)&USART_DATA(UsartPeriph));
+    dma_init_struct.periph_addr         = QL_UART_DMA_ADDR(&USART_DATA(UsartPeriph));
     dma_init_struct.periph_inc          = DMA_PERIPH_INCREASE_DISABLE;
     dma_init_struct.priority            = DMA_PRIORITY_ULTRA_HIGH;
     dma_single_data_mode_init(usart->tx->dma_periph, usart->tx->channelx, &dma_init_struct);
@@ -585,8 +763,8 @@ int32_t Ql_Uart_Init(const char *Name, uint32_t UsartPeriph, uint32_t Baud,
     dma_init_struct.periph_memory_width = DMA_PERIPH_WIDTH_8BIT;
     dma_init_struct.periph_inc          = DMA_PERIPH_INCREASE_DISABLE;
     dma_init_struct.priority            = DMA_PRIORITY_ULTRA_HIGH;
-    dma_init_struct.periph_addr         = ((uint32_t)&USART_DATA(UsartPeriph));
-    dma_init_struct.memory0_addr        = (uint32_t)usart->Recv_Buf;
+    dma_init_struct.periph_addr         = QL_UART_DMA_ADDR(&USART_DATA(UsartPeriph));
+    dma_init_struct.memory0_addr        = QL_UART_DMA_ADDR(usart->Recv_Buf);
     dma_init_struct.number              = usart->Recv_Buf_Size;
     dma_single_data_mode_init(usart->rx->dma_periph, usart->rx->channelx, &dma_init_struct);
     dma_circulation_disable(usart->rx->dma_periph, usart->rx->channelx);
@@ -602,6 +780,13 @@ int32_t Ql_Uart_Init(const char *Name, uint32_t UsartPeriph, uint32_t Baud,
     usart_interrupt_enable(UsartPeriph, USART_INT_IDLE);
     // dma_interrupt_enable(usart->tx->dma_periph, usart->tx->channelx, DMA_CHXCTL_FTFIE);
     dma_interrupt_enable(usart->rx->dma_periph, usart->rx->channelx, DMA_CHXCTL_FTFIE);
+#if QL_UART_STATS_ENABLE
+    dma_interrupt_enable(usart->rx->dma_periph, usart->rx->channelx, DMA_CHXCTL_HTFIE);
+    usart_interrupt_enable(UsartPeriph, USART_INT_ERR);
+    usart_interrupt_enable(UsartPeriph, USART_INT_PERR);
+    usart->Stats_Rx_Pos = 0;
+    usart->Stats_Err_Seen = 0;
+#endif
 
     usart_transmit_config(UsartPeriph, USART_TRANSMIT_ENABLE);
     usart_receive_config(UsartPeriph, USART_RECEIVE_ENABLE);
@@ -622,6 +807,11 @@ _fail_create_recv_sem:
     vSemaphoreDelete(usart->Mutex);
 _fail_create_mutex:
     USART_FREE(usart);
+_fail_malloc_manage:
+    if (UsartPeriph == UART4)
+    {
+        Ql_Uart_Dma0_Release(QL_DMA0_SHARED_UART4);
+    }
 
     return -1;
 }
@@ -653,6 +843,11 @@ int32_t Ql_Uart_DeInit(uint32_t UsartPeriph)
     // usart_interrupt_disable(usart_periph, USART_INT_TC);
     // usart_interrupt_disable(usart_periph, USART_INT_RBNE);
     usart_interrupt_disable(UsartPeriph, USART_INT_IDLE);
+#if QL_UART_STATS_ENABLE
+    dma_interrupt_disable(usart->rx->dma_periph, usart->rx->channelx, DMA_CHXCTL_HTFIE);
+    usart_interrupt_disable(UsartPeriph, USART_INT_ERR);
+    usart_interrupt_disable(UsartPeriph, USART_INT_PERR);
+#endif
 
     dma_channel_disable(usart->tx->dma_periph, usart->tx->channelx);
     dma_channel_disable(usart->rx->dma_periph, usart->rx->channelx);
@@ -691,11 +886,13 @@ int32_t Ql_Uart_DeInit(uint32_t UsartPeriph)
         nvic_irq_disable(DMA0_Channel7_IRQn);
         nvic_irq_disable(DMA0_Channel0_IRQn);
         rcu_periph_clock_disable(RCU_UART4);
+        Ql_Uart_Dma0_Release(QL_DMA0_SHARED_UART4);
     }
     else if (UsartPeriph == USART5)
     {
 
     }
+    usart->Init = 0;
 
     return 0;
 }
@@ -784,6 +981,11 @@ int32_t Ql_Uart_Read(uint32_t UsartPeriph, void* Src, uint16_t Size, uint32_t Ti
         xSemaphoreTake(usart->Recv_Sem, Timeout);
     }
 
+    if ((usart->Bridge_Dst != NULL) && (usart->Bridge_Tap == 0))
+    {
+        return 0;
+    }
+
     usart->Remain_Byte = dma_transfer_number_get(usart->rx->dma_periph, usart->rx->channelx);
     usart->Receive_Idx = usart->Recv_Buf_Size - usart->Remain_Byte;
     if (usart->Read_Idx == usart->Receive_Idx)
@@ -806,6 +1008,8 @@ int32_t Ql_Uart_Read(uint32_t UsartPeriph, void* Src, uint16_t Size, uint32_t Ti
         usart->Read_Idx += read_bytes;
     }
 
+    Ql_Uart_Stats_Read(usart, recv_count, read_bytes);
+
     // debug
     if (usart->Cfg->Recv_Debug == 2)
     {
@@ -826,7 +1030,7 @@ int32_t Ql_Uart_Write(uint32_t UsartPeriph, const void* Src, uint16_t Len, uint3
 {
     usart_manage_t *usart = Ql_Usart_Manage[Ql_GetUsartID(UsartPeriph)];
 
-    if (usart == NULL)
+    if ((usart == NULL) || (usart->Bridge_Src != NULL))
     {
         return 0;
     }
@@ -836,8 +1040,9 @@ int32_t Ql_Uart_Write(uint32_t UsartPeriph, const void* Src, uint16_t Len, uint3
 
     if (usart->Send_Buf == NULL || usart->Send_Buf_Size == 0)
     {
-        dma_memory_address_config(usart->tx->dma_periph, usart->tx->channelx, DMA_MEMORY_0, (uint32_t)Src);
+        dma_memory_address_config(usart->tx->dma_periph, usart->tx->channelx, DMA_MEMORY_0, QL_UART_DMA_ADDR(Src));
         dma_transfer_number_config(usart->tx->dma_periph, usart->tx->channelx, Len);
+        usart->Send_Len = Len;
     }
     else
     {
@@ -852,7 +1057,7 @@ int32_t Ql_Uart_Write(uint32_t UsartPeriph, const void* Src, uint16_t Len, uint3
             memcpy(usart->Send_Buf, Src, usart->Send_Buf_Size);
             usart->Send_Len = usart->Send_Buf_Size;
         }
-        dma_memory_address_config(usart->tx->dma_periph, usart->tx->channelx, DMA_MEMORY_0, (uint32_t)usart->Send_Buf);
+        dma_memory_address_config(usart->tx->dma_periph, usart->tx->channelx, DMA_MEMORY_0, QL_UART_DMA_ADDR(usart->Send_Buf));
         dma_transfer_number_config(usart->tx->dma_periph, usart->tx->channelx, usart->Send_Len);
     }
 
@@ -885,6 +1090,495 @@ usart_cfg_t *Ql_Uart_Cfg(uint32_t UsartPeriph)
     return &Ql_Usart_Cfg[usart_id];
 }
 
+/*****************************************************************************
+* @brief  Drop everything received so far
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+int32_t Ql_Uart_Flush(uint32_t UsartPeriph)
+{
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+    usart_manage_t *usart = NULL;
+
+    if (usart_id == -1)
+    {
+        return -1;
+    }
+
+    usart = Ql_Usart_Manage[usart_id];
+    if ((usart == NULL) || (usart->rx == NULL))
+    {
+        return -1;
+    }
+
+    usart->Remain_Byte = dma_transfer_number_get(usart->rx->dma_periph, usart->rx->channelx);
+    usart->Receive_Idx = usart->Recv_Buf_Size - usart->Remain_Byte;
+    usart->Read_Idx    = usart->Receive_Idx;
+    xSemaphoreTake(usart->Recv_Sem, 0);
+
+#if QL_UART_STATS_ENABLE
+    taskENTER_CRITICAL();
+    Ql_Uart_Stats_Rx_Sample(usart);
+    usart->Stats_Read_Total = usart->Stats.Rx_Bytes;
+    usart->Stats_Rx_Stamp   = 0;
+    taskEXIT_CRITICAL();
+#endif
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Change the baud rate of an initialized port at runtime
+* ex:
+* @par
+* The pending TX frame is drained at the old rate and the RX ring is flushed,
+* bytes received around the switch are garbage anyway. A running DMA transfer
+* is slept on for its length plus two ticks, a TC it sets is left to the
+* interrupt so its writer still gets Send_Sem.
+* @retval
+*****************************************************************************/
+int32_t Ql_Uart_Baud_Set(uint32_t UsartPeriph, uint32_t Baud)
+{
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+    usart_manage_t *usart = NULL;
+    uint32_t frame_us;
+    TickType_t start;
+    TickType_t wait;
+    uint32_t spin;
+
+    if ((usart_id == -1) || (Baud == 0))
+    {
+        return -1;
+    }
+
+    usart = Ql_Usart_Manage[usart_id];
+    if ((usart == NULL) || (usart->Init == 0))
+    {
+        return -1;
+    }
+    frame_us = 10 * 1000000 / usart->baud + 1;
+
+    /* The interrupt clears TC, keep it set for the polls below */
+    usart_interrupt_disable(UsartPeriph, USART_INT_TC);
+
+    wait = pdMS_TO_TICKS(dma_transfer_number_get(usart->tx->dma_periph, usart->tx->channelx) * frame_us / 1000) + 2;
+    start = xTaskGetTickCount();
+    while ((dma_transfer_number_get(usart->tx->dma_periph, usart->tx->channelx) != 0) &&
+           (usart_flag_get(UsartPeriph, USART_FLAG_TC) == RESET) && ((xTaskGetTickCount() - start) < wait))
+    {
+        vTaskDelay(1);
+    }
+
+    /* Data and shift registers. An idle line had its TC taken already */
+    for (spin = 0; (spin < 2 * frame_us) && (usart_flag_get(UsartPeriph, USART_FLAG_TC) == RESET); spin += 10)
+    {
+        delay_us(10);
+    }
+
+    usart_disable(UsartPeriph);
+    usart_baudrate_set(UsartPeriph, Baud);
+    usart->baud = Baud;
+    usart_enable(UsartPeriph);
+    usart_interrupt_enable(UsartPeriph, USART_INT_TC);
+
+    Ql_Uart_Flush(UsartPeriph);
+
+    return 0;
+}
+
+uint32_t Ql_Uart_Baud_Get(uint32_t UsartPeriph)
+{
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+
+    if ((usart_id == -1) || (Ql_Usart_Manage[usart_id] == NULL))
+    {
+        return 0;
+    }
+
+    return Ql_Usart_Manage[usart_id]->baud;
+}
+
+/*****************************************************************************
+* @brief  Zero-copy read: pointer to the next contiguous run in the RX ring
+* ex:
+* @par
+* The data stays valid until the DMA laps it, release it with Ql_Uart_Consume.
+* Timeout applies only when the ring is empty: when the unread data wraps,
+* the next call returns the run at the head of the ring at once.
+* @retval length of the run
+*****************************************************************************/
+int32_t Ql_Uart_Peek(uint32_t UsartPeriph, const uint8_t **Ptr, uint32_t Timeout)
+{
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+    usart_manage_t *usart = NULL;
+
+    if ((usart_id == -1) || (Ptr == NULL))
+    {
+        return 0;
+    }
+
+    usart = Ql_Usart_Manage[usart_id];
+    if ((usart == NULL) || (usart->rx == NULL))
+    {
+        return 0;
+    }
+
+    usart->Remain_Byte = dma_transfer_number_get(usart->rx->dma_periph, usart->rx->channelx);
+    usart->Receive_Idx = usart->Recv_Buf_Size - usart->Remain_Byte;
+
+    /* Wait only when nothing is unread, the second run of a wrapped ring is
+       already there */
+    if ((usart->Read_Idx == usart->Receive_Idx) && (Timeout > 0))
+    {
+        xSemaphoreTake(usart->Recv_Sem, Timeout);
+        usart->Remain_Byte = dma_transfer_number_get(usart->rx->dma_periph, usart->rx->channelx);
+        usart->Receive_Idx = usart->Recv_Buf_Size - usart->Remain_Byte;
+    }
+    if (usart->Read_Idx == usart->Receive_Idx)
+    {
+        return 0;
+    }
+
+    *Ptr = usart->Recv_Buf + usart->Read_Idx;
+
+    return (usart->Read_Idx < usart->Receive_Idx) ? (usart->Receive_Idx - usart->Read_Idx) :
+                                                    (usart->Recv_Buf_Size - usart->Read_Idx);
+}
+
+int32_t Ql_Uart_Consume(uint32_t UsartPeriph, uint32_t Len)
+{
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+    usart_manage_t *usart = NULL;
+
+    if (usart_id == -1)
+    {
+        return -1;
+    }
+
+    usart = Ql_Usart_Manage[usart_id];
+    if ((usart == NULL) || (usart->Recv_Buf_Size == 0))
+    {
+        return -1;
+    }
+
+#if QL_UART_STATS_ENABLE
+    {
+        const uint32_t receive_idx = usart->Recv_Buf_Size - dma_transfer_number_get(usart->rx->dma_periph, usart->rx->channelx);
+
+        Ql_Uart_Stats_Read(usart, (receive_idx + usart->Recv_Buf_Size - usart->Read_Idx) % usart->Recv_Buf_Size, Len);
+    }
+#endif
+
+    usart->Read_Idx = (usart->Read_Idx + Len) % usart->Recv_Buf_Size;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Bridge: hand the next contiguous run of Src RX ring to Dst TX DMA
+* ex:
+* @par
+* Called from the Src IDLE/HT/FT and Dst TC interrupts, and from the poll
+* timer with interrupts masked. One run is in flight at a time, Dst must be
+* at least as fast as Src or the ring laps.
+* @retval
+*****************************************************************************/
+static inline void Ql_Uart_Bridge_Pump(usart_manage_t *Src)
+{
+    usart_manage_t *dst = Src->Bridge_Dst;
+    uint32_t receive_idx;
+    uint32_t len;
+
+    if ((dst == NULL) || (Src->Bridge_Len != 0))
+    {
+        return;
+    }
+
+    receive_idx = Src->Recv_Buf_Size - dma_transfer_number_get(Src->rx->dma_periph, Src->rx->channelx);
+    if (Src->Bridge_Idx == receive_idx)
+    {
+        return;
+    }
+
+    len = (Src->Bridge_Idx < receive_idx) ? (receive_idx - Src->Bridge_Idx) : (Src->Recv_Buf_Size - Src->Bridge_Idx);
+
+    dma_channel_disable(dst->tx->dma_periph, dst->tx->channelx);
+    dma_flag_clear(dst->tx->dma_periph, dst->tx->channelx, DMA_FLAG_FTF);
+    dma_memory_address_config(dst->tx->dma_periph, dst->tx->channelx, DMA_MEMORY_0, QL_UART_DMA_ADDR(Src->Recv_Buf + Src->Bridge_Idx));
+    dma_transfer_number_config(dst->tx->dma_periph, dst->tx->channelx, len);
+    Src->Bridge_Len = len;
+    dma_channel_enable(dst->tx->dma_periph, dst->tx->channelx);
+}
+
+/*****************************************************************************
+* @brief  Bridge poll timer: start a run with what RX DMA has stored so far
+* ex:
+* @par
+* Without it a run only starts at IDLE or half ring. Under a saturated
+* stream that backlog is never caught up, Dst runs at the same rate, and a
+* burst waits for its own end. Once a run is in flight the Dst TC chains
+* the next one, the poll finds Bridge_Len != 0 and does nothing.
+* @retval
+*****************************************************************************/
+static void Ql_Uart_Bridge_Poll(TimerHandle_t Timer)
+{
+    (void)Timer;
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < sizeof(Ql_Usart_Manage) / sizeof(Ql_Usart_Manage[0]); i++)
+    {
+        if ((Ql_Usart_Manage[i] != NULL) && (Ql_Usart_Manage[i]->Bridge_Dst != NULL))
+        {
+            Ql_Uart_Bridge_Pump(Ql_Usart_Manage[i]);
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*****************************************************************************
+* @brief  Forward everything received on SrcPeriph to DstPeriph by DMA
+* ex:
+* Ql_Uart_Bridge_Start(UART3, USART5, 0);
+* Ql_Uart_Bridge_Start(USART5, UART3, 0);
+* @par
+* One direction per call, call twice for full duplex. With Tap = 1,
+* Ql_Uart_Read on SrcPeriph still returns the stream for the parser, its read
+* index is independent of the bridge. DstPeriph rejects Ql_Uart_Write while
+* bridged.
+* @retval
+*****************************************************************************/
+int32_t Ql_Uart_Bridge_Start(uint32_t SrcPeriph, uint32_t DstPeriph, uint8_t Tap)
+{
+    const int32_t src_id = Ql_GetUsartID(SrcPeriph);
+    const int32_t dst_id = Ql_GetUsartID(DstPeriph);
+    usart_manage_t *src = NULL;
+    usart_manage_t *dst = NULL;
+
+    if ((src_id == -1) || (dst_id == -1) || (src_id == dst_id))
+    {
+        return -1;
+    }
+
+    src = Ql_Usart_Manage[src_id];
+    dst = Ql_Usart_Manage[dst_id];
+    if ((src == NULL) || (dst == NULL) || (src->rx == NULL) || (dst->tx == NULL))
+    {
+        return -1;
+    }
+
+    if ((src->Bridge_Dst != NULL) || (dst->Bridge_Src != NULL))
+    {
+        return -1;
+    }
+
+    if (dst->baud < src->baud)
+    {
+        QL_LOG_W("bridge %s(%d) -> %s(%d) may lap the ring", src->Name, src->baud, dst->Name, dst->baud);
+    }
+
+    if (Ql_Uart_Bridge_Timer == NULL)
+    {
+        Ql_Uart_Bridge_Timer = xTimerCreate("uart bridge", QL_UART_BRIDGE_POLL_TICKS, pdTRUE, NULL, Ql_Uart_Bridge_Poll);
+        if (Ql_Uart_Bridge_Timer == NULL)
+        {
+            return -1;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    src->Bridge_Idx = src->Recv_Buf_Size - dma_transfer_number_get(src->rx->dma_periph, src->rx->channelx);
+    src->Bridge_Len = 0;
+    src->Bridge_Tap = Tap;
+    src->Bridge_Dst = dst;
+    dst->Bridge_Src = src;
+    dma_interrupt_enable(src->rx->dma_periph, src->rx->channelx, DMA_CHXCTL_HTFIE);
+    taskEXIT_CRITICAL();
+
+    if (xTimerIsTimerActive(Ql_Uart_Bridge_Timer) == pdFALSE)
+    {
+        xTimerStart(Ql_Uart_Bridge_Timer, 0);
+    }
+
+    return 0;
+}
+
+int32_t Ql_Uart_Bridge_Stop(uint32_t SrcPeriph)
+{
+    const int32_t src_id = Ql_GetUsartID(SrcPeriph);
+    usart_manage_t *src = NULL;
+    usart_manage_t *dst = NULL;
+    uint32_t timeout = 100;
+
+    if (src_id == -1)
+    {
+        return -1;
+    }
+
+    src = Ql_Usart_Manage[src_id];
+    if ((src == NULL) || (src->Bridge_Dst == NULL))
+    {
+        return 0;
+    }
+    dst = src->Bridge_Dst;
+
+    taskENTER_CRITICAL();
+#if !QL_UART_STATS_ENABLE
+    dma_interrupt_disable(src->rx->dma_periph, src->rx->channelx, DMA_CHXCTL_HTFIE);
+#endif
+    src->Bridge_Dst = NULL;
+    taskEXIT_CRITICAL();
+
+    /* Let the run in flight finish before Dst goes back to Ql_Uart_Write */
+    while ((src->Bridge_Len != 0) && (timeout-- > 0))
+    {
+        vTaskDelay(1);
+    }
+
+    dst->Bridge_Src = NULL;
+    src->Bridge_Len = 0;
+    xSemaphoreTake(dst->Send_Sem, 0);
+
+    for (uint32_t i = 0; i < sizeof(Ql_Usart_Manage) / sizeof(Ql_Usart_Manage[0]); i++)
+    {
+        if ((Ql_Usart_Manage[i] != NULL) && (Ql_Usart_Manage[i]->Bridge_Dst != NULL))
+        {
+            return 0;
+        }
+    }
+    xTimerStop(Ql_Uart_Bridge_Timer, 0);
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Snapshot of the link counters
+* ex:
+* @par
+* Copied with interrupts masked, the counters are consistent with each other.
+* @retval -1: port not initialized or QL_UART_STATS_ENABLE is 0
+*****************************************************************************/
+int32_t Ql_Uart_Stats_Get(uint32_t UsartPeriph, usart_stats_t *Stats)
+{
+#if QL_UART_STATS_ENABLE
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+    usart_manage_t *usart = NULL;
+
+    if ((usart_id == -1) || (Stats == NULL))
+    {
+        return -1;
+    }
+
+    usart = Ql_Usart_Manage[usart_id];
+    if ((usart == NULL) || (usart->rx == NULL))
+    {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    Ql_Uart_Stats_Rx_Sample(usart);
+    memcpy(Stats, &usart->Stats, sizeof(usart_stats_t));
+    taskEXIT_CRITICAL();
+
+    return 0;
+#else
+    (void)UsartPeriph;
+    (void)Stats;
+    return -1;
+#endif
+}
+
+int32_t Ql_Uart_Stats_Reset(uint32_t UsartPeriph)
+{
+#if QL_UART_STATS_ENABLE
+    const int32_t usart_id = Ql_GetUsartID(UsartPeriph);
+    usart_manage_t *usart = NULL;
+
+    if (usart_id == -1)
+    {
+        return -1;
+    }
+
+    usart = Ql_Usart_Manage[usart_id];
+    if ((usart == NULL) || (usart->rx == NULL))
+    {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    Ql_Uart_Stats_Rx_Sample(usart);
+    usart->Stats_Read_Total -= usart->Stats.Rx_Bytes;
+    memset(&usart->Stats, 0, sizeof(usart_stats_t));
+    taskEXIT_CRITICAL();
+
+    return 0;
+#else
+    (void)UsartPeriph;
+    return -1;
+#endif
+}
+
+/*****************************************************************************
+* @brief  Read latency percentile from the histogram
+* ex:
+* Ql_Uart_Stats_Latency(&stats, 99);
+* @par
+* Resolution is one histogram bucket, the upper bound is returned.
+* @retval us, 0 if nothing was read yet
+*****************************************************************************/
+uint32_t Ql_Uart_Stats_Latency(const usart_stats_t *Stats, uint8_t Percent)
+{
+    uint32_t total = 0;
+    uint32_t count = 0;
+    uint64_t target;
+
+    if (Stats == NULL)
+    {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < QL_UART_LATENCY_BUCKETS; i++)
+    {
+        total += Stats->Read_Latency[i];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    target = ((uint64_t)total * ((Percent > 100) ? 100 : Percent) + 99) / 100;
+    for (uint8_t i = 0; i < QL_UART_LATENCY_BUCKETS; i++)
+    {
+        count += Stats->Read_Latency[i];
+        if (count >= target)
+        {
+            return 1UL << (i + 6);
+        }
+    }
+
+    return 1UL << (QL_UART_LATENCY_BUCKETS + 5);
+}
+
+void Ql_Uart_Stats_Print(uint32_t UsartPeriph)
+{
+    usart_manage_t *usart = NULL;
+    usart_stats_t stats;
+
+    if (Ql_Uart_Stats_Get(UsartPeriph, &stats) != 0)
+    {
+        return;
+    }
+    usart = Ql_Usart_Manage[Ql_GetUsartID(UsartPeriph)];
+
+    QL_LOG_I("%s: rx %u, tx %u, ore %u, fe %u, ne %u, pe %u, hwm %u/%u, lapped %u",
+             usart->Name, stats.Rx_Bytes, stats.Tx_Bytes, stats.Overrun, stats.Framing, stats.Noise,
+             stats.Parity, stats.Ring_High_Water, usart->Recv_Buf_Size, stats.Ring_Lapped);
+    QL_LOG_I("%s: read latency p50 < %u us, p90 < %u us, p99 < %u us", usart->Name,
+             Ql_Uart_Stats_Latency(&stats, 50), Ql_Uart_Stats_Latency(&stats, 90), Ql_Uart_Stats_Latency(&stats, 99));
+}
+
 /*****************************************************************************
 * @brief  UART IRQ
 * ex:
@@ -897,11 +1591,22 @@ static inline void Ql_Uart_IrqHandler(usart_manage_t *Usart)
     static portBASE_TYPE xHigherPriorityTaskWoken;
     uint16_t temp;
 
+    Ql_Uart_Stats_Err(Usart);
+
     if (usart_interrupt_flag_get(Usart->usart_periph, USART_INT_FLAG_IDLE) != RESET)
     {
         temp = USART_STAT0(Usart->usart_periph);
         temp = USART_DATA(Usart->usart_periph);
         (void)temp;
+        Ql_Uart_Stats_Err_Rearm(Usart);
+
+#if QL_UART_STATS_ENABLE
+        Ql_Uart_Stats_Rx_Sample(Usart);
+        if (Usart->Stats_Rx_Stamp == 0)
+        {
+            Usart->Stats_Rx_Stamp = (uint32_t)getus() | 1;
+        }
+#endif
 
         //--------------------------------------------------------------
         // debug
@@ -931,6 +1636,8 @@ static inline void Ql_Uart_IrqHandler(usart_manage_t *Usart)
         }
         //--------------------------------------------------------------
 
+        Ql_Uart_Bridge_Pump(Usart);
+
         if (Usart->Irq_Callback != NULL)
         {
             Usart->Irq_Callback(USART_IRQ_IDLE);
@@ -944,6 +1651,22 @@ static inline void Ql_Uart_IrqHandler(usart_manage_t *Usart)
     {
         usart_interrupt_flag_clear(Usart->usart_periph, USART_INT_FLAG_TC);
 
+        if (Usart->Bridge_Src != NULL)
+        {
+            usart_manage_t *src = Usart->Bridge_Src;
+
+            QL_UART_STATS_ADD(Usart, Tx_Bytes, src->Bridge_Len);
+            src->Bridge_Idx = (src->Bridge_Idx + src->Bridge_Len) % src->Recv_Buf_Size;
+            src->Bridge_Len = 0;
+            Ql_Uart_Bridge_Pump(src);
+            return;
+        }
+
+#if QL_UART_STATS_ENABLE
+        Usart->Stats.Tx_Bytes += Usart->Send_Len;
+        Usart->Send_Len = 0;
+#endif
+
         if (Usart->Irq_Callback != NULL)
         {
             Usart->Irq_Callback(USART_IRQ_TC);
@@ -963,9 +1686,18 @@ static inline void Ql_Uart_IrqHandler(usart_manage_t *Usart)
 *****************************************************************************/
 static inline void Ql_Uart_Dma_Recv_IrqHandler(usart_manage_t *Usart)
 {
+    if (dma_interrupt_flag_get(Usart->rx->dma_periph, Usart->rx->channelx, DMA_INT_FLAG_HTF) != RESET)
+    {
+        dma_interrupt_flag_clear(Usart->rx->dma_periph, Usart->rx->channelx, DMA_INT_FLAG_HTF);
+        Ql_Uart_Stats_Rx_Sample(Usart);
+        Ql_Uart_Bridge_Pump(Usart);
+    }
+
     if (dma_interrupt_flag_get(Usart->rx->dma_periph, Usart->rx->channelx, DMA_INT_FLAG_FTF) != RESET)
     {
         dma_interrupt_flag_clear(Usart->rx->dma_periph, Usart->rx->channelx, DMA_INT_FLAG_FTF);
+        Ql_Uart_Stats_Rx_Sample(Usart);
+        Ql_Uart_Bridge_Pump(Usart);
 
         dma_channel_disable(Usart->rx->dma_periph, Usart->rx->channelx);
         dma_transfer_number_config(Usart->rx->dma_periph, Usart->rx->channelx, Usart->Recv_Buf_Size);
@@ -1108,15 +1840,26 @@ void UART4_IRQHandler(void)
     Ql_Uart_IrqHandler(usart);
 }
 
+/* Dispatched by the owner taken with Ql_Uart_Dma0_Claim */
 void DMA0_Channel0_IRQHandler(void)
 {
     usart_manage_t *usart = Ql_Usart_Manage[Ql_GetUsartID(UART4)];
+    if (Ql_Dma0_Shared_Owner == QL_DMA0_SHARED_IIC0)
+    {
+        Ql_IIC_DMA0_CH0_IRQHandler();
+        return;
+    }
     Ql_Uart_Dma_Recv_IrqHandler(usart);
 }
 
 void DMA0_Channel7_IRQHandler(void)
 {
     usart_manage_t *usart = Ql_Usart_Manage[Ql_GetUsartID(UART4)];
+    if (Ql_Dma0_Shared_Owner == QL_DMA0_SHARED_IIC0)
+    {
+        Ql_IIC_DMA0_CH7_IRQHandler();
+        return;
+    }
     Ql_Uart_Dma_Send_IrqHandler(usart);
 }
 
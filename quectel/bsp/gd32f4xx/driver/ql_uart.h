@@ -83,6 +83,25 @@ limitations under the License.
 #define UART6_DMA_TX_IRQ_PRI    configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0
 #define UART6_DMA_RX_IRQ_PRI    configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1, 0
 
+/* Link telemetry, 0 removes every counter update from the driver */
+#ifndef QL_UART_STATS_ENABLE
+#define QL_UART_STATS_ENABLE    1
+#endif
+
+/* A bridge also moves what has arrived every this many ticks, so a run
+   does not wait for IDLE or half ring before it is sent */
+#ifndef QL_UART_BRIDGE_POLL_TICKS
+#define QL_UART_BRIDGE_POLL_TICKS   1
+#endif
+
+/* Owner of DMA0 CH0/CH7, shared by UART4 and I2C0 in IIC_MODE_HW0_DMA */
+#define QL_DMA0_SHARED_FREE     0
+#define QL_DMA0_SHARED_UART4    1
+#define QL_DMA0_SHARED_IIC0     2
+
+/* Read latency histogram, bucket 0: < 64us, bucket n: [2^(n+5), 2^(n+6)) us */
+#define QL_UART_LATENCY_BUCKETS 16
+
 typedef enum
 {
     USART_IRQ_IDLE = 0,
@@ -112,6 +131,19 @@ typedef struct
 } usart_cfg_t;
 
 typedef struct
+{
+    uint32_t    Rx_Bytes;
+    uint32_t    Tx_Bytes;
+    uint32_t    Overrun;
+    uint32_t    Framing;
+    uint32_t    Noise;
+    uint32_t    Parity;
+    uint32_t    Ring_High_Water;    /* most unread bytes seen in the RX ring */
+    uint32_t    Ring_Lapped;        /* DMA overwrote data not read yet */
+    uint32_t    Read_Latency[QL_UART_LATENCY_BUCKETS];
+} usart_stats_t;
+
+typedef struct usart_manage
 {
     uint32_t            usart_periph;
     uint32_t            baud;
@@ -132,6 +164,20 @@ typedef struct
     uint32_t            Send_Buf_Size;
     uint32_t            Send_Len;
     void              (*Irq_Callback)(usart_irq_e Irq_Flag);
+    /* Bridge: RX ring of this port is sent by the TX DMA of Bridge_Dst */
+    struct usart_manage *Bridge_Dst;
+    struct usart_manage *Bridge_Src;
+    uint32_t            Bridge_Idx;
+    uint32_t            Bridge_Len;
+    uint8_t             Bridge_Tap;
+#if QL_UART_STATS_ENABLE
+    /* No locks: Stats are written by the ISRs, the read side only by the reading task */
+    usart_stats_t       Stats;
+    uint32_t            Stats_Rx_Pos;
+    uint32_t            Stats_Read_Total;
+    uint32_t            Stats_Rx_Stamp;
+    uint32_t            Stats_Err_Seen;     // error bits of STAT0 already counted
+#endif
 } usart_manage_t;
 
 int32_t Ql_Log_Uart_Init(const char *Name, uint32_t Baud);
@@ -151,5 +197,18 @@ int32_t Ql_Uart_Release(uint32_t UsartPeriph);
 int32_t Ql_Uart_Read(uint32_t UsartPeriph, void* Src, uint16_t Size, uint32_t Timeout);
 int32_t Ql_Uart_Write(uint32_t UsartPeriph, const void* Src, uint16_t Len, uint32_t Timeout);
 usart_cfg_t *Ql_Uart_Cfg(uint32_t UsartPeriph);
+int32_t Ql_Uart_Flush(uint32_t UsartPeriph);
+int32_t Ql_Uart_Baud_Set(uint32_t UsartPeriph, uint32_t Baud);
+uint32_t Ql_Uart_Baud_Get(uint32_t UsartPeriph);
+int32_t Ql_Uart_Peek(uint32_t UsartPeriph, const uint8_t **Ptr, uint32_t Timeout);
+int32_t Ql_Uart_Consume(uint32_t UsartPeriph, uint32_t Len);
+int32_t Ql_Uart_Bridge_Start(uint32_t SrcPeriph, uint32_t DstPeriph, uint8_t Tap);
+int32_t Ql_Uart_Bridge_Stop(uint32_t SrcPeriph);
+int32_t Ql_Uart_Stats_Get(uint32_t UsartPeriph, usart_stats_t *Stats);
+int32_t Ql_Uart_Stats_Reset(uint32_t UsartPeriph);
+uint32_t Ql_Uart_Stats_Latency(const usart_stats_t *Stats, uint8_t Percent);
+int32_t Ql_Uart_Dma0_Claim(uint8_t Owner);
+void    Ql_Uart_Dma0_Release(uint8_t Owner);
+void    Ql_Uart_Stats_Print(uint32_t UsartPeriph);
 
 #endif
@@ -373,7 +373,7 @@ static void _informDataReadyToUpperLayer( CellularSocketContext_t * pSocketData
     }
     else
     {
-        LogError( ( ( "_parseSocketUrc: Data ready callback not set!!" ) ) );
+        LogError( ( "_parseSocketUrc: Data ready callback not set!!" ) );
     }
 }
 
@@ -702,7 +702,7 @@ static void _Cellular_ProcessPowerDown( CellularContext_t * pContext,
 
     if( pContext == NULL )
     {
-        LogError( ( ( "_Cellular_ProcessPowerDown: Context not set" ) ) );
+        LogError( ( "_Cellular_ProcessPowerDown: Context not set" ) );
     }
     else
     {
@@ -723,7 +723,7 @@ static void _Cellular_ProcessPsmPowerDown( CellularContext_t * pContext,
 
     if( pContext == NULL )
     {
-        LogError( ( ( "_Cellular_ProcessPowerDown: Context not set" ) ) );
+        LogError( ( "_Cellular_ProcessPowerDown: Context not set" ) );
     }
     else
     {
@@ -0,0 +1,509 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_cache.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_ff_cache.h"
+
+#define LOG_TAG "ql_ff_cache"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_FF_CACHE_DATA(Cache, i)  (&(Cache)->Data[(i) * FF_MAX_SS])
+
+/* The cache of the SD card, drive 1. Every call runs under the volume lock
+   of FatFs, disk_xxx are only called with it held */
+Ql_FatFs_Cache_TypeDef Ql_FatFs_Sd_Cache;
+
+extern FATFS *qlfs;
+
+static int32_t Ql_FatFs_Cache_Find(const Ql_FatFs_Cache_TypeDef *Cache, uint32_t sector)
+{
+    for (uint32_t i = 0; i < Cache->Lines; i++)
+    {
+        if (Cache->Line[i].Valid && (Cache->Line[i].Sector == sector))
+        {
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+/*****************************************************************************
+* @brief  Free a line for sector, the least recently used one
+* ex:
+* @par
+* A dirty victim is written back first.
+* @retval line index, -1: write back failed
+*****************************************************************************/
+static int32_t Ql_FatFs_Cache_Alloc(Ql_FatFs_Cache_TypeDef *Cache, uint32_t sector)
+{
+    Ql_FatFs_Cache_Line_TypeDef *line;
+    uint32_t victim = 0;
+
+    for (uint32_t i = 0; i < Cache->Lines; i++)
+    {
+        if (!Cache->Line[i].Valid)
+        {
+            victim = i;
+            break;
+        }
+        if (Cache->Line[i].Stamp < Cache->Line[victim].Stamp)
+        {
+            victim = i;
+        }
+    }
+
+    line = &Cache->Line[victim];
+    if (line->Valid && line->Dirty)
+    {
+        if (Cache->Write(QL_FF_CACHE_DATA(Cache, victim), line->Sector, 1) != 0)
+        {
+            return -1;
+        }
+        Cache->Stats.Write_Backs++;
+    }
+
+    line->Sector = sector;
+    line->Valid  = 1;
+    line->Dirty  = 0;
+    line->Stamp  = ++Cache->Clock;
+
+    return victim;
+}
+
+/*****************************************************************************
+* @brief  Allocate the cache of a drive
+* ex:
+* @par
+* KB of sector lines from the heap, kept over a remount. A second call drops
+* the content without writing it, the card may have been changed.
+* @retval 0: cache on, -1: no memory, the drive runs uncached
+*****************************************************************************/
+int32_t Ql_FatFs_Cache_Init(Ql_FatFs_Cache_TypeDef *Cache, uint32_t KB, Ql_FatFs_Cache_Read_TypeDef Read,
+                            Ql_FatFs_Cache_Write_TypeDef Write, uint32_t Sectors)
+{
+    uint32_t lines = KB * 1024U / FF_MAX_SS;
+
+    Cache->Read     = Read;
+    Cache->Write    = Write;
+    Cache->Sectors  = Sectors;
+    Cache->Meta_End = 0;
+    Cache->Seq_Next = 0;
+
+    if ((Cache->Data == NULL) && (lines > 0))
+    {
+        Cache->Line  = pvPortMalloc(lines * sizeof(Ql_FatFs_Cache_Line_TypeDef));
+        Cache->Data  = pvPortMalloc(lines * FF_MAX_SS);
+        Cache->Burst = pvPortMalloc(QL_FF_CACHE_READ_AHEAD * FF_MAX_SS);
+        if ((Cache->Line == NULL) || (Cache->Data == NULL) || (Cache->Burst == NULL))
+        {
+            vPortFree(Cache->Line);
+            vPortFree(Cache->Data);
+            vPortFree(Cache->Burst);
+            Cache->Line  = NULL;
+            Cache->Data  = NULL;
+            Cache->Burst = NULL;
+            Cache->Lines = 0;
+            Cache->Enable = 0;
+            QL_LOG_W("no memory for %u KB, uncached", KB);
+            return -1;
+        }
+        Cache->Lines  = lines;
+        Cache->Enable = 1;
+    }
+
+    if (Cache->Lines > 0)
+    {
+        memset(Cache->Line, 0, Cache->Lines * sizeof(Ql_FatFs_Cache_Line_TypeDef));
+    }
+    Cache->Clock = 0;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return (Cache->Lines > 0) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  Set the end of the metadata area, FATFS.database after mount
+* ex:
+* @par
+* Single sector writes below End are written back on CTRL_SYNC. 0 writes
+* everything through, used before mount and for f_mkfs.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Cache_Meta(Ql_FatFs_Cache_TypeDef *Cache, uint32_t End)
+{
+    Cache->Meta_End = End;
+}
+
+int Ql_FatFs_Cache_Read(Ql_FatFs_Cache_TypeDef *Cache, uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t ahead = 1;
+    uint32_t us;
+    int32_t idx;
+
+    if (!Cache->Enable)
+    {
+        return Cache->Read(buff, sector, count);
+    }
+
+    if (count > 1)
+    {
+        Cache->Stats.Bypass++;
+        if (Cache->Read(buff, sector, count) != 0)
+        {
+            return 1;
+        }
+
+        /* A dirty copy is newer than the card */
+        for (uint32_t i = 0; i < Cache->Lines; i++)
+        {
+            const Ql_FatFs_Cache_Line_TypeDef *line = &Cache->Line[i];
+
+            if (line->Valid && line->Dirty && (line->Sector >= sector) && (line->Sector - sector < count))
+            {
+                memcpy(buff + (line->Sector - sector) * FF_MAX_SS, QL_FF_CACHE_DATA(Cache, i), FF_MAX_SS);
+            }
+        }
+        return 0;
+    }
+
+    Cache->Stats.Reads++;
+
+    idx = Ql_FatFs_Cache_Find(Cache, sector);
+    if (idx >= 0)
+    {
+        Cache->Line[idx].Stamp = ++Cache->Clock;
+        memcpy(buff, QL_FF_CACHE_DATA(Cache, idx), FF_MAX_SS);
+        Cache->Stats.Hits++;
+        Cache->Stats.Hit_Us += (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+        return 0;
+    }
+
+    /* Read ahead up to the next sector already cached, it may be dirty */
+    if (sector == Cache->Seq_Next)
+    {
+        while ((ahead < QL_FF_CACHE_READ_AHEAD) && (ahead < Cache->Lines / 2) && (sector + ahead < Cache->Sectors) &&
+               (Ql_FatFs_Cache_Find(Cache, sector + ahead) < 0))
+        {
+            ahead++;
+        }
+    }
+
+    if (Cache->Read((ahead > 1) ? Cache->Burst : buff, sector, ahead) != 0)
+    {
+        return 1;
+    }
+    if (ahead > 1)
+    {
+        memcpy(buff, Cache->Burst, FF_MAX_SS);
+        Cache->Stats.Read_Ahead += ahead - 1;
+    }
+
+    for (uint32_t i = 0; i < ahead; i++)
+    {
+        idx = Ql_FatFs_Cache_Alloc(Cache, sector + i);
+        if (idx < 0)
+        {
+            return 1;
+        }
+        memcpy(QL_FF_CACHE_DATA(Cache, idx), (ahead > 1) ? &Cache->Burst[i * FF_MAX_SS] : buff, FF_MAX_SS);
+    }
+    Cache->Seq_Next = sector + ahead;
+
+    us = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+    Cache->Stats.Miss_Us += us;
+    Cache->Stats.Miss_Max_Us = (us > Cache->Stats.Miss_Max_Us) ? us : Cache->Stats.Miss_Max_Us;
+
+    return 0;
+}
+
+int Ql_FatFs_Cache_Write(Ql_FatFs_Cache_TypeDef *Cache, const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    int32_t idx;
+    int result;
+
+    if (!Cache->Enable)
+    {
+        return Cache->Write(buff, sector, count);
+    }
+
+    Cache->Stats.Writes++;
+
+    if ((count == 1) && (sector < Cache->Meta_End))
+    {
+        idx = Ql_FatFs_Cache_Find(Cache, sector);
+        if (idx < 0)
+        {
+            idx = Ql_FatFs_Cache_Alloc(Cache, sector);
+        }
+        if (idx >= 0)
+        {
+            memcpy(QL_FF_CACHE_DATA(Cache, idx), buff, FF_MAX_SS);
+            Cache->Line[idx].Dirty = 1;
+            Cache->Line[idx].Stamp = ++Cache->Clock;
+            Cache->Stats.Deferred++;
+            return 0;
+        }
+    }
+
+    result = Cache->Write(buff, sector, count);
+
+    /* Cached copies take the new data, or are dropped when the write failed */
+    for (uint32_t i = 0; i < Cache->Lines; i++)
+    {
+        Ql_FatFs_Cache_Line_TypeDef *line = &Cache->Line[i];
+
+        if (line->Valid && (line->Sector >= sector) && (line->Sector - sector < count))
+        {
+            if (result == 0)
+            {
+                memcpy(QL_FF_CACHE_DATA(Cache, i), buff + (line->Sector - sector) * FF_MAX_SS, FF_MAX_SS);
+                line->Dirty = 0;
+            }
+            else
+            {
+                line->Valid = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*****************************************************************************
+* @brief  Write every dirty sector, lowest first
+* ex:
+* @par
+* Runs of consecutive dirty sectors go out in one transfer of up to
+* QL_FF_CACHE_READ_AHEAD sectors. Called on CTRL_SYNC.
+* @retval 0: clean, 1: write error, the failed lines stay dirty
+*****************************************************************************/
+int Ql_FatFs_Cache_Flush(Ql_FatFs_Cache_TypeDef *Cache)
+{
+    int32_t run[QL_FF_CACHE_READ_AHEAD];
+    uint32_t n;
+    int32_t first;
+
+    while (1)
+    {
+        first = -1;
+        for (uint32_t i = 0; i < Cache->Lines; i++)
+        {
+            if (Cache->Line[i].Valid && Cache->Line[i].Dirty &&
+                ((first < 0) || (Cache->Line[i].Sector < Cache->Line[first].Sector)))
+            {
+                first = i;
+            }
+        }
+        if (first < 0)
+        {
+            return 0;
+        }
+
+        run[0] = first;
+        for (n = 1; n < QL_FF_CACHE_READ_AHEAD; n++)
+        {
+            run[n] = Ql_FatFs_Cache_Find(Cache, Cache->Line[first].Sector + n);
+            if ((run[n] < 0) || !Cache->Line[run[n]].Dirty)
+            {
+                break;
+            }
+        }
+
+        if (n == 1)
+        {
+            if (Cache->Write(QL_FF_CACHE_DATA(Cache, first), Cache->Line[first].Sector, 1) != 0)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                memcpy(&Cache->Burst[i * FF_MAX_SS], QL_FF_CACHE_DATA(Cache, run[i]), FF_MAX_SS);
+            }
+            if (Cache->Write(Cache->Burst, Cache->Line[first].Sector, n) != 0)
+            {
+                return 1;
+            }
+        }
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            Cache->Line[run[i]].Dirty = 0;
+        }
+        Cache->Stats.Write_Backs += n;
+    }
+}
+
+/*****************************************************************************
+* @brief  Switch the cache on or off
+* ex:
+* @par
+* Off writes the dirty sectors and drops the content. Call with the volume
+* lock of FatFs held when the volume is mounted.
+* @retval 0: done, 1: flush failed, the cache stays on
+*****************************************************************************/
+int Ql_FatFs_Cache_Enable(Ql_FatFs_Cache_TypeDef *Cache, uint8_t On)
+{
+    if (Cache->Lines == 0)
+    {
+        return On ? 1 : 0;
+    }
+
+    if (!On && Cache->Enable)
+    {
+        if (Ql_FatFs_Cache_Flush(Cache) != 0)
+        {
+            return 1;
+        }
+        memset(Cache->Line, 0, Cache->Lines * sizeof(Ql_FatFs_Cache_Line_TypeDef));
+    }
+    Cache->Enable = On;
+
+    return 0;
+}
+
+void Ql_FatFs_Cache_Stats(Ql_FatFs_Cache_TypeDef *Cache, Ql_FatFs_Cache_Stats_TypeDef *Stats, uint8_t Reset)
+{
+    if (Stats != NULL)
+    {
+        *Stats = Cache->Stats;
+    }
+    if (Reset)
+    {
+        memset(&Cache->Stats, 0, sizeof(Cache->Stats));
+    }
+}
+
+/*****************************************************************************
+* @brief  f_open, append and f_findfirst with and without the SD cache
+* ex:
+* @par
+* Creates Files files in Dir, then per pass times opening each of them,
+* appending one RMC sentence to each and a folder scan with f_findfirst/f_findnext.
+* The first pass runs uncached, the second cached. Dir is removed afterwards.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Cache_Bench(const char *Dir, uint32_t Files)
+{
+    static const char *name[3] = { "f_open", "append", "f_findfirst" };
+    static FIL fp;
+    static DIR dir;
+    static FILINFO fno;
+    static const char line[] = "$GNRMC,000000.00,V,,,,,,,010100,,,N,V*00\r\n";
+    Ql_FatFs_Cache_Stats_TypeDef stats[2];
+    const uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    uint32_t us[2][3] = { 0 };
+    char path[48];
+    uint32_t start;
+    UINT bw;
+
+    if ((qlfs == NULL) || (Files == 0) || (Ql_FatFs_Sd_Cache.Lines == 0))
+    {
+        return;
+    }
+
+    f_mkdir(Dir);
+    for (uint32_t i = 0; i < Files; i++)
+    {
+        snprintf(path, sizeof(path), "%s/c%05u.txt", Dir, i);
+        if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK)
+        {
+            f_close(&fp);
+        }
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint8_t m = 0; m < 2; m++)
+    {
+        if (ff_mutex_take(qlfs->ldrv))
+        {
+            Ql_FatFs_Cache_Enable(&Ql_FatFs_Sd_Cache, m);
+            Ql_FatFs_Cache_Stats(&Ql_FatFs_Sd_Cache, NULL, 1);
+            ff_mutex_give(qlfs->ldrv);
+        }
+
+        start = DWT->CYCCNT;
+        for (uint32_t i = 0; i < Files; i++)
+        {
+            snprintf(path, sizeof(path), "%s/c%05u.txt", Dir, i);
+            if (f_open(&fp, path, FA_READ) == FR_OK)
+            {
+                f_close(&fp);
+            }
+        }
+        us[m][0] = (DWT->CYCCNT - start) / cycles_per_us;
+
+        start = DWT->CYCCNT;
+        for (uint32_t i = 0; i < Files; i++)
+        {
+            snprintf(path, sizeof(path), "%s/c%05u.txt", Dir, i);
+            if (f_open(&fp, path, FA_OPEN_APPEND | FA_WRITE) == FR_OK)
+            {
+                f_write(&fp, line, sizeof(line) - 1, &bw);
+                f_close(&fp);
+            }
+        }
+        us[m][1] = (DWT->CYCCNT - start) / cycles_per_us;
+
+        start = DWT->CYCCNT;
+        for (FRESULT res = f_findfirst(&dir, &fno, Dir, "*.txt"); (res == FR_OK) && fno.fname[0]; res = f_findnext(&dir, &fno))
+        {
+        }
+        f_closedir(&dir);
+        us[m][2] = (DWT->CYCCNT - start) / cycles_per_us;
+
+        Ql_FatFs_Cache_Stats(&Ql_FatFs_Sd_Cache, &stats[m], 0);
+    }
+
+    for (uint32_t i = 0; i < Files; i++)
+    {
+        snprintf(path, sizeof(path), "%s/c%05u.txt", Dir, i);
+        f_unlink(path);
+    }
+    f_unlink(Dir);
+
+    for (uint8_t k = 0; k < 3; k++)
+    {
+        QL_LOG_I("%s: %u files, %u us uncached, %u us cached", name[k], Files, us[0][k], us[1][k]);
+    }
+    QL_LOG_I("cache %u KB: %u reads, %u hits, %u ahead, %u deferred, %u written back",
+             Ql_FatFs_Sd_Cache.Lines * FF_MAX_SS / 1024, stats[1].Reads, stats[1].Hits, stats[1].Read_Ahead,
+             stats[1].Deferred, stats[1].Write_Backs);
+    QL_LOG_I("hit avg %u us, miss avg %u us max %u us",
+             stats[1].Hits ? stats[1].Hit_Us / stats[1].Hits : 0,
+             (stats[1].Reads > stats[1].Hits) ? stats[1].Miss_Us / (stats[1].Reads - stats[1].Hits) : 0,
+             stats[1].Miss_Max_Us);
+}
@@ -0,0 +1,91 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_cache.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef _QL_FF_CACHE_H__
+#define _QL_FF_CACHE_H__
+
+#include "ql_ff_user.h"
+
+/* LRU sector cache between FatFs and the card driver, used by diskio.c.
+   Single sector reads are cached, a miss right after the previous one reads
+   QL_FF_CACHE_READ_AHEAD sectors in one transfer. Single sector writes below
+   the metadata end (boot, FSINFO, FAT, FAT12/16 root folder) stay dirty in
+   the cache until CTRL_SYNC or eviction, all others are written through.
+   Multi sector transfers go to the card and keep cached copies coherent. */
+#define QL_FF_CACHE_KB              (16U)       // cache of the SD card, 0: none
+#define QL_FF_CACHE_READ_AHEAD      (4U)        // sectors, also the flush burst
+
+/* Backend, 0: done, as MMC_disk_read/MMC_disk_write */
+typedef int (*Ql_FatFs_Cache_Read_TypeDef)(uint8_t *buff, uint32_t sector, uint32_t count);
+typedef int (*Ql_FatFs_Cache_Write_TypeDef)(const uint8_t *buff, uint32_t sector, uint32_t count);
+
+typedef struct
+{
+    uint32_t    Sector;
+    uint32_t    Stamp;      // last use, the smallest is evicted
+    uint8_t     Valid;
+    uint8_t     Dirty;
+} Ql_FatFs_Cache_Line_TypeDef;
+
+typedef struct
+{
+    uint32_t    Reads;          // single sector reads
+    uint32_t    Hits;
+    uint32_t    Read_Ahead;     // sectors fetched ahead of a sequential miss
+    uint32_t    Bypass;         // multi sector transfers
+    uint32_t    Writes;
+    uint32_t    Deferred;       // metadata writes kept dirty
+    uint32_t    Write_Backs;    // dirty sectors written on flush or eviction
+    uint32_t    Hit_Us;         // summed read latency
+    uint32_t    Miss_Us;
+    uint32_t    Miss_Max_Us;
+} Ql_FatFs_Cache_Stats_TypeDef;
+
+typedef struct
+{
+    Ql_FatFs_Cache_Line_TypeDef *Line;
+    uint8_t                     *Data;          // Lines * FF_MAX_SS
+    uint8_t                     *Burst;         // QL_FF_CACHE_READ_AHEAD * FF_MAX_SS
+    uint32_t                     Lines;
+    uint32_t                     Clock;
+    uint32_t                     Seq_Next;      // a miss here is sequential
+    uint32_t                     Meta_End;      // 0: write through only
+    uint32_t                     Sectors;       // device size
+    uint8_t                      Enable;
+    Ql_FatFs_Cache_Read_TypeDef  Read;
+    Ql_FatFs_Cache_Write_TypeDef Write;
+    Ql_FatFs_Cache_Stats_TypeDef Stats;
+} Ql_FatFs_Cache_TypeDef;
+
+extern Ql_FatFs_Cache_TypeDef Ql_FatFs_Sd_Cache;
+
+int32_t Ql_FatFs_Cache_Init(Ql_FatFs_Cache_TypeDef *Cache, uint32_t KB, Ql_FatFs_Cache_Read_TypeDef Read,
+                            Ql_FatFs_Cache_Write_TypeDef Write, uint32_t Sectors);
+void    Ql_FatFs_Cache_Meta(Ql_FatFs_Cache_TypeDef *Cache, uint32_t End);
+int     Ql_FatFs_Cache_Read(Ql_FatFs_Cache_TypeDef *Cache, uint8_t *buff, uint32_t sector, uint32_t count);
+int     Ql_FatFs_Cache_Write(Ql_FatFs_Cache_TypeDef *Cache, const uint8_t *buff, uint32_t sector, uint32_t count);
+int     Ql_FatFs_Cache_Flush(Ql_FatFs_Cache_TypeDef *Cache);
+int     Ql_FatFs_Cache_Enable(Ql_FatFs_Cache_TypeDef *Cache, uint8_t On);
+void    Ql_FatFs_Cache_Stats(Ql_FatFs_Cache_TypeDef *Cache, Ql_FatFs_Cache_Stats_TypeDef *Stats, uint8_t Reset);
+void    Ql_FatFs_Cache_Bench(const char *Dir, uint32_t Files);
+
+#endif
@@ -0,0 +1,326 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_disk.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* The host port's vTaskDelay runs on the virtual clock, an injected stall
+   blocks the caller there as it does on the target */
+#define QL_DISK_DELAY_MS(ms)        vTaskDelay(pdMS_TO_TICKS(ms))
+#if defined(QL_DISK_HOST)
+#include <stdlib.h>
+#define QL_DISK_MALLOC(n)           malloc(n)
+#define QL_DISK_FREE(p)             free(p)
+#else
+#define QL_DISK_MALLOC(n)           pvPortMalloc(n)
+#define QL_DISK_FREE(p)             vPortFree(p)
+#endif
+
+#include "ff.h"
+#include "ql_ff_disk.h"
+
+#define LOG_TAG "ql_ff_disk"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+static uint8_t *Ram_Disk = NULL;
+static FATFS *Ram_Fs = NULL;
+static Ql_FatFs_Disk_Fault_TypeDef Disk_Fault[QL_FF_DISK_DRIVES];
+
+/*****************************************************************************
+* @brief  RAM disk, QL_RAM_DISK_KB allocated on the first initialize
+* ex:
+* @par
+* The content stays over a remount, it is only freed by Ql_FatFs_Ram_UnMount.
+* @retval 0: ready, 1: no memory
+*****************************************************************************/
+int RAM_disk_initialize(void)
+{
+    if ((Ram_Disk == NULL) && (QL_RAM_DISK_KB > 0))
+    {
+        Ram_Disk = QL_DISK_MALLOC(QL_RAM_DISK_KB * 1024U);
+    }
+
+    return (Ram_Disk != NULL) ? 0 : 1;
+}
+
+int RAM_disk_status(void)
+{
+    return (Ram_Disk != NULL) ? 0 : 1;
+}
+
+int RAM_disk_read(uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    if ((Ram_Disk == NULL) || (sector + count > RAM_sector_count()))
+    {
+        return 1;
+    }
+
+    memcpy(buff, &Ram_Disk[sector * FF_MAX_SS], count * FF_MAX_SS);
+    return 0;
+}
+
+int RAM_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    if ((Ram_Disk == NULL) || (sector + count > RAM_sector_count()))
+    {
+        return 1;
+    }
+
+    memcpy(&Ram_Disk[sector * FF_MAX_SS], buff, count * FF_MAX_SS);
+    return 0;
+}
+
+uint32_t RAM_sector_count(void)
+{
+    return QL_RAM_DISK_KB * 1024U / FF_MAX_SS;
+}
+
+/*****************************************************************************
+* @brief  Format and mount the RAM disk as "0:"
+* ex:
+* @par
+* A FAT12/16 volume without partition table, made on every mount.
+* @retval 0: mounted, -1: no memory or format failed
+*****************************************************************************/
+int32_t Ql_FatFs_Ram_Mount(void)
+{
+    const MKFS_PARM opt = { FM_FAT | FM_SFD, 1, 0, 0, 0 };
+    BYTE *work;
+    FRESULT Res;
+
+    if (Ram_Fs != NULL)
+    {
+        return 0;
+    }
+
+    Ram_Fs = QL_DISK_MALLOC(sizeof(FATFS));
+    work = QL_DISK_MALLOC(FF_MAX_SS);
+    if ((Ram_Fs == NULL) || (work == NULL))
+    {
+        QL_DISK_FREE(work);
+        QL_DISK_FREE(Ram_Fs);
+        Ram_Fs = NULL;
+        return -1;
+    }
+
+    Res = f_mkfs(QL_RAM_DISK_PATH, &opt, work, FF_MAX_SS);
+    QL_DISK_FREE(work);
+    if (Res == FR_OK)
+    {
+        Res = f_mount(Ram_Fs, QL_RAM_DISK_PATH, 1);
+    }
+
+    if (Res != FR_OK)
+    {
+        QL_LOG_E("ram disk fail, %d", Res);
+        QL_DISK_FREE(Ram_Fs);
+        Ram_Fs = NULL;
+        return -1;
+    }
+
+    QL_LOG_I("ram disk %u KB", QL_RAM_DISK_KB);
+    return 0;
+}
+
+int32_t Ql_FatFs_Ram_UnMount(void)
+{
+    if (Ram_Fs == NULL)
+    {
+        return 0;
+    }
+
+    if (f_mount(NULL, QL_RAM_DISK_PATH, 0) != FR_OK)
+    {
+        return -1;
+    }
+
+    QL_DISK_FREE(Ram_Fs);
+    QL_DISK_FREE(Ram_Disk);
+    Ram_Fs = NULL;
+    Ram_Disk = NULL;
+
+    return 0;
+}
+
+#if defined(QL_DISK_HOST)
+static FILE *Img_File = NULL;
+static uint32_t Img_Sectors = 0;
+
+/*****************************************************************************
+* @brief  Open a disk image file for the SD card slot of a host build
+* ex:
+* @par
+* A missing file is created with sectors sectors, an existing one keeps its
+* size when sectors is 0. Format it with f_mkfs("1:") or copy a card dump.
+* @retval 0: open, 1: failed
+*****************************************************************************/
+int IMG_disk_open(const char *path, uint32_t sectors)
+{
+    long size;
+
+    IMG_disk_close();
+
+    Img_File = fopen(path, "r+b");
+    if (Img_File == NULL)
+    {
+        Img_File = fopen(path, "w+b");
+    }
+    if (Img_File == NULL)
+    {
+        return 1;
+    }
+
+    fseek(Img_File, 0, SEEK_END);
+    size = ftell(Img_File);
+    if ((sectors > 0) && ((uint32_t)(size / FF_MAX_SS) < sectors))
+    {
+        fseek(Img_File, (long)sectors * FF_MAX_SS - 1, SEEK_SET);
+        fputc(0, Img_File);
+        size = (long)sectors * FF_MAX_SS;
+    }
+    Img_Sectors = (uint32_t)(size / FF_MAX_SS);
+
+    return (Img_Sectors > 0) ? 0 : 1;
+}
+
+void IMG_disk_close(void)
+{
+    if (Img_File != NULL)
+    {
+        fclose(Img_File);
+        Img_File = NULL;
+    }
+    Img_Sectors = 0;
+}
+
+int IMG_disk_status(void)
+{
+    return (Img_File != NULL) ? 0 : 1;
+}
+
+int IMG_disk_read(uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    if ((Img_File == NULL) || (sector + count > Img_Sectors) ||
+        (fseek(Img_File, (long)sector * FF_MAX_SS, SEEK_SET) != 0))
+    {
+        return 1;
+    }
+
+    return (fread(buff, FF_MAX_SS, count, Img_File) == count) ? 0 : 1;
+}
+
+int IMG_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    if ((Img_File == NULL) || (sector + count > Img_Sectors) ||
+        (fseek(Img_File, (long)sector * FF_MAX_SS, SEEK_SET) != 0))
+    {
+        return 1;
+    }
+
+    return (fwrite(buff, FF_MAX_SS, count, Img_File) == count) ? 0 : 1;
+}
+
+int IMG_disk_sync(void)
+{
+    return (Img_File != NULL) && (fflush(Img_File) == 0) ? 0 : 1;
+}
+
+uint32_t IMG_sector_count(void)
+{
+    return Img_Sectors;
+}
+#endif
+
+/*****************************************************************************
+* @brief  Set the fault injection of a drive, NULL clears it
+* ex:
+* @par
+* Fail_After counts the transfers from this call on. Clearing also puts a
+* removed disk back, FatFs mounts it again on the next access.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Disk_Fault_Set(uint8_t pdrv, const Ql_FatFs_Disk_Fault_TypeDef *Fault)
+{
+    if (pdrv >= QL_FF_DISK_DRIVES)
+    {
+        return;
+    }
+
+    if (Fault != NULL)
+    {
+        Disk_Fault[pdrv] = *Fault;
+    }
+    else
+    {
+        memset(&Disk_Fault[pdrv], 0, sizeof(Disk_Fault[pdrv]));
+    }
+}
+
+/*****************************************************************************
+* @brief  Apply the fault injection to one transfer
+* ex:
+* @par
+* Called by the backends in diskio.c before each transfer, waits the set
+* latency first.
+* @retval 0: go on, 1: the transfer fails
+*****************************************************************************/
+int Ql_FatFs_Disk_Fault(uint8_t pdrv, uint8_t Write)
+{
+    Ql_FatFs_Disk_Fault_TypeDef *fault;
+    uint32_t delay;
+
+    if (pdrv >= QL_FF_DISK_DRIVES)
+    {
+        return 0;
+    }
+
+    fault = &Disk_Fault[pdrv];
+    if (fault->Removed)
+    {
+        return 1;
+    }
+
+    delay = Write ? fault->Write_Delay_Ms : fault->Read_Delay_Ms;
+    if (delay > 0)
+    {
+        QL_DISK_DELAY_MS(delay);
+    }
+
+    if ((fault->Fail_After > 0) && (--fault->Fail_After == 0))
+    {
+        fault->Removed = fault->Remove_On_Fail;
+        QL_LOG_W("drive %u: injected %s failure%s", pdrv, Write ? "write" : "read",
+                 fault->Removed ? ", removed" : "");
+        return 1;
+    }
+
+    return 0;
+}
+
+uint8_t Ql_FatFs_Disk_Removed(uint8_t pdrv)
+{
+    return (pdrv < QL_FF_DISK_DRIVES) ? Disk_Fault[pdrv].Removed : 0;
+}
@@ -0,0 +1,73 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_disk.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef _QL_FF_DISK_H__
+#define _QL_FF_DISK_H__
+
+#include <stdint.h>
+
+/* Disk backends besides the SD card, called from diskio.c:
+   - RAM disk on drive "0:" (DEV_RAM), QL_RAM_DISK_KB from the heap, for hot
+     data staged before it goes to the card. Lost on reset.
+   - File image, only built with QL_DISK_HOST: on a Linux build the image
+     takes the SD card slot (DEV_MMC, "1:"), the code above diskio.c runs
+     unchanged.
+   Fault injection adds latency to, or fails, the transfers of a drive below
+   the sector cache, to test card stalls and removal. */
+#define QL_RAM_DISK_KB              (64U)       // 0: no RAM disk, at least 64 for f_mkfs
+#define QL_RAM_DISK_PATH            "0:"
+
+#define QL_FF_DISK_DRIVES           (3U)        // DEV_RAM, DEV_MMC, DEV_USB
+
+typedef struct
+{
+    uint32_t    Read_Delay_Ms;      // added to every read transfer
+    uint32_t    Write_Delay_Ms;
+    uint32_t    Fail_After;         // transfers until one fails, 0: never
+    uint8_t     Remove_On_Fail;     // the failing transfer also removes the disk
+    uint8_t     Removed;            // disk_status reports STA_NODISK
+} Ql_FatFs_Disk_Fault_TypeDef;
+
+int      RAM_disk_status(void);
+int      RAM_disk_initialize(void);
+int      RAM_disk_read(uint8_t *buff, uint32_t sector, uint32_t count);
+int      RAM_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count);
+uint32_t RAM_sector_count(void);
+
+int32_t  Ql_FatFs_Ram_Mount(void);
+int32_t  Ql_FatFs_Ram_UnMount(void);
+
+#if defined(QL_DISK_HOST)
+int      IMG_disk_open(const char *path, uint32_t sectors);
+void     IMG_disk_close(void);
+int      IMG_disk_status(void);
+int      IMG_disk_read(uint8_t *buff, uint32_t sector, uint32_t count);
+int      IMG_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count);
+int      IMG_disk_sync(void);
+uint32_t IMG_sector_count(void);
+#endif
+
+void     Ql_FatFs_Disk_Fault_Set(uint8_t pdrv, const Ql_FatFs_Disk_Fault_TypeDef *Fault);
+int      Ql_FatFs_Disk_Fault(uint8_t pdrv, uint8_t Write);
+uint8_t  Ql_FatFs_Disk_Removed(uint8_t pdrv);
+
+#endif
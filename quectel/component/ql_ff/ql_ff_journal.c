@@ -0,0 +1,292 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_journal.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <stddef.h>
+
+#include "ql_ff_journal.h"
+#include "ql_check.h"
+#include "diskio.h"
+
+#define LOG_TAG "ql_ff_journal"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_FF_JOURNAL_CRC_LEN       (offsetof(Ql_FatFs_Journal_Rec_TypeDef, Crc))
+
+typedef struct
+{
+    uint32_t    Seq;
+    uint8_t     Used;
+    char        Path[QL_FF_JOURNAL_PATH_MAX];
+} Ql_FatFs_Journal_Slot_TypeDef;
+
+extern FATFS *qlfs;
+
+static Ql_FatFs_Journal_Slot_TypeDef Journal_Slot[QL_FF_JOURNAL_SLOTS];
+static LBA_t Journal_Sect = 0;                  // first sector, 0: no journal
+static uint32_t Journal_Buf[FF_MAX_SS / 4];     // word aligned for the SDIO DMA, used under the volume lock
+
+/*****************************************************************************
+* @brief  Sector IO on the journal file, Sect relative to its start
+* ex:
+* @par
+* Holds the volume lock of FatFs. A write is followed by CTRL_SYNC, it only
+* counts once the card has programmed it.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_FatFs_Journal_IO(uint32_t Sect, uint8_t Write)
+{
+    DRESULT res;
+
+    if (!ff_mutex_take(qlfs->ldrv))
+    {
+        return -1;
+    }
+
+    if (Write)
+    {
+        res = disk_write(qlfs->pdrv, (const BYTE *)Journal_Buf, Journal_Sect + Sect, 1);
+        if (res == RES_OK)
+        {
+            res = disk_ioctl(qlfs->pdrv, CTRL_SYNC, NULL);
+        }
+    }
+    else
+    {
+        res = disk_read(qlfs->pdrv, (BYTE *)Journal_Buf, Journal_Sect + Sect, 1);
+    }
+
+    ff_mutex_give(qlfs->ldrv);
+
+    return (res == RES_OK) ? 0 : -1;
+}
+
+static int32_t Ql_FatFs_Journal_Put(uint32_t Slot, uint32_t State, uint32_t Sclust, uint32_t Size)
+{
+    Ql_FatFs_Journal_Rec_TypeDef *rec = (Ql_FatFs_Journal_Rec_TypeDef *)Journal_Buf;
+    Ql_FatFs_Journal_Slot_TypeDef *slot = &Journal_Slot[Slot];
+
+    memset(Journal_Buf, 0, sizeof(Journal_Buf));
+    rec->Magic  = QL_FF_JOURNAL_MAGIC;
+    rec->Seq    = ++slot->Seq;
+    rec->State  = State;
+    rec->Sclust = Sclust;
+    rec->Size   = Size;
+    memcpy(rec->Path, slot->Path, sizeof(rec->Path));
+    rec->Crc    = Ql_Check_CRC32(0, (const unsigned char *)rec, QL_FF_JOURNAL_CRC_LEN);
+
+    /* The other sector of the slot keeps the previous record */
+    return Ql_FatFs_Journal_IO(Slot * 2 + (rec->Seq & 1), 1);
+}
+
+/*****************************************************************************
+* @brief  Give a file its committed size back
+* ex:
+* @par
+* f_lseek past the end in write mode follows the chain allocated before the
+* commit and sets the size; the data in the clusters is not touched.
+* @retval
+*****************************************************************************/
+static void Ql_FatFs_Journal_Repair(const Ql_FatFs_Journal_Rec_TypeDef *Rec)
+{
+    static FIL fp;
+    FSIZE_t size;
+
+    if (f_open(&fp, Rec->Path, FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
+    {
+        QL_LOG_W("replay: %s gone", Rec->Path);
+        return;
+    }
+
+    size = f_size(&fp);
+    if (fp.obj.sclust != Rec->Sclust)
+    {
+        QL_LOG_W("replay: %s replaced", Rec->Path);
+    }
+    else if (size < Rec->Size)
+    {
+        if ((f_lseek(&fp, Rec->Size) == FR_OK) && (f_tell(&fp) == Rec->Size))
+        {
+            QL_LOG_I("replay: %s %u -> %u bytes", Rec->Path, (uint32_t)size, Rec->Size);
+        }
+        else
+        {
+            QL_LOG_E("replay: %s, size %u not reached", Rec->Path, Rec->Size);
+        }
+    }
+
+    f_close(&fp);
+}
+
+/*****************************************************************************
+* @brief  Open the journal after mount and replay the open slots
+* ex:
+* @par
+* The journal file is created contiguous and zeroed when it is missing or
+* has the wrong size. Without it streams run unjournaled.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Journal_Init(void)
+{
+    static FIL fp;
+    static Ql_FatFs_Journal_Rec_TypeDef cur;
+    const Ql_FatFs_Journal_Rec_TypeDef *rec = (const Ql_FatFs_Journal_Rec_TypeDef *)Journal_Buf;
+    const uint32_t size = QL_FF_JOURNAL_SLOTS * 2 * FF_MAX_SS;
+    uint8_t fresh = 0;
+    FRESULT Res;
+
+    memset(Journal_Slot, 0, sizeof(Journal_Slot));
+    Journal_Sect = 0;
+
+    if (qlfs == NULL)
+    {
+        return -1;
+    }
+
+    Res = f_open(&fp, QL_FF_JOURNAL_PATH, FA_OPEN_ALWAYS | FA_WRITE);
+    if ((Res == FR_OK) && (f_size(&fp) != size))
+    {
+        f_truncate(&fp);
+        Res = f_expand(&fp, size, 1);
+        fresh = 1;
+    }
+    if (Res == FR_OK)
+    {
+        Journal_Sect = qlfs->database + (LBA_t)(fp.obj.sclust - 2) * qlfs->csize;
+    }
+    f_close(&fp);
+
+    if (Res != FR_OK)
+    {
+        QL_LOG_E("journal fail, %d", Res);
+        Journal_Sect = 0;
+        return -1;
+    }
+
+    /* Old records left in the clusters of a new file must not replay */
+    memset(Journal_Buf, 0, sizeof(Journal_Buf));
+    for (uint32_t i = 0; fresh && (i < QL_FF_JOURNAL_SLOTS * 2); i++)
+    {
+        if (Ql_FatFs_Journal_IO(i, 1) != 0)
+        {
+            Journal_Sect = 0;
+            return -1;
+        }
+    }
+
+    for (uint32_t s = 0; (s < QL_FF_JOURNAL_SLOTS) && !fresh; s++)
+    {
+        cur.Magic = 0;
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            if ((Ql_FatFs_Journal_IO(s * 2 + k, 0) == 0) && (rec->Magic == QL_FF_JOURNAL_MAGIC) &&
+                (rec->Crc == Ql_Check_CRC32(0, (const unsigned char *)rec, QL_FF_JOURNAL_CRC_LEN)) &&
+                ((cur.Magic != QL_FF_JOURNAL_MAGIC) || ((int32_t)(rec->Seq - cur.Seq) > 0)))
+            {
+                cur = *rec;
+            }
+        }
+        if (cur.Magic != QL_FF_JOURNAL_MAGIC)
+        {
+            continue;
+        }
+
+        Journal_Slot[s].Seq = cur.Seq;
+        if (cur.State == QL_FF_JOURNAL_OPEN)
+        {
+            cur.Path[QL_FF_JOURNAL_PATH_MAX - 1] = '\0';
+            Ql_FatFs_Journal_Repair(&cur);
+            memcpy(Journal_Slot[s].Path, cur.Path, QL_FF_JOURNAL_PATH_MAX);
+            Ql_FatFs_Journal_Put(s, QL_FF_JOURNAL_CLOSED, 0, 0);
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Take a slot for a stream on path
+* ex:
+* @par
+* Nothing is written before the first commit.
+* @retval slot, -1: no journal or all slots in use
+*****************************************************************************/
+int32_t Ql_FatFs_Journal_Open(const char *path)
+{
+    if ((Journal_Sect == 0) || (path == NULL) || (strlen(path) >= QL_FF_JOURNAL_PATH_MAX))
+    {
+        return -1;
+    }
+
+    for (uint32_t s = 0; s < QL_FF_JOURNAL_SLOTS; s++)
+    {
+        if (!Journal_Slot[s].Used)
+        {
+            Journal_Slot[s].Used = 1;
+            strcpy(Journal_Slot[s].Path, path);
+            return s;
+        }
+    }
+
+    QL_LOG_W("no journal slot. path: %s", path);
+    return -1;
+}
+
+/*****************************************************************************
+* @brief  Record Size bytes of the file as written
+* ex:
+* @par
+* The data and the cluster chain have to be on the card already.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Journal_Commit(int32_t Slot, uint32_t Sclust, uint32_t Size)
+{
+    if ((Journal_Sect == 0) || (Slot < 0) || (Slot >= (int32_t)QL_FF_JOURNAL_SLOTS) || !Journal_Slot[Slot].Used)
+    {
+        return -1;
+    }
+
+    return Ql_FatFs_Journal_Put(Slot, QL_FF_JOURNAL_OPEN, Sclust, Size);
+}
+
+/*****************************************************************************
+* @brief  Release the slot once the file is closed
+* ex:
+* @par
+* None
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Journal_Close(int32_t Slot)
+{
+    int32_t ret;
+
+    if ((Journal_Sect == 0) || (Slot < 0) || (Slot >= (int32_t)QL_FF_JOURNAL_SLOTS) || !Journal_Slot[Slot].Used)
+    {
+        return -1;
+    }
+
+    ret = Ql_FatFs_Journal_Put(Slot, QL_FF_JOURNAL_CLOSED, 0, 0);
+    Journal_Slot[Slot].Used = 0;
+
+    return ret;
+}
@@ -0,0 +1,59 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_journal.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef _QL_FF_JOURNAL_H__
+#define _QL_FF_JOURNAL_H__
+
+#include "ql_ff_user.h"
+
+/* Write ahead journal of contiguous streams. The journal file is a row of
+   QL_FF_JOURNAL_SLOTS slots, two sectors each, written alternately so a torn
+   write leaves the other one. A slot records the path, start cluster and
+   committed size of one open stream; a commit is one sector write instead
+   of the FAT and directory updates of f_sync. Ql_FatFs_Journal_Init()
+   replays the open slots on mount: a file shorter than its committed size
+   gets that size back, the data is already in its preallocated clusters. */
+#define QL_FF_JOURNAL_PATH          "1:ql_jrnl.bin"
+#define QL_FF_JOURNAL_SLOTS         (8U)
+#define QL_FF_JOURNAL_PATH_MAX      (64U)
+#define QL_FF_JOURNAL_MAGIC         (0x4C4E524AU)   // "JRNL"
+
+#define QL_FF_JOURNAL_CLOSED        (0U)
+#define QL_FF_JOURNAL_OPEN          (1U)
+
+typedef struct
+{
+    uint32_t    Magic;
+    uint32_t    Seq;        // the higher of the two sectors of a slot is current
+    uint32_t    State;
+    uint32_t    Sclust;     // start cluster, a replaced file is not touched
+    uint32_t    Size;       // committed bytes
+    char        Path[QL_FF_JOURNAL_PATH_MAX];
+    uint32_t    Crc;        // over the fields above
+} Ql_FatFs_Journal_Rec_TypeDef;
+
+int32_t Ql_FatFs_Journal_Init(void);
+int32_t Ql_FatFs_Journal_Open(const char *path);
+int32_t Ql_FatFs_Journal_Commit(int32_t Slot, uint32_t Sclust, uint32_t Size);
+int32_t Ql_FatFs_Journal_Close(int32_t Slot);
+
+#endif
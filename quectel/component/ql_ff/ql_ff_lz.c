@@ -0,0 +1,345 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_lz.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "gd32f4xx.h"
+#include "ql_ff_lz.h"
+#include "ql_check.h"
+
+#define LOG_TAG "ql_ff_lz"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_FF_LZ_NONE               (0xFFFFU)
+#define QL_FF_LZ_HIST_MAX           (QL_FF_LZ_WINDOW - QL_FF_LZ_BLOCK_SIZE)
+
+static uint32_t Ql_FatFs_Lz_Hash(const uint8_t *p)
+{
+    return ((((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2]) * 2654435761U) >> (32 - QL_FF_LZ_HASH_BITS);
+}
+
+void Ql_FatFs_Lz_Init(Ql_FatFs_Lz_TypeDef *Lz)
+{
+    memset(Lz->Head, 0xFF, sizeof(Lz->Head));
+    Lz->Hist  = 0;
+    Lz->Len   = 0;
+    Lz->Reset = 1;
+    Lz->Raw_Total  = 0;
+    Lz->Comp_Total = 0;
+}
+
+/*****************************************************************************
+* @brief  Compress Buf[Hist, Hist + Len) into Out
+* ex:
+* @par
+* One flag byte per 8 items, bit set: match. A literal is one byte, a
+* match is (Off - 1) in 12 bits and (Len - 3) in 4 bits, 15 adds a byte.
+* One hash slot per bucket, the latest position wins.
+* @retval payload length
+*****************************************************************************/
+static uint32_t Ql_FatFs_Lz_Block(Ql_FatFs_Lz_TypeDef *Lz, uint8_t *Out)
+{
+    const uint8_t *buf = Lz->Buf;
+    const uint32_t end = Lz->Hist + Lz->Len;
+    uint32_t pos = Lz->Hist;
+    uint32_t o = 0;
+    uint32_t cand;
+    uint32_t len;
+    uint32_t max;
+    uint32_t off;
+    uint32_t h;
+    uint8_t *flag = Out;
+    uint8_t bit = 8;
+
+    while (pos < end)
+    {
+        if (bit == 8)
+        {
+            flag  = &Out[o++];
+            *flag = 0;
+            bit   = 0;
+        }
+
+        len = 0;
+        if ((pos + QL_FF_LZ_MIN_MATCH) <= end)
+        {
+            h = Ql_FatFs_Lz_Hash(&buf[pos]);
+            cand = Lz->Head[h];
+            Lz->Head[h] = pos;
+            if (cand != QL_FF_LZ_NONE)
+            {
+                max = end - pos;
+                max = (max > QL_FF_LZ_MAX_MATCH) ? QL_FF_LZ_MAX_MATCH : max;
+                while ((len < max) && (buf[cand + len] == buf[pos + len]))
+                {
+                    len++;
+                }
+            }
+        }
+
+        if (len >= QL_FF_LZ_MIN_MATCH)
+        {
+            *flag |= 1U << bit;
+            off = pos - cand - 1;
+            Out[o++] = off >> 4;
+            if ((len - QL_FF_LZ_MIN_MATCH) < 15)
+            {
+                Out[o++] = ((off & 0x0F) << 4) | (len - QL_FF_LZ_MIN_MATCH);
+            }
+            else
+            {
+                Out[o++] = ((off & 0x0F) << 4) | 0x0F;
+                Out[o++] = len - QL_FF_LZ_MIN_MATCH - 15;
+            }
+
+            /* Later repeats of the NMEA talker and field prefixes start inside matches */
+            for (uint32_t i = 1; (i < len) && ((pos + i + QL_FF_LZ_MIN_MATCH) <= end); i++)
+            {
+                Lz->Head[Ql_FatFs_Lz_Hash(&buf[pos + i])] = pos + i;
+            }
+            pos += len;
+        }
+        else
+        {
+            Out[o++] = buf[pos++];
+        }
+        bit++;
+    }
+
+    return o;
+}
+
+/*****************************************************************************
+* @brief  Frame the filled block, pass it to Out and slide the window
+* ex:
+* @par
+* A block that does not shrink is stored. After a failed Out the history
+* no longer matches the file, the encoder starts over with a reset block.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_FatFs_Lz_Emit(Ql_FatFs_Lz_TypeDef *Lz, Ql_FatFs_Lz_Out_TypeDef Out, void *Ctx)
+{
+    uint8_t *hdr = Lz->Out;
+    uint32_t comp;
+    uint32_t crc;
+    uint32_t total;
+    uint32_t shift;
+    uint8_t flags = Lz->Reset ? QL_FF_LZ_FLAG_RESET : 0;
+
+    comp = Ql_FatFs_Lz_Block(Lz, &hdr[QL_FF_LZ_HDR_SIZE]);
+    if (comp >= Lz->Len)
+    {
+        memcpy(&hdr[QL_FF_LZ_HDR_SIZE], &Lz->Buf[Lz->Hist], Lz->Len);
+        comp   = Lz->Len;
+        flags |= QL_FF_LZ_FLAG_STORED;
+    }
+
+    crc = Ql_Check_CRC32(0, &Lz->Buf[Lz->Hist], Lz->Len);
+    hdr[0]  = 'Q';
+    hdr[1]  = 'Z';
+    hdr[2]  = flags;
+    hdr[3]  = 0;
+    hdr[4]  = Lz->Len & 0xFF;
+    hdr[5]  = Lz->Len >> 8;
+    hdr[6]  = comp & 0xFF;
+    hdr[7]  = comp >> 8;
+    hdr[8]  = crc & 0xFF;
+    hdr[9]  = (crc >> 8) & 0xFF;
+    hdr[10] = (crc >> 16) & 0xFF;
+    hdr[11] = crc >> 24;
+
+    Lz->Raw_Total  += Lz->Len;
+    Lz->Comp_Total += QL_FF_LZ_HDR_SIZE + comp;
+
+    if (Out(Ctx, hdr, QL_FF_LZ_HDR_SIZE + comp) != 0)
+    {
+        memset(Lz->Head, 0xFF, sizeof(Lz->Head));
+        Lz->Hist  = 0;
+        Lz->Len   = 0;
+        Lz->Reset = 1;
+        return -1;
+    }
+    Lz->Reset = 0;
+
+    /* Keep the last QL_FF_LZ_HIST_MAX bytes in front of the next block */
+    total = Lz->Hist + Lz->Len;
+    if (total > QL_FF_LZ_HIST_MAX)
+    {
+        shift = total - QL_FF_LZ_HIST_MAX;
+        memmove(Lz->Buf, &Lz->Buf[shift], QL_FF_LZ_HIST_MAX);
+        for (uint32_t i = 0; i < (1U << QL_FF_LZ_HASH_BITS); i++)
+        {
+            Lz->Head[i] = ((Lz->Head[i] == QL_FF_LZ_NONE) || (Lz->Head[i] < shift)) ? QL_FF_LZ_NONE : (Lz->Head[i] - shift);
+        }
+        total = QL_FF_LZ_HIST_MAX;
+    }
+    Lz->Hist = total;
+    Lz->Len  = 0;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Compress Data, every full block is handed to Out
+* ex:
+* @par
+* Up to QL_FF_LZ_BLOCK_SIZE - 1 bytes stay in Lz until the next call or
+* Ql_FatFs_Lz_Flush.
+* @retval 0: ok, -1: Out failed, the block is lost
+*****************************************************************************/
+int32_t Ql_FatFs_Lz_Write(Ql_FatFs_Lz_TypeDef *Lz, const uint8_t *Data, uint32_t Len,
+                          Ql_FatFs_Lz_Out_TypeDef Out, void *Ctx)
+{
+    int32_t ret = 0;
+    uint32_t n;
+
+    if ((Lz == NULL) || (Data == NULL) || (Out == NULL))
+    {
+        return -1;
+    }
+
+    while (Len > 0)
+    {
+        n = QL_FF_LZ_BLOCK_SIZE - Lz->Len;
+        n = (n > Len) ? Len : n;
+        memcpy(&Lz->Buf[Lz->Hist + Lz->Len], Data, n);
+        Lz->Len += n;
+        Data    += n;
+        Len     -= n;
+
+        if ((Lz->Len == QL_FF_LZ_BLOCK_SIZE) && (Ql_FatFs_Lz_Emit(Lz, Out, Ctx) != 0))
+        {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Emit the partly filled block
+* ex:
+* @par
+* Call before closing the file, the history is kept.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Lz_Flush(Ql_FatFs_Lz_TypeDef *Lz, Ql_FatFs_Lz_Out_TypeDef Out, void *Ctx)
+{
+    if ((Lz == NULL) || (Out == NULL))
+    {
+        return -1;
+    }
+
+    if (Lz->Len == 0)
+    {
+        return 0;
+    }
+
+    return Ql_FatFs_Lz_Emit(Lz, Out, Ctx);
+}
+
+static int32_t Ql_FatFs_Lz_Bench_Out(void *Ctx, const uint8_t *Block, uint32_t Len)
+{
+    (void)Ctx;
+    (void)Block;
+    (void)Len;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Compression ratio and speed on this core
+* ex:
+* Ql_FatFs_Lz_Bench(NULL, 64 * 1024);
+* @par
+* Data is a recorded log, NULL: Len bytes of generated GGA/RMC/GSA lines.
+* Cycles from the DWT counter, the sink discards the blocks.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Lz_Bench(const uint8_t *Data, uint32_t Len)
+{
+    const uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    Ql_FatFs_Lz_TypeDef *lz;
+    uint8_t *gen = NULL;
+    uint32_t cycles;
+    uint32_t start;
+    uint32_t us;
+    uint32_t n = 0;
+    uint32_t i = 0;
+
+    lz = pvPortMalloc(sizeof(Ql_FatFs_Lz_TypeDef));
+    if ((lz == NULL) || (Len == 0))
+    {
+        vPortFree(lz);
+        return;
+    }
+
+    if (Data == NULL)
+    {
+        gen = pvPortMalloc(Len + 3 * 128);
+        if (gen == NULL)
+        {
+            vPortFree(lz);
+            return;
+        }
+
+        while (n < Len)
+        {
+            uint32_t s = 36000 + i;
+
+            n += snprintf((char *)&gen[n], 128, "$GNGGA,%02u%02u%02u.000,3149.%04u,N,11706.%04u,E,1,%u,0.6%u,6%u.%u,M,-0.3,M,,*%02X\r\n",
+                          (s / 3600) % 24, (s / 60) % 60, s % 60, 3300 + (i * 7) % 100, 9100 + (i * 3) % 100,
+                          20 + i % 9, i % 10, 1 + i % 3, i % 10, i & 0xFF);
+            n += snprintf((char *)&gen[n], 128, "$GNRMC,%02u%02u%02u.000,A,3149.%04u,N,11706.%04u,E,0.0%u,%u.%u,181026,,,A,V*%02X\r\n",
+                          (s / 3600) % 24, (s / 60) % 60, s % 60, 3300 + (i * 7) % 100, 9100 + (i * 3) % 100,
+                          i % 10, i % 360, i % 10, (i * 5) & 0xFF);
+            n += snprintf((char *)&gen[n], 128, "$GNGSA,A,3,05,13,15,18,23,24,,,,,,,1.2%u,0.6%u,1.0%u,1*%02X\r\n",
+                          i % 10, i % 10, i % 10, (i * 3) & 0xFF);
+            i++;
+        }
+        Data = gen;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Ql_FatFs_Lz_Init(lz);
+    start = DWT->CYCCNT;
+    Ql_FatFs_Lz_Write(lz, Data, Len, Ql_FatFs_Lz_Bench_Out, NULL);
+    Ql_FatFs_Lz_Flush(lz, Ql_FatFs_Lz_Bench_Out, NULL);
+    cycles = DWT->CYCCNT - start;
+    us = cycles / cycles_per_us;
+
+    QL_LOG_I("lz: %u -> %u bytes, ratio %u.%02u, %u.%02u cycles/byte, %u KB/s",
+             lz->Raw_Total, lz->Comp_Total,
+             lz->Raw_Total / lz->Comp_Total, (lz->Raw_Total % lz->Comp_Total) * 100 / lz->Comp_Total,
+             cycles / Len, (cycles % Len) * 100 / Len,
+             (us == 0) ? 0 : (uint32_t)((uint64_t)Len * 1000 / 1024 * 1000 / us));
+
+    vPortFree(gen);
+    vPortFree(lz);
+}
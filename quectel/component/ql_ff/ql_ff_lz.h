@@ -0,0 +1,67 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_lz.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef _QL_FF_LZ_H__
+#define _QL_FF_LZ_H__
+
+#include <stdint.h>
+
+/* LZ77 stream compressor, all state in Ql_FatFs_Lz_TypeDef (about 7.2 KB).
+   The output is a sequence of blocks:
+     'Q' 'Z' Flags Rsv Raw_Len(2) Comp_Len(2) CRC32 of the raw data(4), payload
+   A match may reach back into earlier blocks, so a file decodes from its
+   start up to the last complete block. QL_FF_LZ_FLAG_RESET marks a block
+   that needs no history, a decoder restarts there after a damaged block.
+   Decoder: quectel/tools/ql_lz_decode.py */
+#define QL_FF_LZ_WINDOW             (4096U)     // history + block, 12 bit offsets
+#define QL_FF_LZ_BLOCK_SIZE         (1024U)     // raw bytes per block
+#define QL_FF_LZ_HASH_BITS          (10U)
+#define QL_FF_LZ_MIN_MATCH          (3U)
+#define QL_FF_LZ_MAX_MATCH          (QL_FF_LZ_MIN_MATCH + 15U + 255U)
+#define QL_FF_LZ_HDR_SIZE           (12U)
+#define QL_FF_LZ_OUT_SIZE           (QL_FF_LZ_HDR_SIZE + QL_FF_LZ_BLOCK_SIZE + QL_FF_LZ_BLOCK_SIZE / 8)
+
+#define QL_FF_LZ_FLAG_STORED        (0x01U)     // payload is the raw data
+#define QL_FF_LZ_FLAG_RESET         (0x02U)     // first block after Ql_FatFs_Lz_Init
+
+/* Receives every finished block, 0: written */
+typedef int32_t (*Ql_FatFs_Lz_Out_TypeDef)(void *Ctx, const uint8_t *Block, uint32_t Len);
+
+typedef struct
+{
+    uint8_t     Buf[QL_FF_LZ_WINDOW];       // history, then the block being filled
+    uint16_t    Head[1U << QL_FF_LZ_HASH_BITS];
+    uint8_t     Out[QL_FF_LZ_OUT_SIZE];
+    uint32_t    Hist;
+    uint32_t    Len;
+    uint8_t     Reset;
+    uint32_t    Raw_Total;
+    uint32_t    Comp_Total;
+} Ql_FatFs_Lz_TypeDef;
+
+void    Ql_FatFs_Lz_Init(Ql_FatFs_Lz_TypeDef *Lz);
+int32_t Ql_FatFs_Lz_Write(Ql_FatFs_Lz_TypeDef *Lz, const uint8_t *Data, uint32_t Len,
+                          Ql_FatFs_Lz_Out_TypeDef Out, void *Ctx);
+int32_t Ql_FatFs_Lz_Flush(Ql_FatFs_Lz_TypeDef *Lz, Ql_FatFs_Lz_Out_TypeDef Out, void *Ctx);
+void    Ql_FatFs_Lz_Bench(const uint8_t *Data, uint32_t Len);
+
+#endif
@@ -0,0 +1,521 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_rotate.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_ff_rotate.h"
+#include "ql_check.h"
+
+#define LOG_TAG "ql_ff_rotate"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_FF_ROTATE_REC_OFFSET(Seq)    (FF_MAX_SS + ((Seq) % QL_FF_ROTATE_INDEX_CAP) * sizeof(Ql_FatFs_Rotate_Rec_TypeDef))
+
+/* Index header, sector 0 of the index file */
+typedef struct
+{
+    uint32_t    Magic;
+    uint32_t    Head;
+    uint32_t    Tail;
+    uint32_t    Crc;        // over Head and Tail
+} Ql_FatFs_Rotate_Hdr_TypeDef;
+
+extern DWORD get_fattime(void);
+
+static int32_t Ql_FatFs_Rotate_Io(Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Ofs, void *Buf, uint32_t Len, uint8_t Write)
+{
+    FRESULT res;
+    UINT n = 0;
+
+    res = f_lseek(&Rot->Index, Ofs);
+    if (res == FR_OK)
+    {
+        res = Write ? f_write(&Rot->Index, Buf, Len, &n) : f_read(&Rot->Index, Buf, Len, &n);
+    }
+
+    return ((res == FR_OK) && (n == Len)) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  Head and Tail to the index, one sector write and a sync
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Rotate_Hdr_Save(Ql_FatFs_Rotate_TypeDef *Rot)
+{
+    Ql_FatFs_Rotate_Hdr_TypeDef hdr;
+
+    hdr.Magic = QL_FF_ROTATE_INDEX_MAGIC;
+    hdr.Head  = Rot->Head;
+    hdr.Tail  = Rot->Tail;
+    hdr.Crc   = Ql_Check_CRC32(0, (const uint8_t *)&hdr.Head, 8);
+
+    if ((Ql_FatFs_Rotate_Io(Rot, 0, &hdr, sizeof(hdr), 1) != 0) || (f_sync(&Rot->Index) != FR_OK))
+    {
+        QL_LOG_E("%s: index write fail", Rot->Dir);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int32_t Ql_FatFs_Rotate_Rec_Save(Ql_FatFs_Rotate_TypeDef *Rot, const Ql_FatFs_Rotate_Rec_TypeDef *Rec)
+{
+    return Ql_FatFs_Rotate_Io(Rot, QL_FF_ROTATE_REC_OFFSET(Rec->Seq), (void *)Rec, sizeof(*Rec), 1);
+}
+
+/*****************************************************************************
+* @brief  Number in Name if it is <Prefix>_<digits>.*, or a shard folder
+* ex:
+* @par
+* None
+* @retval -1: not ours
+*****************************************************************************/
+static int32_t Ql_FatFs_Rotate_Parse(const char *Name, const char *Prefix)
+{
+    const char *p = Name;
+    char *end;
+    long seq;
+
+    if (Prefix != NULL)
+    {
+        const uint32_t len = strlen(Prefix);
+
+        if ((strncmp(Name, Prefix, len) != 0) || (Name[len] != '_'))
+        {
+            return -1;
+        }
+        p = Name + len + 1;
+    }
+
+    if ((*p < '0') || (*p > '9'))
+    {
+        return -1;
+    }
+    seq = strtol(p, &end, 10);
+    if ((Prefix == NULL) ? (*end != '\0') : (*end != '.'))
+    {
+        return -1;
+    }
+
+    return (int32_t)seq;
+}
+
+/*****************************************************************************
+* @brief  Smallest or largest number of the entries in Path
+* ex:
+* @par
+* None
+* @retval -1: none
+*****************************************************************************/
+static int32_t Ql_FatFs_Rotate_Scan(const char *Path, const char *Prefix, uint8_t Max)
+{
+    DIR dir;
+    FILINFO fno;
+    int32_t best = -1;
+    int32_t seq;
+
+    if (f_opendir(&dir, Path) != FR_OK)
+    {
+        return -1;
+    }
+
+    while ((f_readdir(&dir, &fno) == FR_OK) && (fno.fname[0] != '\0'))
+    {
+        seq = Ql_FatFs_Rotate_Parse(fno.fname, Prefix);
+        if ((seq >= 0) && ((best < 0) || (Max ? (seq > best) : (seq < best))))
+        {
+            best = seq;
+        }
+    }
+    f_closedir(&dir);
+
+    return best;
+}
+
+/*****************************************************************************
+* @brief  Recover Head and Tail from the folders, index lost or broken
+* ex:
+* @par
+* Reads the shard list and the first and last shard only.
+* @retval
+*****************************************************************************/
+static void Ql_FatFs_Rotate_Rebuild(Ql_FatFs_Rotate_TypeDef *Rot)
+{
+    char path[QL_FF_ROTATE_PATH_MAX];
+    int32_t first;
+    int32_t last;
+    int32_t seq;
+
+    Rot->Head = 0;
+    Rot->Tail = 0;
+
+    first = Ql_FatFs_Rotate_Scan(Rot->Dir, NULL, 0);
+    last  = Ql_FatFs_Rotate_Scan(Rot->Dir, NULL, 1);
+    if ((first < 0) || (last < 0))
+    {
+        return;
+    }
+
+    snprintf(path, sizeof(path), "%s/%05d", Rot->Dir, first);
+    seq = Ql_FatFs_Rotate_Scan(path, Rot->Prefix, 0);
+    Rot->Head = (seq < 0) ? (first * QL_FF_ROTATE_SHARD) : seq;
+
+    snprintf(path, sizeof(path), "%s/%05d", Rot->Dir, last);
+    seq = Ql_FatFs_Rotate_Scan(path, Rot->Prefix, 1);
+    Rot->Tail = (seq < 0) ? Rot->Head : (seq + 1);
+
+    QL_LOG_W("%s: index rebuilt, segments %u..%u", Rot->Dir, Rot->Head, Rot->Tail);
+}
+
+int32_t Ql_FatFs_Rotate_Path(const Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Seq, char *Buf, uint32_t Size)
+{
+    int len;
+
+    len = snprintf(Buf, Size, "%s/%05u/%s_%08u.%s", Rot->Dir, Seq / QL_FF_ROTATE_SHARD, Rot->Prefix, Seq, Rot->Ext);
+
+    return ((len > 0) && (len < Size)) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  Open the index of Rot->Dir, or build it
+* ex:
+* @par
+* The segment Tail - 1 is continued. A folder without segments gets the
+* first one, Ql_FatFs_Rotate_Path(Rot, Rot->Tail - 1) is the file to write.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Rotate_Init(Ql_FatFs_Rotate_TypeDef *Rot)
+{
+    char path[QL_FF_ROTATE_PATH_MAX];
+    Ql_FatFs_Rotate_Hdr_TypeDef hdr;
+    Ql_FatFs_Rotate_Rec_TypeDef rec;
+    FRESULT res;
+
+    if ((Rot == NULL) || (Rot->Dir == NULL) || (Rot->Prefix == NULL) || (Rot->Ext == NULL))
+    {
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", Rot->Dir, QL_FF_ROTATE_INDEX_NAME);
+    if (Ql_FatFs_Mkdir_Path(path) != 0)
+    {
+        return -1;
+    }
+
+    res = f_open(&Rot->Index, path, FA_OPEN_ALWAYS | FA_READ | FA_WRITE);
+    if (res != FR_OK)
+    {
+        QL_LOG_E("f_open fail, %d. path: %s", res, path);
+        return -1;
+    }
+
+    if ((Ql_FatFs_Rotate_Io(Rot, 0, &hdr, sizeof(hdr), 0) == 0) && (hdr.Magic == QL_FF_ROTATE_INDEX_MAGIC) &&
+        (hdr.Crc == Ql_Check_CRC32(0, (const uint8_t *)&hdr.Head, 8)) && (hdr.Tail >= hdr.Head))
+    {
+        Rot->Head = hdr.Head;
+        Rot->Tail = hdr.Tail;
+    }
+    else
+    {
+        Ql_FatFs_Rotate_Rebuild(Rot);
+        if (Ql_FatFs_Rotate_Hdr_Save(Rot) != 0)
+        {
+            f_close(&Rot->Index);
+            return -1;
+        }
+    }
+
+    Rot->Init = 1;
+    if (Rot->Head == Rot->Tail)
+    {
+        return Ql_FatFs_Rotate_Next(Rot, 0);
+    }
+
+    /* Continue the open segment, its age comes from the index */
+    Rot->Start_Tick = xTaskGetTickCount();
+    Rot->Start_Day  = get_fattime() >> 16;
+    if ((Ql_FatFs_Rotate_Io(Rot, QL_FF_ROTATE_REC_OFFSET(Rot->Tail - 1), &rec, sizeof(rec), 0) == 0) &&
+        (rec.Seq == (Rot->Tail - 1)))
+    {
+        Rot->Start_Day = rec.Start >> 16;
+    }
+
+    return 0;
+}
+
+int32_t Ql_FatFs_Rotate_DeInit(Ql_FatFs_Rotate_TypeDef *Rot)
+{
+    if ((Rot == NULL) || (Rot->Init == 0))
+    {
+        return -1;
+    }
+
+    Rot->Init = 0;
+
+    return (f_close(&Rot->Index) == FR_OK) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  The open segment of Size bytes has to be closed
+* ex:
+* @par
+* None
+* @retval 1: rotate now
+*****************************************************************************/
+uint8_t Ql_FatFs_Rotate_Due(const Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Size)
+{
+    if ((Rot == NULL) || (Rot->Init == 0))
+    {
+        return 0;
+    }
+
+    if ((Rot->Max_Size != 0) && (Size >= Rot->Max_Size))
+    {
+        return 1;
+    }
+
+    if ((Rot->Max_Secs != 0) && ((xTaskGetTickCount() - Rot->Start_Tick) >= pdMS_TO_TICKS(Rot->Max_Secs * 1000)))
+    {
+        return 1;
+    }
+
+    if (Rot->By_Day && (Size > 0) && ((get_fattime() >> 16) != Rot->Start_Day))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Close the open segment in the index and start the next one
+* ex:
+* @par
+* The caller closes the old file before and opens the new path after.
+* Two index records and the header, no folder scan.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Rotate_Next(Ql_FatFs_Rotate_TypeDef *Rot, uint32_t LastSize)
+{
+    char path[QL_FF_ROTATE_PATH_MAX];
+    Ql_FatFs_Rotate_Rec_TypeDef rec;
+
+    if ((Rot == NULL) || (Rot->Init == 0))
+    {
+        return -1;
+    }
+
+    if ((Rot->Tail > Rot->Head) &&
+        (Ql_FatFs_Rotate_Io(Rot, QL_FF_ROTATE_REC_OFFSET(Rot->Tail - 1), &rec, sizeof(rec), 0) == 0) &&
+        (rec.Seq == (Rot->Tail - 1)))
+    {
+        rec.Size = LastSize;
+        Ql_FatFs_Rotate_Rec_Save(Rot, &rec);
+    }
+
+    /* The index is full, the oldest segment goes */
+    if ((Rot->Tail - Rot->Head) >= QL_FF_ROTATE_INDEX_CAP)
+    {
+        Ql_FatFs_Rotate_Delete_Oldest(Rot);
+    }
+
+    if ((Ql_FatFs_Rotate_Path(Rot, Rot->Tail, path, sizeof(path)) != 0) || (Ql_FatFs_Mkdir_Path(path) != 0))
+    {
+        return -1;
+    }
+
+    rec.Seq      = Rot->Tail;
+    rec.Start    = get_fattime();
+    rec.Size     = 0;
+    rec.Reserved = 0;
+    if (Ql_FatFs_Rotate_Rec_Save(Rot, &rec) != 0)
+    {
+        return -1;
+    }
+
+    Rot->Tail++;
+    Rot->Start_Tick = xTaskGetTickCount();
+    Rot->Start_Day  = rec.Start >> 16;
+
+    return Ql_FatFs_Rotate_Hdr_Save(Rot);
+}
+
+/*****************************************************************************
+* @brief  Delete the oldest segment, never the open one
+* ex:
+* @par
+* The shard folder goes with its last segment.
+* @retval 0: deleted; -1: nothing to delete
+*****************************************************************************/
+int32_t Ql_FatFs_Rotate_Delete_Oldest(Ql_FatFs_Rotate_TypeDef *Rot)
+{
+    char path[QL_FF_ROTATE_PATH_MAX];
+    FRESULT res;
+
+    if ((Rot == NULL) || (Rot->Init == 0) || ((Rot->Tail - Rot->Head) <= 1))
+    {
+        return -1;
+    }
+
+    Ql_FatFs_Rotate_Path(Rot, Rot->Head, path, sizeof(path));
+    res = f_unlink(path);
+    if ((res != FR_OK) && (res != FR_NO_FILE))
+    {
+        QL_LOG_E("f_unlink fail, %d. path: %s", res, path);
+        return -1;
+    }
+
+    if (((Rot->Head + 1) % QL_FF_ROTATE_SHARD) == 0)
+    {
+        *strrchr(path, '/') = '\0';
+        f_unlink(path);
+    }
+
+    Rot->Head++;
+
+    return Ql_FatFs_Rotate_Hdr_Save(Rot);
+}
+
+/*****************************************************************************
+* @brief  Delete the oldest segments until Reserve_MB is free
+* ex:
+* @par
+* At most Max deletions per call, run from the storage task.
+* @retval segments deleted
+*****************************************************************************/
+int32_t Ql_FatFs_Rotate_Reclaim(Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Max)
+{
+    int32_t n = 0;
+
+    if ((Rot == NULL) || (Rot->Init == 0) || (Rot->Reserve_MB == 0))
+    {
+        return 0;
+    }
+
+    while ((n < Max) && Ql_FatFs_Free_Valid() && (Ql_FatFs_GetFree() < Rot->Reserve_MB))
+    {
+        if (Ql_FatFs_Rotate_Delete_Oldest(Rot) != 0)
+        {
+            break;
+        }
+        n++;
+    }
+
+    if (n > 0)
+    {
+        QL_LOG_I("%s: %d segments deleted, %u MB free", Rot->Dir, n, Ql_FatFs_GetFree());
+    }
+
+    return n;
+}
+
+/*****************************************************************************
+* @brief  Cost of Next and Delete_Oldest with Count segments in Dir
+* ex:
+* @par
+* Creates Count empty segments, times a plain folder scan over all of them
+* for comparison, then deletes them oldest first. Dir is left empty.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Rotate_Bench(const char *Dir, uint32_t Count)
+{
+    static Ql_FatFs_Rotate_TypeDef rot;
+    static FIL fp;
+    char path[QL_FF_ROTATE_PATH_MAX];
+    const uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    uint32_t sum[2] = { 0 };
+    uint32_t max[2] = { 0 };
+    uint32_t scan_us;
+    uint32_t start;
+    uint32_t us;
+    uint32_t n = 0;
+
+    memset(&rot, 0, sizeof(rot));
+    rot.Dir    = Dir;
+    rot.Prefix = "bench";
+    rot.Ext    = "bin";
+
+    if ((Count == 0) || (Ql_FatFs_Rotate_Init(&rot) != 0))
+    {
+        return;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        start = DWT->CYCCNT;
+        Ql_FatFs_Rotate_Next(&rot, 0);
+        Ql_FatFs_Rotate_Path(&rot, rot.Tail - 1, path, sizeof(path));
+        if (f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK)
+        {
+            f_close(&fp);
+        }
+        us = (DWT->CYCCNT - start) / cycles_per_us;
+        sum[0] += us;
+        max[0]  = (us > max[0]) ? us : max[0];
+    }
+
+    /* What finding the oldest costs without the index */
+    start = DWT->CYCCNT;
+    for (uint32_t shard = rot.Head / QL_FF_ROTATE_SHARD; shard <= (rot.Tail - 1) / QL_FF_ROTATE_SHARD; shard++)
+    {
+        snprintf(path, sizeof(path), "%s/%05u", Dir, shard);
+        Ql_FatFs_Rotate_Scan(path, rot.Prefix, 0);
+    }
+    scan_us = (DWT->CYCCNT - start) / cycles_per_us;
+
+    while (1)
+    {
+        start = DWT->CYCCNT;
+        if (Ql_FatFs_Rotate_Delete_Oldest(&rot) != 0)
+        {
+            break;
+        }
+        us = (DWT->CYCCNT - start) / cycles_per_us;
+        sum[1] += us;
+        max[1]  = (us > max[1]) ? us : max[1];
+        n++;
+    }
+
+    /* The open segment and the index */
+    Ql_FatFs_Rotate_Path(&rot, rot.Tail - 1, path, sizeof(path));
+    f_unlink(path);
+    *strrchr(path, '/') = '\0';
+    f_unlink(path);
+    Ql_FatFs_Rotate_DeInit(&rot);
+    snprintf(path, sizeof(path), "%s/%s", Dir, QL_FF_ROTATE_INDEX_NAME);
+    f_unlink(path);
+
+    QL_LOG_I("%u segments: next avg %u us max %u us, delete oldest avg %u us max %u us, full scan %u us",
+             Count, sum[0] / Count, max[0], (n == 0) ? 0 : (sum[1] / n), max[1], scan_us);
+}
@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_rotate.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef _QL_FF_ROTATE_H__
+#define _QL_FF_ROTATE_H__
+
+#include "ql_ff_user.h"
+
+/* Segments are Dir/<Seq / SHARD>/<Prefix>_<Seq>.<Ext>. A shard folder holds
+   at most QL_FF_ROTATE_SHARD files, so a name lookup never scans more */
+#define QL_FF_ROTATE_SHARD          (256U)
+#define QL_FF_ROTATE_INDEX_CAP      (16384U)    // segments kept at most
+#define QL_FF_ROTATE_INDEX_NAME     "index.bin"
+#define QL_FF_ROTATE_INDEX_MAGIC    (0x58444E49U)   // "INDX"
+#define QL_FF_ROTATE_RECLAIM_MAX    (8U)        // deletions per storage task period
+#define QL_FF_ROTATE_PATH_MAX       (64U)
+
+/* Index record of one segment, at 512 + (Seq % QL_FF_ROTATE_INDEX_CAP) * 16 */
+typedef struct
+{
+    uint32_t    Seq;
+    uint32_t    Start;      // FAT timestamp, get_fattime()
+    uint32_t    Size;       // bytes, 0 while it is the open segment
+    uint32_t    Reserved;
+} Ql_FatFs_Rotate_Rec_TypeDef;
+
+typedef struct
+{
+    /* Set by the user */
+    const char *Dir;            // "1:nmea"
+    const char *Prefix;         // "nmea"
+    const char *Ext;            // "txt"
+    uint32_t    Max_Size;       // bytes, 0: no size limit
+    uint32_t    Max_Secs;       // segment duration, 0: no limit
+    uint8_t     By_Day;         // new segment when the RTC date changes
+    uint32_t    Reserve_MB;     // free space kept by deleting the oldest segments
+
+    /* State, segments Head..Tail - 1 exist, Tail - 1 is the open one */
+    FIL         Index;
+    uint32_t    Head;
+    uint32_t    Tail;
+    uint32_t    Start_Tick;
+    uint16_t    Start_Day;
+    uint8_t     Init;
+} Ql_FatFs_Rotate_TypeDef;
+
+int32_t Ql_FatFs_Rotate_Init(Ql_FatFs_Rotate_TypeDef *Rot);
+int32_t Ql_FatFs_Rotate_DeInit(Ql_FatFs_Rotate_TypeDef *Rot);
+int32_t Ql_FatFs_Rotate_Path(const Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Seq, char *Buf, uint32_t Size);
+uint8_t Ql_FatFs_Rotate_Due(const Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Size);
+int32_t Ql_FatFs_Rotate_Next(Ql_FatFs_Rotate_TypeDef *Rot, uint32_t LastSize);
+int32_t Ql_FatFs_Rotate_Delete_Oldest(Ql_FatFs_Rotate_TypeDef *Rot);
+int32_t Ql_FatFs_Rotate_Reclaim(Ql_FatFs_Rotate_TypeDef *Rot, uint32_t Max);
+void    Ql_FatFs_Rotate_Bench(const char *Dir, uint32_t Count);
+
+#endif
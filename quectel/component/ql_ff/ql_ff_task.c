@@ -0,0 +1,567 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_task.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+
+#include "ql_ff_task.h"
+
+#define LOG_TAG "ql_ff_task"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+static TaskHandle_t Ql_FatFs_TaskHandle = NULL;
+static SemaphoreHandle_t Ql_FatFs_List_Mutex = NULL;
+static Ql_FatFs_Chan_TypeDef *Ql_FatFs_Chan_List = NULL;
+
+static uint32_t Ql_FatFs_Cycles_To_Us(uint32_t Cycles)
+{
+    return Cycles / (SystemCoreClock / 1000000);
+}
+
+/*****************************************************************************
+* @brief  Hand the active buffer to the task if the other one is free
+* ex:
+* @par
+* Called with Chan->Mutex held.
+* @retval 1: swapped
+*****************************************************************************/
+static uint8_t Ql_FatFs_Chan_Swap(Ql_FatFs_Chan_TypeDef *Chan)
+{
+    if ((Chan->Pending != 0) || (Chan->Len[Chan->Active] == 0))
+    {
+        return 0;
+    }
+
+    Chan->Active ^= 1;
+    Chan->Pending = 1;
+
+    return 1;
+}
+
+static int32_t Ql_FatFs_Chan_Stream_Open(Ql_FatFs_Chan_TypeDef *Chan, const char *path)
+{
+#if QL_FF_CHAN_CHUNK
+    return Ql_FatFs_Stream_Open_Contig(&Chan->Stream, path, QL_FF_CHAN_CHUNK, QL_FF_STREAM_SYNC_BYTES, QL_FF_STREAM_SYNC_MS);
+#else
+    return Ql_FatFs_Stream_Open(&Chan->Stream, path, QL_FF_STREAM_SYNC_BYTES, QL_FF_STREAM_SYNC_MS);
+#endif
+}
+
+static int32_t Ql_FatFs_Chan_Lz_Out(void *Ctx, const uint8_t *Block, uint32_t Len)
+{
+    Ql_FatFs_Chan_TypeDef *chan = (Ql_FatFs_Chan_TypeDef *)Ctx;
+
+    if (Ql_FatFs_Stream_Write(&chan->Stream, Block, Len) != 0)
+    {
+        return -1;
+    }
+    chan->Stats.Bytes_Stored += Len;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Write a buffer to the file, through the compressor if set
+* ex:
+* @par
+* Up to one compressor block stays in RAM until it fills, the channel
+* closes or the segment rolls.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_FatFs_Chan_Store(Ql_FatFs_Chan_TypeDef *Chan, const uint8_t *Data, uint32_t Len)
+{
+    if (Chan->Lz != NULL)
+    {
+        return Ql_FatFs_Lz_Write(Chan->Lz, Data, Len, Ql_FatFs_Chan_Lz_Out, Chan);
+    }
+
+    return Ql_FatFs_Chan_Lz_Out(Chan, Data, Len);
+}
+
+/*****************************************************************************
+* @brief  Close the segment if the rotation rules say so, start the next
+* ex:
+* @par
+* Also reopens the segment after a failed rotation.
+* @retval
+*****************************************************************************/
+static void Ql_FatFs_Chan_Roll(Ql_FatFs_Chan_TypeDef *Chan)
+{
+    char path[QL_FF_ROTATE_PATH_MAX];
+
+    if (Chan->Stream.Open)
+    {
+        if (!Ql_FatFs_Rotate_Due(Chan->Rotate, Ql_FatFs_Stream_Size(&Chan->Stream)))
+        {
+            return;
+        }
+
+        if (Chan->Lz != NULL)
+        {
+            Ql_FatFs_Lz_Flush(Chan->Lz, Ql_FatFs_Chan_Lz_Out, Chan);
+        }
+        Ql_FatFs_Rotate_Next(Chan->Rotate, Ql_FatFs_Stream_Size(&Chan->Stream));
+        Ql_FatFs_Stream_Close(&Chan->Stream);
+        Chan->Stats.Segments++;
+    }
+
+    Ql_FatFs_Rotate_Path(Chan->Rotate, Chan->Rotate->Tail - 1, path, sizeof(path));
+    if (Ql_FatFs_Chan_Stream_Open(Chan, path) != 0)
+    {
+        Chan->Stats.Errors++;
+    }
+
+    /* Every segment decodes on its own */
+    if (Chan->Lz != NULL)
+    {
+        Ql_FatFs_Lz_Init(Chan->Lz);
+    }
+}
+
+/*****************************************************************************
+* @brief  Write every pending buffer of Chan to its file
+* ex:
+* @par
+* The producers only touch Buf[Active], the pending buffer is written
+* without the channel mutex. Flush is set on a timeout or close, then a
+* partly filled buffer goes out as well.
+* @retval
+*****************************************************************************/
+static void Ql_FatFs_Chan_Service(Ql_FatFs_Chan_TypeDef *Chan, uint8_t Flush)
+{
+    TickType_t start;
+    uint32_t ms;
+    uint8_t i;
+
+    xSemaphoreTake(Chan->Mutex, portMAX_DELAY);
+    if (Flush)
+    {
+        Ql_FatFs_Chan_Swap(Chan);
+    }
+    xSemaphoreGive(Chan->Mutex);
+
+    /* Keep the free reserve in the background, not when the card is full */
+    if (Flush && (Chan->Rotate != NULL))
+    {
+        Ql_FatFs_Rotate_Reclaim(Chan->Rotate, QL_FF_ROTATE_RECLAIM_MAX);
+    }
+
+    while (Chan->Pending)
+    {
+        i = Chan->Active ^ 1;
+
+        start = xTaskGetTickCount();
+        if (Chan->Rotate != NULL)
+        {
+            Ql_FatFs_Chan_Roll(Chan);
+        }
+
+        if (Ql_FatFs_Chan_Store(Chan, Chan->Buf[i], Chan->Len[i]) == 0)
+        {
+            Chan->Stats.Bytes_Written += Chan->Len[i];
+        }
+        else
+        {
+            Chan->Stats.Errors++;
+            Chan->Stats.Bytes_Dropped += Chan->Len[i];
+            /* Card full, make room for the next buffer */
+            Ql_FatFs_Rotate_Reclaim(Chan->Rotate, QL_FF_ROTATE_RECLAIM_MAX);
+        }
+        ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        Chan->Stats.Flushes++;
+        Chan->Stats.Flush_Sum_Ms += ms;
+        Chan->Stats.Flush_Max_Ms = (ms > Chan->Stats.Flush_Max_Ms) ? ms : Chan->Stats.Flush_Max_Ms;
+
+        xSemaphoreTake(Chan->Mutex, portMAX_DELAY);
+        Chan->Len[i] = 0;
+        Chan->Pending = 0;
+        /* The producers filled the other buffer meanwhile */
+        if ((Chan->Len[Chan->Active] >= Chan->Buf_Size) || Flush)
+        {
+            Ql_FatFs_Chan_Swap(Chan);
+        }
+        xSemaphoreGive(Chan->Mutex);
+
+        xSemaphoreGive(Chan->Free_Sem);
+    }
+}
+
+static void Ql_FatFs_Chan_Release(Ql_FatFs_Chan_TypeDef *Chan)
+{
+    Ql_FatFs_Chan_TypeDef **pp = &Ql_FatFs_Chan_List;
+
+    while (*pp != NULL)
+    {
+        if (*pp == Chan)
+        {
+            *pp = Chan->Next;
+            break;
+        }
+        pp = &(*pp)->Next;
+    }
+
+    if (Chan->Lz != NULL)
+    {
+        Ql_FatFs_Lz_Flush(Chan->Lz, Ql_FatFs_Chan_Lz_Out, Chan);
+    }
+    Ql_FatFs_Stream_Close(&Chan->Stream);
+    /* The segment stays open in the index, the next session continues it */
+    Ql_FatFs_Rotate_DeInit(Chan->Rotate);
+    vPortFree(Chan->Buf[0]);
+    vPortFree(Chan->Buf[1]);
+    Chan->Buf[0] = NULL;
+    Chan->Buf[1] = NULL;
+    Chan->Open = 0;
+}
+
+/*****************************************************************************
+* @brief  Storage task, the only writer of the channel files
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+static void Ql_FatFs_Task(void *Param)
+{
+    Ql_FatFs_Chan_TypeDef *chan;
+    Ql_FatFs_Chan_TypeDef *next;
+    TickType_t period = xTaskGetTickCount();
+    uint8_t flush;
+    uint8_t close;
+
+    (void)Param;
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(QL_FF_TASK_PERIOD));
+
+        flush = 0;
+        if ((xTaskGetTickCount() - period) >= pdMS_TO_TICKS(QL_FF_TASK_PERIOD))
+        {
+            period = xTaskGetTickCount();
+            flush = 1;
+        }
+
+        xSemaphoreTake(Ql_FatFs_List_Mutex, portMAX_DELAY);
+        for (chan = Ql_FatFs_Chan_List; chan != NULL; chan = next)
+        {
+            next = chan->Next;
+            /* A close requested while the buffers are written waits for the
+               next round, the active buffer has not gone out yet */
+            close = chan->Close_Req;
+            Ql_FatFs_Chan_Service(chan, flush || close);
+            if (close)
+            {
+                Ql_FatFs_Chan_Release(chan);
+            }
+        }
+        xSemaphoreGive(Ql_FatFs_List_Mutex);
+    }
+}
+
+int32_t Ql_FatFs_Task_Init(void)
+{
+    if (Ql_FatFs_List_Mutex == NULL)
+    {
+        Ql_FatFs_List_Mutex = xSemaphoreCreateMutex();
+        if (Ql_FatFs_List_Mutex == NULL)
+        {
+            return -1;
+        }
+    }
+
+    if (Ql_FatFs_TaskHandle == NULL)
+    {
+        /* Producer side timing in Ql_FatFs_Chan_Write */
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+        if (xTaskCreate(Ql_FatFs_Task,
+                        "ff_task",
+                        QL_FF_TASK_STACK_SIZE,
+                        NULL,
+                        QL_FF_TASK_PRIORITY,
+                        &Ql_FatFs_TaskHandle) != pdPASS)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Open path through the storage task
+* ex:
+* @par
+* BufSize is rounded up to whole sectors, two of them are allocated.
+* Policy decides what Ql_FatFs_Chan_Write does when both are busy.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_FatFs_Chan_Open_Internal(Ql_FatFs_Chan_TypeDef *Chan, const char *path, uint32_t BufSize,
+                                           Ql_FatFs_Chan_Policy_TypeDef Policy, uint32_t WaitMs,
+                                           Ql_FatFs_Rotate_TypeDef *Rot)
+{
+    if ((Chan == NULL) || (path == NULL) || (BufSize == 0) || (Ql_FatFs_Task_Init() != 0))
+    {
+        return -1;
+    }
+
+    memset(Chan, 0, sizeof(Ql_FatFs_Chan_TypeDef));
+    Chan->Rotate   = Rot;
+    Chan->Buf_Size = (BufSize + FF_MAX_SS - 1) & ~(FF_MAX_SS - 1);
+    Chan->Policy   = Policy;
+    Chan->Wait_Ms  = WaitMs;
+    Chan->Buf[0]   = pvPortMalloc(Chan->Buf_Size);
+    Chan->Buf[1]   = pvPortMalloc(Chan->Buf_Size);
+    Chan->Mutex    = xSemaphoreCreateMutex();
+    Chan->Free_Sem = xSemaphoreCreateBinary();
+    if ((Chan->Buf[0] == NULL) || (Chan->Buf[1] == NULL) || (Chan->Mutex == NULL) || (Chan->Free_Sem == NULL))
+    {
+        QL_LOG_E("chan malloc fail. path: %s", path);
+        goto err;
+    }
+
+    if (Ql_FatFs_Chan_Stream_Open(Chan, path) != 0)
+    {
+        goto err;
+    }
+
+    Chan->Open = 1;
+
+    xSemaphoreTake(Ql_FatFs_List_Mutex, portMAX_DELAY);
+    Chan->Next = Ql_FatFs_Chan_List;
+    Ql_FatFs_Chan_List = Chan;
+    xSemaphoreGive(Ql_FatFs_List_Mutex);
+
+    return 0;
+
+err:
+    vPortFree(Chan->Buf[0]);
+    vPortFree(Chan->Buf[1]);
+    if (Chan->Mutex != NULL)
+    {
+        vSemaphoreDelete(Chan->Mutex);
+    }
+    if (Chan->Free_Sem != NULL)
+    {
+        vSemaphoreDelete(Chan->Free_Sem);
+    }
+    memset(Chan, 0, sizeof(Ql_FatFs_Chan_TypeDef));
+
+    return -1;
+}
+
+int32_t Ql_FatFs_Chan_Open(Ql_FatFs_Chan_TypeDef *Chan, const char *path, uint32_t BufSize,
+                           Ql_FatFs_Chan_Policy_TypeDef Policy, uint32_t WaitMs)
+{
+    return Ql_FatFs_Chan_Open_Internal(Chan, path, BufSize, Policy, WaitMs, NULL);
+}
+
+/*****************************************************************************
+* @brief  Open a channel that writes the segments of Rot
+* ex:
+* @par
+* Rot needs Dir, Prefix, Ext and the rules set, the rest is filled here.
+* Closing the channel also closes the segment.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Chan_Open_Rotate(Ql_FatFs_Chan_TypeDef *Chan, Ql_FatFs_Rotate_TypeDef *Rot, uint32_t BufSize,
+                                  Ql_FatFs_Chan_Policy_TypeDef Policy, uint32_t WaitMs)
+{
+    char path[QL_FF_ROTATE_PATH_MAX];
+
+    if ((Rot == NULL) || (Ql_FatFs_Rotate_Init(Rot) != 0))
+    {
+        return -1;
+    }
+
+    Ql_FatFs_Rotate_Path(Rot, Rot->Tail - 1, path, sizeof(path));
+    if (Ql_FatFs_Chan_Open_Internal(Chan, path, BufSize, Policy, WaitMs, Rot) != 0)
+    {
+        Ql_FatFs_Rotate_DeInit(Rot);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Compress what goes through Chan with Lz
+* ex:
+* static Ql_FatFs_Lz_TypeDef nmea_lz;
+* Ql_FatFs_Chan_Compress(&chan, &nmea_lz);
+* @par
+* Call after the open, before the first write. Lz is owned by the storage
+* task until the channel is closed. Decode with tools/ql_lz_decode.py.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Chan_Compress(Ql_FatFs_Chan_TypeDef *Chan, Ql_FatFs_Lz_TypeDef *Lz)
+{
+    int32_t ret = -1;
+
+    if ((Chan == NULL) || (Chan->Open == 0) || (Lz == NULL))
+    {
+        return -1;
+    }
+
+    xSemaphoreTake(Chan->Mutex, portMAX_DELAY);
+    if (Chan->Stats.Bytes_In == 0)
+    {
+        Ql_FatFs_Lz_Init(Lz);
+        Chan->Lz = Lz;
+        ret = 0;
+    }
+    xSemaphoreGive(Chan->Mutex);
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Append data, never touches the card
+* ex:
+* @par
+* Blocks for a memcpy at most, or up to Wait_Ms with QL_FF_CHAN_WAIT when
+* both buffers are busy. The longest call is kept in Stats.Write_Max_Us.
+* @retval bytes accepted, the rest is counted in Stats.Bytes_Dropped; -1: error
+*****************************************************************************/
+int32_t Ql_FatFs_Chan_Write(Ql_FatFs_Chan_TypeDef *Chan, const uint8_t *str, uint32_t len)
+{
+    const uint32_t start = DWT->CYCCNT;
+    const TickType_t tick = xTaskGetTickCount();
+    TickType_t waited;
+    uint32_t done = 0;
+    uint32_t us;
+    uint32_t n;
+    uint8_t *buf;
+
+    if ((Chan == NULL) || (Chan->Open == 0) || (Chan->Close_Req != 0) || (str == NULL))
+    {
+        return -1;
+    }
+
+    xSemaphoreTake(Chan->Mutex, portMAX_DELAY);
+    Chan->Stats.Bytes_In += len;
+
+    while (done < len)
+    {
+        buf = Chan->Buf[Chan->Active];
+        n = Chan->Buf_Size - Chan->Len[Chan->Active];
+        n = (n > (len - done)) ? (len - done) : n;
+        memcpy(buf + Chan->Len[Chan->Active], str + done, n);
+        Chan->Len[Chan->Active] += n;
+        done += n;
+
+        if (Chan->Len[Chan->Active] < Chan->Buf_Size)
+        {
+            break;
+        }
+
+        if (Ql_FatFs_Chan_Swap(Chan))
+        {
+            xTaskNotifyGive(Ql_FatFs_TaskHandle);
+            continue;
+        }
+
+        if (done >= len)
+        {
+            break;
+        }
+
+        /* Both buffers busy, the card is behind */
+        waited = xTaskGetTickCount() - tick;
+        if ((Chan->Policy != QL_FF_CHAN_WAIT) || (waited >= pdMS_TO_TICKS(Chan->Wait_Ms)))
+        {
+            Chan->Stats.Bytes_Dropped += len - done;
+            break;
+        }
+
+        xSemaphoreGive(Chan->Mutex);
+        xSemaphoreTake(Chan->Free_Sem, pdMS_TO_TICKS(Chan->Wait_Ms) - waited);
+        xSemaphoreTake(Chan->Mutex, portMAX_DELAY);
+    }
+
+    us = Ql_FatFs_Cycles_To_Us(DWT->CYCCNT - start);
+    Chan->Stats.Write_Max_Us = (us > Chan->Stats.Write_Max_Us) ? us : Chan->Stats.Write_Max_Us;
+    xSemaphoreGive(Chan->Mutex);
+
+    return done;
+}
+
+/*****************************************************************************
+* @brief  Write what is buffered, close the file and free the channel
+* ex:
+* @par
+* Waits for the storage task, at most 5 s.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Chan_Close(Ql_FatFs_Chan_TypeDef *Chan)
+{
+    uint32_t wait = 0;
+
+    if ((Chan == NULL) || (Chan->Open == 0))
+    {
+        return -1;
+    }
+
+    Chan->Close_Req = 1;
+    xTaskNotifyGive(Ql_FatFs_TaskHandle);
+    while (Chan->Open && (wait < 5000))
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        wait += 10;
+    }
+
+    if (Chan->Open)
+    {
+        return -1;
+    }
+
+    vSemaphoreDelete(Chan->Mutex);
+    vSemaphoreDelete(Chan->Free_Sem);
+    Chan->Mutex = NULL;
+    Chan->Free_Sem = NULL;
+
+    return 0;
+}
+
+void Ql_FatFs_Chan_Stats_Get(const Ql_FatFs_Chan_TypeDef *Chan, Ql_FatFs_Chan_Stats_TypeDef *Stats)
+{
+    if ((Chan == NULL) || (Stats == NULL))
+    {
+        return;
+    }
+
+    memcpy(Stats, &Chan->Stats, sizeof(Ql_FatFs_Chan_Stats_TypeDef));
+}
+
+void Ql_FatFs_Chan_Stats_Print(const Ql_FatFs_Chan_TypeDef *Chan)
+{
+    Ql_FatFs_Chan_Stats_TypeDef stats;
+
+    Ql_FatFs_Chan_Stats_Get(Chan, &stats);
+
+    QL_LOG_I("in %u, written %u, stored %u, dropped %u, errors %u, segments %u", stats.Bytes_In, stats.Bytes_Written,
+             stats.Bytes_Stored, stats.Bytes_Dropped, stats.Errors, stats.Segments);
+    QL_LOG_I("flush %u, avg %u ms, max %u ms, producer max %u us", stats.Flushes,
+             (stats.Flushes == 0) ? 0 : (stats.Flush_Sum_Ms / stats.Flushes), stats.Flush_Max_Ms, stats.Write_Max_Us);
+}
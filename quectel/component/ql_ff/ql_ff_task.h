@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_ff_task.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef _QL_FF_TASK_H__
+#define _QL_FF_TASK_H__
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "ql_ff_user.h"
+#include "ql_ff_rotate.h"
+#include "ql_ff_lz.h"
+
+/* Storage task: producers copy into the active buffer of a channel and
+   return, the task writes the full one to the card */
+#define QL_FF_TASK_PRIORITY         (tskIDLE_PRIORITY + 2)
+#define QL_FF_TASK_STACK_SIZE       (configMINIMAL_STACK_SIZE * 4)
+#define QL_FF_TASK_PERIOD           (1000U)     // ms, a partly filled buffer is written after this
+#define QL_FF_CHAN_CHUNK            QL_FF_STREAM_CHUNK  // contiguous preallocation, 0: plain stream
+
+typedef enum
+{
+    QL_FF_CHAN_DROP = 0,    // both buffers busy: drop what does not fit
+    QL_FF_CHAN_WAIT,        // both buffers busy: wait up to Wait_Ms, then drop
+} Ql_FatFs_Chan_Policy_TypeDef;
+
+typedef struct
+{
+    uint32_t    Bytes_In;
+    uint32_t    Bytes_Written;
+    uint32_t    Bytes_Stored;       // on the card, differs from Bytes_Written when compressed
+    uint32_t    Bytes_Dropped;
+    uint32_t    Flushes;
+    uint32_t    Flush_Max_Ms;       // longest buffer write incl. FAT updates
+    uint32_t    Flush_Sum_Ms;
+    uint32_t    Write_Max_Us;       // longest Ql_FatFs_Chan_Write, the producer side bound
+    uint32_t    Errors;
+    uint32_t    Segments;           // files started by rotation
+} Ql_FatFs_Chan_Stats_TypeDef;
+
+typedef struct ql_ff_chan
+{
+    Ql_FatFs_Stream_TypeDef         Stream;
+    Ql_FatFs_Chan_Policy_TypeDef    Policy;
+    uint32_t                        Wait_Ms;
+    SemaphoreHandle_t               Mutex;      // held for a memcpy and a swap only
+    SemaphoreHandle_t               Free_Sem;   // given after every flush
+    uint8_t                        *Buf[2];
+    uint32_t                        Buf_Size;
+    uint32_t                        Len[2];
+    uint8_t                         Active;     // buffer the producers fill
+    volatile uint8_t                Pending;    // Buf[Active ^ 1] waits for the task
+    volatile uint8_t                Close_Req;
+    uint8_t                         Open;
+    Ql_FatFs_Chan_Stats_TypeDef     Stats;
+    Ql_FatFs_Rotate_TypeDef        *Rotate;     // NULL: one file
+    Ql_FatFs_Lz_TypeDef            *Lz;         // NULL: stored as written
+    struct ql_ff_chan              *Next;
+} Ql_FatFs_Chan_TypeDef;
+
+int32_t Ql_FatFs_Task_Init(void);
+int32_t Ql_FatFs_Chan_Open(Ql_FatFs_Chan_TypeDef *Chan, const char *path, uint32_t BufSize,
+                           Ql_FatFs_Chan_Policy_TypeDef Policy, uint32_t WaitMs);
+int32_t Ql_FatFs_Chan_Open_Rotate(Ql_FatFs_Chan_TypeDef *Chan, Ql_FatFs_Rotate_TypeDef *Rot, uint32_t BufSize,
+                                  Ql_FatFs_Chan_Policy_TypeDef Policy, uint32_t WaitMs);
+int32_t Ql_FatFs_Chan_Compress(Ql_FatFs_Chan_TypeDef *Chan, Ql_FatFs_Lz_TypeDef *Lz);
+int32_t Ql_FatFs_Chan_Write(Ql_FatFs_Chan_TypeDef *Chan, const uint8_t *str, uint32_t len);
+int32_t Ql_FatFs_Chan_Close(Ql_FatFs_Chan_TypeDef *Chan);
+void    Ql_FatFs_Chan_Stats_Get(const Ql_FatFs_Chan_TypeDef *Chan, Ql_FatFs_Chan_Stats_TypeDef *Stats);
+void    Ql_FatFs_Chan_Stats_Print(const Ql_FatFs_Chan_TypeDef *Chan);
+
+#endif
@@ -21,6 +21,10 @@ limitations under the License.
 */
 
 #include "ql_ff_user.h"
+#include "ql_ff_cache.h"
+#include "ql_ff_journal.h"
+#include "diskio.h"
+#include "ql_sdcard.h"
 #include "FreeRTOS.h"
 #include "task.h"
 
@@ -28,10 +32,251 @@ limitations under the License.
 #define LOG_LVL QL_LOG_DEBUG
 #include "ql_log.h"
 
+/* FIL.flag bit of ff.c, makes f_sync write the directory entry after a raw write */
+#define QL_FF_FA_MODIFIED           (0x40U)
+
 FATFS *qlfs = NULL;
+static TaskHandle_t Ql_FatFs_Free_TaskHandle = NULL;
+static void (*Ql_FatFs_Space_Cb)(uint8_t Level, uint32_t FreeMB) = NULL;
+static uint8_t Ql_FatFs_Space_Level = QL_SD_SPACE_OK;
+
+/* Free cluster scan, one slice of FAT sectors per hold of the volume lock.
+   Slices written after they were counted are counted again */
+static uint16_t *Ql_FatFs_Free_Count = NULL;    // free entries per slice
+static uint8_t  *Ql_FatFs_Free_Dirty = NULL;    // one bit per slice
+static uint32_t  Ql_FatFs_Free_Done = 0;        // slices counted so far
+
+/*****************************************************************************
+* @brief  Note FAT sectors written while the free clusters are counted
+* ex:
+* @par
+* Called by disk_write under the volume lock, like the scan itself.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Free_Touch(LBA_t Sector, UINT Count)
+{
+    uint32_t slice;
+
+    if ((Ql_FatFs_Free_Dirty == NULL) || (qlfs == NULL))
+    {
+        return;
+    }
+
+    for ( ; Count > 0; Count--, Sector++)
+    {
+        if ((Sector < qlfs->fatbase) || (Sector >= (qlfs->fatbase + qlfs->fsize)))
+        {
+            continue;
+        }
+        slice = (uint32_t)(Sector - qlfs->fatbase) / QL_FF_FREE_SLICE;
+        if (slice < Ql_FatFs_Free_Done)
+        {
+            Ql_FatFs_Free_Dirty[slice >> 3] |= (1U << (slice & 7));
+        }
+    }
+}
+
+/* Free entries of one slice, the FatFs window is newer than the disk */
+static int32_t Ql_FatFs_Free_Slice(FATFS *fs, uint32_t Slice, uint8_t *Buf)
+{
+    const uint32_t per_sect = (fs->fs_type == FS_FAT16) ? (FF_MAX_SS / 2) : (FF_MAX_SS / 4);
+    uint32_t entry = Slice * QL_FF_FREE_SLICE * per_sect;
+    uint32_t count = 0;
+    const BYTE *sect;
+    LBA_t lba;
+
+    for (uint32_t s = 0; (s < QL_FF_FREE_SLICE) && (entry < fs->n_fatent); s++)
+    {
+        lba = fs->fatbase + (Slice * QL_FF_FREE_SLICE) + s;
+        sect = fs->win;
+        if (lba != fs->winsect)
+        {
+            if (disk_read(fs->pdrv, Buf, lba, 1) != RES_OK)
+            {
+                return -1;
+            }
+            sect = Buf;
+        }
+
+        for (uint32_t i = 0; (i < per_sect) && (entry < fs->n_fatent); i++, entry++)
+        {
+            if (entry < 2)
+            {
+                continue;
+            }
+            if (fs->fs_type == FS_FAT16)
+            {
+                count += ((sect[i * 2] | sect[(i * 2) + 1]) == 0) ? 1 : 0;
+            }
+            else
+            {
+                count += ((sect[i * 4] | sect[(i * 4) + 1] | sect[(i * 4) + 2] | (sect[(i * 4) + 3] & 0x0F)) == 0) ? 1 : 0;
+            }
+        }
+    }
+
+    return (int32_t)count;
+}
+
+/* Count one slice under the lock, Slice >= Ql_FatFs_Free_Done moves the front */
+static int32_t Ql_FatFs_Free_Step(FATFS *fs, uint32_t Slice, uint8_t *Buf)
+{
+    int32_t count;
+
+    if (!ff_mutex_take(fs->ldrv))
+    {
+        return -1;
+    }
+
+    count = Ql_FatFs_Free_Slice(fs, Slice, Buf);
+    if (count >= 0)
+    {
+        Ql_FatFs_Free_Count[Slice] = (uint16_t)count;
+        Ql_FatFs_Free_Dirty[Slice >> 3] &= ~(1U << (Slice & 7));
+        if (Slice >= Ql_FatFs_Free_Done)
+        {
+            Ql_FatFs_Free_Done = Slice + 1;
+        }
+    }
+
+    ff_mutex_give(fs->ldrv);
+
+    return count;
+}
+
+/*****************************************************************************
+* @brief  Count the free clusters once after mount
+* ex:
+* @par
+* Without a valid FSINFO the whole FAT is read, seconds on a large card.
+* f_getfree would hold the volume lock that long and writers waiting more
+* than FF_FS_TIMEOUT get FR_TIMEOUT, so the FAT is read QL_FF_FREE_SLICE
+* sectors per hold instead. free_clst is set only when every slice is
+* counted; FatFs keeps it up to date afterwards, Ql_FatFs_GetFree() only
+* reads it. FAT12 volumes are small, f_getfree still does them.
+* @retval
+*****************************************************************************/
+static void Ql_FatFs_Free_Task(void *Param)
+{
+    FATFS *fs = qlfs;
+    DWORD fre_clust;
+    uint32_t slices;
+    uint32_t total;
+    uint32_t round;
+    uint32_t dirty;
+    uint8_t *buf = NULL;
+    int32_t ret = 0;
+
+    (void)Param;
+
+    slices = (fs->fsize + QL_FF_FREE_SLICE - 1) / QL_FF_FREE_SLICE;
+    if (fs->fs_type != FS_FAT12)
+    {
+        buf = (uint8_t *)pvPortMalloc(FF_MAX_SS);
+        Ql_FatFs_Free_Count = (uint16_t *)pvPortMalloc(slices * sizeof(uint16_t));
+        Ql_FatFs_Free_Dirty = (uint8_t *)pvPortMalloc((slices + 7) / 8);
+    }
+
+    if ((buf == NULL) || (Ql_FatFs_Free_Count == NULL) || (Ql_FatFs_Free_Dirty == NULL))
+    {
+        /* FAT12, or no memory for the sliced scan */
+        ret = (f_getfree("1:", &fre_clust, &fs) == FR_OK) ? 0 : -1;
+    }
+    else
+    {
+        memset(Ql_FatFs_Free_Dirty, 0, (slices + 7) / 8);
+        Ql_FatFs_Free_Done = 0;
+
+        for (uint32_t s = 0; (s < slices) && (ret == 0); s++)
+        {
+            ret = (Ql_FatFs_Free_Step(fs, s, buf) < 0) ? -1 : 0;
+            vTaskDelay(1);
+        }
+
+        /* Slices written behind the front. The last round runs in one hold,
+           so a busy writer cannot keep the count from ever finishing */
+        for (round = 0; ret == 0; round++)
+        {
+            if (!ff_mutex_take(fs->ldrv))
+            {
+                ret = -1;
+                break;
+            }
+
+            if (fs->wflag && (fs->winsect >= fs->fatbase) && (fs->winsect < (fs->fatbase + fs->fsize)))
+            {
+                Ql_FatFs_Free_Touch(fs->winsect, 1);
+            }
+
+            dirty = 0;
+            total = 0;
+            for (uint32_t s = 0; s < slices; s++)
+            {
+                if (!(Ql_FatFs_Free_Dirty[s >> 3] & (1U << (s & 7))))
+                {
+                    total += Ql_FatFs_Free_Count[s];
+                }
+                else if (round < QL_FF_FREE_ROUNDS)
+                {
+                    dirty++;
+                }
+                else
+                {
+                    ret = Ql_FatFs_Free_Slice(fs, s, buf);
+                    if (ret < 0)
+                    {
+                        break;
+                    }
+                    total += (uint32_t)ret;
+                    ret = 0;
+                }
+            }
+
+            if ((ret == 0) && (dirty == 0))
+            {
+                fs->free_clst = total;
+                fs->fsi_flag |= 1;
+            }
+            ff_mutex_give(fs->ldrv);
+
+            if ((ret != 0) || (dirty == 0))
+            {
+                break;
+            }
+
+            for (uint32_t s = 0; (s < slices) && (ret == 0); s++)
+            {
+                if (Ql_FatFs_Free_Dirty[s >> 3] & (1U << (s & 7)))
+                {
+                    ret = (Ql_FatFs_Free_Step(fs, s, buf) < 0) ? -1 : 0;
+                    vTaskDelay(1);
+                }
+            }
+        }
+    }
+
+    if (ff_mutex_take(fs->ldrv))
+    {
+        vPortFree(Ql_FatFs_Free_Dirty);
+        Ql_FatFs_Free_Dirty = NULL;
+        ff_mutex_give(fs->ldrv);
+    }
+    vPortFree(Ql_FatFs_Free_Count);
+    Ql_FatFs_Free_Count = NULL;
+    vPortFree(buf);
+
+    if (ret == 0)
+    {
+        check_sd_remain_size();
+    }
+    else
+    {
+        QL_LOG_W("free cluster count failed");
+    }
 
-//static FRESULT delete_old_files(const char *path);
-//static void delete_no_time_files(const char *path);
+    Ql_FatFs_Free_TaskHandle = NULL;
+    vTaskDelete(NULL);
+}
 
 int32_t Ql_FatFs_Mount(void)
 {
@@ -94,6 +339,22 @@ int32_t Ql_FatFs_Mount(void)
     }
     
     qlfs = fs;
+    Ql_FatFs_Space_Level = QL_SD_SPACE_OK;
+    
+    /* The flash event log only keeps warnings while there is no card */
+    Ql_Log_Flash_Enable(0);
+    
+    /* Boot sector, FSINFO and FAT are written back on sync */
+    Ql_FatFs_Cache_Meta(&Ql_FatFs_Sd_Cache, fs->database);
+    
+    /* Files of journaled streams cut by a power loss get their size back */
+    Ql_FatFs_Journal_Init();
+    
+    if (fs->free_clst > (fs->n_fatent - 2))
+    {
+        xTaskCreate(Ql_FatFs_Free_Task, "ff_free", configMINIMAL_STACK_SIZE * 2, NULL,
+                    tskIDLE_PRIORITY + 1, &Ql_FatFs_Free_TaskHandle);
+    }
     
     return 0;
 }
@@ -107,6 +368,19 @@ int32_t Ql_FatFs_UnMount(void)
         return 0;
     }
     
+    // The free cluster count still runs
+    while (Ql_FatFs_Free_TaskHandle != NULL)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    
+    if (ff_mutex_take(qlfs->ldrv))
+    {
+        Ql_FatFs_Cache_Flush(&Ql_FatFs_Sd_Cache);
+        Ql_FatFs_Cache_Meta(&Ql_FatFs_Sd_Cache, 0);
+        ff_mutex_give(qlfs->ldrv);
+    }
+    
     Res = f_mount(NULL, "1:", 0);
     if (Res != FR_OK)
     {
@@ -115,6 +389,7 @@ int32_t Ql_FatFs_UnMount(void)
     
     vPortFree(qlfs);
     qlfs = NULL;
+    Ql_Log_Flash_Enable(1);
     
     return 0;
 }
@@ -128,20 +403,19 @@ int32_t Ql_FatFs_Mount_State(void)
     return 0;
 }
 
-static int32_t Ql_FatFs_Write_Internal(const char *path, const uint8_t *str, uint32_t len, uint32_t *file_size)
+/*****************************************************************************
+* @brief  Create every folder of path, the last component is a file name
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+int32_t Ql_FatFs_Mkdir_Path(const char *path)
 {
-    FIL *fp = NULL;
-    UINT ptr;
     char *folder;
     char *p = (char *)path;
-    
     FRESULT Res;
-    
-    if ((qlfs == NULL) || (path == NULL) || (str == NULL) || (len == 0))
-    {
-        return -1;
-    }
-    
+
     folder = pvPortMalloc(strlen(path) + 1);
     if (folder == NULL)
     {
@@ -149,10 +423,7 @@ static int32_t Ql_FatFs_Write_Internal(const char *path, const uint8_t *str, uin
         return -1;
     }
     memset(folder, 0, strlen(path) + 1);
-    
-    // Check the remaining SD card size
-    check_sd_remain_size();
-    
+
     // Create a folder if it does not exist
     for ( ; ; )
     {
@@ -174,13 +445,37 @@ static int32_t Ql_FatFs_Write_Internal(const char *path, const uint8_t *str, uin
             return -1;
         }
     }
+
+    vPortFree(folder);
+
+    return 0;
+}
+
+static int32_t Ql_FatFs_Write_Internal(const char *path, const uint8_t *str, uint32_t len, uint32_t *file_size)
+{
+    FIL *fp = NULL;
+    UINT ptr;
+    
+    FRESULT Res;
+    
+    if ((qlfs == NULL) || (path == NULL) || (str == NULL) || (len == 0))
+    {
+        return -1;
+    }
+    
+    // Check the remaining SD card size
+    check_sd_remain_size();
+    
+    if (Ql_FatFs_Mkdir_Path(path) != 0)
+    {
+        return -1;
+    }
     
     // append
     fp = (FIL *)pvPortMalloc(sizeof(FIL));
     if (fp == NULL)
     {
         QL_LOG_E("Ql_FatFs_Write, fp malloc fail. path: %s", path);
-        vPortFree(folder);
         return -1;
     }
     
@@ -190,7 +485,6 @@ static int32_t Ql_FatFs_Write_Internal(const char *path, const uint8_t *str, uin
     {
         QL_LOG_E("f_open fail, %d. path: %s", Res, path);
         vPortFree(fp);
-        vPortFree(folder);
         return -1;
     }
     
@@ -210,12 +504,10 @@ static int32_t Ql_FatFs_Write_Internal(const char *path, const uint8_t *str, uin
     {
         QL_LOG_E("f_close fail, %d. path: %s", Res, path);
         vPortFree(fp);
-        vPortFree(folder);
         return -1;
     }
     
     vPortFree(fp);
-    vPortFree(folder);
     
     return 0;
 }
@@ -247,26 +539,29 @@ uint32_t Ql_FatFs_GetTotal(void)
     return tot_size;
 }
 
+/*****************************************************************************
+* @brief  Free space in MB from the cluster count FatFs keeps
+* ex:
+* @par
+* 0 until the count after mount is done.
+* @retval
+*****************************************************************************/
 uint32_t Ql_FatFs_GetFree(void)
 {
     DWORD fre_clust;
-    DWORD fre_size;
-    FRESULT Res;
     
     if (qlfs == NULL)
     {
         return 0;
     }
     
-    Res = f_getfree( "1:", &fre_clust, &qlfs );
-    if (Res != FR_OK)
+    fre_clust = qlfs->free_clst;
+    if (fre_clust > (qlfs->n_fatent - 2))
     {
         return 0;
     }
     
-    fre_size = fre_clust * qlfs->csize / 2048;  // Mbyte
-    
-    return fre_size;
+    return fre_clust * qlfs->csize / 2048;  // Mbyte
 }
 
 char* Ql_FatFs_Size(void)
@@ -316,21 +611,68 @@ int Ql_FatFs_Format(void)
     return 0;
 }
 
+/*****************************************************************************
+* @brief  Report a change of the space level
+* ex:
+* @par
+* Only reads the cached cluster count, cheap enough for every write. The
+* callback and the warning come once per level change, not per write.
+* @retval
+*****************************************************************************/
 void check_sd_remain_size(void)
 {
     DWORD fre_size = 0;
+    uint8_t level = QL_SD_SPACE_OK;
+
+    if ((qlfs == NULL) || (qlfs->free_clst > (qlfs->n_fatent - 2)))
+    {
+        return;
+    }
 
     fre_size = Ql_FatFs_GetFree();
     if(fre_size < QL_SD_REMAIN_MINIMUM_SIZE / 4)
     {
-        QL_LOG_W("Insufficient remaining space: %d MB\r\n", fre_size);
+        level = QL_SD_SPACE_CRITICAL;
     }
     else if(fre_size < QL_SD_REMAIN_MINIMUM_SIZE)
     {
-        QL_LOG_W("Insufficient remaining space: %d MB\r\n", fre_size);
+        level = QL_SD_SPACE_LOW;
+    }
+
+    if (level == Ql_FatFs_Space_Level)
+    {
+        return;
+    }
+    Ql_FatFs_Space_Level = level;
+
+    if (level != QL_SD_SPACE_OK)
+    {
+        QL_LOG_W("Insufficient remaining space: %d MB", fre_size);
+    }
+
+    if (Ql_FatFs_Space_Cb != NULL)
+    {
+        Ql_FatFs_Space_Cb(level, fre_size);
     }
 }
 
+/*****************************************************************************
+* @brief  Ql_FatFs_GetFree() is valid, the count after mount is done
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+uint8_t Ql_FatFs_Free_Valid(void)
+{
+    return (qlfs != NULL) && (qlfs->free_clst <= (qlfs->n_fatent - 2));
+}
+
+void Ql_FatFs_Space_Cb_Register(void (*Cb)(uint8_t Level, uint32_t FreeMB))
+{
+    Ql_FatFs_Space_Cb = Cb;
+}
+
 int32_t Ql_FatFs_OpenFile(const char *pPath, FIL *pFP, uint16_t OpenFileType)
 {
     FRESULT file_res;
@@ -369,7 +711,7 @@ int32_t Ql_FatFs_OpenFile(const char *pPath, FIL *pFP, uint16_t OpenFileType)
     return 0;
 }
 
-int32_t Ql_FatFs_ReadFile(const FIL *pFP, uint8_t *pBuf, uint32_t Len, uint32_t *pBytesRead)
+int32_t Ql_FatFs_ReadFile(FIL *pFP, uint8_t *pBuf, uint32_t Len, uint32_t *pBytesRead)
 {
     FRESULT res;
 
@@ -377,7 +719,7 @@ int32_t Ql_FatFs_ReadFile(const FIL *pFP, uint8_t *pBuf, uint32_t Len, uint32_t
     {
         return -1;
     }
-    res = f_read(pFP, pBuf, Len, (UINT)pBytesRead);  
+    res = f_read(pFP, pBuf, Len, (UINT *)pBytesRead);  
     if (res != FR_OK) 
     {
         QL_LOG_E("%s, f_read fail, %d", __func__, res);
@@ -397,7 +739,139 @@ int32_t Ql_FatFs_ReadFileSize(const FIL *pFP)
     return f_size(pFP);
 }
 
-int32_t Ql_FatFs_CloseFile(const FIL *pFP)
+int32_t Ql_FatFs_WriteFile(FIL *pFP, const uint8_t *pBuf, uint32_t Len, uint32_t *pBytesWritten)
+{
+    FRESULT res;
+    UINT bw = 0;
+
+    if(pFP == NULL)
+    {
+        return -1;
+    }
+    res = f_write(pFP, pBuf, Len, &bw);
+    if (pBytesWritten != NULL)
+    {
+        *pBytesWritten = bw;
+    }
+    if ((res != FR_OK) || (bw != Len))
+    {
+        QL_LOG_E("%s, f_write fail, %d, %u/%u", __func__, res, bw, Len);
+        return -2;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Size and time stamp of a file, path without the drive as in
+*         Ql_FatFs_OpenFile
+* ex:
+* @par
+* None
+* @retval 0: ok; -2: no such file
+*****************************************************************************/
+int32_t Ql_FatFs_StatFile(const char *pPath, FILINFO *pInfo)
+{
+    FRESULT res;
+    char *path;
+
+    if ((qlfs == NULL) || (pPath == NULL) || (pInfo == NULL))
+    {
+        return -1;
+    }
+
+    path = pvPortMalloc(strlen(pPath) + 5);
+    if (path == NULL)
+    {
+        return -1;
+    }
+    sprintf(path, "1:%s", pPath);
+    res = f_stat(path, pInfo);
+    vPortFree(path);
+
+    return (res == FR_OK) ? 0 : -2;
+}
+
+int32_t Ql_FatFs_DeleteFile(const char *pPath)
+{
+    FRESULT res;
+    char *path;
+
+    if ((qlfs == NULL) || (pPath == NULL))
+    {
+        return -1;
+    }
+
+    path = pvPortMalloc(strlen(pPath) + 5);
+    if (path == NULL)
+    {
+        return -1;
+    }
+    sprintf(path, "1:%s", pPath);
+    res = f_unlink(path);
+    vPortFree(path);
+
+    return ((res == FR_OK) || (res == FR_NO_FILE)) ? 0 : -2;
+}
+
+/*****************************************************************************
+* @brief  Fast seek for a file opened for reading
+* ex:
+* @par
+* f_lseek and f_read look clusters up in pTbl instead of walking the FAT.
+* pTbl must stay valid while the file is open, the file must not grow.
+* TblLen QL_FF_FASTSEEK_CLMT_SIZE covers 31 fragments.
+* @retval 0: ok; -2: file too fragmented for TblLen
+*****************************************************************************/
+int32_t Ql_FatFs_FastSeek(FIL *pFP, DWORD *pTbl, uint32_t TblLen)
+{
+    FRESULT res;
+
+    if ((pFP == NULL) || (pTbl == NULL) || (TblLen < 4))
+    {
+        return -1;
+    }
+
+    pTbl[0] = TblLen;
+    pFP->cltbl = pTbl;
+    res = f_lseek(pFP, CREATE_LINKMAP);
+    if (res != FR_OK)
+    {
+        pFP->cltbl = NULL;
+        QL_LOG_E("%s, link map fail, %d, %u items needed", __func__, res, pTbl[0]);
+        return (res == FR_NOT_ENOUGH_CORE) ? -2 : -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Move the read/write pointer of an open file
+* ex:
+* @par
+* Ql_FatFs_SeekFile(&fp, 16 * 4096);
+* @retval 0: ok; -2: seek fail or Ofs past the end of a read only file
+*****************************************************************************/
+int32_t Ql_FatFs_SeekFile(FIL *pFP, uint32_t Ofs)
+{
+    FRESULT res;
+
+    if (pFP == NULL)
+    {
+        return -1;
+    }
+
+    res = f_lseek(pFP, Ofs);
+    if ((res != FR_OK) || (f_tell(pFP) != Ofs))
+    {
+        QL_LOG_E("%s, f_lseek fail, %d", __func__, res);
+        return -2;
+    }
+
+    return 0;
+}
+
+int32_t Ql_FatFs_CloseFile(FIL *pFP)
 {
     FRESULT res;
     //int32_t  ret_unmount = 0;
@@ -416,3 +890,766 @@ int32_t Ql_FatFs_CloseFile(const FIL *pFP)
 
     return 0;
 }
+
+/*****************************************************************************
+* @brief  Open path for appending and keep it open
+* ex:
+* @par
+* The folders are created and the free space is checked here once, not on
+* every write. SyncBytes / SyncMs select the sync policy, 0 disables one.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Stream_Open(Ql_FatFs_Stream_TypeDef *Stream, const char *path, uint32_t SyncBytes, uint32_t SyncMs)
+{
+    FRESULT Res;
+
+    if ((Stream == NULL) || (path == NULL) || (qlfs == NULL))
+    {
+        return -1;
+    }
+
+    memset(Stream, 0, sizeof(Ql_FatFs_Stream_TypeDef));
+
+    check_sd_remain_size();
+
+    if (Ql_FatFs_Mkdir_Path(path) != 0)
+    {
+        return -1;
+    }
+
+    Stream->Buf_Size = (uint32_t)qlfs->csize * FF_MAX_SS;
+    Stream->Buf_Size = (Stream->Buf_Size > QL_FF_STREAM_BUF_MAX) ? QL_FF_STREAM_BUF_MAX : Stream->Buf_Size;
+    Stream->Buf = pvPortMalloc(Stream->Buf_Size);
+    if (Stream->Buf == NULL)
+    {
+        QL_LOG_E("stream buf malloc fail. path: %s", path);
+        return -1;
+    }
+
+    Res = f_open(&Stream->File, path, FA_OPEN_APPEND | FA_WRITE);
+    if (Res != FR_OK)
+    {
+        QL_LOG_E("f_open fail, %d. path: %s", Res, path);
+        vPortFree(Stream->Buf);
+        Stream->Buf = NULL;
+        return -1;
+    }
+
+    Stream->Sync_Bytes = SyncBytes;
+    Stream->Sync_Ms    = SyncMs;
+    Stream->Sync_Tick  = xTaskGetTickCount();
+    Stream->Open       = 1;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Link map of the whole cluster chain, allocated but unwritten included
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Stream_Map(Ql_FatFs_Stream_TypeDef *Stream)
+{
+    FRESULT Res;
+
+    Stream->Clmt[0] = QL_FF_STREAM_CLMT_SIZE;
+    Stream->Clmt[1] = 0;
+    if (Stream->File.obj.sclust == 0)
+    {
+        return 0;
+    }
+
+    Stream->File.cltbl = Stream->Clmt;
+    Res = f_lseek(&Stream->File, CREATE_LINKMAP);
+    Stream->File.cltbl = NULL;
+    if (Res != FR_OK)
+    {
+        QL_LOG_E("link map fail, %d, %u items needed", Res, Stream->Clmt[0]);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Allocate Chunk steps until End bytes are allocated
+* ex:
+* @par
+* f_lseek past the end allocates the chain, the file size is set back to
+* what is written. FatFs follows the existing chain when it appends later.
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Stream_Extend(Ql_FatFs_Stream_TypeDef *Stream, uint32_t End)
+{
+    const FSIZE_t size = f_size(&Stream->File);
+    uint32_t alloc = Stream->Alloc;
+    FRESULT Res;
+
+    while (alloc < End)
+    {
+        alloc += Stream->Chunk;
+    }
+
+    Res = f_lseek(&Stream->File, alloc);
+    Stream->File.obj.objsize = size;
+    if ((Res != FR_OK) || (f_tell(&Stream->File) != alloc))
+    {
+        QL_LOG_E("extend to %u fail, %d", alloc, Res);
+        return -1;
+    }
+    Stream->Alloc = alloc;
+    check_sd_remain_size();
+
+    /* A journal commit may only refer to clusters the FAT holds already */
+    if (Stream->Journal_On && (f_sync(&Stream->File) != FR_OK))
+    {
+        return -1;
+    }
+
+    return Ql_FatFs_Stream_Map(Stream);
+}
+
+/*****************************************************************************
+* @brief  Sector IO at file offset Ofs through the link map
+* ex:
+* @par
+* Holds the volume lock of FatFs, the card driver is not reentrant.
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Stream_Raw_IO(Ql_FatFs_Stream_TypeDef *Stream, uint8_t *Buf, uint32_t Ofs,
+                                      uint32_t Count, uint8_t Write)
+{
+    FATFS *fs = Stream->File.obj.fs;
+    const DWORD *tbl;
+    DWORD sect;
+    DWORD cl;
+    DWORD run;
+    DRESULT res = RES_OK;
+
+    if (!ff_mutex_take(fs->ldrv))
+    {
+        return -1;
+    }
+
+    while ((Count > 0) && (res == RES_OK))
+    {
+        sect = Ofs / FF_MAX_SS;
+        cl = sect / fs->csize;
+        for (tbl = Stream->Clmt + 1; (tbl[0] != 0) && (cl >= tbl[0]); tbl += 2)
+        {
+            cl -= tbl[0];
+        }
+        if (tbl[0] == 0)
+        {
+            res = RES_PARERR;
+            break;
+        }
+
+        run  = (tbl[0] - cl) * fs->csize - (sect % fs->csize);
+        run  = (run > Count) ? Count : run;
+        sect = fs->database + (tbl[1] - 2 + cl) * fs->csize + (sect % fs->csize);
+        res  = Write ? disk_write(fs->pdrv, Buf, sect, run) : disk_read(fs->pdrv, Buf, sect, run);
+
+        Buf   += run * FF_MAX_SS;
+        Ofs   += run * FF_MAX_SS;
+        Count -= run;
+    }
+
+    ff_mutex_give(fs->ldrv);
+
+    if (res != RES_OK)
+    {
+        QL_LOG_E("raw %s fail, %d", Write ? "write" : "read", res);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Contiguous mode flush, Len bytes of the buffer at Raw_Pos
+* ex:
+* @par
+* A partial last sector is written padded and stays in the buffer, the
+* next flush writes it again.
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Stream_Raw_Flush(Ql_FatFs_Stream_TypeDef *Stream, uint32_t Len)
+{
+    const uint32_t count = (Len + FF_MAX_SS - 1) / FF_MAX_SS;
+    const uint32_t full = Len & ~(FF_MAX_SS - 1);
+
+    if (((Stream->Raw_Pos + count * FF_MAX_SS) > Stream->Alloc) &&
+        (Ql_FatFs_Stream_Extend(Stream, Stream->Raw_Pos + count * FF_MAX_SS) != 0))
+    {
+        return -1;
+    }
+
+    if (Ql_FatFs_Stream_Raw_IO(Stream, Stream->Buf, Stream->Raw_Pos, count, 1) != 0)
+    {
+        return -1;
+    }
+
+    Stream->File.obj.objsize = Stream->Raw_Pos + Len;
+    Stream->File.flag |= QL_FF_FA_MODIFIED;
+
+    Stream->Raw_Pos  += full;
+    Stream->Buf_Len  -= full;
+    Stream->Unsynced += full;
+    if (Stream->Buf_Len > 0)
+    {
+        memmove(Stream->Buf, Stream->Buf + full, Stream->Buf_Len);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Commit everything written so far to the journal
+* ex:
+* @par
+* The buffer goes to the card first, a partial sector padded.
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Stream_Journal_Commit(Ql_FatFs_Stream_TypeDef *Stream)
+{
+    if ((Stream->Buf_Len > 0) && (Ql_FatFs_Stream_Raw_Flush(Stream, Stream->Buf_Len) != 0))
+    {
+        return -1;
+    }
+
+    if (Ql_FatFs_Journal_Commit(Stream->Journal_Slot, Stream->File.obj.sclust, Stream->Raw_Pos + Stream->Buf_Len) != 0)
+    {
+        return -1;
+    }
+
+    Stream->Journal_Pos  = Stream->Raw_Pos + Stream->Buf_Len;
+    Stream->Journal_Tick = xTaskGetTickCount();
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Journal a contiguous stream
+* ex:
+* @par
+* Data is committed to the journal once LossBytes are uncommitted or LossMs
+* have passed since the last commit, checked on every write. A commit is
+* one sector write, f_sync stays on the Sync_Bytes / Sync_Ms policy and can
+* be set far apart. After a power loss Ql_FatFs_Mount() restores the size
+* of the last commit. path is the one the stream was opened with.
+* @retval 0: ok, -1: not contiguous or no journal slot, the stream runs on
+*         as before
+*****************************************************************************/
+int32_t Ql_FatFs_Stream_Journal(Ql_FatFs_Stream_TypeDef *Stream, const char *path, uint32_t LossBytes, uint32_t LossMs)
+{
+    if ((Stream == NULL) || (Stream->Open == 0) || (Stream->Contig == 0) || Stream->Journal_On)
+    {
+        return -1;
+    }
+
+    Stream->Journal_Slot = Ql_FatFs_Journal_Open(path);
+    if (Stream->Journal_Slot < 0)
+    {
+        return -1;
+    }
+
+    /* The start cluster and the allocation have to be on the card */
+    if (f_sync(&Stream->File) != FR_OK)
+    {
+        Ql_FatFs_Journal_Close(Stream->Journal_Slot);
+        return -1;
+    }
+
+    Stream->Journal_On    = 1;
+    Stream->Journal_Bytes = LossBytes;
+    Stream->Journal_Ms    = LossMs;
+    Stream->Journal_Pos   = Stream->Raw_Pos + Stream->Buf_Len;
+    Stream->Journal_Tick  = xTaskGetTickCount();
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Open path for appending in contiguous mode
+* ex:
+* @par
+* An empty file gets Chunk bytes in one contiguous extent with f_expand.
+* Later chunks, or all of them when the card has no contiguous area left,
+* are allocated with f_lseek. The buffer goes to the card with
+* disk_write, FatFs only updates the directory entry on sync.
+* Use Ql_FatFs_Stream_Close(), it releases the unused allocation.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Stream_Open_Contig(Ql_FatFs_Stream_TypeDef *Stream, const char *path, uint32_t Chunk,
+                                    uint32_t SyncBytes, uint32_t SyncMs)
+{
+    uint32_t clust;
+    FSIZE_t size;
+    FRESULT Res;
+
+    if ((Chunk == 0) || (Ql_FatFs_Stream_Open(Stream, path, SyncBytes, SyncMs) != 0))
+    {
+        return -1;
+    }
+
+    clust = (uint32_t)qlfs->csize * FF_MAX_SS;
+    size = f_size(&Stream->File);
+    Stream->Chunk  = (Chunk + clust - 1) / clust * clust;
+    Stream->Alloc  = (size + clust - 1) / clust * clust;
+    Stream->Contig = 1;
+
+    if (size == 0)
+    {
+        Res = f_expand(&Stream->File, Stream->Chunk, 1);
+        if (Res == FR_OK)
+        {
+            Stream->File.obj.objsize = 0;
+            Stream->Alloc = Stream->Chunk;
+        }
+        else if (Res == FR_DENIED)
+        {
+            QL_LOG_W("no contiguous %u bytes. path: %s", Stream->Chunk, path);
+        }
+        else
+        {
+            QL_LOG_E("f_expand fail, %d. path: %s", Res, path);
+            goto err;
+        }
+    }
+
+    if (Ql_FatFs_Stream_Map(Stream) != 0)
+    {
+        goto err;
+    }
+
+    /* The partial last sector is read back and written again with the next block */
+    Stream->Raw_Pos = size & ~(FF_MAX_SS - 1);
+    Stream->Buf_Len = size - Stream->Raw_Pos;
+    if ((Stream->Buf_Len > 0) && (Ql_FatFs_Stream_Raw_IO(Stream, Stream->Buf, Stream->Raw_Pos, 1, 0) != 0))
+    {
+        goto err;
+    }
+
+    return 0;
+
+err:
+    f_close(&Stream->File);
+    vPortFree(Stream->Buf);
+    Stream->Buf  = NULL;
+    Stream->Open = 0;
+
+    return -1;
+}
+
+/*****************************************************************************
+* @brief  Write the first Len bytes of the buffer
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+static int32_t Ql_FatFs_Stream_Flush(Ql_FatFs_Stream_TypeDef *Stream, uint32_t Len)
+{
+    FRESULT Res;
+    UINT bw;
+
+    if (Stream->Contig)
+    {
+        return Ql_FatFs_Stream_Raw_Flush(Stream, Len);
+    }
+
+    Res = f_write(&Stream->File, Stream->Buf, Len, &bw);
+    if ((Res != FR_OK) || (bw != Len))
+    {
+        QL_LOG_E("f_write fail, %d, %u/%u", Res, bw, Len);
+        return -1;
+    }
+
+    Stream->Buf_Len  -= Len;
+    Stream->Unsynced += Len;
+    check_sd_remain_size();
+    if (Stream->Buf_Len > 0)
+    {
+        memmove(Stream->Buf, Stream->Buf + Len, Stream->Buf_Len);
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Append data
+* ex:
+* @par
+* f_write is only called once the data reaches the next Buf_Size boundary
+* of the file, so FatFs transfers whole sectors straight from the buffer.
+* The byte policy syncs what is written already, the time policy writes
+* the partial buffer too; the next block then realigns the file.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Stream_Write(Ql_FatFs_Stream_TypeDef *Stream, const uint8_t *str, uint32_t len)
+{
+    uint32_t chunk;
+    uint32_t n;
+
+    if ((Stream == NULL) || (Stream->Open == 0) || (str == NULL))
+    {
+        return -1;
+    }
+
+    while (len > 0)
+    {
+        n = Stream->Buf_Size - Stream->Buf_Len;
+        n = (n > len) ? len : n;
+        memcpy(Stream->Buf + Stream->Buf_Len, str, n);
+        Stream->Buf_Len += n;
+        str += n;
+        len -= n;
+
+        chunk = Stream->Contig ? Stream->Raw_Pos : f_tell(&Stream->File);
+        chunk = Stream->Buf_Size - (chunk % Stream->Buf_Size);
+        if ((Stream->Buf_Len >= chunk) && (Ql_FatFs_Stream_Flush(Stream, chunk) != 0))
+        {
+            return -1;
+        }
+    }
+
+    if ((Stream->Sync_Ms != 0) && ((xTaskGetTickCount() - Stream->Sync_Tick) >= pdMS_TO_TICKS(Stream->Sync_Ms)))
+    {
+        return Ql_FatFs_Stream_Sync(Stream);
+    }
+
+    if (Stream->Journal_On)
+    {
+        const uint32_t lost = Stream->Raw_Pos + Stream->Buf_Len - Stream->Journal_Pos;
+
+        if ((lost > 0) &&
+            (((Stream->Journal_Bytes != 0) && (lost >= Stream->Journal_Bytes)) ||
+             ((Stream->Journal_Ms != 0) && ((xTaskGetTickCount() - Stream->Journal_Tick) >= pdMS_TO_TICKS(Stream->Journal_Ms)))) &&
+            (Ql_FatFs_Stream_Journal_Commit(Stream) != 0))
+        {
+            return -1;
+        }
+    }
+
+    if ((Stream->Sync_Bytes != 0) && (Stream->Unsynced >= Stream->Sync_Bytes))
+    {
+        if (f_sync(&Stream->File) != FR_OK)
+        {
+            return -1;
+        }
+        Stream->Unsynced = 0;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Write the buffer and update the directory entry
+* ex:
+* @par
+* None
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_FatFs_Stream_Sync(Ql_FatFs_Stream_TypeDef *Stream)
+{
+    FRESULT Res;
+
+    if ((Stream == NULL) || (Stream->Open == 0))
+    {
+        return -1;
+    }
+
+    if ((Stream->Buf_Len > 0) && (Ql_FatFs_Stream_Flush(Stream, Stream->Buf_Len) != 0))
+    {
+        return -1;
+    }
+
+    Stream->Sync_Tick = xTaskGetTickCount();
+    Stream->Unsynced  = 0;
+
+    Res = f_sync(&Stream->File);
+    if (Res != FR_OK)
+    {
+        QL_LOG_E("f_sync fail, %d", Res);
+        return -1;
+    }
+
+    /* The directory entry holds it all now */
+    if (Stream->Journal_On)
+    {
+        Stream->Journal_Pos  = Stream->Raw_Pos + Stream->Buf_Len;
+        Stream->Journal_Tick = Stream->Sync_Tick;
+    }
+
+    return 0;
+}
+
+int32_t Ql_FatFs_Stream_Close(Ql_FatFs_Stream_TypeDef *Stream)
+{
+    int32_t ret;
+
+    if ((Stream == NULL) || (Stream->Open == 0))
+    {
+        return -1;
+    }
+
+    ret = Ql_FatFs_Stream_Sync(Stream);
+
+    /* Released once the directory entry holds the size, before the tail of
+       the chain is freed. A failed sync keeps the slot for the replay. */
+    if (Stream->Journal_On && (ret == 0))
+    {
+        Ql_FatFs_Journal_Close(Stream->Journal_Slot);
+    }
+    Stream->Journal_On = 0;
+
+    /* Give the unused part of the allocation back */
+    if (Stream->Contig && (Stream->Alloc > f_size(&Stream->File)))
+    {
+        const FSIZE_t size = f_size(&Stream->File);
+
+        Stream->File.obj.objsize = Stream->Alloc;
+        if ((f_lseek(&Stream->File, size) != FR_OK) || (f_truncate(&Stream->File) != FR_OK))
+        {
+            ret = -1;
+        }
+    }
+
+    if (f_close(&Stream->File) != FR_OK)
+    {
+        ret = -1;
+    }
+
+    vPortFree(Stream->Buf);
+    Stream->Buf  = NULL;
+    Stream->Open = 0;
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  File size including the data still buffered
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+uint32_t Ql_FatFs_Stream_Size(const Ql_FatFs_Stream_TypeDef *Stream)
+{
+    if ((Stream == NULL) || (Stream->Open == 0))
+    {
+        return 0;
+    }
+
+    if (Stream->Contig)
+    {
+        return Stream->Raw_Pos + Stream->Buf_Len;
+    }
+
+    return f_size(&Stream->File) + Stream->Buf_Len;
+}
+
+/*****************************************************************************
+* @brief  Ql_FatFs_Write against the stream writer on the mounted card
+* ex:
+* @par
+* Writes count blocks of len bytes to path with Ql_FatFs_Write, the stream
+* writer and the contiguous stream, then times random seeks in the last
+* file with and without the link map. The file is deleted afterwards.
+* Per call latency from the DWT cycle counter.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Stream_Bench(const char *path, uint32_t len, uint32_t count)
+{
+    static const char *name[3] = { "Ql_FatFs_Write", "stream", "contig stream" };
+    static Ql_FatFs_Stream_TypeDef stream;
+    static DWORD clmt[QL_FF_FASTSEEK_CLMT_SIZE];
+    const uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    uint32_t sum[3] = { 0 };
+    uint32_t max[3] = { 0 };
+    uint32_t ms[3];
+    uint32_t seek_us[2] = { 0 };
+    uint32_t start;
+    uint32_t us;
+    uint32_t tick;
+    uint32_t seed = 1;
+    FSIZE_t size;
+    uint8_t *data;
+    int32_t ret;
+
+    data = pvPortMalloc(len);
+    if ((data == NULL) || (count == 0))
+    {
+        vPortFree(data);
+        return;
+    }
+    memset(data, 'Q', len);
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint8_t m = 0; m < 3; m++)
+    {
+        f_unlink(path);
+        tick = xTaskGetTickCount();
+        if (m == 0)
+        {
+            ret = 0;
+        }
+        else if (m == 1)
+        {
+            ret = Ql_FatFs_Stream_Open(&stream, path, QL_FF_STREAM_SYNC_BYTES, QL_FF_STREAM_SYNC_MS);
+        }
+        else
+        {
+            ret = Ql_FatFs_Stream_Open_Contig(&stream, path, QL_FF_STREAM_CHUNK, QL_FF_STREAM_SYNC_BYTES, QL_FF_STREAM_SYNC_MS);
+        }
+
+        for (uint32_t i = 0; (i < count) && (ret == 0); i++)
+        {
+            start = DWT->CYCCNT;
+            ret = (m == 0) ? Ql_FatFs_Write(path, data, len, NULL) : Ql_FatFs_Stream_Write(&stream, data, len);
+            us = (DWT->CYCCNT - start) / cycles_per_us;
+            sum[m] += us;
+            max[m]  = (us > max[m]) ? us : max[m];
+        }
+
+        if (m != 0)
+        {
+            Ql_FatFs_Stream_Close(&stream);
+        }
+        ms[m] = (xTaskGetTickCount() - tick) * portTICK_PERIOD_MS;
+    }
+
+    /* 32 random seeks, each followed by a one byte read */
+    if (f_open(&stream.File, path, FA_READ) == FR_OK)
+    {
+        size = f_size(&stream.File);
+        for (uint8_t m = 0; (m < 2) && (size > 0); m++)
+        {
+            if ((m == 1) && (Ql_FatFs_FastSeek(&stream.File, clmt, QL_FF_FASTSEEK_CLMT_SIZE) != 0))
+            {
+                break;
+            }
+
+            start = DWT->CYCCNT;
+            for (uint32_t i = 0; i < 32; i++)
+            {
+                UINT br;
+
+                seed = seed * 1103515245 + 12345;
+                f_lseek(&stream.File, seed % size);
+                f_read(&stream.File, data, 1, &br);
+            }
+            seek_us[m] = (DWT->CYCCNT - start) / cycles_per_us / 32;
+        }
+        f_close(&stream.File);
+    }
+    f_unlink(path);
+
+    vPortFree(data);
+
+    for (uint8_t m = 0; m < 3; m++)
+    {
+        QL_LOG_I("%s: %u x %u bytes, avg %u us max %u us per call, %u KB/s",
+                 name[m], count, len, sum[m] / count, max[m],
+                 (ms[m] == 0) ? 0 : (uint32_t)(((uint64_t)len * count * 1000 / 1024) / ms[m]));
+    }
+    QL_LOG_I("seek + read: %u us FAT walk, %u us link map", seek_us[0], seek_us[1]);
+}
+
+/*****************************************************************************
+* @brief  Raw card throughput, single block against multi block transfers
+* ex:
+* @par
+* Preallocates Sectors sectors contiguously at path and times disk_write and
+* disk_read on them below FatFs, one sector per call and
+* QL_FF_DISK_BENCH_BURST sectors per call. Writes include the final
+* CTRL_SYNC, the card programming time counts. Holds the volume lock of
+* FatFs meanwhile; the file is deleted afterwards.
+* @retval
+*****************************************************************************/
+void Ql_FatFs_Disk_Bench(const char *path, uint32_t Sectors)
+{
+    static const char *name[4] = { "write single", "write multi", "read single", "read multi" };
+    static FIL file;
+    uint32_t us[4] = { 0 };
+    SD_BusInfo bus;
+    FATFS *fs;
+    LBA_t first;
+    uint32_t start;
+    uint32_t step;
+    uint8_t *data;
+    DRESULT res = RES_OK;
+
+    Sectors -= Sectors % QL_FF_DISK_BENCH_BURST;
+    data = pvPortMalloc(QL_FF_DISK_BENCH_BURST * FF_MAX_SS);
+    if ((data == NULL) || (Sectors == 0))
+    {
+        vPortFree(data);
+        return;
+    }
+    memset(data, 'Q', QL_FF_DISK_BENCH_BURST * FF_MAX_SS);
+
+    f_unlink(path);
+    if (f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE | FA_READ) != FR_OK)
+    {
+        vPortFree(data);
+        return;
+    }
+    if (f_expand(&file, (FSIZE_t)Sectors * FF_MAX_SS, 1) != FR_OK)
+    {
+        QL_LOG_E("disk bench, no %u contiguous sectors", Sectors);
+        f_close(&file);
+        f_unlink(path);
+        vPortFree(data);
+        return;
+    }
+
+    fs    = file.obj.fs;
+    first = fs->database + (LBA_t)(file.obj.sclust - 2) * fs->csize;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    if (ff_mutex_take(fs->ldrv))
+    {
+        for (uint8_t m = 0; (m < 4) && (res == RES_OK); m++)
+        {
+            step  = (m & 1) ? QL_FF_DISK_BENCH_BURST : 1;
+            start = DWT->CYCCNT;
+            for (uint32_t i = 0; (i < Sectors) && (res == RES_OK); i += step)
+            {
+                res = (m < 2) ? disk_write(fs->pdrv, data, first + i, step) : disk_read(fs->pdrv, data, first + i, step);
+            }
+            if ((m < 2) && (res == RES_OK))
+            {
+                res = disk_ioctl(fs->pdrv, CTRL_SYNC, NULL);
+            }
+            us[m] = (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+        }
+        ff_mutex_give(fs->ldrv);
+    }
+
+    f_close(&file);
+    f_unlink(path);
+    vPortFree(data);
+
+    if (res != RES_OK)
+    {
+        QL_LOG_E("disk bench fail, %d", res);
+        return;
+    }
+
+    SD_GetBusInfo(&bus);
+    QL_LOG_I("sd bus %u bit, %s speed, %u kHz", bus.BusWidth, bus.HighSpeed ? "high" : "default", bus.ClockKHz);
+    for (uint8_t m = 0; m < 4; m++)
+    {
+        QL_LOG_I("%s: %u sectors, %u per call, %u us, %u KB/s", name[m], Sectors,
+                 (m & 1) ? QL_FF_DISK_BENCH_BURST : 1, us[m],
+                 (us[m] == 0) ? 0 : (uint32_t)((uint64_t)Sectors * FF_MAX_SS * 1000000 / 1024 / us[m]));
+    }
+}
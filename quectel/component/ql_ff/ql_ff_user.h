@@ -30,6 +30,11 @@ limitations under the License.
 //#define QL_SD_REMAIN_MINIMUM_SIZE1  (4096)  // MB
 //#define QL_SD_REMAIN_MINIMUM_SIZE2  (2048)  // MB
 
+/* Space levels, reported through the callback when they change */
+#define QL_SD_SPACE_OK              (0U)
+#define QL_SD_SPACE_LOW             (1U)    // < QL_SD_REMAIN_MINIMUM_SIZE
+#define QL_SD_SPACE_CRITICAL        (2U)    // < QL_SD_REMAIN_MINIMUM_SIZE / 4
+
 //extern const char tempLOG[];
 extern const char tempHCN[];
 //extern const char tempRAW[];
@@ -42,21 +47,85 @@ extern const char tempHCN[];
 #define	QL_FILE_OPEN_ALWAYS		0x10
 #define	QL_FILE_OPEN_APPEND		0x30
 
+/* Stream writer: the file stays open, data is collected in a buffer of
+   QL_FF_STREAM_BUF_MAX or one cluster, whichever is smaller, and written as
+   whole sectors at sector aligned file offsets */
+#define QL_FF_STREAM_BUF_MAX        (8U * 1024U)
+#define QL_FF_STREAM_SYNC_BYTES     (64U * 1024U)   // default policy, 0: never by size
+#define QL_FF_STREAM_SYNC_MS        (5000U)         // default policy, 0: never by time
+
+/* Contiguous mode: the file is allocated Chunk bytes ahead with f_expand or
+   f_lseek, data goes straight to the sectors found in the link map */
+#define QL_FF_STREAM_CHUNK          (4U * 1024U * 1024U)
+#define QL_FF_STREAM_CLMT_SIZE      (32U)       // link map items, (32 - 2) / 2 fragments
+#define QL_FF_FASTSEEK_CLMT_SIZE    (64U)
+#define QL_FF_DISK_BENCH_BURST      (32U)       // sectors per multi block call of Ql_FatFs_Disk_Bench
+
+/* Free cluster count after mount: FAT sectors read per hold of the volume
+   lock, and rounds of recounting written slices before the last round is
+   done in one hold */
+#define QL_FF_FREE_SLICE            (16U)
+#define QL_FF_FREE_ROUNDS           (4U)
+
+typedef struct
+{
+    FIL         File;
+    uint8_t     Open;
+    uint8_t    *Buf;
+    uint32_t    Buf_Size;       // multiple of FF_MAX_SS
+    uint32_t    Buf_Len;
+    uint32_t    Sync_Bytes;     // f_sync after this many bytes written
+    uint32_t    Sync_Ms;        // or this long after the last sync
+    uint32_t    Unsynced;
+    uint32_t    Sync_Tick;
+    uint8_t     Contig;
+    uint32_t    Chunk;
+    uint32_t    Alloc;          // bytes allocated to the file, the size is only what is written
+    uint32_t    Raw_Pos;        // sector aligned file offset of Buf[0]
+    DWORD       Clmt[QL_FF_STREAM_CLMT_SIZE];
+    uint8_t     Journal_On;     // contiguous mode only, see ql_ff_journal.h
+    int32_t     Journal_Slot;
+    uint32_t    Journal_Bytes;  // most bytes lost on power loss, 0: no limit
+    uint32_t    Journal_Ms;     // most time lost on power loss, 0: no limit
+    uint32_t    Journal_Pos;    // committed size
+    uint32_t    Journal_Tick;
+} Ql_FatFs_Stream_TypeDef;
+
 int32_t  Ql_FatFs_Mount(void);
 int32_t  Ql_FatFs_UnMount(void);
 int32_t  Ql_FatFs_Mount_State(void);
 int32_t  Ql_FatFs_Write(const char *path, const uint8_t *str, uint32_t len,  uint32_t *file_size);
 uint32_t Ql_FatFs_GetTotal(void);
 uint32_t Ql_FatFs_GetFree(void);
+void     Ql_FatFs_Free_Touch(LBA_t Sector, UINT Count);
 char* Ql_FatFs_Size(void);
 int Ql_FatFs_Format(void);
 
 int32_t Ql_FatFs_OpenFile(const char *pPath, FIL *pFP, uint16_t OpenFileType);
-int32_t Ql_FatFs_ReadFile(const FIL *pFP, uint8_t *pBuf, uint32_t Len, uint32_t *pBytesRead);
+int32_t Ql_FatFs_ReadFile(FIL *pFP, uint8_t *pBuf, uint32_t Len, uint32_t *pBytesRead);
 int32_t Ql_FatFs_ReadFileSize(const FIL *pFP);
-int32_t Ql_FatFs_CloseFile(const FIL *pFP);
+int32_t Ql_FatFs_WriteFile(FIL *pFP, const uint8_t *pBuf, uint32_t Len, uint32_t *pBytesWritten);
+int32_t Ql_FatFs_StatFile(const char *pPath, FILINFO *pInfo);
+int32_t Ql_FatFs_DeleteFile(const char *pPath);
+int32_t Ql_FatFs_SeekFile(FIL *pFP, uint32_t Ofs);
+int32_t Ql_FatFs_CloseFile(FIL *pFP);
+int32_t Ql_FatFs_FastSeek(FIL *pFP, DWORD *pTbl, uint32_t TblLen);
+
+int32_t Ql_FatFs_Stream_Open(Ql_FatFs_Stream_TypeDef *Stream, const char *path, uint32_t SyncBytes, uint32_t SyncMs);
+int32_t Ql_FatFs_Stream_Open_Contig(Ql_FatFs_Stream_TypeDef *Stream, const char *path, uint32_t Chunk,
+                                    uint32_t SyncBytes, uint32_t SyncMs);
+int32_t Ql_FatFs_Stream_Journal(Ql_FatFs_Stream_TypeDef *Stream, const char *path, uint32_t LossBytes, uint32_t LossMs);
+int32_t Ql_FatFs_Stream_Write(Ql_FatFs_Stream_TypeDef *Stream, const uint8_t *str, uint32_t len);
+int32_t Ql_FatFs_Stream_Sync(Ql_FatFs_Stream_TypeDef *Stream);
+int32_t Ql_FatFs_Stream_Close(Ql_FatFs_Stream_TypeDef *Stream);
+uint32_t Ql_FatFs_Stream_Size(const Ql_FatFs_Stream_TypeDef *Stream);
+void    Ql_FatFs_Stream_Bench(const char *path, uint32_t len, uint32_t count);
+void    Ql_FatFs_Disk_Bench(const char *path, uint32_t Sectors);
 
 
 void check_sd_remain_size(void);
+void Ql_FatFs_Space_Cb_Register(void (*Cb)(uint8_t Level, uint32_t FreeMB));
+uint8_t Ql_FatFs_Free_Valid(void);
+int32_t Ql_FatFs_Mkdir_Path(const char *path);
 
 #endif
@@ -0,0 +1,1014 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_fwupg.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "ql_fwupg.h"
+#include "ql_check.h"
+
+#define LOG_TAG "fwupg"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+typedef struct
+{
+    uint32_t    Magic;
+    uint32_t    File_Size;
+    uint32_t    Size;           // bytes sent, the CRC covers the padding
+    uint16_t    File_Date;      // of the image, a copied file gets a new one
+    uint16_t    File_Time;
+    uint32_t    Image_Crc;
+    uint32_t    Crc;            // over the fields above
+} Ql_FwUpg_Crc_Cache_TypeDef;
+
+typedef struct
+{
+    uint32_t    Length;         // bytes read, less than a block at the end of the file
+    int32_t     Result;         // of Ql_FatFs_ReadFile
+    uint8_t     Data[QL_FWUPG_HEAD_ROOM + QL_FWUPG_BLOCK_MAX + QL_FWUPG_TAIL_ROOM];
+} Ql_FwUpg_Block_TypeDef;
+
+typedef struct
+{
+    FIL                *Fp;
+    uint32_t            Block_Size;
+    QueueHandle_t       Free;   // blocks for the reader
+    QueueHandle_t       Full;   // blocks for the sender, in file order
+    SemaphoreHandle_t   Done;   // given when the reader task ends
+    volatile uint8_t    Stop;
+} Ql_FwUpg_Pipe_TypeDef;
+
+static Ql_FwUpg_Block_TypeDef FwUpg_Blocks[QL_FWUPG_PIPE_DEPTH];
+static Ql_FwUpg_Pipe_TypeDef FwUpg_Pipe;
+static char FwUpg_Cache_Path[QL_FWUPG_PATH_MAX + sizeof(QL_FWUPG_CRC_SUFFIX)];
+static char FwUpg_Ckpt_Path[QL_FWUPG_PATH_MAX + sizeof(QL_FWUPG_CKPT_NAME)];
+
+#define QL_FWUPG_MS(ticks)          ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+#define QL_FWUPG_BLOCK_DATA(b)      ((b)->Data + QL_FWUPG_HEAD_ROOM)
+#define QL_FWUPG_CACHE_CRC_LEN      (sizeof(Ql_FwUpg_Crc_Cache_TypeDef) - 4U)
+#define QL_FWUPG_CKPT_CRC_LEN       (sizeof(Ql_FwUpg_Ckpt_TypeDef) - 4U)
+
+/*****************************************************************************
+* @brief  Send to the module, cut into segments of the protocol
+* ex:
+* @par
+* The protocol gap follows every segment, the bootloaders need it to move
+* the bytes out of their I2C buffer.
+* @retval 0: ok, -1: transport error
+*****************************************************************************/
+int32_t Ql_FwUpg_Send(Ql_FwUpg_Ctx_TypeDef *Ctx, const uint8_t *Data, uint32_t Len)
+{
+    const uint32_t segment = (Ctx->Proto->Segment != 0) ? Ctx->Proto->Segment : Len;
+    uint32_t sent = 0;
+    uint32_t n;
+
+    while (sent < Len)
+    {
+        n = ((Len - sent) > segment) ? segment : (Len - sent);
+        if (Ctx->Bus->Write(Ctx->Bus->Port, Data + sent, n) != 0)
+        {
+            Ctx->Stats.Bus_Errors++;
+            return -1;
+        }
+        Ctx->Stats.Bus_Writes++;
+        Ctx->Stats.Bus_Bytes += n;
+        sent += n;
+
+        if (Ctx->Proto->Gap != 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(Ctx->Proto->Gap));
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Receive Len bytes from the module
+* ex:
+* @par
+* None
+* @retval 0: ok, -1: transport error or timeout
+*****************************************************************************/
+int32_t Ql_FwUpg_Recv(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t *Data, uint32_t Len, uint32_t Timeout)
+{
+    if (Ctx->Bus->Read(Ctx->Bus->Port, Data, Len, Timeout) != 0)
+    {
+        Ctx->Stats.Bus_Errors++;
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Log the progress in steps of Step percent
+* ex:
+* @par
+* Shown holds the last percentage logged, 0 before the first call.
+* @retval None
+*****************************************************************************/
+void Ql_FwUpg_Progress(const char *What, uint32_t Done, uint32_t Total, uint8_t *Shown, uint8_t Step)
+{
+    uint32_t percent = (Total == 0) ? 100 : (uint32_t)(((uint64_t)Done * 100) / Total);
+
+    if ((percent > *Shown) && (*Shown < 100))
+    {
+        percent = *Shown + ((percent - *Shown) / Step + 1) * Step;
+        *Shown = (percent >= 100) ? 100 : (uint8_t)percent;
+        QL_LOG_I("%s progress: %02d%%", What, *Shown);
+    }
+}
+
+/*****************************************************************************
+* @brief  Read the images from the cfg file of the fw package
+* ex:
+* @par
+* Every "rom:" entry needs file, name and begin_address. An optional crc32
+* line saves reading the image for the image CRC.
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+int32_t Ql_FwUpg_Load_Cfg(const char *Dir, Ql_FwUpg_Image_TypeDef *Images, uint32_t Max, uint32_t *Count)
+{
+    char path[QL_FWUPG_PATH_MAX];
+    char *buffer = NULL;
+    char *start;
+    char *next;
+    char *file;
+    char *name;
+    char *addr;
+    char *crc;
+    uint32_t size;
+    uint32_t read_length = 0;
+    int32_t ret = 0;
+    FIL fp;
+
+    *Count = 0;
+    snprintf(path, sizeof(path), "%s%s", Dir, QL_FWUPG_CFG_NAME);
+    if (Ql_FatFs_OpenFile(path, &fp, QL_FILE_READ) != 0)
+    {
+        QL_LOG_E("open %s fail", path);
+        return -1;
+    }
+
+    size = Ql_FatFs_ReadFileSize(&fp);
+    buffer = pvPortMalloc(size + 1);
+    if (buffer == NULL)
+    {
+        Ql_FatFs_CloseFile(&fp);
+        return -2;
+    }
+    if ((Ql_FatFs_ReadFile(&fp, (uint8_t *)buffer, size, &read_length) != 0) || (read_length != size))
+    {
+        ret = -3;
+        goto END;
+    }
+    buffer[size] = '\0';
+
+    start = buffer;
+    while ((start = strstr(start, "rom:")) != NULL)
+    {
+        start += strlen("rom:");
+        if (*Count >= Max)
+        {
+            QL_LOG_W("more than %d images in %s", Max, path);
+            break;
+        }
+
+        next = strstr(start, "rom:");
+        file = strstr(start, "file: ");
+        name = strstr(start, "name: ");
+        addr = strstr(start, "begin_address: ");
+        crc  = strstr(start, "crc32: ");
+        if ((file == NULL) || (name == NULL) || (addr == NULL))
+        {
+            ret = -4;
+            goto END;
+        }
+
+        memset(&Images[*Count], 0, sizeof(Ql_FwUpg_Image_TypeDef));
+        sscanf(file, "file: %63s", Images[*Count].File);
+        sscanf(name, "name: %31s", Images[*Count].Name);
+        sscanf(addr, "begin_address: 0x%x", &Images[*Count].Addr);
+        Images[*Count].Crc_Valid = (crc != NULL) && ((next == NULL) || (crc < next)) &&
+                                   (sscanf(crc, "crc32: 0x%x", &Images[*Count].Crc) == 1);
+
+        QL_LOG_I("parsed file: %s; name: %s; begin_address: 0x%x", Images[*Count].File, Images[*Count].Name,
+                 Images[*Count].Addr);
+        (*Count)++;
+    }
+
+END:
+    Ql_FatFs_CloseFile(&fp);
+    vPortFree(buffer);
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Find an image by its name
+* ex:
+* @par
+* None
+* @retval the image, NULL: not found
+*****************************************************************************/
+const Ql_FwUpg_Image_TypeDef *Ql_FwUpg_Find(const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count, const char *Name)
+{
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        if (strcmp(Images[i].Name, Name) == 0)
+        {
+            return &Images[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*****************************************************************************
+* @brief  Read the image block by block into the free buffers of the pipe
+* ex:
+* @par
+* None
+* @retval None
+*****************************************************************************/
+static void Ql_FwUpg_Reader_Task(void *Param)
+{
+    Ql_FwUpg_Pipe_TypeDef *pipe = (Ql_FwUpg_Pipe_TypeDef *)Param;
+    Ql_FwUpg_Block_TypeDef *block = NULL;
+    uint8_t is_last = 0;
+
+    while ((is_last == 0) && (xQueueReceive(pipe->Free, &block, portMAX_DELAY) == pdPASS))
+    {
+        if (pipe->Stop)
+        {
+            break;
+        }
+
+        block->Length = 0;
+        block->Result = Ql_FatFs_ReadFile(pipe->Fp, QL_FWUPG_BLOCK_DATA(block), pipe->Block_Size, &block->Length);
+        is_last = (block->Result != 0) || (block->Length < pipe->Block_Size);
+
+        xQueueSend(pipe->Full, &block, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(pipe->Done);
+    vTaskDelete(NULL);
+}
+
+static void Ql_FwUpg_Pipe_Delete(Ql_FwUpg_Pipe_TypeDef *Pipe)
+{
+    if (Pipe->Free != NULL)
+    {
+        vQueueDelete(Pipe->Free);
+        Pipe->Free = NULL;
+    }
+    if (Pipe->Full != NULL)
+    {
+        vQueueDelete(Pipe->Full);
+        Pipe->Full = NULL;
+    }
+    if (Pipe->Done != NULL)
+    {
+        vSemaphoreDelete(Pipe->Done);
+        Pipe->Done = NULL;
+    }
+}
+
+/*****************************************************************************
+* @brief  Start reading the image ahead of the sender
+* ex:
+* @par
+* The reader runs at the priority of the caller, it gets the CPU while the
+* sender waits on the bus or the module.
+* @retval 0: ok, < 0: no memory
+*****************************************************************************/
+static int32_t Ql_FwUpg_Pipe_Start(Ql_FwUpg_Pipe_TypeDef *Pipe, FIL *Fp, uint32_t Block_Size)
+{
+    Ql_FwUpg_Block_TypeDef *block = NULL;
+
+    memset(Pipe, 0, sizeof(Ql_FwUpg_Pipe_TypeDef));
+    Pipe->Fp = Fp;
+    Pipe->Block_Size = Block_Size;
+    Pipe->Free = xQueueCreate(QL_FWUPG_PIPE_DEPTH, sizeof(Ql_FwUpg_Block_TypeDef *));
+    Pipe->Full = xQueueCreate(QL_FWUPG_PIPE_DEPTH, sizeof(Ql_FwUpg_Block_TypeDef *));
+    Pipe->Done = xSemaphoreCreateBinary();
+    if ((Pipe->Free == NULL) || (Pipe->Full == NULL) || (Pipe->Done == NULL))
+    {
+        Ql_FwUpg_Pipe_Delete(Pipe);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < QL_FWUPG_PIPE_DEPTH; i++)
+    {
+        block = &FwUpg_Blocks[i];
+        xQueueSend(Pipe->Free, &block, 0);
+    }
+
+    if (xTaskCreate(Ql_FwUpg_Reader_Task, "fw_read", configMINIMAL_STACK_SIZE * 4, Pipe,
+                    uxTaskPriorityGet(NULL), NULL) != pdPASS)
+    {
+        Ql_FwUpg_Pipe_Delete(Pipe);
+        return -2;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Stop the reader task and release the pipe
+* ex:
+* @par
+* None
+* @retval None
+*****************************************************************************/
+static void Ql_FwUpg_Pipe_Stop(Ql_FwUpg_Pipe_TypeDef *Pipe)
+{
+    Ql_FwUpg_Block_TypeDef *block = NULL;
+
+    Pipe->Stop = 1;
+
+    // hand back what was read ahead, a reader waiting for a buffer then sees Stop
+    while (xSemaphoreTake(Pipe->Done, 0) != pdPASS)
+    {
+        if (xQueueReceive(Pipe->Full, &block, pdMS_TO_TICKS(10)) == pdPASS)
+        {
+            xQueueSend(Pipe->Free, &block, 0);
+        }
+    }
+
+    Ql_FwUpg_Pipe_Delete(Pipe);
+}
+
+/*****************************************************************************
+* @brief  Get the image CRC cached next to the image
+* ex:
+* @par
+* The cache has to match the size and time of the image and the bytes sent.
+* @retval 0: ok, < 0: no valid cache
+*****************************************************************************/
+static int32_t Ql_FwUpg_Crc_Load(Ql_FwUpg_Ctx_TypeDef *Ctx, const FILINFO *Info)
+{
+    Ql_FwUpg_Crc_Cache_TypeDef cache;
+    FILINFO cache_info;
+    uint32_t read_length = 0;
+    FIL fp;
+
+    snprintf(FwUpg_Cache_Path, sizeof(FwUpg_Cache_Path), "%s%s", Ctx->Path, QL_FWUPG_CRC_SUFFIX);
+
+    // no cache yet is the normal case, don't let the open log an error
+    if (Ql_FatFs_StatFile(FwUpg_Cache_Path, &cache_info) != 0)
+    {
+        return -1;
+    }
+    if (Ql_FatFs_OpenFile(FwUpg_Cache_Path, &fp, QL_FILE_READ) != 0)
+    {
+        return -1;
+    }
+    memset(&cache, 0, sizeof(cache));
+    Ql_FatFs_ReadFile(&fp, (uint8_t *)&cache, sizeof(cache), &read_length);
+    Ql_FatFs_CloseFile(&fp);
+
+    if ((read_length != sizeof(cache)) || (cache.Magic != QL_FWUPG_CRC_MAGIC) ||
+        (cache.Crc != Ql_Check_CRC32(0, (const unsigned char *)&cache, QL_FWUPG_CACHE_CRC_LEN)))
+    {
+        return -2;
+    }
+
+    if ((cache.File_Size != Info->fsize) || (cache.Size != Ctx->Size) ||
+        (cache.File_Date != Info->fdate) || (cache.File_Time != Info->ftime))
+    {
+        QL_LOG_I("crc cache is older than %s", Ctx->Path);
+        return -3;
+    }
+
+    Ctx->Crc = cache.Image_Crc;
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Cache the image CRC next to the image for the next upgrade
+* ex:
+* @par
+* None
+* @retval None
+*****************************************************************************/
+static void Ql_FwUpg_Crc_Save(const Ql_FwUpg_Ctx_TypeDef *Ctx, const FILINFO *Info)
+{
+    Ql_FwUpg_Crc_Cache_TypeDef cache;
+    FIL fp;
+
+    snprintf(FwUpg_Cache_Path, sizeof(FwUpg_Cache_Path), "%s%s", Ctx->Path, QL_FWUPG_CRC_SUFFIX);
+
+    cache.Magic = QL_FWUPG_CRC_MAGIC;
+    cache.File_Size = Info->fsize;
+    cache.Size = Ctx->Size;
+    cache.File_Date = Info->fdate;
+    cache.File_Time = Info->ftime;
+    cache.Image_Crc = Ctx->Crc;
+    cache.Crc = Ql_Check_CRC32(0, (const unsigned char *)&cache, QL_FWUPG_CACHE_CRC_LEN);
+
+    if (Ql_FatFs_OpenFile(FwUpg_Cache_Path, &fp, QL_FILE_WRITE | QL_FILE_CREATE_ALWAYS) != 0)
+    {
+        return;
+    }
+    if (Ql_FatFs_WriteFile(&fp, (const uint8_t *)&cache, sizeof(cache), NULL) != 0)
+    {
+        QL_LOG_W("crc cache write error, path: %s", FwUpg_Cache_Path);
+    }
+    Ql_FatFs_CloseFile(&fp);
+}
+
+/*****************************************************************************
+* @brief  Read the image once for the image CRC
+* ex:
+* @par
+* CRC32 over the 4 bytes of Size, then over the bytes sent, 0xFF padding
+* included. Whole clusters go to the card as one multi block read.
+* @retval 0: ok, < 0: read error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Crc_Calc(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    uint8_t *buffer = NULL;
+    uint8_t *fallback = QL_FWUPG_BLOCK_DATA(&FwUpg_Blocks[0]);
+    uint32_t buffer_size;
+    uint32_t read_length = 0;
+    uint32_t had_read_length = 0;
+    uint32_t pad_length;
+    uint32_t crc;
+    int32_t ret = 0;
+    FIL fp;
+
+    if (Ql_FatFs_OpenFile(Ctx->Path, &fp, QL_FILE_READ) != 0)
+    {
+        return -1;
+    }
+
+    buffer_size = fp.obj.fs->csize * FF_MAX_SS;
+    buffer_size = (buffer_size > QL_FWUPG_CRC_READ_MAX) ? QL_FWUPG_CRC_READ_MAX : buffer_size;
+    while ((buffer == NULL) && (buffer_size >= QL_FWUPG_BLOCK_MAX))
+    {
+        buffer = pvPortMalloc(buffer_size);
+        buffer_size = (buffer == NULL) ? (buffer_size / 2) : buffer_size;
+    }
+    if (buffer == NULL)
+    {
+        // the pipe is idle before the image is sent
+        buffer = fallback;
+        buffer_size = QL_FWUPG_BLOCK_MAX;
+    }
+
+    crc = Ql_Check_CRC32(0, (const unsigned char *)&Ctx->Size, 4);
+    while (had_read_length < Ctx->Size)
+    {
+        if (Ql_FatFs_ReadFile(&fp, buffer, buffer_size, &read_length) != 0)
+        {
+            ret = -2;
+            break;
+        }
+        if (read_length < buffer_size)
+        {
+            // end of the file, 0xFF up to the size sent
+            pad_length = ((Ctx->Size - had_read_length < buffer_size) ? (Ctx->Size - had_read_length) : buffer_size) - read_length;
+            memset(buffer + read_length, 0xFF, pad_length);
+            read_length += pad_length;
+            if (read_length == 0)
+            {
+                ret = -3;
+                break;
+            }
+        }
+        crc = Ql_Check_CRC32(crc, buffer, read_length);
+        had_read_length += read_length;
+    }
+
+    Ql_FatFs_CloseFile(&fp);
+    if (buffer != fallback)
+    {
+        vPortFree(buffer);
+    }
+
+    Ctx->Crc = crc;
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Sizes and CRC of the image at Ctx->Path
+* ex:
+* @par
+* The image CRC comes from the cfg file, the cache next to the image or a
+* pass over the image, in this order.
+* @retval where the CRC came from, NULL: read error
+*****************************************************************************/
+static const char *Ql_FwUpg_Image_Crc(Ql_FwUpg_Ctx_TypeDef *Ctx, const Ql_FwUpg_Image_TypeDef *Image, const FILINFO *Info)
+{
+    const Ql_FwUpg_Protocol_TypeDef *proto = Ctx->Proto;
+
+    Ctx->File_Size = Info->fsize;
+    Ctx->Size = Info->fsize;
+    if (proto->Flags & QL_FWUPG_PAD)
+    {
+        Ctx->Size = (Info->fsize + proto->Block_Size - 1) / proto->Block_Size * proto->Block_Size;
+    }
+
+    if (Image->Crc_Valid)
+    {
+        Ctx->Crc = Image->Crc;
+        return "cfg";
+    }
+    if (Ql_FwUpg_Crc_Load(Ctx, Info) == 0)
+    {
+        return "cache";
+    }
+    if (Ql_FwUpg_Crc_Calc(Ctx) == 0)
+    {
+        return "file";
+    }
+
+    return NULL;
+}
+
+/*****************************************************************************
+* @brief  Fingerprint of an upgrade: protocol, directory and images
+* ex:
+* @par
+* A replaced image changes its size, time or CRC and with it the
+* fingerprint, blocks of two images of the same size never mix. A CRC read
+* from the image is cached for Ql_FwUpg_Image.
+* @retval 0: ok, < 0: an image is missing
+*****************************************************************************/
+static int32_t Ql_FwUpg_Ckpt_Set(Ql_FwUpg_Ctx_TypeDef *Ctx, const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count,
+                                 uint32_t *Set_Crc)
+{
+    const char *crc_from;
+    uint32_t stamp[4];
+    uint32_t crc;
+    FILINFO info;
+
+    crc = Ql_Check_CRC32(0, (const unsigned char *)Ctx->Proto->Name, strlen(Ctx->Proto->Name));
+    crc = Ql_Check_CRC32(crc, (const unsigned char *)Ctx->Dir, strlen(Ctx->Dir));
+    for (uint32_t i = 0; i < Count; i++)
+    {
+        snprintf(Ctx->Path, sizeof(Ctx->Path), "%s%s", Ctx->Dir, Images[i].File);
+        if (Ql_FatFs_StatFile(Ctx->Path, &info) != 0)
+        {
+            return -1;
+        }
+        crc_from = Ql_FwUpg_Image_Crc(Ctx, &Images[i], &info);
+        if (crc_from == NULL)
+        {
+            return -1;
+        }
+        if (strcmp(crc_from, "file") == 0)
+        {
+            Ql_FwUpg_Crc_Save(Ctx, &info);
+        }
+        stamp[0] = info.fsize;
+        stamp[1] = ((uint32_t)info.fdate << 16) | info.ftime;
+        stamp[2] = Images[i].Addr;
+        stamp[3] = Ctx->Crc;
+        crc = Ql_Check_CRC32(crc, (const unsigned char *)Images[i].File, strlen(Images[i].File));
+        crc = Ql_Check_CRC32(crc, (const unsigned char *)stamp, sizeof(stamp));
+    }
+
+    *Set_Crc = crc;
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Pick up the checkpoint an interrupted upgrade left
+* ex:
+* @par
+* Without a checkpoint of this upgrade Ctx->Ckpt starts at the first block
+* of the first image with nothing erased.
+* @retval None
+*****************************************************************************/
+static void Ql_FwUpg_Ckpt_Load(Ql_FwUpg_Ctx_TypeDef *Ctx, const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count)
+{
+    Ql_FwUpg_Ckpt_TypeDef ckpt;
+    uint32_t set_crc;
+    uint32_t read_length = 0;
+    FILINFO info;
+    FIL fp;
+
+    memset(&Ctx->Ckpt, 0, sizeof(Ctx->Ckpt));
+    if (Ql_FwUpg_Ckpt_Set(Ctx, Images, Count, &set_crc) != 0)
+    {
+        // the image fails later with its own error, no checkpoint for this run
+        return;
+    }
+    Ctx->Ckpt.Magic = QL_FWUPG_CKPT_MAGIC;
+    Ctx->Ckpt.Set_Crc = set_crc;
+
+    snprintf(FwUpg_Ckpt_Path, sizeof(FwUpg_Ckpt_Path), "%s%s", Ctx->Dir, QL_FWUPG_CKPT_NAME);
+    if ((Ql_FatFs_StatFile(FwUpg_Ckpt_Path, &info) != 0) || (Ql_FatFs_OpenFile(FwUpg_Ckpt_Path, &fp, QL_FILE_READ) != 0))
+    {
+        return;
+    }
+    memset(&ckpt, 0, sizeof(ckpt));
+    Ql_FatFs_ReadFile(&fp, (uint8_t *)&ckpt, sizeof(ckpt), &read_length);
+    Ql_FatFs_CloseFile(&fp);
+
+    if ((read_length != sizeof(ckpt)) || (ckpt.Magic != QL_FWUPG_CKPT_MAGIC) ||
+        (ckpt.Crc != Ql_Check_CRC32(0, (const unsigned char *)&ckpt, QL_FWUPG_CKPT_CRC_LEN)))
+    {
+        QL_LOG_W("checkpoint broken, start over");
+        return;
+    }
+    if ((ckpt.Set_Crc != set_crc) || (ckpt.Image >= Count))
+    {
+        QL_LOG_I("checkpoint of another upgrade, start over");
+        return;
+    }
+
+    Ctx->Ckpt = ckpt;
+    QL_LOG_I("resume at %s block %d, 0x%08X bytes erased", Images[ckpt.Image].Name, ckpt.Block, ckpt.Erased);
+}
+
+/*****************************************************************************
+* @brief  Write the progress to the checkpoint
+* ex:
+* @par
+* Ql_FwUpg_Checkpoint(Ctx, 0) after each step, a block sent or a range
+* erased; it goes to the card every QL_FWUPG_CKPT_INTERVAL steps and when
+* Force is set.
+* @retval None
+*****************************************************************************/
+void Ql_FwUpg_Checkpoint(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t Force)
+{
+    TickType_t tick;
+    FIL fp;
+
+    if ((QL_FWUPG_CKPT_INTERVAL == 0) || (Ctx->Ckpt.Magic != QL_FWUPG_CKPT_MAGIC))
+    {
+        return;
+    }
+    if (!Force && (++Ctx->Ckpt_Steps < QL_FWUPG_CKPT_INTERVAL))
+    {
+        return;
+    }
+
+    tick = xTaskGetTickCount();
+    Ctx->Ckpt_Steps = 0;
+    Ctx->Ckpt.Crc = Ql_Check_CRC32(0, (const unsigned char *)&Ctx->Ckpt, QL_FWUPG_CKPT_CRC_LEN);
+    if (Ql_FatFs_OpenFile(FwUpg_Ckpt_Path, &fp, QL_FILE_WRITE | QL_FILE_CREATE_ALWAYS) != 0)
+    {
+        return;
+    }
+    if (Ql_FatFs_WriteFile(&fp, (const uint8_t *)&Ctx->Ckpt, sizeof(Ctx->Ckpt), NULL) != 0)
+    {
+        QL_LOG_W("checkpoint write error, path: %s", FwUpg_Ckpt_Path);
+    }
+    Ql_FatFs_CloseFile(&fp);
+
+    Ctx->Stats.Ckpt_Writes++;
+    Ctx->Stats.Ckpt_Ms += QL_FWUPG_MS(xTaskGetTickCount() - tick);
+}
+
+/*****************************************************************************
+* @brief  Send the image through the pipe, block by block
+* ex:
+* @par
+* A block the module rejects with QL_FWUPG_RETRY is sent again, its buffer
+* goes back to the reader when the module took it. Blocks before Start are
+* on the module already; the image CRC is only checked from block 0. A
+* checkpoint saved after the last block leaves nothing to send.
+* @retval 0: ok, -3: the blocks sent don't match the image CRC, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Send_File(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Start)
+{
+    const Ql_FwUpg_Protocol_TypeDef *proto = Ctx->Proto;
+    Ql_FwUpg_Block_TypeDef *block = NULL;
+    uint32_t index = Start;
+    uint32_t done = Start * proto->Block_Size;
+    uint32_t length = 0;
+    uint32_t tries;
+    uint32_t crc = Ql_Check_CRC32(0, (const unsigned char *)&Ctx->Size, 4);
+    uint8_t shown = 0;
+    int32_t ret = 0;
+    TickType_t tick;
+    FIL fp;
+
+    if ((Start != 0) && (done >= Ctx->File_Size))
+    {
+        // every block is on the module, the padded last one makes done larger than the file
+        return 0;
+    }
+
+    if (Ql_FatFs_OpenFile(Ctx->Path, &fp, QL_FILE_READ) != 0)
+    {
+        QL_LOG_E("open file error, path: %s", Ctx->Path);
+        return -1;
+    }
+    if ((Start != 0) && (Ql_FatFs_SeekFile(&fp, done) != 0))
+    {
+        Ql_FatFs_CloseFile(&fp);
+        return -1;
+    }
+    if (Ql_FwUpg_Pipe_Start(&FwUpg_Pipe, &fp, proto->Block_Size) != 0)
+    {
+        QL_LOG_E("fw read pipe start error");
+        Ql_FatFs_CloseFile(&fp);
+        return -1;
+    }
+
+    do
+    {
+        // the next block was read while the module programmed the previous one
+        tick = xTaskGetTickCount();
+        if (xQueueReceive(FwUpg_Pipe.Full, &block, pdMS_TO_TICKS(QL_FWUPG_READ_TIMEOUT)) != pdPASS)
+        {
+            block = NULL;
+            ret = -2;
+            QL_LOG_E("read file timeout");
+            break;
+        }
+        Ctx->Stats.Card_Ms += QL_FWUPG_MS(xTaskGetTickCount() - tick);
+
+        if (block->Result != 0)
+        {
+            ret = -2;
+            QL_LOG_E("read file error");
+            break;
+        }
+        if (block->Length == 0)
+        {
+            break;
+        }
+
+        length = block->Length;
+        if ((proto->Flags & QL_FWUPG_PAD) && (length < proto->Block_Size))
+        {
+            memset(QL_FWUPG_BLOCK_DATA(block) + length, 0xFF, proto->Block_Size - length);
+            length = proto->Block_Size;
+        }
+        crc = Ql_Check_CRC32(crc, QL_FWUPG_BLOCK_DATA(block), length);
+
+        tick = xTaskGetTickCount();
+        for (tries = 1; ; tries++)
+        {
+            ret = proto->Block(Ctx, index, QL_FWUPG_BLOCK_DATA(block), length);
+            if ((ret != QL_FWUPG_RETRY) || (tries >= QL_FWUPG_BLOCK_RETRY))
+            {
+                break;
+            }
+            Ctx->Stats.Retries++;
+            QL_LOG_W("block %d rejected, send it again", index);
+        }
+        Ctx->Stats.Block_Ms += QL_FWUPG_MS(xTaskGetTickCount() - tick);
+
+        done += block->Length;
+        xQueueSend(FwUpg_Pipe.Free, &block, 0);
+        block = NULL;
+        if (ret != 0)
+        {
+            ret = -2;
+            QL_LOG_E("send block %d error", index);
+            break;
+        }
+
+        index++;
+        Ctx->Stats.Blocks++;
+        Ctx->Ckpt.Block = index;
+        Ql_FwUpg_Checkpoint(Ctx, 0);
+        Ql_FwUpg_Progress("Send FW", done, Ctx->File_Size, &shown, 10);
+    } while (done < Ctx->File_Size);
+
+    if (block != NULL)
+    {
+        xQueueSend(FwUpg_Pipe.Free, &block, 0);
+    }
+    Ql_FwUpg_Pipe_Stop(&FwUpg_Pipe);
+    Ql_FatFs_CloseFile(&fp);
+
+    Ctx->Stats.Bytes += done - Start * proto->Block_Size;
+    if ((ret == 0) && (done != Ctx->File_Size))
+    {
+        QL_LOG_E("read %d bytes of %d", done, Ctx->File_Size);
+        ret = -2;
+    }
+    if ((ret == 0) && (proto->Flags & QL_FWUPG_IMAGE_CRC) && (Start == 0) && (crc != Ctx->Crc))
+    {
+        QL_LOG_E("crc32 0x%08X of the blocks sent != 0x%08X announced", crc, Ctx->Crc);
+        ret = -3;
+    }
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Upgrade one image
+* ex:
+* @par
+* Start: first block to send, see Ql_FwUpg_Image_Crc for the image CRC.
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Image(Ql_FwUpg_Ctx_TypeDef *Ctx, const Ql_FwUpg_Image_TypeDef *Image, uint32_t Start)
+{
+    const Ql_FwUpg_Protocol_TypeDef *proto = Ctx->Proto;
+    const char *crc_from = NULL;
+    TickType_t start_tick = xTaskGetTickCount();
+    uint32_t crc_ms = 0;
+    FILINFO info;
+    int32_t ret;
+
+    Ctx->Image = Image;
+    snprintf(Ctx->Path, sizeof(Ctx->Path), "%s%s", Ctx->Dir, Image->File);
+    if (Ql_FatFs_StatFile(Ctx->Path, &info) != 0)
+    {
+        QL_LOG_E("open file error, path: %s", Ctx->Path);
+        return -1;
+    }
+
+    Ctx->File_Size = info.fsize;
+    Ctx->Size = info.fsize;
+    if (proto->Flags & QL_FWUPG_PAD)
+    {
+        Ctx->Size = (info.fsize + proto->Block_Size - 1) / proto->Block_Size * proto->Block_Size;
+    }
+
+    if (proto->Flags & QL_FWUPG_IMAGE_CRC)
+    {
+        crc_from = Ql_FwUpg_Image_Crc(Ctx, Image, &info);
+        if (crc_from == NULL)
+        {
+            QL_LOG_E("read file error, path: %s", Ctx->Path);
+            return -1;
+        }
+        crc_ms = QL_FWUPG_MS(xTaskGetTickCount() - start_tick);
+        Ctx->Stats.Crc_Ms += crc_ms;
+        QL_LOG_I("fw crc32 0x%08X from %s in %d ms", Ctx->Crc, crc_from, crc_ms);
+    }
+
+    if ((proto->Begin != NULL) && (proto->Begin(Ctx) != 0))
+    {
+        return -2;
+    }
+
+    QL_LOG_I("-->send fw file %s", Ctx->Path);
+    if (Start != 0)
+    {
+        QL_LOG_I("go on from block %d", Start);
+        Ctx->Stats.Resumed += Start;
+    }
+    ret = Ql_FwUpg_Send_File(Ctx, Start);
+    if ((ret == -3) && (crc_from != NULL) && (strcmp(crc_from, "cache") == 0))
+    {
+        snprintf(FwUpg_Cache_Path, sizeof(FwUpg_Cache_Path), "%s%s", Ctx->Path, QL_FWUPG_CRC_SUFFIX);
+        Ql_FatFs_DeleteFile(FwUpg_Cache_Path);
+    }
+    if (ret != 0)
+    {
+        QL_LOG_E("send fw file error");
+        return -3;
+    }
+
+    if ((proto->End != NULL) && (proto->End(Ctx) != 0))
+    {
+        return -4;
+    }
+
+    if ((crc_from != NULL) && (strcmp(crc_from, "file") == 0))
+    {
+        Ql_FwUpg_Crc_Save(Ctx, &info);
+    }
+
+    Ctx->Stats.Images++;
+    QL_LOG_I("upgrade %s in %d ms, crc32 %d ms", Image->File, QL_FWUPG_MS(xTaskGetTickCount() - start_tick), crc_ms);
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Upgrade the module with the images in the given order
+* ex:
+* @par
+* Ql_FwUpg_Run(&ctx, &bus, &Ql_FwUpg_LCX9H, "/lcx9h_fwupg/", images, 3);
+* The transport is opened and closed here, the SD card has to be mounted.
+* A QL_FWUPG_RESUME protocol goes on from the checkpoint of the same
+* upgrade, the checkpoint is deleted when the upgrade is done.
+* @retval 0: ok, -1: transport, -2: connect, -3: image, -4: finish
+*****************************************************************************/
+int32_t Ql_FwUpg_Run(Ql_FwUpg_Ctx_TypeDef *Ctx, const Ql_FwUpg_Transport_TypeDef *Bus, const Ql_FwUpg_Protocol_TypeDef *Proto,
+                     const char *Dir, const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count)
+{
+    TickType_t start_tick = xTaskGetTickCount();
+    int32_t ret = 0;
+
+    if (Proto->Block_Size > QL_FWUPG_BLOCK_MAX)
+    {
+        return -1;
+    }
+
+    memset(Ctx, 0, sizeof(Ql_FwUpg_Ctx_TypeDef));
+    Ctx->Bus = Bus;
+    Ctx->Proto = Proto;
+    Ctx->Dir = Dir;
+
+    if ((Proto->Flags & QL_FWUPG_RESUME) && (QL_FWUPG_CKPT_INTERVAL != 0))
+    {
+        Ql_FwUpg_Ckpt_Load(Ctx, Images, Count);
+    }
+
+    if (Bus->Open(Bus->Port) != 0)
+    {
+        QL_LOG_E("%s transport open fail", Proto->Name);
+        return -1;
+    }
+
+    QL_LOG_I("============== %s Connect ============", Proto->Name);
+    if (Proto->Connect(Ctx) != 0)
+    {
+        QL_LOG_E("%s connect fail", Proto->Name);
+        ret = -2;
+    }
+
+    for (uint32_t i = Ctx->Ckpt.Image; (ret == 0) && (i < Count); i++)
+    {
+        QL_LOG_I("============== UpgradeFwFile Start File %s ============", Images[i].Name);
+        if (Ql_FwUpg_Image(Ctx, &Images[i], Ctx->Ckpt.Block) != 0)
+        {
+            QL_LOG_E("send %s Fail", Images[i].Name);
+            ret = -3;
+            break;
+        }
+        Ctx->Ckpt.Image = i + 1;
+        Ctx->Ckpt.Block = 0;
+        Ql_FwUpg_Checkpoint(Ctx, 1);
+    }
+
+    if ((ret == 0) && (Proto->Finish != NULL) && (Proto->Finish(Ctx) != 0))
+    {
+        ret = -4;
+    }
+
+    if (ret == 0)
+    {
+        if (Ctx->Ckpt.Magic == QL_FWUPG_CKPT_MAGIC)
+        {
+            Ql_FatFs_DeleteFile(FwUpg_Ckpt_Path);
+        }
+    }
+    else
+    {
+        // what the module acknowledged up to the error
+        Ql_FwUpg_Checkpoint(Ctx, 1);
+    }
+
+    Bus->Close(Bus->Port);
+    Ctx->Stats.Total_Ms = QL_FWUPG_MS(xTaskGetTickCount() - start_tick);
+    Ql_FwUpg_Stats_Print(Ctx);
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Log the metrics of the last run
+* ex:
+* @par
+* None
+* @retval None
+*****************************************************************************/
+void Ql_FwUpg_Stats_Print(const Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const Ql_FwUpg_Stats_TypeDef *stats = &Ctx->Stats;
+
+    QL_LOG_I("%s: %d images, %d blocks, %d bytes in %d ms", Ctx->Proto->Name, stats->Images, stats->Blocks,
+             stats->Bytes, stats->Total_Ms);
+    QL_LOG_I("crc %d ms, card wait %d ms, blocks %d ms, retries %d", stats->Crc_Ms, stats->Card_Ms, stats->Block_Ms,
+             stats->Retries);
+    QL_LOG_I("bus: %d writes, %d bytes, %d errors", stats->Bus_Writes, stats->Bus_Bytes, stats->Bus_Errors);
+    if (Ctx->Ckpt.Magic == QL_FWUPG_CKPT_MAGIC)
+    {
+        QL_LOG_I("resumed %d blocks, %d checkpoints in %d ms", stats->Resumed, stats->Ckpt_Writes, stats->Ckpt_Ms);
+    }
+    if (Ctx->Bus->Type == QL_FWUPG_BUS_IIC)
+    {
+        Ql_IIC_PacePrint(&((const Ql_FwUpg_IIC_TypeDef *)Ctx->Bus->Port)->Pace);
+    }
+}
@@ -0,0 +1,207 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_fwupg.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_FWUPG_H__
+#define __QL_FWUPG_H__
+
+#include <stdint.h>
+
+#include "ql_ff_user.h"
+#include "ql_iic.h"
+#include "ql_spi.h"
+
+/* Firmware upgrade of a GNSS module from the SD card. A transport moves
+   bytes over I2C, UART or SPI; a protocol descriptor drives one bootloader
+   over it. The engine reads the images listed in the cfg file, gets the
+   image CRC for the protocols that announce it, reads each file ahead of
+   the bus, resends the blocks the module rejects and keeps the metrics.
+   For the protocols that address each block it keeps a checkpoint next
+   to the images, an interrupted upgrade goes on from there. On I2C the
+   transport paces the transactions for the module, the protocols poll
+   without fixed delays.
+   Protocols: ql_fwupg_lcx.c for the LCx9H and LCx6G bootloader,
+   ql_fwupg_da.c for the LCx9H boot ROM with the download agent. */
+#define QL_FWUPG_BLOCK_MAX          (4096U)         // data bytes of one packet
+#define QL_FWUPG_HEAD_ROOM          (16U)           // writable bytes before the data, for a frame built in place
+#define QL_FWUPG_TAIL_ROOM          (8U)            // and after it
+#define QL_FWUPG_PIPE_DEPTH         (3U)            // blocks read ahead of the one on the bus
+#define QL_FWUPG_READ_TIMEOUT       (5000U)         // ms
+#define QL_FWUPG_BLOCK_RETRY        (3U)            // sends of a block the module rejected
+#define QL_FWUPG_PATH_MAX           (256U)
+#define QL_FWUPG_CFG_NAME           "flash_download.cfg"
+#define QL_FWUPG_CRC_READ_MAX       (32U * 1024U)   // crc pre-pass reads whole clusters up to this
+#define QL_FWUPG_CRC_SUFFIX         ".crc"          // crc cache next to the image
+#define QL_FWUPG_CRC_MAGIC          (0x43524346U)   // "FCRC"
+#define QL_FWUPG_CKPT_NAME          "fwupg.ckpt"    // checkpoint in the image directory
+#define QL_FWUPG_CKPT_MAGIC         (0x54504B43U)   // "CKPT"
+#ifndef QL_FWUPG_CKPT_INTERVAL
+#define QL_FWUPG_CKPT_INTERVAL      (16U)           // steps between two checkpoints, 0: no checkpoint
+#endif
+
+/* Protocol flags */
+#define QL_FWUPG_PAD                (0x01U)         // the last block is filled up with 0xFF
+#define QL_FWUPG_IMAGE_CRC          (0x02U)         // Begin announces the CRC32 of the image
+#define QL_FWUPG_RESUME             (0x04U)         // blocks carry their address, an image can go on from any block
+
+/* Block result besides 0 and < 0: the module dropped it, send it again */
+#define QL_FWUPG_RETRY              (1)
+
+typedef enum
+{
+    QL_FWUPG_BUS_IIC = 0,
+    QL_FWUPG_BUS_UART,
+    QL_FWUPG_BUS_SPI,
+} Ql_FwUpg_Bus_TypeDef;
+
+typedef struct
+{
+    Ql_FwUpg_Bus_TypeDef Type;
+    int32_t   (*Open)(void *Port);
+    void      (*Close)(void *Port);
+    int32_t   (*Write)(void *Port, const uint8_t *Data, uint32_t Len);
+    int32_t   (*Read)(void *Port, uint8_t *Data, uint32_t Len, uint32_t Timeout);    // ms, 0: all Len bytes read
+    void       *Port;
+} Ql_FwUpg_Transport_TypeDef;
+
+typedef struct
+{
+    IIC_Mode_TypeDef    Mode;
+    IIC_Speed_TypeDef   Speed;
+    uint32_t            Tx_Size;
+    uint32_t            Rx_Size;
+    uint8_t             Addr;       // 8 bit address, write direction
+    const char         *Module;     // module type the pacing learns for
+    uint32_t            Gap_Min_Us; // turnaround of the module
+    uint32_t            Gap_Max_Us;
+    IIC_Pace_TypeDef    Pace;       // set up by Ql_FwUpg_IIC_Transport the first time
+} Ql_FwUpg_IIC_TypeDef;
+
+typedef struct
+{
+    const char         *Name;
+    uint32_t            Periph;
+    uint32_t            Baud;
+    uint32_t            Rx_Size;
+    uint32_t            Tx_Size;
+} Ql_FwUpg_Uart_TypeDef;
+
+typedef struct
+{
+    SPI_Mode_TypeDef    Mode;
+    uint32_t            Tx_Size;
+    uint32_t            Rx_Size;
+} Ql_FwUpg_SPI_TypeDef;
+
+typedef struct
+{
+    char        File[64];
+    char        Name[32];
+    uint32_t    Addr;
+    uint32_t    Format_Size;    // 0: the bytes sent
+    uint32_t    Crc;            // image CRC32 from the cfg file
+    uint8_t     Crc_Valid;
+} Ql_FwUpg_Image_TypeDef;
+
+typedef struct
+{
+    uint32_t    Images;
+    uint32_t    Blocks;
+    uint32_t    Bytes;
+    uint32_t    Retries;
+    uint32_t    Bus_Writes;
+    uint32_t    Bus_Bytes;
+    uint32_t    Bus_Errors;
+    uint32_t    Total_Ms;
+    uint32_t    Crc_Ms;         // getting the image CRCs
+    uint32_t    Card_Ms;        // waiting for the reader
+    uint32_t    Block_Ms;       // sending blocks and waiting for the module
+    uint32_t    Resumed;        // blocks a checkpoint saved from sending again
+    uint32_t    Ckpt_Writes;
+    uint32_t    Ckpt_Ms;
+} Ql_FwUpg_Stats_TypeDef;
+
+/* Progress of a QL_FWUPG_RESUME upgrade, valid for the same protocol,
+   directory and images, sizes and times included */
+typedef struct
+{
+    uint32_t    Magic;
+    uint32_t    Set_Crc;        // of the protocol, directory and images
+    uint32_t    Image;          // index of the image being sent
+    uint32_t    Block;          // blocks of it the module acknowledged
+    uint32_t    Erased;         // bytes the protocol erased before the first image
+    uint32_t    Crc;            // over the fields above
+} Ql_FwUpg_Ckpt_TypeDef;
+
+typedef struct Ql_FwUpg_Ctx Ql_FwUpg_Ctx_TypeDef;
+
+typedef struct
+{
+    const char *Name;
+    uint32_t    Block_Size;
+    uint32_t    Flags;
+    uint16_t    Segment;        // bytes per transport write, 0: no limit
+    uint16_t    Gap;            // ms after each segment
+    int32_t   (*Connect)(Ql_FwUpg_Ctx_TypeDef *Ctx);     // before the first image
+    int32_t   (*Begin)(Ql_FwUpg_Ctx_TypeDef *Ctx);       // before the first block of an image, NULL: nothing to do
+    int32_t   (*Block)(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Index, uint8_t *Data, uint32_t Len);    // 0, < 0 or QL_FWUPG_RETRY
+    int32_t   (*End)(Ql_FwUpg_Ctx_TypeDef *Ctx);         // NULL: nothing to do
+    int32_t   (*Finish)(Ql_FwUpg_Ctx_TypeDef *Ctx);      // after the last image, NULL: nothing to do
+    const void *Param;          // for the callbacks, a variant of a shared protocol
+} Ql_FwUpg_Protocol_TypeDef;
+
+struct Ql_FwUpg_Ctx
+{
+    const Ql_FwUpg_Transport_TypeDef *Bus;
+    const Ql_FwUpg_Protocol_TypeDef  *Proto;
+    const char                       *Dir;     // of the images, ends with '/'
+    const Ql_FwUpg_Image_TypeDef     *Image;   // being sent
+    uint32_t                          File_Size;
+    uint32_t                          Size;    // bytes sent, File_Size up to whole blocks with QL_FWUPG_PAD
+    uint32_t                          Crc;     // with QL_FWUPG_IMAGE_CRC
+    char                              Path[QL_FWUPG_PATH_MAX];
+    Ql_FwUpg_Ckpt_TypeDef             Ckpt;    // loaded before Connect, the protocol keeps Erased up to date
+    uint32_t                          Ckpt_Steps;
+    Ql_FwUpg_Stats_TypeDef            Stats;
+};
+
+extern const Ql_FwUpg_Protocol_TypeDef Ql_FwUpg_LCX9H;
+extern const Ql_FwUpg_Protocol_TypeDef Ql_FwUpg_LCX6G;
+extern const Ql_FwUpg_Protocol_TypeDef Ql_FwUpg_LCX9H_DA;
+
+void    Ql_FwUpg_IIC_Transport(Ql_FwUpg_Transport_TypeDef *Bus, Ql_FwUpg_IIC_TypeDef *Port);
+void    Ql_FwUpg_Uart_Transport(Ql_FwUpg_Transport_TypeDef *Bus, Ql_FwUpg_Uart_TypeDef *Port);
+void    Ql_FwUpg_SPI_Transport(Ql_FwUpg_Transport_TypeDef *Bus, Ql_FwUpg_SPI_TypeDef *Port);
+
+int32_t Ql_FwUpg_Load_Cfg(const char *Dir, Ql_FwUpg_Image_TypeDef *Images, uint32_t Max, uint32_t *Count);
+const Ql_FwUpg_Image_TypeDef *Ql_FwUpg_Find(const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count, const char *Name);
+int32_t Ql_FwUpg_Run(Ql_FwUpg_Ctx_TypeDef *Ctx, const Ql_FwUpg_Transport_TypeDef *Bus, const Ql_FwUpg_Protocol_TypeDef *Proto,
+                     const char *Dir, const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count);
+void    Ql_FwUpg_Stats_Print(const Ql_FwUpg_Ctx_TypeDef *Ctx);
+
+/* For the protocols: transport access with the segments, gaps and counters
+   of the descriptor */
+int32_t Ql_FwUpg_Send(Ql_FwUpg_Ctx_TypeDef *Ctx, const uint8_t *Data, uint32_t Len);
+int32_t Ql_FwUpg_Recv(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t *Data, uint32_t Len, uint32_t Timeout);
+void    Ql_FwUpg_Progress(const char *What, uint32_t Done, uint32_t Total, uint8_t *Shown, uint8_t Step);
+void    Ql_FwUpg_Checkpoint(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t Force);
+
+#endif
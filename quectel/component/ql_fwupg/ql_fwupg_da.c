@@ -0,0 +1,607 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_fwupg_da.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_fwupg.h"
+
+#define LOG_TAG "fwupg_da"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+/* Boot ROM of the LCx9H with a download agent (DA). The ROM takes the DA
+   into RAM and starts it, the DA formats the flash and writes the images
+   with race commands. Every read ends with the mark 0x66, headers go to
+   the module byte by byte. All numbers are little endian. */
+#define QL_FWUPG_DA_FILE            "da_i2c.bin"
+#define QL_FWUPG_DA_RUN_ADDRESS     (0x04000000U)
+#define QL_FWUPG_DA_LENGTH          (0x00006A44U)
+#define QL_FWUPG_DA_BLOCK_SIZE      (1024U)
+#define QL_FWUPG_DA_WDT_REGISTER    (0xA2080000U)
+#define QL_FWUPG_DA_WDT_VALUE       (0x0010U)
+#define QL_FWUPG_DA_BROM_ERROR      (0x1000U)
+#define QL_FWUPG_DA_MARK            (0x66U)
+#define QL_FWUPG_DA_READ_MAX        (32U)
+#define QL_FWUPG_DA_POLL            (10U)           // ms before the answer to a command, longest between two polls
+#define QL_FWUPG_DA_HANDSHAKE_MAX   (100U * 50U)    // polls for the ROM
+#define QL_FWUPG_DA_RESP_TIMEOUT    (500U)          // ms
+
+#define QL_FWUPG_DA_FORMAT_ADDRESS  (0x08000000U)
+#define QL_FWUPG_DA_FORMAT_LENGTH   (0x003E0000U)
+#define QL_FWUPG_DA_FORMAT_BLOCK    (0x00010000U)
+
+#define QL_FWUPG_DA_RACE_HEAD       (0x05U)
+#define QL_FWUPG_DA_RACE_TYPE       (0x5AU)
+#define QL_FWUPG_DA_RACE_FORMAT     (0x2104U)
+#define QL_FWUPG_DA_RACE_WRITE      (0x2100U)
+#define QL_FWUPG_DA_RACE_HEAD_LEN   (16U)           // of a write, the data follows
+#define QL_FWUPG_DA_RACE_FORMAT_LEN (14U)
+#define QL_FWUPG_DA_RACE_RESP_LEN   (11U)           // head, type, length, cmd id, status, address
+
+static void Ql_FwUpg_Da_Put(uint8_t *Data, uint32_t Value, uint32_t Len)
+{
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        Data[i] = (Value >> (8 * i)) & 0xFF;
+    }
+}
+
+static uint32_t Ql_FwUpg_Da_Get(const uint8_t *Data, uint32_t Len)
+{
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        value |= (uint32_t)Data[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/* Read Len bytes and the mark */
+static int32_t Ql_FwUpg_Da_Read(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t *Recv, uint32_t RecvLen)
+{
+    uint8_t buffer[QL_FWUPG_DA_READ_MAX + 1];
+
+    if (RecvLen > QL_FWUPG_DA_READ_MAX)
+    {
+        return -1;
+    }
+    if (Ql_FwUpg_Recv(Ctx, buffer, RecvLen + 1, QL_FWUPG_DA_POLL) != 0)
+    {
+        return -1;
+    }
+    if (buffer[RecvLen] != QL_FWUPG_DA_MARK)
+    {
+        return -2;
+    }
+
+    memcpy(Recv, buffer, RecvLen);
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  One exchange with the module: send, then read Len bytes and the mark
+* ex:
+* @par
+* The ROM answers a command once, the read waits QL_FWUPG_DA_POLL for it.
+* @retval 0: ok, -1: transport error, -2: no mark
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Exchange(Ql_FwUpg_Ctx_TypeDef *Ctx, const uint8_t *Send, uint32_t SendLen,
+                                    uint8_t *Recv, uint32_t RecvLen)
+{
+    if ((Send != NULL) && (SendLen != 0) && (Ql_FwUpg_Send(Ctx, Send, SendLen) != 0))
+    {
+        return -1;
+    }
+    if ((Recv == NULL) || (RecvLen == 0))
+    {
+        return 0;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_DA_POLL));
+    return Ql_FwUpg_Da_Read(Ctx, Recv, RecvLen);
+}
+
+/* Poll for Len bytes for up to Timeout ms. The first poll goes at once, the
+   gap doubles from 1 ms up to QL_FWUPG_DA_POLL, the transport keeps the
+   turnaround of the module */
+static int32_t Ql_FwUpg_Da_Wait(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t *Recv, uint32_t Len, uint32_t Timeout)
+{
+    const TickType_t start_tick = xTaskGetTickCount();
+    uint32_t gap = 1;
+
+    while (1)
+    {
+        if (Ql_FwUpg_Da_Read(Ctx, Recv, Len) == 0)
+        {
+            return 0;
+        }
+        if ((xTaskGetTickCount() - start_tick) >= pdMS_TO_TICKS(Timeout))
+        {
+            return -1;
+        }
+        vTaskDelay(pdMS_TO_TICKS(gap));
+        gap = (gap * 2 < QL_FWUPG_DA_POLL) ? (gap * 2) : QL_FWUPG_DA_POLL;
+    }
+}
+
+/*****************************************************************************
+* @brief  Send a number and check the echo of the module
+* ex:
+* @par
+* Ql_FwUpg_Da_Check(Ctx, 0x0A, 1, 0xF5, 1);
+* @retval 0: ok, < 0: no or wrong echo
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Check(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Send, uint32_t SendLen, uint32_t Expect, uint32_t RecvLen)
+{
+    uint8_t send_data[4];
+    uint8_t recv_data[4];
+
+    Ql_FwUpg_Da_Put(send_data, Send, SendLen);
+    if (Ql_FwUpg_Da_Exchange(Ctx, send_data, SendLen, recv_data, RecvLen) != 0)
+    {
+        QL_LOG_E("send 0x%X, no answer", Send);
+        return -1;
+    }
+    if (Ql_FwUpg_Da_Get(recv_data, RecvLen) != Expect)
+    {
+        QL_LOG_E("send 0x%X, answer 0x%X != 0x%X", Send, Ql_FwUpg_Da_Get(recv_data, RecvLen), Expect);
+        return -2;
+    }
+
+    return 0;
+}
+
+/* Read a 16 bit value, What names it in the log. Values from 0x1000 are
+   errors when Check is set */
+static int32_t Ql_FwUpg_Da_Value(Ql_FwUpg_Ctx_TypeDef *Ctx, const char *What, uint32_t Len, uint8_t Check)
+{
+    uint8_t recv_data[4] = { 0 };
+    uint32_t value;
+
+    if (Ql_FwUpg_Da_Exchange(Ctx, NULL, 0, recv_data, Len) != 0)
+    {
+        QL_LOG_E("recv %s fail", What);
+        return -1;
+    }
+
+    value = Ql_FwUpg_Da_Get(recv_data, Len);
+    if (Check && (value >= QL_FWUPG_DA_BROM_ERROR))
+    {
+        QL_LOG_E("recv %s: 0x%04X", What, value);
+        return -2;
+    }
+    QL_LOG_I("recv %s: 0x%0*X", What, (int)(Len * 2), value);
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Shake hands with the boot ROM and read the hardware code
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Handshake(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const uint8_t start = 0xA0;
+    uint8_t recv_data = 0;
+    uint32_t count;
+
+    for (count = 0; count <= QL_FWUPG_DA_HANDSHAKE_MAX; count++)
+    {
+        if ((Ql_FwUpg_Da_Exchange(Ctx, &start, 1, &recv_data, 1) == 0) && (recv_data == 0x5F))
+        {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_DA_POLL));
+        if (count % 100 == 0)
+        {
+            QL_LOG_I("waiting for handshake...");
+        }
+    }
+    if (count > QL_FWUPG_DA_HANDSHAKE_MAX)
+    {
+        return -1;
+    }
+
+    if ((Ql_FwUpg_Da_Check(Ctx, 0x0A, 1, 0xF5, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x50, 1, 0xAF, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x05, 1, 0xFA, 1) != 0))
+    {
+        return -2;
+    }
+
+    // hardware code, then sub code
+    if ((Ql_FwUpg_Da_Check(Ctx, 0xD0, 1, 0xD0, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x80000008, 4, 0x80000008, 4) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x00000001, 4, 0x00000001, 4) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom Status", 2, 1) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "HW_CODE", 2, 0) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom Status", 2, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0xD0, 1, 0xD0, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x8000000C, 4, 0x8000000C, 4) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x00000001, 4, 0x00000001, 4) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom Status", 2, 1) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "HW_SUBCODE", 2, 0) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom Status", 2, 1) != 0))
+    {
+        return -3;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Stop the watchdog of the module
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Disable_WDT(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    if ((Ql_FwUpg_Da_Check(Ctx, 0xD2, 1, 0xD2, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, QL_FWUPG_DA_WDT_REGISTER, 4, QL_FWUPG_DA_WDT_REGISTER, 4) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x01, 4, 0x01, 4) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom status", 2, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, QL_FWUPG_DA_WDT_VALUE, 2, QL_FWUPG_DA_WDT_VALUE, 2) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom status", 2, 1) != 0))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* XOR of the 16 bit words, a last odd byte on its own */
+static uint16_t Ql_FwUpg_Da_Checksum(const uint8_t *Data, uint32_t Len)
+{
+    uint16_t checksum = 0;
+    uint32_t i;
+
+    for (i = 0; i + 1 < Len; i += 2)
+    {
+        checksum ^= Data[i] | (Data[i + 1] << 8);
+    }
+    if (Len % 2)
+    {
+        checksum ^= Data[i];
+    }
+
+    return checksum;
+}
+
+/*****************************************************************************
+* @brief  Load the DA from the fw directory into the RAM of the module
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Send(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const uint32_t block_count = (QL_FWUPG_DA_LENGTH + QL_FWUPG_DA_BLOCK_SIZE - 1) / QL_FWUPG_DA_BLOCK_SIZE;
+    uint8_t *block = NULL;
+    uint8_t recv_data[2] = { 0 };
+    uint32_t read_length = 0;
+    uint32_t had_read_length = 0;
+    uint16_t checksum = 0;
+    uint8_t shown = 0;
+    int32_t ret = -1;
+    FIL fp;
+
+    if ((Ql_FwUpg_Da_Check(Ctx, 0xD7, 1, 0xD7, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, QL_FWUPG_DA_RUN_ADDRESS, 4, QL_FWUPG_DA_RUN_ADDRESS, 4) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, QL_FWUPG_DA_LENGTH, 4, QL_FWUPG_DA_LENGTH, 4) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x00, 4, 0x00, 4) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom Status", 2, 1) != 0))
+    {
+        return -1;
+    }
+
+    snprintf(Ctx->Path, sizeof(Ctx->Path), "%s%s", Ctx->Dir, QL_FWUPG_DA_FILE);
+    if (Ql_FatFs_OpenFile(Ctx->Path, &fp, QL_FILE_READ) != 0)
+    {
+        QL_LOG_E("open da file error, path: %s", Ctx->Path);
+        return -2;
+    }
+    block = pvPortMalloc(QL_FWUPG_DA_BLOCK_SIZE);
+    if (block == NULL)
+    {
+        Ql_FatFs_CloseFile(&fp);
+        return -3;
+    }
+
+    for (uint32_t i = 0; i < block_count; i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_DA_POLL));
+        if ((Ql_FatFs_ReadFile(&fp, block, QL_FWUPG_DA_BLOCK_SIZE, &read_length) != 0) || (read_length == 0))
+        {
+            QL_LOG_E("read da file error");
+            break;
+        }
+
+        checksum ^= Ql_FwUpg_Da_Checksum(block, read_length);
+        had_read_length += read_length;
+        if (Ql_FwUpg_Send(Ctx, block, read_length) != 0)
+        {
+            QL_LOG_E("send da file block error");
+            break;
+        }
+        Ql_FwUpg_Progress("Send DA", i + 1, block_count, &shown, 5);
+    }
+
+    Ql_FatFs_CloseFile(&fp);
+    vPortFree(block);
+
+    if (had_read_length != QL_FWUPG_DA_LENGTH)
+    {
+        QL_LOG_E("da file length %d != %d", had_read_length, QL_FWUPG_DA_LENGTH);
+    }
+
+    if ((Ql_FwUpg_Da_Wait(Ctx, recv_data, 2, QL_FWUPG_DA_RESP_TIMEOUT) != 0) ||
+        (Ql_FwUpg_Da_Get(recv_data, 2) != checksum))
+    {
+        QL_LOG_E("recv checksum of DA: 0x%04X, calc=0x%04X", Ql_FwUpg_Da_Get(recv_data, 2), checksum);
+        return -4;
+    }
+    if (Ql_FwUpg_Da_Value(Ctx, "Brom status", 2, 1) == 0)
+    {
+        ret = 0;
+    }
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Start the DA and sync with it
+* ex:
+* @par
+* The DA answers with the flash ID, start address and size.
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Start(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    uint8_t recv_data = 0;
+
+    if ((Ql_FwUpg_Da_Check(Ctx, 0xD5, 1, 0xD5, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, QL_FWUPG_DA_RUN_ADDRESS, 4, QL_FWUPG_DA_RUN_ADDRESS, 4) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Brom status", 2, 1) != 0))
+    {
+        return -1;
+    }
+
+    if ((Ql_FwUpg_Da_Wait(Ctx, &recv_data, 1, QL_FWUPG_DA_RESP_TIMEOUT) != 0) && (recv_data != 0xC0))
+    {
+        QL_LOG_E("no sync from the DA");
+        return -2;
+    }
+
+    if ((Ql_FwUpg_Da_Check(Ctx, 0x3F, 1, 0x0C, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0xF3, 1, 0x3F, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0xC0, 1, 0xF3, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x0C, 1, 0x5A, 1) != 0) ||
+        (Ql_FwUpg_Da_Check(Ctx, 0x01, 1, 0x69, 1) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Flash Manufacturer ID", 2, 1) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Flash Device ID 1", 2, 0) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Flash Device ID 2", 2, 0) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Flash Start Addr", 4, 0) != 0) ||
+        (Ql_FwUpg_Da_Value(Ctx, "Flash Size", 4, 0) != 0))
+    {
+        return -3;
+    }
+
+    return 0;
+}
+
+/* Send a race header byte by byte, the DA takes it with a 1 byte FIFO.
+   The segment gap of the descriptor paces the bytes */
+static int32_t Ql_FwUpg_Da_Race_Head(Ql_FwUpg_Ctx_TypeDef *Ctx, const uint8_t *Head, uint32_t Len)
+{
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        if (Ql_FwUpg_Send(Ctx, Head + i, 1) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Wait for the race response and check status and address */
+static int32_t Ql_FwUpg_Da_Race_Resp(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Addr)
+{
+    uint8_t resp[QL_FWUPG_DA_RACE_RESP_LEN];
+
+    if (Ql_FwUpg_Da_Wait(Ctx, resp, sizeof(resp), QL_FWUPG_DA_RESP_TIMEOUT) != 0)
+    {
+        QL_LOG_E("race 0x%08X no response", Addr);
+        return -1;
+    }
+    if ((resp[6] != 0) || (Ql_FwUpg_Da_Get(resp + 7, 4) != Addr))
+    {
+        QL_LOG_E("race 0x%08X response status %d, address 0x%08X", Addr, resp[6], Ql_FwUpg_Da_Get(resp + 7, 4));
+        return -2;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Format the flash of the module in 64KB steps
+* ex:
+* @par
+* Goes on after the range the checkpoint has erased already.
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Format(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const uint32_t count = QL_FWUPG_DA_FORMAT_LENGTH / QL_FWUPG_DA_FORMAT_BLOCK;
+    const uint32_t first = Ctx->Ckpt.Erased / QL_FWUPG_DA_FORMAT_BLOCK;
+    uint8_t cmd[QL_FWUPG_DA_RACE_FORMAT_LEN];
+    uint8_t shown = 0;
+    uint32_t addr;
+
+    QL_LOG_I("Format Flash address: 0x%08X, length: 0x%08X", QL_FWUPG_DA_FORMAT_ADDRESS, QL_FWUPG_DA_FORMAT_LENGTH);
+    if (first > count)
+    {
+        QL_LOG_I("Format Flash done before");
+        return 0;
+    }
+    if (first != 0)
+    {
+        QL_LOG_I("Format Flash from 0x%08X", QL_FWUPG_DA_FORMAT_ADDRESS + first * QL_FWUPG_DA_FORMAT_BLOCK);
+    }
+
+    cmd[0] = QL_FWUPG_DA_RACE_HEAD;
+    cmd[1] = QL_FWUPG_DA_RACE_TYPE;
+    Ql_FwUpg_Da_Put(cmd + 2, QL_FWUPG_DA_RACE_FORMAT_LEN - 4, 2);
+    Ql_FwUpg_Da_Put(cmd + 4, QL_FWUPG_DA_RACE_FORMAT, 2);
+    Ql_FwUpg_Da_Put(cmd + 10, QL_FWUPG_DA_FORMAT_BLOCK, 4);
+
+    for (uint32_t i = first; i <= count; i++)
+    {
+        addr = QL_FWUPG_DA_FORMAT_ADDRESS + i * QL_FWUPG_DA_FORMAT_BLOCK;
+        Ql_FwUpg_Da_Put(cmd + 6, addr, 4);
+        if (Ql_FwUpg_Da_Race_Head(Ctx, cmd, sizeof(cmd)) != 0)
+        {
+            QL_LOG_E("Format Flash address send no response");
+            return -1;
+        }
+        if (Ql_FwUpg_Da_Race_Resp(Ctx, addr) != 0)
+        {
+            return -2;
+        }
+        Ql_FwUpg_Progress("Format Flash", i, count, &shown, 5);
+        Ctx->Ckpt.Erased = (i + 1) * QL_FWUPG_DA_FORMAT_BLOCK;
+        Ql_FwUpg_Checkpoint(Ctx, 0);
+    }
+    Ql_FwUpg_Checkpoint(Ctx, 1);
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Bring up the DA and format the flash for the images
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Connect(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    QL_LOG_I("-->handshake");
+    if (Ql_FwUpg_Da_Handshake(Ctx) != 0)
+    {
+        return -1;
+    }
+    QL_LOG_I("-->disable module WDT");
+    if (Ql_FwUpg_Da_Disable_WDT(Ctx) != 0)
+    {
+        return -2;
+    }
+    QL_LOG_I("-->send DA");
+    if (Ql_FwUpg_Da_Send(Ctx) != 0)
+    {
+        return -3;
+    }
+    QL_LOG_I("-->jump to DA");
+    if (Ql_FwUpg_Da_Start(Ctx) != 0)
+    {
+        return -4;
+    }
+    QL_LOG_I("-->format flash");
+    if (Ql_FwUpg_Da_Format(Ctx) != 0)
+    {
+        return -5;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Write one block with a race command built in place
+* ex:
+* @par
+* The header goes in the 16 bytes before the data, byte by byte, the data
+* in segments.
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Da_Block(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Index, uint8_t *Data, uint32_t Len)
+{
+    uint8_t *head = Data - QL_FWUPG_DA_RACE_HEAD_LEN;
+    uint32_t addr = Ctx->Image->Addr + Index * Ctx->Proto->Block_Size;
+    uint32_t checksum = 0;
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        checksum += Data[i];
+    }
+
+    head[0] = QL_FWUPG_DA_RACE_HEAD;
+    head[1] = QL_FWUPG_DA_RACE_TYPE;
+    Ql_FwUpg_Da_Put(head + 2, Len + QL_FWUPG_DA_RACE_HEAD_LEN - 4, 2);
+    Ql_FwUpg_Da_Put(head + 4, QL_FWUPG_DA_RACE_WRITE, 2);
+    Ql_FwUpg_Da_Put(head + 6, addr, 4);
+    Ql_FwUpg_Da_Put(head + 10, Len, 2);
+    Ql_FwUpg_Da_Put(head + 12, checksum, 4);
+
+    if ((Ql_FwUpg_Da_Race_Head(Ctx, head, QL_FWUPG_DA_RACE_HEAD_LEN) != 0) ||
+        (Ql_FwUpg_Send(Ctx, Data, Len) != 0))
+    {
+        QL_LOG_E("race 0x%08X send error", addr);
+        return -1;
+    }
+
+    return Ql_FwUpg_Da_Race_Resp(Ctx, addr);
+}
+
+/* The DA wants a pause between two images */
+static int32_t Ql_FwUpg_Da_End(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    (void)Ctx;
+    vTaskDelay(pdMS_TO_TICKS(100));
+    return 0;
+}
+
+const Ql_FwUpg_Protocol_TypeDef Ql_FwUpg_LCX9H_DA =
+{
+    .Name = "LCx9H DA",
+    .Block_Size = 4096,
+    .Flags = QL_FWUPG_PAD | QL_FWUPG_RESUME,
+    .Segment = 256,
+    .Gap = 1,
+    .Connect = Ql_FwUpg_Da_Connect,
+    .Begin = NULL,
+    .Block = Ql_FwUpg_Da_Block,
+    .End = Ql_FwUpg_Da_End,
+    .Finish = NULL,
+    .Param = NULL,
+};
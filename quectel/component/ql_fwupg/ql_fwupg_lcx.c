@@ -0,0 +1,579 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_fwupg_lcx.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_fwupg.h"
+#include "ql_check.h"
+
+#define LOG_TAG "fwupg_lcx"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+/* Bootloader of the LCx9H and LCx6G modules. Frames are
+   AA 02 <msg> <len BE16> <payload> <crc32 BE> 55, the CRC32 covers class
+   to payload. On I2C the host polls the module for the bytes it has to
+   send; the LCx6G also wants the length of every frame up front. On UART
+   and SPI the frames go straight over the line. */
+#define QL_FWUPG_LCX_HEAD           (0xAAU)
+#define QL_FWUPG_LCX_CLASS          (0x02U)
+#define QL_FWUPG_LCX_TAIL           (0x55U)
+#define QL_FWUPG_LCX_FRAME_LEN(n)   (5U + (n) + 5U)
+#define QL_FWUPG_LCX_PAYLOAD_MAX    (16U)           // of the commands, the data goes in place
+#define QL_FWUPG_LCX_POLL           (10U)           // longest ms between two I2C polls, and for one on UART and SPI
+#define QL_FWUPG_LCX_CMD_DELAY      (100U)          // ms between a command and its response
+#define QL_FWUPG_LCX_HANDSHAKE_MAX  (100U * 50U)    // polls for the first handshake word
+
+#define QL_FWUPG_LCX_MSG_FW_ADDR    (0x01U)
+#define QL_FWUPG_LCX_MSG_FW_INFO    (0x02U)
+#define QL_FWUPG_LCX_MSG_UPGRADE    (0x03U)         // LCx9H
+#define QL_FWUPG_LCX_MSG_ERASE      (0x03U)         // LCx6G
+#define QL_FWUPG_LCX_MSG_FW_DATA    (0x04U)
+#define QL_FWUPG_LCX_MSG_FORMAT     (0x21U)
+#define QL_FWUPG_LCX_MSG_REBOOT     (0x31U)
+#define QL_FWUPG_LCX_MSG_BL_VER     (0x71U)
+
+#define QL_FWUPG_LCX_STATUS_OK      (0x00U)
+#define QL_FWUPG_LCX_STATUS_CRC_ERR (0x02U)
+
+typedef struct
+{
+    uint32_t    Resp_Reg;       // I2C register with the number of bytes to read
+    uint32_t    Announce_Reg;   // I2C register for the length of the next frame, 0: none
+    uint16_t    Reg_Gap;        // ms between writing the register and reading it
+    uint16_t    Poll_Gap;       // ms between two polls of a response, 0: from 1 ms doubling up to QL_FWUPG_LCX_POLL
+    uint32_t    Resp_Ms;        // for a response
+} Ql_FwUpg_Lcx_TypeDef;
+
+static const Ql_FwUpg_Lcx_TypeDef FwUpg_Lcx9h =
+{
+    .Resp_Reg = 0x080051AA,
+    .Announce_Reg = 0,
+    .Reg_Gap = 0,
+    .Poll_Gap = 0,
+    .Resp_Ms = 2000,
+};
+
+static const Ql_FwUpg_Lcx_TypeDef FwUpg_Lcx6g =
+{
+    .Resp_Reg = 0x080051AA,
+    .Announce_Reg = 0x040051AA,
+    .Reg_Gap = 10,
+    .Poll_Gap = 20,
+    .Resp_Ms = 180 * 1000,
+};
+
+static uint8_t FwUpg_Lcx_Frame[QL_FWUPG_LCX_FRAME_LEN(QL_FWUPG_LCX_PAYLOAD_MAX)];
+
+static void Ql_FwUpg_Put_LE32(uint8_t *Data, uint32_t Value)
+{
+    Data[0] = Value & 0xFF;
+    Data[1] = (Value >> 8) & 0xFF;
+    Data[2] = (Value >> 16) & 0xFF;
+    Data[3] = (Value >> 24) & 0xFF;
+}
+
+static void Ql_FwUpg_Put_BE32(uint8_t *Data, uint32_t Value)
+{
+    Data[0] = (Value >> 24) & 0xFF;
+    Data[1] = (Value >> 16) & 0xFF;
+    Data[2] = (Value >> 8) & 0xFF;
+    Data[3] = Value & 0xFF;
+}
+
+static uint32_t Ql_FwUpg_Get_LE32(const uint8_t *Data)
+{
+    return Data[0] | (Data[1] << 8) | (Data[2] << 16) | ((uint32_t)Data[3] << 24);
+}
+
+static uint32_t Ql_FwUpg_Get_BE32(const uint8_t *Data)
+{
+    return ((uint32_t)Data[0] << 24) | (Data[1] << 16) | (Data[2] << 8) | Data[3];
+}
+
+/*****************************************************************************
+* @brief  One exchange with the module: send, then read what it has
+* ex:
+* @par
+* Either part may be left out. On I2C the module is asked for the number of
+* bytes it holds, fewer than RecvLen is a failed poll. The transport paces
+* the I2C transactions, no delay is needed for the module to turn around.
+* @retval 0: ok, < 0: nothing or not enough to read
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Exchange(Ql_FwUpg_Ctx_TypeDef *Ctx, const uint8_t *Send, uint32_t SendLen,
+                                     uint8_t *Recv, uint32_t RecvLen)
+{
+    const Ql_FwUpg_Lcx_TypeDef *lcx = (const Ql_FwUpg_Lcx_TypeDef *)Ctx->Proto->Param;
+    const uint8_t is_iic = (Ctx->Bus->Type == QL_FWUPG_BUS_IIC);
+    uint8_t reg[8];
+
+    if ((Send != NULL) && (SendLen != 0))
+    {
+        if (is_iic && (lcx->Announce_Reg != 0))
+        {
+            Ql_FwUpg_Put_LE32(reg, lcx->Announce_Reg);
+            Ql_FwUpg_Put_LE32(reg + 4, SendLen);
+            if (Ql_FwUpg_Send(Ctx, reg, 8) != 0)
+            {
+                return -1;
+            }
+        }
+        if (Ql_FwUpg_Send(Ctx, Send, SendLen) != 0)
+        {
+            return -1;
+        }
+    }
+
+    if ((Recv == NULL) || (RecvLen == 0))
+    {
+        return 0;
+    }
+    if (is_iic != 1)
+    {
+        return Ql_FwUpg_Recv(Ctx, Recv, RecvLen, QL_FWUPG_LCX_POLL);
+    }
+
+    Ql_FwUpg_Put_LE32(reg, lcx->Resp_Reg);
+    if (Ctx->Bus->Write(Ctx->Bus->Port, reg, 4) != 0)
+    {
+        Ctx->Stats.Bus_Errors++;
+        return -1;
+    }
+    Ctx->Stats.Bus_Writes++;
+    Ctx->Stats.Bus_Bytes += 4;
+    if (lcx->Reg_Gap != 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(lcx->Reg_Gap));
+    }
+    if (Ql_FwUpg_Recv(Ctx, reg, 4, QL_FWUPG_LCX_POLL) != 0)
+    {
+        return -2;
+    }
+    if (Ql_FwUpg_Get_LE32(reg) < RecvLen)
+    {
+        QL_LOG_D("can read length %d < RecvLength %d", Ql_FwUpg_Get_LE32(reg), RecvLen);
+        return -3;
+    }
+
+    return (Ql_FwUpg_Recv(Ctx, Recv, RecvLen, QL_FWUPG_LCX_POLL) == 0) ? 0 : -2;
+}
+
+/*****************************************************************************
+* @brief  Repeat the exchange until the module answers
+* ex:
+* @par
+* None
+* @retval 0: ok, -1: no answer
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Wait(Ql_FwUpg_Ctx_TypeDef *Ctx, const uint8_t *Send, uint32_t SendLen,
+                                 uint8_t *Recv, uint32_t RecvLen)
+{
+    const Ql_FwUpg_Lcx_TypeDef *lcx = (const Ql_FwUpg_Lcx_TypeDef *)Ctx->Proto->Param;
+    const TickType_t start_tick = xTaskGetTickCount();
+    uint32_t gap = 1;
+
+    while (1)
+    {
+        if (Ql_FwUpg_Lcx_Exchange(Ctx, Send, SendLen, Recv, RecvLen) == 0)
+        {
+            return 0;
+        }
+
+        if ((xTaskGetTickCount() - start_tick) >= pdMS_TO_TICKS(lcx->Resp_Ms))
+        {
+            return -1;
+        }
+        if (lcx->Poll_Gap != 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(lcx->Poll_Gap));
+        }
+        else if (Ctx->Bus->Type == QL_FWUPG_BUS_IIC)
+        {
+            /* a quick answer is seen at once, a busy module is polled less often */
+            vTaskDelay(pdMS_TO_TICKS(gap));
+            gap = (gap * 2 < QL_FWUPG_LCX_POLL) ? (gap * 2) : QL_FWUPG_LCX_POLL;
+        }
+    }
+}
+
+/*****************************************************************************
+* @brief  Frame and send the payload at Frame + 5
+* ex:
+* @par
+* Frame needs 5 bytes before the payload and 5 after it.
+* @retval 0: ok, < 0: transport error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Send(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t Msg, uint8_t *Frame, uint32_t Len)
+{
+    uint32_t crc;
+
+    Frame[0] = QL_FWUPG_LCX_HEAD;
+    Frame[1] = QL_FWUPG_LCX_CLASS;
+    Frame[2] = Msg;
+    Frame[3] = (Len >> 8) & 0xFF;
+    Frame[4] = Len & 0xFF;
+    crc = Ql_Check_CRC32(0, Frame + 1, 4 + Len);
+    Ql_FwUpg_Put_BE32(Frame + 5 + Len, crc);
+    Frame[9 + Len] = QL_FWUPG_LCX_TAIL;
+
+    return Ql_FwUpg_Lcx_Exchange(Ctx, Frame, QL_FWUPG_LCX_FRAME_LEN(Len), NULL, 0);
+}
+
+/*****************************************************************************
+* @brief  Wait for a response and check its frame
+* ex:
+* @par
+* Payload gets Len bytes: class, msg id, then the rest of the response.
+* @retval 0: ok, -1: no response, -2: broken frame
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Recv(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t *Payload, uint32_t Len)
+{
+    uint8_t frame[QL_FWUPG_LCX_FRAME_LEN(QL_FWUPG_LCX_PAYLOAD_MAX)];
+    uint32_t payload_len;
+
+    if (Ql_FwUpg_Lcx_Wait(Ctx, NULL, 0, frame, QL_FWUPG_LCX_FRAME_LEN(Len)) != 0)
+    {
+        QL_LOG_E("get protocol error");
+        return -1;
+    }
+
+    payload_len = (frame[3] << 8) | frame[4];
+    if ((frame[0] != QL_FWUPG_LCX_HEAD) || (frame[QL_FWUPG_LCX_FRAME_LEN(Len) - 1] != QL_FWUPG_LCX_TAIL) ||
+        (payload_len != Len))
+    {
+        QL_LOG_E("response header, tail or length error");
+        return -2;
+    }
+    if (Ql_FwUpg_Get_BE32(frame + 5 + Len) != Ql_Check_CRC32(0, frame + 1, 4 + Len))
+    {
+        QL_LOG_E("response CRC32 error");
+        return -2;
+    }
+
+    memcpy(Payload, frame + 5, Len);
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Send a command and check the response of the module
+* ex:
+* @par
+* Resp gets Len bytes of the response payload, at least the 4 of
+* class, msg id and status BE16. Resp may be the payload sent.
+* @retval 0: ok, > 0: status of the module, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Cmd(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t Msg, uint8_t *Frame, uint32_t Len,
+                                uint32_t Delay, uint8_t *Resp, uint32_t RespLen)
+{
+    uint16_t status;
+
+    if (Ql_FwUpg_Lcx_Send(Ctx, Msg, Frame, Len) != 0)
+    {
+        QL_LOG_E("send protocol 0x%02X error", Msg);
+        return -1;
+    }
+    if (Delay != 0)
+    {
+        vTaskDelay(pdMS_TO_TICKS(Delay));
+    }
+    if (Ql_FwUpg_Lcx_Recv(Ctx, Resp, RespLen) != 0)
+    {
+        return -2;
+    }
+    if (Resp[1] != Msg)
+    {
+        QL_LOG_E("get protocol msgid error, 0x%02X != 0x%02X", Resp[1], Msg);
+        return -3;
+    }
+
+    status = (Resp[2] << 8) | Resp[3];
+    if (status != QL_FWUPG_LCX_STATUS_OK)
+    {
+        QL_LOG_E("get protocol 0x%02X status error, 0x%04X", Msg, status);
+    }
+    return status;
+}
+
+/* A command with a payload of up to QL_FWUPG_LCX_PAYLOAD_MAX bytes */
+static int32_t Ql_FwUpg_Lcx_Simple(Ql_FwUpg_Ctx_TypeDef *Ctx, uint8_t Msg, const uint8_t *Payload, uint32_t Len,
+                                   uint32_t Delay)
+{
+    uint8_t resp[4];
+
+    memcpy(FwUpg_Lcx_Frame + 5, Payload, Len);
+    return (Ql_FwUpg_Lcx_Cmd(Ctx, Msg, FwUpg_Lcx_Frame, Len, Delay, resp, sizeof(resp)) == 0) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  Shake hands with the bootloader
+* ex:
+* @par
+* The first word is sent until the module answers, for up to 5000 polls.
+* @retval 0: ok, -1: no answer, -2: wrong second word
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Connect(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    uint8_t send_data[4];
+    uint8_t recv_data[4];
+    uint32_t count;
+
+    Ql_FwUpg_Put_LE32(send_data, 0x514C1309);
+    for (count = 0; count <= QL_FWUPG_LCX_HANDSHAKE_MAX; count++)
+    {
+        if ((Ql_FwUpg_Lcx_Exchange(Ctx, send_data, 4, recv_data, 4) == 0) &&
+            (Ql_FwUpg_Get_LE32(recv_data) == 0xAAFC3A4D))
+        {
+            QL_LOG_D("get handshake word1...");
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_LCX_POLL));
+        if (count % 100 == 0)
+        {
+            QL_LOG_I("waiting for handshake...");
+        }
+    }
+    if (count > QL_FWUPG_LCX_HANDSHAKE_MAX)
+    {
+        return -1;
+    }
+
+    Ql_FwUpg_Put_LE32(send_data, 0x1203A504);
+    if ((Ql_FwUpg_Lcx_Wait(Ctx, send_data, 4, recv_data, 4) != 0) || (Ql_FwUpg_Get_LE32(recv_data) != 0x55FD5BA0))
+    {
+        QL_LOG_E("get handshake word2 error, 0x%08X", Ql_FwUpg_Get_LE32(recv_data));
+        return -2;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Format the flash of the LCx9H for the image
+* ex:
+* @par
+* The module reports the progress, each report is echoed back until 100%,
+* then a normal response follows.
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx9h_Format(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Addr, uint32_t Len)
+{
+    uint8_t *payload = FwUpg_Lcx_Frame + 5;
+    uint8_t resp[5];
+    uint32_t size = 8;
+
+    Ql_FwUpg_Put_BE32(payload, Addr);
+    Ql_FwUpg_Put_BE32(payload + 4, Len);
+    if (Ql_FwUpg_Lcx_Send(Ctx, QL_FWUPG_LCX_MSG_FORMAT, FwUpg_Lcx_Frame, size) != 0)
+    {
+        return -1;
+    }
+    vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_LCX_CMD_DELAY));
+
+    do
+    {
+        if (Ql_FwUpg_Lcx_Recv(Ctx, resp, sizeof(resp)) != 0)
+        {
+            return -2;
+        }
+        if ((resp[1] != QL_FWUPG_LCX_MSG_FORMAT) || (resp[3] != 0) || (resp[4] != 0))
+        {
+            QL_LOG_E("format response error, msg 0x%02X status 0x%02X%02X", resp[1], resp[3], resp[4]);
+            return -3;
+        }
+        QL_LOG_I("format flash progress %d%%", resp[2]);
+
+        payload[0] = 0;
+        payload[1] = 0;
+        payload[2] = resp[2];
+        payload[3] = 0;
+        payload[4] = 0;
+        if (Ql_FwUpg_Lcx_Send(Ctx, QL_FWUPG_LCX_MSG_FORMAT, FwUpg_Lcx_Frame, 5) != 0)
+        {
+            return -1;
+        }
+    } while (resp[2] < 100);
+
+    if ((Ql_FwUpg_Lcx_Recv(Ctx, resp, 4) != 0) || (resp[1] != QL_FWUPG_LCX_MSG_FORMAT) ||
+        (resp[2] != 0) || (resp[3] != 0))
+    {
+        QL_LOG_E("format end response error");
+        return -4;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Announce an image to the LCx9H and format its flash
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx9h_Begin(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const Ql_FwUpg_Image_TypeDef *image = Ctx->Image;
+    uint8_t payload[16] = { 0 };
+    uint32_t format_size;
+
+    QL_LOG_I("-->send fw addr 0x%08X", image->Addr);
+    Ql_FwUpg_Put_BE32(payload, image->Addr);
+    if (Ql_FwUpg_Lcx_Simple(Ctx, QL_FWUPG_LCX_MSG_FW_ADDR, payload, 4, 0) != 0)
+    {
+        return -1;
+    }
+
+    QL_LOG_I("-->send fw info: size 0x%08X", Ctx->Size);
+    Ql_FwUpg_Put_BE32(payload, Ctx->Size);
+    Ql_FwUpg_Put_BE32(payload + 4, Ctx->Crc);
+    Ql_FwUpg_Put_BE32(payload + 8, image->Addr);
+    payload[12] = 0x01;     // erase
+    if (Ql_FwUpg_Lcx_Simple(Ctx, QL_FWUPG_LCX_MSG_FW_INFO, payload, 16, QL_FWUPG_LCX_CMD_DELAY) != 0)
+    {
+        return -2;
+    }
+
+    QL_LOG_I("-->send fw upgrade command");
+    if (Ql_FwUpg_Lcx_Simple(Ctx, QL_FWUPG_LCX_MSG_UPGRADE, payload, 0, QL_FWUPG_LCX_CMD_DELAY) != 0)
+    {
+        return -3;
+    }
+
+    QL_LOG_I("-->format flash");
+    format_size = (image->Format_Size < Ctx->Proto->Block_Size) ? Ctx->Size : image->Format_Size;
+    if (Ql_FwUpg_Lcx9h_Format(Ctx, image->Addr, format_size) != 0)
+    {
+        return -4;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Read the bootloader version of the LCx6G, announce the image and
+*         erase its flash
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx6g_Begin(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const Ql_FwUpg_Image_TypeDef *image = Ctx->Image;
+    uint8_t payload[16] = { 0 };
+    uint8_t resp[7];
+
+    QL_LOG_I("-->get boot ver");
+    if (Ql_FwUpg_Lcx_Cmd(Ctx, QL_FWUPG_LCX_MSG_BL_VER, FwUpg_Lcx_Frame, 0, 0, resp, sizeof(resp)) != 0)
+    {
+        return -1;
+    }
+    QL_LOG_I("Boot ver: V%02X.%02X.%02X", resp[4], resp[5], resp[6]);
+
+    QL_LOG_I("-->send fw info: size %d, crc32 0x%08X, dest 0x%08X", Ctx->Size, Ctx->Crc, image->Addr);
+    Ql_FwUpg_Put_BE32(payload, Ctx->Size);
+    Ql_FwUpg_Put_BE32(payload + 4, Ctx->Crc);
+    Ql_FwUpg_Put_BE32(payload + 8, image->Addr);
+    if (Ql_FwUpg_Lcx_Simple(Ctx, QL_FWUPG_LCX_MSG_FW_INFO, payload, 16, QL_FWUPG_LCX_CMD_DELAY) != 0)
+    {
+        return -2;
+    }
+
+    QL_LOG_I("-->send fw Erase command");
+    if (Ql_FwUpg_Lcx_Simple(Ctx, QL_FWUPG_LCX_MSG_ERASE, payload, 0, QL_FWUPG_LCX_CMD_DELAY) != 0)
+    {
+        return -3;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Send one data packet, framed in place around the block
+* ex:
+* @par
+* The packet number goes in the 4 bytes before the data. A block the
+* module got with a bad CRC32 is sent again.
+* @retval 0: ok, QL_FWUPG_RETRY: send it again, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx_Block(Ql_FwUpg_Ctx_TypeDef *Ctx, uint32_t Index, uint8_t *Data, uint32_t Len)
+{
+    uint8_t resp[4];
+    int32_t ret;
+
+    Ql_FwUpg_Put_BE32(Data - 4, Index);
+    ret = Ql_FwUpg_Lcx_Cmd(Ctx, QL_FWUPG_LCX_MSG_FW_DATA, Data - 9, Len + 4, 0, resp, sizeof(resp));
+    if (ret == QL_FWUPG_LCX_STATUS_CRC_ERR)
+    {
+        return QL_FWUPG_RETRY;
+    }
+
+    return (ret == 0) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  Reboot the LCx6G into the new firmware
+* ex:
+* @par
+* None
+* @retval 0: ok, < 0: error
+*****************************************************************************/
+static int32_t Ql_FwUpg_Lcx6g_Reboot(Ql_FwUpg_Ctx_TypeDef *Ctx)
+{
+    const uint8_t payload[2] = { 0x02, 0x00 };      // the module resets itself
+
+    QL_LOG_I("-->reboot");
+    return Ql_FwUpg_Lcx_Simple(Ctx, QL_FWUPG_LCX_MSG_REBOOT, payload, 2, QL_FWUPG_LCX_CMD_DELAY);
+}
+
+const Ql_FwUpg_Protocol_TypeDef Ql_FwUpg_LCX9H =
+{
+    .Name = "LCx9H",
+    .Block_Size = 4096,
+    .Flags = QL_FWUPG_PAD | QL_FWUPG_IMAGE_CRC,
+    .Segment = 256,
+    .Gap = 10,
+    .Connect = Ql_FwUpg_Lcx_Connect,
+    .Begin = Ql_FwUpg_Lcx9h_Begin,
+    .Block = Ql_FwUpg_Lcx_Block,
+    .End = NULL,
+    .Finish = NULL,
+    .Param = &FwUpg_Lcx9h,
+};
+
+const Ql_FwUpg_Protocol_TypeDef Ql_FwUpg_LCX6G =
+{
+    .Name = "LCx6G",
+    .Block_Size = 4096,
+    .Flags = QL_FWUPG_IMAGE_CRC,
+    .Segment = 256,
+    .Gap = 10,
+    .Connect = Ql_FwUpg_Lcx_Connect,
+    .Begin = Ql_FwUpg_Lcx6g_Begin,
+    .Block = Ql_FwUpg_Lcx_Block,
+    .End = NULL,
+    .Finish = Ql_FwUpg_Lcx6g_Reboot,
+    .Param = &FwUpg_Lcx6g,
+};
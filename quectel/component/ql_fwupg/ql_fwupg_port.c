@@ -0,0 +1,253 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_fwupg_port.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_fwupg.h"
+#include "ql_uart.h"
+
+#define LOG_TAG "fwupg"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_FWUPG_IIC_TIMEOUT        (1000U)     // ms per transfer
+#define QL_FWUPG_IIC_DELAY          (10U)       // ms after an error
+#define QL_FWUPG_UART_TIMEOUT       (1000U)     // ms per write
+#define QL_FWUPG_SPI_TIMEOUT        (1000U)     // ms per write
+
+/*****************************************************************************
+* @brief  Recover the I2C port after an error
+* ex:
+* @par
+* A busy bus is released and the port initialized again. A NACK the pacing
+* could not get past is what a module in the middle of programming answers,
+* it is not logged.
+* @retval None
+*****************************************************************************/
+static void Ql_FwUpg_IIC_ErrHandle(const Ql_FwUpg_IIC_TypeDef *Port, Ql_IIC_Status_TypeDef Status)
+{
+    switch (Status)
+    {
+        case QL_IIC_STATUS_OK:
+            break;
+        case QL_IIC_STATUS_BUSY:
+            Ql_IIC_CheckBusSatus();
+            Ql_IIC_DeInit();
+            QL_LOG_E("iic port busy and re-init.");
+            vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_IIC_DELAY));
+            Ql_IIC_Init(Port->Mode, Port->Speed, Port->Tx_Size, Port->Rx_Size);
+            break;
+        case QL_IIC_STATUS_TIMEOUT:
+            QL_LOG_E("iic port r/w timeout.");
+            break;
+        case QL_IIC_STATUS_NOACK:
+            break;
+        case QL_IIC_STATUS_SEM_ERROR:
+            QL_LOG_E("iic port semaphore error.");
+            break;
+        case QL_IIC_STATUS_MODE_ERROR:
+            QL_LOG_E("iic port mode error.");
+            break;
+        case QL_IIC_STATUS_MEMORY_ERROR:
+            QL_LOG_E("iic port memory error.");
+            break;
+        case QL_IIC_STATUS_ADDSEND_ERROR:
+            QL_LOG_E("iic port address send error.");
+            vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_IIC_DELAY));
+            break;
+        default:
+            QL_LOG_W("iic port unknown state:%d", Status);
+            break;
+    }
+    vTaskDelay(pdMS_TO_TICKS(QL_FWUPG_IIC_DELAY));
+}
+
+static int32_t Ql_FwUpg_IIC_Open(void *Port)
+{
+    const Ql_FwUpg_IIC_TypeDef *iic = (const Ql_FwUpg_IIC_TypeDef *)Port;
+
+    return (Ql_IIC_Init(iic->Mode, iic->Speed, iic->Tx_Size, iic->Rx_Size) == QL_IIC_STATUS_OK) ? 0 : -1;
+}
+
+static void Ql_FwUpg_IIC_Close(void *Port)
+{
+    (void)Port;
+    Ql_IIC_DeInit();
+}
+
+static int32_t Ql_FwUpg_IIC_Write(void *Port, const uint8_t *Data, uint32_t Len)
+{
+    Ql_FwUpg_IIC_TypeDef *iic = (Ql_FwUpg_IIC_TypeDef *)Port;
+    Ql_IIC_Status_TypeDef status;
+
+    status = Ql_IIC_PaceWrite(&iic->Pace, iic->Addr & 0xFE, 0, (uint8_t *)Data, Len, QL_FWUPG_IIC_TIMEOUT);
+    if (status != QL_IIC_STATUS_OK)
+    {
+        Ql_FwUpg_IIC_ErrHandle(iic, status);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* The slave clocks out whatever it has, the caller polls for a response */
+static int32_t Ql_FwUpg_IIC_Read(void *Port, uint8_t *Data, uint32_t Len, uint32_t Timeout)
+{
+    Ql_FwUpg_IIC_TypeDef *iic = (Ql_FwUpg_IIC_TypeDef *)Port;
+    Ql_IIC_Status_TypeDef status;
+
+    (void)Timeout;
+    status = Ql_IIC_PaceRead(&iic->Pace, iic->Addr | 0x01, 0, Data, Len, QL_FWUPG_IIC_TIMEOUT);
+    if (status != QL_IIC_STATUS_OK)
+    {
+        Ql_FwUpg_IIC_ErrHandle(iic, status);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Bind a transport to an I2C port
+* ex:
+* @par
+* Port has to live as long as the transport. The pacing is set up on the
+* first bind only, what it learnt carries over to the next upgrade.
+* @retval None
+*****************************************************************************/
+void Ql_FwUpg_IIC_Transport(Ql_FwUpg_Transport_TypeDef *Bus, Ql_FwUpg_IIC_TypeDef *Port)
+{
+    if (Port->Pace.name == NULL)
+    {
+        Ql_IIC_PaceInit(&Port->Pace, (Port->Module != NULL) ? Port->Module : "fwupg", Port->Gap_Min_Us, Port->Gap_Max_Us);
+    }
+    Bus->Type = QL_FWUPG_BUS_IIC;
+    Bus->Open = Ql_FwUpg_IIC_Open;
+    Bus->Close = Ql_FwUpg_IIC_Close;
+    Bus->Write = Ql_FwUpg_IIC_Write;
+    Bus->Read = Ql_FwUpg_IIC_Read;
+    Bus->Port = Port;
+}
+
+static int32_t Ql_FwUpg_Uart_Open(void *Port)
+{
+    const Ql_FwUpg_Uart_TypeDef *uart = (const Ql_FwUpg_Uart_TypeDef *)Port;
+
+    return Ql_Uart_Init(uart->Name, uart->Periph, uart->Baud, uart->Rx_Size, uart->Tx_Size);
+}
+
+static void Ql_FwUpg_Uart_Close(void *Port)
+{
+    Ql_Uart_DeInit(((const Ql_FwUpg_Uart_TypeDef *)Port)->Periph);
+}
+
+static int32_t Ql_FwUpg_Uart_Write(void *Port, const uint8_t *Data, uint32_t Len)
+{
+    const Ql_FwUpg_Uart_TypeDef *uart = (const Ql_FwUpg_Uart_TypeDef *)Port;
+
+    return (Ql_Uart_Write(uart->Periph, Data, Len, pdMS_TO_TICKS(QL_FWUPG_UART_TIMEOUT)) == (int32_t)Len) ? 0 : -1;
+}
+
+/* Ql_Uart_Read returns what arrived so far, wait for the rest */
+static int32_t Ql_FwUpg_Uart_Read(void *Port, uint8_t *Data, uint32_t Len, uint32_t Timeout)
+{
+    const Ql_FwUpg_Uart_TypeDef *uart = (const Ql_FwUpg_Uart_TypeDef *)Port;
+    TickType_t start_tick = xTaskGetTickCount();
+    TickType_t elapsed;
+    uint32_t had_read = 0;
+    int32_t n;
+
+    while (had_read < Len)
+    {
+        elapsed = xTaskGetTickCount() - start_tick;
+        if (elapsed >= pdMS_TO_TICKS(Timeout))
+        {
+            return -1;
+        }
+        n = Ql_Uart_Read(uart->Periph, Data + had_read, Len - had_read, pdMS_TO_TICKS(Timeout) - elapsed);
+        had_read += (n > 0) ? n : 0;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Bind a transport to a UART
+* ex:
+* @par
+* Port has to live as long as the transport.
+* @retval None
+*****************************************************************************/
+void Ql_FwUpg_Uart_Transport(Ql_FwUpg_Transport_TypeDef *Bus, Ql_FwUpg_Uart_TypeDef *Port)
+{
+    Bus->Type = QL_FWUPG_BUS_UART;
+    Bus->Open = Ql_FwUpg_Uart_Open;
+    Bus->Close = Ql_FwUpg_Uart_Close;
+    Bus->Write = Ql_FwUpg_Uart_Write;
+    Bus->Read = Ql_FwUpg_Uart_Read;
+    Bus->Port = Port;
+}
+
+static int32_t Ql_FwUpg_SPI_Open(void *Port)
+{
+    const Ql_FwUpg_SPI_TypeDef *spi = (const Ql_FwUpg_SPI_TypeDef *)Port;
+
+    return (Ql_SPI_Init(spi->Mode, spi->Tx_Size, spi->Rx_Size) == SPI_STATUS_OK) ? 0 : -1;
+}
+
+static void Ql_FwUpg_SPI_Close(void *Port)
+{
+    (void)Port;
+    Ql_SPI_DeInit();
+}
+
+static int32_t Ql_FwUpg_SPI_Write(void *Port, const uint8_t *Data, uint32_t Len)
+{
+    (void)Port;
+    return (Ql_SPI_Write((uint8_t *)Data, Len, QL_FWUPG_SPI_TIMEOUT) == SPI_STATUS_OK) ? 0 : -1;
+}
+
+static int32_t Ql_FwUpg_SPI_Read(void *Port, uint8_t *Data, uint32_t Len, uint32_t Timeout)
+{
+    (void)Port;
+    return (Ql_SPI_Read(Data, Len, Timeout) == SPI_STATUS_OK) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  Bind a transport to the SPI port
+* ex:
+* @par
+* Port has to live as long as the transport.
+* @retval None
+*****************************************************************************/
+void Ql_FwUpg_SPI_Transport(Ql_FwUpg_Transport_TypeDef *Bus, Ql_FwUpg_SPI_TypeDef *Port)
+{
+    Bus->Type = QL_FWUPG_BUS_SPI;
+    Bus->Open = Ql_FwUpg_SPI_Open;
+    Bus->Close = Ql_FwUpg_SPI_Close;
+    Bus->Write = Ql_FwUpg_SPI_Write;
+    Bus->Read = Ql_FwUpg_SPI_Read;
+    Bus->Port = Port;
+}
@@ -0,0 +1,562 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_flash_log.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#if !defined(QL_FLASH_HOST)
+#include "semphr.h"
+#include "ql_rtc.h"
+#endif
+
+#include "ql_flash.h"
+#include "ql_flash_log.h"
+#include "ql_check.h"
+
+#define LOG_TAG "flash_log"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_FLASH_LOG_ALIGN(n)       (((n) + 3U) & ~3U)
+#define QL_FLASH_LOG_REC_SIZE(len)  QL_FLASH_LOG_ALIGN(sizeof(Ql_Flash_Log_Rec_TypeDef) + (len))
+#define QL_FLASH_LOG_SECT_CRC_LEN   (sizeof(Ql_Flash_Log_Sect_TypeDef) - 4U)
+#define QL_FLASH_LOG_REC_CRC_LEN    (sizeof(Ql_Flash_Log_Rec_TypeDef) - 4U)
+
+typedef struct
+{
+    uint8_t     Ready;
+    uint32_t    Head;
+    uint32_t    Head_Seq;
+    uint32_t    Head_Erase;     // erase count of the head sector
+    uint32_t    Offset;         // write position in the head sector
+    uint32_t    Rec_Seq;
+    uint32_t    Base_Seq;       // records below it are cleared
+} Ql_Flash_Log_TypeDef;
+
+static Ql_Flash_Log_TypeDef Flash_Log;
+static Ql_Flash_Log_Stats_TypeDef Flash_Log_Stats;
+static uint32_t Flash_Log_Buf[QL_FLASH_LOG_REC_SIZE(QL_FLASH_LOG_REC_MAX) / 4];
+
+static int32_t Ql_Flash_Log_Raw_Read(uint32_t Ofs, void *Buf, uint32_t Len)
+{
+    return (Ql_Flash_Read(QL_FLASH_LOG_ADDR + Ofs, Buf, Len) < 0) ? -1 : 0;
+}
+
+static int32_t Ql_Flash_Log_Raw_Prog(uint32_t Ofs, const void *Buf, uint32_t Len)
+{
+    return (Ql_Flash_Write(QL_FLASH_LOG_ADDR + Ofs, Buf, Len) < 0) ? -1 : 0;
+}
+
+static int32_t Ql_Flash_Log_Raw_Erase(uint32_t Sector)
+{
+    return (Ql_Flash_Erase(QL_FLASH_LOG_ADDR + Sector * QL_FLASH_LOG_SECTOR_SIZE, QL_FLASH_LOG_SECTOR_SIZE) < 0) ? -1 : 0;
+}
+
+#if defined(QL_FLASH_HOST)
+static uint32_t Ql_Flash_Log_Time(void)
+{
+    return (uint32_t)time(NULL);
+}
+
+#define QL_FLASH_LOG_LOCK()         (1)
+#define QL_FLASH_LOG_UNLOCK()
+#else
+static SemaphoreHandle_t Flash_Log_Mutex = NULL;
+
+static uint32_t Ql_Flash_Log_Time(void)
+{
+    struct tm now = { 0 };
+
+    if (Ql_RTC_Get(&now) != 0)
+    {
+        return 0;
+    }
+    return (uint32_t)mktime(&now);
+}
+
+#define QL_FLASH_LOG_LOCK()         ((Flash_Log_Mutex != NULL) && (xSemaphoreTake(Flash_Log_Mutex, portMAX_DELAY) == pdTRUE))
+#define QL_FLASH_LOG_UNLOCK()       xSemaphoreGive(Flash_Log_Mutex)
+#endif
+
+/*****************************************************************************
+* @brief  Read and check the header of a sector
+* ex:
+* @par
+* None
+* @retval 1: valid, 0: erased, torn or foreign
+*****************************************************************************/
+static uint8_t Ql_Flash_Log_Sect_Get(uint32_t Sector, Ql_Flash_Log_Sect_TypeDef *Sect)
+{
+    Ql_Flash_Log_Raw_Read(Sector * QL_FLASH_LOG_SECTOR_SIZE, Sect, sizeof(*Sect));
+
+    return (Sect->Magic == QL_FLASH_LOG_MAGIC) &&
+           (Sect->Crc == Ql_Check_CRC32(0, (const unsigned char *)Sect, QL_FLASH_LOG_SECT_CRC_LEN));
+}
+
+/*****************************************************************************
+* @brief  Read the record at Ofs into Flash_Log_Buf
+* ex:
+* @par
+* None
+* @retval 1: good, 0: end of the sector, -1: bad CRC, skip Rec->Len,
+*         -2: the length is broken, the rest of the sector is lost
+*****************************************************************************/
+static int32_t Ql_Flash_Log_Rec_Get(uint32_t Sector, uint32_t Ofs, Ql_Flash_Log_Rec_TypeDef *Rec)
+{
+    const uint32_t base = Sector * QL_FLASH_LOG_SECTOR_SIZE;
+
+    if (Ofs + sizeof(*Rec) > QL_FLASH_LOG_SECTOR_SIZE)
+    {
+        return 0;
+    }
+
+    Ql_Flash_Log_Raw_Read(base + Ofs, Rec, sizeof(*Rec));
+
+    /* Programmed in address order, an erased length means nothing of it is there */
+    if (Rec->Len == 0xFFFFU)
+    {
+        return 0;
+    }
+    if ((Rec->Len > QL_FLASH_LOG_REC_MAX) || (Ofs + QL_FLASH_LOG_REC_SIZE(Rec->Len) > QL_FLASH_LOG_SECTOR_SIZE))
+    {
+        return -2;
+    }
+
+    Ql_Flash_Log_Raw_Read(base + Ofs + sizeof(*Rec), Flash_Log_Buf, Rec->Len);
+    if (Rec->Crc != Ql_Check_CRC32(Ql_Check_CRC32(0, (const unsigned char *)Rec, QL_FLASH_LOG_REC_CRC_LEN),
+                                   (const unsigned char *)Flash_Log_Buf, Rec->Len))
+    {
+        return -1;
+    }
+
+    return 1;
+}
+
+/*****************************************************************************
+* @brief  Erase the sector after the head and make it the head
+* ex:
+* @par
+* The erase count is carried over from its old header. A power loss
+* between the erase and the header leaves it blank, the next mount takes
+* the sector before as head and erases it again. A blank sector gets the
+* count of the head, the sectors of a ring wear alike.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_Flash_Log_Advance(void)
+{
+    Ql_Flash_Log_Sect_TypeDef *sect = (Ql_Flash_Log_Sect_TypeDef *)Flash_Log_Buf;
+    const uint32_t next = Flash_Log.Ready ? (Flash_Log.Head + 1) % QL_FLASH_LOG_SECTORS : 0;
+    uint32_t count = (Flash_Log.Head_Erase > 0) ? Flash_Log.Head_Erase - 1 : 0;
+
+    if (Ql_Flash_Log_Sect_Get(next, sect))
+    {
+        count = sect->Erase_Count;
+    }
+
+    if (Ql_Flash_Log_Raw_Erase(next) != 0)
+    {
+        QL_LOG_E("erase sector %u fail", next);
+        return -1;
+    }
+    Flash_Log_Stats.Erases++;
+
+    sect->Magic       = QL_FLASH_LOG_MAGIC;
+    sect->Seq         = Flash_Log.Ready ? Flash_Log.Head_Seq + 1 : 1;
+    sect->Erase_Count = count + 1;
+    sect->Rec_Seq     = Flash_Log.Rec_Seq;
+    sect->Base_Seq    = Flash_Log.Base_Seq;
+    sect->Crc         = Ql_Check_CRC32(0, (const unsigned char *)sect, QL_FLASH_LOG_SECT_CRC_LEN);
+    if (Ql_Flash_Log_Raw_Prog(next * QL_FLASH_LOG_SECTOR_SIZE, sect, sizeof(*sect)) != 0)
+    {
+        return -1;
+    }
+
+    Flash_Log.Head       = next;
+    Flash_Log.Head_Seq   = sect->Seq;
+    Flash_Log.Head_Erase = sect->Erase_Count;
+    Flash_Log.Offset     = sizeof(*sect);
+    Flash_Log.Ready      = 1;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Find the head sector and the end of its records
+* ex:
+* @par
+* Along the ring the sector sequence rises up to the head and drops after
+* it, so "valid and not older than sector 0" holds for sectors 0..Head
+* only and a binary search finds Head in log2(N) + 1 header reads. An
+* erased region is formatted. Call once before the scheduler or from one
+* task.
+* @retval 0: ok, -1: flash error, the log stays off
+*****************************************************************************/
+int32_t Ql_Flash_Log_Init(void)
+{
+    Ql_Flash_Log_Sect_TypeDef first;
+    Ql_Flash_Log_Sect_TypeDef sect;
+    Ql_Flash_Log_Sect_TypeDef probe;
+    Ql_Flash_Log_Rec_TypeDef rec;
+    uint32_t lo = 0;
+    uint32_t hi = QL_FLASH_LOG_SECTORS;
+    uint32_t mid;
+    int32_t ret;
+
+#if !defined(QL_FLASH_HOST)
+    if (Flash_Log_Mutex == NULL)
+    {
+        Flash_Log_Mutex = xSemaphoreCreateMutex();
+        if (Flash_Log_Mutex == NULL)
+        {
+            return -1;
+        }
+    }
+#endif
+
+    memset(&Flash_Log, 0, sizeof(Flash_Log));
+    memset(&Flash_Log_Stats, 0, sizeof(Flash_Log_Stats));
+
+    Flash_Log_Stats.Mount_Reads = 1;
+    if (!Ql_Flash_Log_Sect_Get(0, &first))
+    {
+        /* A blank region, or sector 0 was being erased for the next round */
+        Flash_Log_Stats.Mount_Reads++;
+        if (!Ql_Flash_Log_Sect_Get(QL_FLASH_LOG_SECTORS - 1, &sect))
+        {
+            QL_LOG_I("blank, formatting %u sectors", QL_FLASH_LOG_SECTORS);
+            return Ql_Flash_Log_Advance();
+        }
+        lo = QL_FLASH_LOG_SECTORS - 1;
+    }
+    else
+    {
+        sect = first;
+        while (hi - lo > 1)
+        {
+            mid = (lo + hi) / 2;
+            Flash_Log_Stats.Mount_Reads++;
+            if (Ql_Flash_Log_Sect_Get(mid, &probe) && ((int32_t)(probe.Seq - first.Seq) >= 0))
+            {
+                lo   = mid;
+                sect = probe;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+    }
+
+    Flash_Log.Head       = lo;
+    Flash_Log.Head_Seq   = sect.Seq;
+    Flash_Log.Head_Erase = sect.Erase_Count;
+    Flash_Log.Rec_Seq    = sect.Rec_Seq;
+    Flash_Log.Base_Seq   = sect.Base_Seq;
+    Flash_Log.Offset     = sizeof(sect);
+
+    while ((ret = Ql_Flash_Log_Rec_Get(lo, Flash_Log.Offset, &rec)) != 0)
+    {
+        if (ret == -2)
+        {
+            Flash_Log.Offset = QL_FLASH_LOG_SECTOR_SIZE;
+            break;
+        }
+        if (ret == 1)
+        {
+            Flash_Log.Rec_Seq = rec.Seq + 1;
+        }
+        else
+        {
+            Flash_Log_Stats.Torn++;
+        }
+        Flash_Log.Offset += QL_FLASH_LOG_REC_SIZE(rec.Len);
+        Flash_Log_Stats.Mount_Recs++;
+    }
+
+    Flash_Log.Ready = 1;
+    QL_LOG_I("head sector %u, %u bytes used, next record %u", lo, Flash_Log.Offset, Flash_Log.Rec_Seq);
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Append one record
+* ex:
+* @par
+* Len up to QL_FLASH_LOG_REC_MAX. The CPU stalls while the flash programs
+* when the code runs from the same bank, call it from a low priority task.
+* @retval 0: ok, -1: log not ready, too long or flash error
+*****************************************************************************/
+int32_t Ql_Flash_Log_Append(uint8_t Type, const void *Data, uint32_t Len)
+{
+    Ql_Flash_Log_Rec_TypeDef *rec = (Ql_Flash_Log_Rec_TypeDef *)Flash_Log_Buf;
+    const uint32_t size = QL_FLASH_LOG_REC_SIZE(Len);
+    int32_t ret = -1;
+
+    if (!Flash_Log.Ready || (Len > QL_FLASH_LOG_REC_MAX) || ((Data == NULL) && (Len > 0)) || !QL_FLASH_LOG_LOCK())
+    {
+        return -1;
+    }
+
+    if ((Flash_Log.Offset + size > QL_FLASH_LOG_SECTOR_SIZE) && (Ql_Flash_Log_Advance() != 0))
+    {
+        goto out;
+    }
+
+    memset(Flash_Log_Buf, 0xFF, size);
+    rec->Len  = (uint16_t)Len;
+    rec->Type = Type;
+    rec->Rsv  = 0xFF;
+    rec->Seq  = Flash_Log.Rec_Seq;
+    rec->Time = Ql_Flash_Log_Time();
+    memcpy(rec + 1, Data, Len);
+    rec->Crc  = Ql_Check_CRC32(Ql_Check_CRC32(0, (const unsigned char *)rec, QL_FLASH_LOG_REC_CRC_LEN),
+                               (const unsigned char *)(rec + 1), Len);
+
+    /* A failed program leaves an unknown part of the record, skip its space */
+    ret = Ql_Flash_Log_Raw_Prog(Flash_Log.Head * QL_FLASH_LOG_SECTOR_SIZE + Flash_Log.Offset, rec, size);
+    Flash_Log.Offset += size;
+    Flash_Log.Rec_Seq++;
+    Flash_Log_Stats.Appends++;
+
+out:
+    QL_FLASH_LOG_UNLOCK();
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Drop all records
+* ex:
+* @par
+* Starts a new sector whose header moves the base sequence past the last
+* record; older records are no longer read and their sectors are erased as
+* the ring comes round.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_Flash_Log_Clear(void)
+{
+    int32_t ret;
+
+    if (!Flash_Log.Ready || !QL_FLASH_LOG_LOCK())
+    {
+        return -1;
+    }
+
+    Flash_Log.Base_Seq = Flash_Log.Rec_Seq;
+    ret = Ql_Flash_Log_Advance();
+    QL_FLASH_LOG_UNLOCK();
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Point the cursor at the oldest record
+* ex:
+* @par
+* The oldest sector is the first valid one after the head that is not newer
+* than it; a blank sector after the head is one the ring has not reached
+* yet, or one whose erase was cut off.
+* @retval
+*****************************************************************************/
+void Ql_Flash_Log_Rewind(Ql_Flash_Log_Cursor_TypeDef *Cursor)
+{
+    Ql_Flash_Log_Sect_TypeDef sect;
+    uint32_t oldest = Flash_Log.Head;
+
+    Cursor->Left = 0;
+    if (!Flash_Log.Ready || !QL_FLASH_LOG_LOCK())
+    {
+        return;
+    }
+
+    for (uint32_t k = 1; k < QL_FLASH_LOG_SECTORS; k++)
+    {
+        const uint32_t s = (Flash_Log.Head + k) % QL_FLASH_LOG_SECTORS;
+
+        if (Ql_Flash_Log_Sect_Get(s, &sect) && ((int32_t)(sect.Seq - Flash_Log.Head_Seq) < 0))
+        {
+            oldest = s;
+            break;
+        }
+    }
+
+    Cursor->Sector = oldest;
+    Cursor->Offset = sizeof(sect);
+    Cursor->Left   = (Flash_Log.Head + QL_FLASH_LOG_SECTORS - oldest) % QL_FLASH_LOG_SECTORS + 1;
+    QL_FLASH_LOG_UNLOCK();
+}
+
+/*****************************************************************************
+* @brief  Read the next record, oldest first
+* ex:
+* @par
+* Up to Size bytes of the payload are copied to Buf, records with a bad CRC
+* are skipped. Safe against a concurrent append, a sector erased under the
+* cursor ends the read.
+* @retval payload length, 0: no more records
+*****************************************************************************/
+int32_t Ql_Flash_Log_Read(Ql_Flash_Log_Cursor_TypeDef *Cursor, Ql_Flash_Log_Rec_TypeDef *Rec,
+                          uint8_t *Buf, uint32_t Size)
+{
+    Ql_Flash_Log_Sect_TypeDef sect;
+    int32_t ret = 0;
+
+    if (!Flash_Log.Ready || !QL_FLASH_LOG_LOCK())
+    {
+        return 0;
+    }
+
+    while (Cursor->Left > 0)
+    {
+        /* The head may have moved into the cursor's sector */
+        if ((Cursor->Offset == sizeof(sect)) &&
+            (!Ql_Flash_Log_Sect_Get(Cursor->Sector, &sect) || ((int32_t)(sect.Seq - Flash_Log.Head_Seq) > 0)))
+        {
+            Cursor->Left = 0;
+            break;
+        }
+
+        ret = Ql_Flash_Log_Rec_Get(Cursor->Sector, Cursor->Offset, Rec);
+        if ((ret == 1) && ((int32_t)(Rec->Seq - Flash_Log.Base_Seq) < 0))
+        {
+            Cursor->Offset += QL_FLASH_LOG_REC_SIZE(Rec->Len);
+            continue;
+        }
+        if (ret == 1)
+        {
+            Cursor->Offset += QL_FLASH_LOG_REC_SIZE(Rec->Len);
+            memcpy(Buf, Flash_Log_Buf, (Rec->Len < Size) ? Rec->Len : Size);
+            ret = Rec->Len;
+            break;
+        }
+        if (ret == -1)
+        {
+            Flash_Log_Stats.Torn++;
+            Cursor->Offset += QL_FLASH_LOG_REC_SIZE(Rec->Len);
+            continue;
+        }
+
+        ret = 0;
+        Cursor->Sector = (Cursor->Sector + 1) % QL_FLASH_LOG_SECTORS;
+        Cursor->Offset = sizeof(sect);
+        Cursor->Left--;
+    }
+
+    QL_FLASH_LOG_UNLOCK();
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  State of the log and the wear of its sectors
+* ex:
+* @par
+* Reads every sector header for the erase counts.
+* @retval
+*****************************************************************************/
+void Ql_Flash_Log_Stats(Ql_Flash_Log_Stats_TypeDef *Stats)
+{
+    Ql_Flash_Log_Sect_TypeDef sect;
+
+    Flash_Log_Stats.Head      = Flash_Log.Head;
+    Flash_Log_Stats.Free      = QL_FLASH_LOG_SECTOR_SIZE - Flash_Log.Offset;
+    Flash_Log_Stats.Rec_Seq   = Flash_Log.Rec_Seq;
+    Flash_Log_Stats.Erase_Min = 0xFFFFFFFFU;
+    Flash_Log_Stats.Erase_Max = 0;
+    for (uint32_t i = 0; i < QL_FLASH_LOG_SECTORS; i++)
+    {
+        if (!Ql_Flash_Log_Sect_Get(i, &sect))
+        {
+            sect.Erase_Count = 0;
+        }
+        Flash_Log_Stats.Erase_Min = (sect.Erase_Count < Flash_Log_Stats.Erase_Min) ? sect.Erase_Count : Flash_Log_Stats.Erase_Min;
+        Flash_Log_Stats.Erase_Max = (sect.Erase_Count > Flash_Log_Stats.Erase_Max) ? sect.Erase_Count : Flash_Log_Stats.Erase_Max;
+    }
+
+    memcpy(Stats, &Flash_Log_Stats, sizeof(*Stats));
+}
+
+/*****************************************************************************
+* @brief  Append Records records of Len bytes, then mount and read them back
+* ex:
+* @par
+* Uses the DWT cycle counter. The records stay in the log as type
+* QL_FLASH_LOG_BENCH.
+* @retval
+*****************************************************************************/
+void Ql_Flash_Log_Bench(uint32_t Records, uint32_t Len)
+{
+    static uint8_t data[QL_FLASH_LOG_REC_MAX];
+    Ql_Flash_Log_Cursor_TypeDef cursor;
+    Ql_Flash_Log_Rec_TypeDef rec;
+    Ql_Flash_Log_Stats_TypeDef stats;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t max = 0;
+    uint32_t sum = 0;
+    uint32_t mount;
+    uint32_t read = 0;
+
+    if (Records == 0)
+    {
+        return;
+    }
+
+    Len = (Len > QL_FLASH_LOG_REC_MAX) ? QL_FLASH_LOG_REC_MAX : Len;
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < Records; i++)
+    {
+        start = DWT->CYCCNT;
+        if (Ql_Flash_Log_Append(QL_FLASH_LOG_BENCH, data, Len) != 0)
+        {
+            QL_LOG_E("append %u fail", i);
+            return;
+        }
+        cycles = DWT->CYCCNT - start;
+        sum += cycles;
+        max  = (cycles > max) ? cycles : max;
+    }
+
+    start = DWT->CYCCNT;
+    Ql_Flash_Log_Init();
+    mount = DWT->CYCCNT - start;
+    Ql_Flash_Log_Stats(&stats);
+
+    Ql_Flash_Log_Rewind(&cursor);
+    while (Ql_Flash_Log_Read(&cursor, &rec, data, sizeof(data)) > 0)
+    {
+        read++;
+    }
+
+    QL_LOG_I("%u records of %u bytes: append avg %u us max %u us, mount %u us (%u headers, %u records walked)",
+             Records, Len, sum / Records / (SystemCoreClock / 1000000U), max / (SystemCoreClock / 1000000U),
+             mount / (SystemCoreClock / 1000000U), stats.Mount_Reads, stats.Mount_Recs);
+    QL_LOG_I("%u records readable, sector erases %u..%u, %u torn", read, stats.Erase_Min, stats.Erase_Max, stats.Torn);
+}
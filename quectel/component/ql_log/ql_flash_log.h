@@ -0,0 +1,98 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_flash_log.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_FLASH_LOG_H__
+#define __QL_FLASH_LOG_H__
+
+#include <stdint.h>
+
+#include "ql_flash.h"
+
+/* Circular event log in the internal flash, for diagnostics while there is
+   no SD card. The region is a ring of equal sectors, each starting with a
+   header that holds a sequence number one above the previous sector's and
+   its erase count. Records are appended to the head sector; when it is full
+   the next sector, the oldest one, is erased and becomes the head, so every
+   sector is erased once per round. Mount finds the head by a binary search
+   over the sector headers and walks the records of that sector only.
+   RAM use is the state below and one record buffer. */
+#define QL_FLASH_LOG_SECTOR_SIZE    (128U * 1024U)
+#define QL_FLASH_LOG_SECTORS        (QL_FLASH_LOG_SIZE / QL_FLASH_LOG_SECTOR_SIZE)
+#define QL_FLASH_LOG_REC_MAX        (256U)          // payload bytes per record
+#define QL_FLASH_LOG_MAGIC          (0x474F4C46U)   // "FLOG"
+
+/* Record types, the rest are free for the application */
+#define QL_FLASH_LOG_TEXT           (1U)            // console line of ql_log
+#define QL_FLASH_LOG_EVENT          (2U)
+#define QL_FLASH_LOG_BENCH          (0x7FU)
+
+typedef struct
+{
+    uint32_t    Magic;
+    uint32_t    Seq;            // sector sequence, +1 per erase of the ring
+    uint32_t    Erase_Count;    // of this sector
+    uint32_t    Rec_Seq;        // sequence of the first record in it
+    uint32_t    Base_Seq;       // records below it are cleared
+    uint32_t    Crc;            // over the fields above
+} Ql_Flash_Log_Sect_TypeDef;
+
+typedef struct
+{
+    uint16_t    Len;            // payload bytes, 0xFFFF: erased, end of the sector
+    uint8_t     Type;
+    uint8_t     Rsv;
+    uint32_t    Seq;
+    uint32_t    Time;           // seconds since 1970 from the RTC
+    uint32_t    Crc;            // over the fields above and the payload
+} Ql_Flash_Log_Rec_TypeDef;
+
+typedef struct
+{
+    uint32_t    Sector;
+    uint32_t    Offset;
+    uint32_t    Left;           // sectors still to read, the current one included
+} Ql_Flash_Log_Cursor_TypeDef;
+
+typedef struct
+{
+    uint32_t    Head;           // sector being written
+    uint32_t    Free;           // bytes left in it
+    uint32_t    Rec_Seq;        // sequence of the next record
+    uint32_t    Erase_Min;
+    uint32_t    Erase_Max;
+    uint32_t    Mount_Reads;    // sector headers read by the last mount
+    uint32_t    Mount_Recs;     // records walked by the last mount
+    uint32_t    Appends;
+    uint32_t    Erases;
+    uint32_t    Torn;           // records with a bad CRC seen by mount and reads
+} Ql_Flash_Log_Stats_TypeDef;
+
+int32_t Ql_Flash_Log_Init(void);
+int32_t Ql_Flash_Log_Append(uint8_t Type, const void *Data, uint32_t Len);
+int32_t Ql_Flash_Log_Clear(void);
+void    Ql_Flash_Log_Rewind(Ql_Flash_Log_Cursor_TypeDef *Cursor);
+int32_t Ql_Flash_Log_Read(Ql_Flash_Log_Cursor_TypeDef *Cursor, Ql_Flash_Log_Rec_TypeDef *Rec,
+                          uint8_t *Buf, uint32_t Size);
+void    Ql_Flash_Log_Stats(Ql_Flash_Log_Stats_TypeDef *Stats);
+void    Ql_Flash_Log_Bench(uint32_t Records, uint32_t Len);
+
+#endif
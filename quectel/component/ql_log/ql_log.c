@@ -29,15 +29,925 @@ limitations under the License.
 #include "semphr.h"
 
 #include "ql_uart.h"
+#include "ql_delay.h"
+#include "ql_check.h"
+#include "ql_flash.h"
+#include "ql_flash_log.h"
 
 #define QL_PRINTF_BUF_SIZE    (1024*4)
 
-static uint8_t Ql_Log_Buf[QL_PRINTF_BUF_SIZE] = {0};
+/* Ring record: commit word, header word, sequence, payload. The commit word
+   is written last and holds the ring position of the record, the consumer
+   takes a record only when it matches its own Tail. A record left over from
+   an earlier lap or one not finished yet never does. Records are 8 byte
+   aligned so that a pad record always has room for both words */
+#define QL_LOG_REC_MARK             (0xA5U)
+#define QL_LOG_REC_PAD              (0U)
+#define QL_LOG_REC_BIN              (1U)    // Fmt, Tick, packed arguments
+#define QL_LOG_REC_TEXT             (2U)    // formatted line
+#define QL_LOG_REC_COMMIT(Pos)      ((Pos) | 1U)    // never 0, a released or blank slot reads 0
+#define QL_LOG_REC_HDR(Type, Len)   (((uint32_t)QL_LOG_REC_MARK << 24) | ((uint32_t)(Type) << 16) | (Len))
+#define QL_LOG_REC_TYPE(Hdr)        (((Hdr) >> 16) & 0xFF)
+#define QL_LOG_REC_LEN(Hdr)         ((Hdr) & 0xFFFF)
+#define QL_LOG_REC_ALIGN(Len)       (((Len) + 7) & ~7U)
+#define QL_LOG_REC_SIZE(Hdr)        QL_LOG_REC_ALIGN(QL_LOG_REC_LEN(Hdr))
+#define QL_LOG_REC_HDR_SIZE         (12U)
+#define QL_LOG_BIN_HDR_SIZE         (QL_LOG_REC_HDR_SIZE + 8)
+
+/* Frame on the wire: Sync, Args_Len, Fmt(4), Tick(4), Args, XOR of Args_Len..Args */
+#define QL_LOG_FRAME_SIZE(Args_Len) ((Args_Len) + 11)
+#define QL_LOG_OUT_BUF_SIZE         (512U)
+
+typedef enum
+{
+    QL_LOG_BAND_ISR = 0,
+    QL_LOG_BAND_HIGH,
+    QL_LOG_BAND_LOW,
+    QL_LOG_BAND_NUM
+} Ql_Log_Band_TypeDef;
+
+typedef struct
+{
+    uint8_t            *Buf;
+    uint32_t            Size;
+    volatile uint32_t   Head;       // reserved by the producers, free running
+    volatile uint32_t   Tail;       // released by Ql_Log_Task, free running
+    volatile uint32_t   Dropped;
+} Ql_Log_Ring_TypeDef;
+
+static char Ql_Log_Buf[QL_PRINTF_BUF_SIZE] = {0};
 static SemaphoreHandle_t Ql_Log_Mutex = NULL;
 
+static uint32_t Ql_Log_Ring_Isr[QL_LOG_RING_SIZE_ISR / 4];
+static uint32_t Ql_Log_Ring_High[QL_LOG_RING_SIZE_HIGH / 4];
+static uint32_t Ql_Log_Ring_Low[QL_LOG_RING_SIZE_LOW / 4];
+static Ql_Log_Ring_TypeDef Ql_Log_Ring[QL_LOG_BAND_NUM] =
+{
+    { (uint8_t *)Ql_Log_Ring_Isr,  QL_LOG_RING_SIZE_ISR,  0, 0, 0 },
+    { (uint8_t *)Ql_Log_Ring_High, QL_LOG_RING_SIZE_HIGH, 0, 0, 0 },
+    { (uint8_t *)Ql_Log_Ring_Low,  QL_LOG_RING_SIZE_LOW,  0, 0, 0 },
+};
+static volatile uint32_t Ql_Log_Seq = 0;
+static uint8_t Ql_Log_Out_Buf[QL_LOG_OUT_BUF_SIZE];
+static TaskHandle_t Ql_Log_TaskHandle = NULL;
+
+typedef struct
+{
+    char        Tag[QL_LOG_TAG_NAME_MAX];   // "*" matches every tag
+    uint8_t     Level;
+} Ql_Log_Override_TypeDef;
+
+/* Flash image of the overrides, CRC over Num and Item[] */
+typedef struct
+{
+    uint32_t                Magic;
+    uint32_t                Num;
+    Ql_Log_Override_TypeDef Item[QL_LOG_OVERRIDE_MAX];
+    uint32_t                Crc;
+} Ql_Log_Level_Store_TypeDef;
+
+static Ql_Log_Tag_TypeDef *Ql_Log_Tag_List = NULL;
+static Ql_Log_Level_Store_TypeDef Ql_Log_Level_Store = { 0 };    // Magic is set on save
+#if QL_LOG_CMD_ENABLE
+static volatile uint8_t Ql_Log_Cmd_On = 1;
+#endif
+
+static uint32_t Ql_Log_Atomic_Inc(volatile uint32_t *Val)
+{
+    uint32_t val;
+
+    do
+    {
+        val = __LDREXW(Val) + 1;
+    } while (__STREXW(val, Val) != 0);
+
+    return val;
+}
+
+/* Finish a record or a pad at ring position Pos */
+static inline void Ql_Log_Ring_Commit(uint32_t *Rec, uint32_t Pos, uint8_t Type, uint32_t Len)
+{
+    Rec[1] = QL_LOG_REC_HDR(Type, Len);
+    __DMB();
+    *(volatile uint32_t *)Rec = QL_LOG_REC_COMMIT(Pos);
+}
+
+/*****************************************************************************
+* @brief  Reserve Len bytes, lock-free for tasks and ISRs
+* ex:
+* @par
+* A record never wraps, the end of the ring is filled with a pad record
+* instead. Returns NULL and counts a drop when the ring is full.
+* @retval
+*****************************************************************************/
+static uint32_t *Ql_Log_Ring_Reserve(Ql_Log_Ring_TypeDef *Ring, uint32_t Len, uint32_t *Pos)
+{
+    uint32_t head;
+    uint32_t off;
+    uint32_t pad;
+
+    Len = QL_LOG_REC_ALIGN(Len);
+    do
+    {
+        head = __LDREXW(&Ring->Head);
+        off  = head & (Ring->Size - 1);
+        pad  = ((off + Len) > Ring->Size) ? (Ring->Size - off) : 0;
+        if ((head + pad + Len - Ring->Tail) > Ring->Size)
+        {
+            __CLREX();
+            Ql_Log_Atomic_Inc(&Ring->Dropped);
+            return NULL;
+        }
+    } while (__STREXW(head + pad + Len, &Ring->Head) != 0);
+
+    if (pad != 0)
+    {
+        Ql_Log_Ring_Commit((uint32_t *)(Ring->Buf + off), head, QL_LOG_REC_PAD, pad);
+    }
+
+    *Pos = head + pad;
+    return (uint32_t *)(Ring->Buf + (*Pos & (Ring->Size - 1)));
+}
+
+/*****************************************************************************
+* @brief  Give back the unused end of a record reserved for its worst case
+* ex:
+* @par
+* If nothing was reserved after it, Head moves back. Otherwise the rest is
+* committed as a pad record, the consumer skips it. Call before the record
+* itself is committed.
+* @retval
+*****************************************************************************/
+static void Ql_Log_Ring_Trim(Ql_Log_Ring_TypeDef *Ring, uint32_t Pos, uint32_t Reserved, uint32_t Used)
+{
+    const uint32_t end = Pos + QL_LOG_REC_ALIGN(Reserved);
+    const uint32_t cut = Pos + QL_LOG_REC_ALIGN(Used);
+
+    if (cut == end)
+    {
+        return;
+    }
+
+    /* Payload bytes left at cut must not read as the next record's commit word */
+    *(volatile uint32_t *)(Ring->Buf + (cut & (Ring->Size - 1))) = 0;
+    __DMB();
+    do
+    {
+        if (__LDREXW(&Ring->Head) != end)
+        {
+            __CLREX();
+            Ql_Log_Ring_Commit((uint32_t *)(Ring->Buf + (cut & (Ring->Size - 1))), cut, QL_LOG_REC_PAD, end - cut);
+            return;
+        }
+    } while (__STREXW(cut, &Ring->Head) != 0);
+}
+
+static uint32_t *Ql_Log_Ring_Peek(Ql_Log_Ring_TypeDef *Ring)
+{
+    uint32_t *rec;
+
+    if (Ring->Tail == Ring->Head)
+    {
+        return NULL;
+    }
+
+    rec = (uint32_t *)(Ring->Buf + (Ring->Tail & (Ring->Size - 1)));
+    if (*(volatile uint32_t *)rec != QL_LOG_REC_COMMIT(Ring->Tail))
+    {
+        return NULL;
+    }
+    __DMB();
+
+    return rec;
+}
+
+static void Ql_Log_Ring_Release(Ql_Log_Ring_TypeDef *Ring, uint32_t *Rec)
+{
+    const uint32_t size = QL_LOG_REC_SIZE(Rec[1]);
+
+    *(volatile uint32_t *)Rec = 0;
+    __DMB();
+    Ring->Tail += size;
+}
+
+/*****************************************************************************
+* @brief  Reserve a record in the ring of the caller's band
+* ex:
+* @par
+* ISRs, tasks at or above QL_LOG_HIGH_PRIORITY and the rest never share a
+* ring, a low priority task flooding its ring cannot make a high priority
+* one drop lines. The sequence number gives Ql_Log_Task the merge order.
+* @retval
+*****************************************************************************/
+static uint32_t *Ql_Log_Reserve(uint32_t Len, Ql_Log_Ring_TypeDef **Ring, uint32_t *Pos)
+{
+    Ql_Log_Band_TypeDef band = QL_LOG_BAND_LOW;
+    uint32_t *rec;
+
+    if (__get_IPSR() != 0)
+    {
+        band = QL_LOG_BAND_ISR;
+    }
+    else if ((xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) &&
+             (uxTaskPriorityGet(NULL) >= QL_LOG_HIGH_PRIORITY))
+    {
+        band = QL_LOG_BAND_HIGH;
+    }
+
+    *Ring = &Ql_Log_Ring[band];
+    rec = Ql_Log_Ring_Reserve(*Ring, Len, Pos);
+    if (rec != NULL)
+    {
+        rec[2] = Ql_Log_Atomic_Inc(&Ql_Log_Seq);
+    }
+
+    return rec;
+}
+
+/*****************************************************************************
+* @brief  Log call, safe from tasks and ISRs, never blocks
+* ex:
+* @par
+* The line is formatted straight into a ring record reserved for
+* QL_LOG_LINE_MAX, cut there, and the record trimmed to what it took.
+* @retval
+*****************************************************************************/
+void Ql_Log_Text(const char *Fmt, ...)
+{
+    Ql_Log_Ring_TypeDef *ring;
+    uint32_t pos;
+    uint32_t *rec;
+    char *line;
+    va_list ap;
+    int len;
+
+    rec = Ql_Log_Reserve(QL_LOG_REC_HDR_SIZE + QL_LOG_LINE_MAX, &ring, &pos);
+    if (rec == NULL)
+    {
+        return;
+    }
+    line = (char *)(rec + 3);
+
+    va_start(ap, Fmt);
+    len = vsnprintf(line, QL_LOG_LINE_MAX - 2, Fmt, ap);
+    va_end(ap);
+
+    if (len < 0)
+    {
+        Ql_Log_Ring_Commit(rec, pos, QL_LOG_REC_PAD, QL_LOG_REC_HDR_SIZE + QL_LOG_LINE_MAX);
+        return;
+    }
+    len = (len > (QL_LOG_LINE_MAX - 3)) ? (QL_LOG_LINE_MAX - 3) : len;
+    line[len++] = '\r';
+    line[len++] = '\n';
+
+    Ql_Log_Ring_Trim(ring, pos, QL_LOG_REC_HDR_SIZE + QL_LOG_LINE_MAX, QL_LOG_REC_HDR_SIZE + len);
+    Ql_Log_Ring_Commit(rec, pos, QL_LOG_REC_TEXT, QL_LOG_REC_HDR_SIZE + len);
+}
+
+#if QL_LOG_DEFERRED_ENABLE
+/*****************************************************************************
+* @brief  Pack the arguments of Fmt as the decoder expects them
+* ex:
+* @par
+* Integers, chars and pointers take 4 bytes, %ll/%j 8 bytes, floating point
+* 8 bytes (double). %s is copied with its '\0', at most QL_LOG_BIN_STR_MAX.
+* A '*' width or precision is packed as an int in front of its argument.
+* @retval packed length
+*****************************************************************************/
+static uint32_t Ql_Log_Bin_Pack(const char *Fmt, va_list Args, uint8_t *Out)
+{
+    uint32_t len = 0;
+    uint32_t u32;
+    uint64_t u64;
+    double   f64;
+    const char *str;
+    uint8_t  lng;
+
+    while (*Fmt != '\0')
+    {
+        if (*Fmt++ != '%')
+        {
+            continue;
+        }
+
+        /* flags, width, precision */
+        while ((*Fmt != '\0') && (strchr("-+ #0123456789.*", *Fmt) != NULL))
+        {
+            if ((*Fmt == '*') && ((len + 4) <= QL_LOG_BIN_ARGS_MAX))
+            {
+                u32 = va_arg(Args, uint32_t);
+                memcpy(Out + len, &u32, 4);
+                len += 4;
+            }
+            Fmt++;
+        }
+
+        /* length */
+        lng = 0;
+        while ((*Fmt != '\0') && (strchr("hlLjzt", *Fmt) != NULL))
+        {
+            lng += (*Fmt == 'l') ? 1 : ((*Fmt == 'j') ? 2 : 0);
+            Fmt++;
+        }
+
+        switch (*Fmt)
+        {
+        case '\0':
+            return len;
+        case '%':
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            if ((len + 8) > QL_LOG_BIN_ARGS_MAX)
+            {
+                return len;
+            }
+            f64 = va_arg(Args, double);
+            memcpy(Out + len, &f64, 8);
+            len += 8;
+            break;
+        case 's':
+            str = va_arg(Args, const char *);
+            str = (str == NULL) ? "(null)" : str;
+            for (u32 = 0; (u32 < (QL_LOG_BIN_STR_MAX - 1)) && (str[u32] != '\0'); u32++);
+            if ((len + u32 + 1) > QL_LOG_BIN_ARGS_MAX)
+            {
+                return len;
+            }
+            memcpy(Out + len, str, u32);
+            Out[len + u32] = '\0';
+            len += u32 + 1;
+            break;
+        default:
+            if (lng >= 2)
+            {
+                if ((len + 8) > QL_LOG_BIN_ARGS_MAX)
+                {
+                    return len;
+                }
+                u64 = va_arg(Args, uint64_t);
+                memcpy(Out + len, &u64, 8);
+                len += 8;
+            }
+            else
+            {
+                if ((len + 4) > QL_LOG_BIN_ARGS_MAX)
+                {
+                    return len;
+                }
+                u32 = va_arg(Args, uint32_t);
+                memcpy(Out + len, &u32, 4);
+                len += 4;
+            }
+            break;
+        }
+        Fmt++;
+    }
+
+    return len;
+}
+
+/*****************************************************************************
+* @brief  Deferred log call, safe from tasks and ISRs, never blocks
+* ex:
+* @par
+* Fmt must live in the ql_log_fmt section, see QL_LOG_LINE. The arguments
+* are packed straight into the ring record, as Ql_Log_Text does.
+* @retval
+*****************************************************************************/
+void Ql_Log_Bin(const char *Fmt, ...)
+{
+    Ql_Log_Ring_TypeDef *ring;
+    uint32_t pos;
+    uint32_t args_len;
+    uint32_t *rec;
+    va_list  ap;
+
+    rec = Ql_Log_Reserve(QL_LOG_BIN_HDR_SIZE + QL_LOG_BIN_ARGS_MAX, &ring, &pos);
+    if (rec == NULL)
+    {
+        return;
+    }
+
+    rec[3] = (uint32_t)Fmt;
+    rec[4] = Ql_GetTick();
+    va_start(ap, Fmt);
+    args_len = Ql_Log_Bin_Pack(Fmt, ap, (uint8_t *)(rec + 5));
+    va_end(ap);
+
+    Ql_Log_Ring_Trim(ring, pos, QL_LOG_BIN_HDR_SIZE + QL_LOG_BIN_ARGS_MAX, QL_LOG_BIN_HDR_SIZE + args_len);
+    Ql_Log_Ring_Commit(rec, pos, QL_LOG_REC_BIN, QL_LOG_BIN_HDR_SIZE + args_len);
+}
+#endif
+
+/*****************************************************************************
+* @brief  Console bytes of one record
+* ex:
+* @par
+* None
+* @retval 0: does not fit, the record stays in the ring
+*****************************************************************************/
+static uint32_t Ql_Log_Rec_Output(const uint32_t *Rec, uint8_t *Out, uint32_t Size)
+{
+    uint32_t len = QL_LOG_REC_LEN(Rec[1]);
+
+    if (QL_LOG_REC_TYPE(Rec[1]) == QL_LOG_REC_TEXT)
+    {
+        len -= QL_LOG_REC_HDR_SIZE;
+        if (len > Size)
+        {
+            return 0;
+        }
+        memcpy(Out, Rec + 3, len);
+        return len;
+    }
+
+    len -= QL_LOG_BIN_HDR_SIZE;
+    if (QL_LOG_FRAME_SIZE(len) > Size)
+    {
+        return 0;
+    }
+    Out[0] = QL_LOG_BIN_SYNC;
+    Out[1] = (uint8_t)len;
+    memcpy(Out + 2, Rec + 3, 8 + len);
+    Out[10 + len] = Ql_CheckXOR(Out + 1, 9 + len);
+
+    return QL_LOG_FRAME_SIZE(len);
+}
+
+/*****************************************************************************
+* @brief  Oldest finished record over all bands
+* ex:
+* @par
+* A record reserved but not finished yet holds back its own ring only.
+* When the console cannot keep up, the isr or high ring past half full goes
+* first, out of call order: the older low band lines wait and the low band
+* drops, not the one above it.
+* @retval
+*****************************************************************************/
+static uint32_t *Ql_Log_Next(Ql_Log_Ring_TypeDef **Ring)
+{
+    uint32_t *next = NULL;
+    uint32_t *rec;
+
+    for (uint8_t i = 0; i < QL_LOG_BAND_NUM; i++)
+    {
+        while (((rec = Ql_Log_Ring_Peek(&Ql_Log_Ring[i])) != NULL) && (QL_LOG_REC_TYPE(rec[1]) == QL_LOG_REC_PAD))
+        {
+            Ql_Log_Ring_Release(&Ql_Log_Ring[i], rec);
+        }
+
+        if ((rec != NULL) && (i != QL_LOG_BAND_LOW) &&
+            ((Ql_Log_Ring[i].Head - Ql_Log_Ring[i].Tail) > (Ql_Log_Ring[i].Size / 2)))
+        {
+            *Ring = &Ql_Log_Ring[i];
+            return rec;
+        }
+
+        if ((rec != NULL) && ((next == NULL) || ((int32_t)(rec[2] - next[2]) < 0)))
+        {
+            next  = rec;
+            *Ring = &Ql_Log_Ring[i];
+        }
+    }
+
+    return next;
+}
+
+/*****************************************************************************
+* @brief  Level of Tag from the override table, Default if none
+* ex:
+* @par
+* An exact tag match wins over "*".
+* @retval
+*****************************************************************************/
+static uint8_t Ql_Log_Level_Lookup(const char *Tag, uint8_t Default)
+{
+    uint8_t level = Default;
+
+    for (uint32_t i = 0; i < Ql_Log_Level_Store.Num; i++)
+    {
+        if (strcmp(Ql_Log_Level_Store.Item[i].Tag, Tag) == 0)
+        {
+            return Ql_Log_Level_Store.Item[i].Level;
+        }
+        if (strcmp(Ql_Log_Level_Store.Item[i].Tag, "*") == 0)
+        {
+            level = Ql_Log_Level_Store.Item[i].Level;
+        }
+    }
+
+    return level;
+}
+
+/*****************************************************************************
+* @brief  First call through a tag object, see QL_LOG_ON
+* ex:
+* @par
+* Called from tasks and ISRs, the list is only changed with IRQs masked.
+* @retval 1: Level is enabled for the tag
+*****************************************************************************/
+uint8_t Ql_Log_Tag_Register(Ql_Log_Tag_TypeDef *Tag, uint8_t Level)
+{
+    const uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    if (Tag->Level == QL_LOG_LEVEL_UNSET)
+    {
+        Tag->Level = Ql_Log_Level_Lookup(Tag->Name, Tag->Default);
+        Tag->Next = Ql_Log_Tag_List;
+        Ql_Log_Tag_List = Tag;
+    }
+    __set_PRIMASK(primask);
+
+    return (Level <= Tag->Level);
+}
+
+/*****************************************************************************
+* @brief  Change the level of Tag, "*" for every tag
+* ex:
+* @par
+* Tags that did not log yet pick the level up on their first call. Not
+* persistent until Ql_Log_Level_Save().
+* @retval 0: ok; -1: bad argument or table full
+*****************************************************************************/
+int32_t Ql_Log_Level_Set(const char *Tag, uint8_t Level)
+{
+    const uint8_t all = (strcmp(Tag, "*") == 0);
+    Ql_Log_Tag_TypeDef *tag;
+    uint32_t i;
+
+    if ((Level > QL_LOG_DEBUG) || (strlen(Tag) >= QL_LOG_TAG_NAME_MAX))
+    {
+        return -1;
+    }
+
+    /* "*" overrides everything set before it */
+    if (all)
+    {
+        Ql_Log_Level_Store.Num = 0;
+    }
+
+    for (i = 0; i < Ql_Log_Level_Store.Num; i++)
+    {
+        if (strcmp(Ql_Log_Level_Store.Item[i].Tag, Tag) == 0)
+        {
+            break;
+        }
+    }
+    if (i >= QL_LOG_OVERRIDE_MAX)
+    {
+        return -1;
+    }
+    strcpy(Ql_Log_Level_Store.Item[i].Tag, Tag);
+    Ql_Log_Level_Store.Item[i].Level = Level;
+    Ql_Log_Level_Store.Num = (i == Ql_Log_Level_Store.Num) ? (i + 1) : Ql_Log_Level_Store.Num;
+
+    for (tag = Ql_Log_Tag_List; tag != NULL; tag = tag->Next)
+    {
+        if (all || (strcmp(tag->Name, Tag) == 0))
+        {
+            tag->Level = Level;
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Write the override table to the parameter sector
+* ex:
+* @par
+* Erases the whole sector, the CPU stalls while the flash is busy.
+* @retval 0: ok; -1: flash error
+*****************************************************************************/
+int32_t Ql_Log_Level_Save(void)
+{
+    Ql_Log_Level_Store.Magic = QL_LOG_LEVEL_FLASH_MAGIC;
+    Ql_Log_Level_Store.Crc = Ql_Check_CRC32(0, (const uint8_t *)&Ql_Log_Level_Store.Num,
+                                            sizeof(Ql_Log_Level_Store.Num) + sizeof(Ql_Log_Level_Store.Item));
+
+    if ((Ql_Flash_Erase(QL_LOG_LEVEL_FLASH_ADDR, sizeof(Ql_Log_Level_Store)) < 0) ||
+        (Ql_Flash_Write(QL_LOG_LEVEL_FLASH_ADDR, (const uint8_t *)&Ql_Log_Level_Store, sizeof(Ql_Log_Level_Store)) < 0))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+static void Ql_Log_Level_Load(void)
+{
+    Ql_Log_Level_Store_TypeDef *store = &Ql_Log_Level_Store;
+
+    if ((Ql_Flash_Read(QL_LOG_LEVEL_FLASH_ADDR, (uint8_t *)store, sizeof(*store)) < 0) ||
+        (store->Magic != QL_LOG_LEVEL_FLASH_MAGIC) || (store->Num > QL_LOG_OVERRIDE_MAX) ||
+        (store->Crc != Ql_Check_CRC32(0, (const uint8_t *)&store->Num, sizeof(store->Num) + sizeof(store->Item))))
+    {
+        memset(store, 0, sizeof(*store));
+        return;
+    }
+
+    for (uint32_t i = 0; i < Ql_Log_Level_Store.Num; i++)
+    {
+        Ql_Log_Level_Store.Item[i].Tag[QL_LOG_TAG_NAME_MAX - 1] = '\0';
+    }
+}
+
+/*****************************************************************************
+* @brief  Console command
+* ex:
+* @par
+* log                       list the tags that logged so far
+* log <tag|*> <n|e|w|i|d>   set a level, 0..4 works as well
+* log save                  keep the overrides over a reset
+* log reset                 back to the LOG_LVL of every file, flash cleared
+* A level above the build floor QL_LOG_LVL is accepted but prints nothing,
+* those statements are not in the image.
+* @retval 0: handled; -1: not a log command or bad argument
+*****************************************************************************/
+int32_t Ql_Log_Cmd(const char *Line)
+{
+    static const char level_name[] = "newid";
+    char cmd[8] = { 0 };
+    char tag[QL_LOG_TAG_NAME_MAX] = { 0 };
+    char lvl[4] = { 0 };
+    const char *pos;
+    Ql_Log_Tag_TypeDef *item;
+    int32_t level = -1;
+    int n;
+
+    n = sscanf(Line, "%7s %15s %3s", cmd, tag, lvl);
+    if ((n < 1) || (strcmp(cmd, "log") != 0))
+    {
+        return -1;
+    }
+
+    if ((n == 1) || (strcmp(tag, "list") == 0))
+    {
+        Ql_Printf("[I/log] build floor %c\r\n", level_name[QL_LOG_LVL]);
+        for (item = Ql_Log_Tag_List; item != NULL; item = item->Next)
+        {
+            Ql_Printf("[I/log]   %-15s %c (default %c)\r\n", item->Name, level_name[item->Level], level_name[item->Default]);
+        }
+        for (uint32_t i = 0; i < Ql_Log_Level_Store.Num; i++)
+        {
+            Ql_Printf("[I/log]   override %s %c\r\n", Ql_Log_Level_Store.Item[i].Tag, level_name[Ql_Log_Level_Store.Item[i].Level]);
+        }
+        return 0;
+    }
+
+    if ((n == 2) && (strcmp(tag, "save") == 0))
+    {
+        n = Ql_Log_Level_Save();
+        Ql_Printf("[I/log] save %s\r\n", (n == 0) ? "ok" : "failed");
+        return n;
+    }
+
+    if ((n == 2) && (strcmp(tag, "reset") == 0))
+    {
+        Ql_Log_Level_Store.Num = 0;
+        for (item = Ql_Log_Tag_List; item != NULL; item = item->Next)
+        {
+            item->Level = item->Default;
+        }
+        n = (Ql_Flash_Erase(QL_LOG_LEVEL_FLASH_ADDR, sizeof(Ql_Log_Level_Store)) < 0) ? -1 : 0;
+        Ql_Printf("[I/log] reset %s\r\n", (n == 0) ? "ok" : "failed");
+        return n;
+    }
+
+    if (n == 3)
+    {
+        if ((lvl[0] >= '0') && (lvl[0] <= '4'))
+        {
+            level = lvl[0] - '0';
+        }
+        else if ((pos = strchr(level_name, lvl[0] | 0x20)) != NULL)
+        {
+            level = pos - level_name;
+        }
+    }
+
+    if ((level < 0) || (Ql_Log_Level_Set(tag, level) != 0))
+    {
+        Ql_Printf("[W/log] usage: log [list|save|reset] | log <tag|*> <n|e|w|i|d>\r\n");
+        return -1;
+    }
+
+    Ql_Printf("[I/log] %s -> %c\r\n", tag, level_name[level]);
+
+    return 0;
+}
+
+#if QL_LOG_CMD_ENABLE
+/*****************************************************************************
+* @brief  Let Ql_Log_Task read commands from the console RX
+* ex:
+* @par
+* Turn it off when an application owns the console RX.
+* @retval
+*****************************************************************************/
+void Ql_Log_Cmd_Enable(uint8_t Enable)
+{
+    Ql_Log_Cmd_On = Enable;
+}
+
+static void Ql_Log_Cmd_Poll(void)
+{
+    static char line[48];
+    static uint8_t len = 0;
+    char ch;
+
+    while (Ql_Log_Cmd_On && (Ql_Uart_Read(LOG_UART, &ch, 1, 0) == 1))
+    {
+        if ((ch == '\r') || (ch == '\n'))
+        {
+            line[len] = '\0';
+            if (len > 0)
+            {
+                Ql_Log_Cmd(line);
+            }
+            len = 0;
+        }
+        else if (len < (sizeof(line) - 1))
+        {
+            line[len++] = ch;
+        }
+    }
+}
+#else
+void Ql_Log_Cmd_Enable(uint8_t Enable)
+{
+    (void)Enable;
+}
+#endif
+
+#if QL_LOG_FLASH_ENABLE
+static volatile uint8_t Ql_Log_Flash_On = 1;
+
+/*****************************************************************************
+* @brief  Keep the W and E lines in the flash event log
+* ex:
+* @par
+* Switched on while there is nowhere else to keep them. A failed append
+* switches it off, the error line it logs would fail again.
+* @retval
+*****************************************************************************/
+void Ql_Log_Flash_Enable(uint8_t Enable)
+{
+    Ql_Log_Flash_On = Enable;
+}
+
+static void Ql_Log_Flash_Save(const uint32_t *Rec)
+{
+    const char *line = (const char *)(Rec + 3);
+    uint32_t len = QL_LOG_REC_LEN(Rec[1]) - QL_LOG_REC_HDR_SIZE;
+
+    if (!Ql_Log_Flash_On || (QL_LOG_REC_TYPE(Rec[1]) != QL_LOG_REC_TEXT) || (len < 4) ||
+        (line[0] != '[') || ((line[1] != 'E') && (line[1] != 'W')))
+    {
+        return;
+    }
+
+    while ((len > 0) && ((line[len - 1] == '\r') || (line[len - 1] == '\n')))
+    {
+        len--;
+    }
+
+    if (Ql_Flash_Log_Append(QL_FLASH_LOG_TEXT, line, len) != 0)
+    {
+        Ql_Log_Flash_On = 0;
+    }
+}
+#else
+void Ql_Log_Flash_Enable(uint8_t Enable)
+{
+    (void)Enable;
+}
+#endif
+
+/*****************************************************************************
+* @brief  Merge the band rings by sequence and drain them to the console
+* ex:
+* @par
+* The only QL_LOG writer of the console, Ql_Printf output is serialized
+* against it with Ql_Log_Mutex.
+* @retval
+*****************************************************************************/
+static void Ql_Log_Task(void *param)
+{
+    static const char *band_name[QL_LOG_BAND_NUM] = { "isr", "high", "low" };
+    uint32_t dropped[QL_LOG_BAND_NUM] = { 0 };
+    Ql_Log_Ring_TypeDef *ring = NULL;
+    uint32_t *rec;
+    uint32_t len;
+    uint32_t n;
+
+    (void)param;
+
+    while (1)
+    {
+        len = 0;
+        while ((rec = Ql_Log_Next(&ring)) != NULL)
+        {
+            n = Ql_Log_Rec_Output(rec, Ql_Log_Out_Buf + len, sizeof(Ql_Log_Out_Buf) - len);
+            if (n == 0)
+            {
+                break;
+            }
+            len += n;
+#if QL_LOG_FLASH_ENABLE
+            Ql_Log_Flash_Save(rec);
+#endif
+            Ql_Log_Ring_Release(ring, rec);
+        }
+
+        if (len > 0)
+        {
+            Ql_Log_MutexTake();
+            Ql_Log_Uart_Output(Ql_Log_Out_Buf, len);
+            Ql_Log_MutexGive();
+            continue;
+        }
+
+        for (uint8_t i = 0; i < QL_LOG_BAND_NUM; i++)
+        {
+            if (dropped[i] != Ql_Log_Ring[i].Dropped)
+            {
+                Ql_Printf("[W/log] %s ring full, %u lines dropped\r\n", band_name[i], Ql_Log_Ring[i].Dropped - dropped[i]);
+                dropped[i] = Ql_Log_Ring[i].Dropped;
+            }
+        }
+
+#if QL_LOG_CMD_ENABLE
+        Ql_Log_Cmd_Poll();
+#endif
+
+        vTaskDelay(pdMS_TO_TICKS(QL_LOG_TASK_PERIOD));
+    }
+}
+
+/*****************************************************************************
+* @brief  Cycles per log call, QL_LOG against the synchronous Ql_Printf
+* ex:
+* @par
+* Uses the DWT cycle counter. The worst case is what a high priority task
+* pays when the console is busy, Ql_Printf includes the wait for the DMA.
+* @retval
+*****************************************************************************/
+void Ql_Log_Bench(void)
+{
+    const uint32_t loop = 32;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t log_sum  = 0, log_max  = 0;
+    uint32_t prt_sum  = 0, prt_max  = 0;
+    uint32_t off_sum  = 0, off_max  = 0;
+    uint8_t  level;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint32_t i = 0; i < loop; i++)
+    {
+        start = DWT->CYCCNT;
+        QL_LOG_I("bench %u: %s %d", i, "ring", -1);
+        cycles = DWT->CYCCNT - start;
+        log_sum += cycles;
+        log_max  = (cycles > log_max) ? cycles : log_max;
+    }
+
+    /* Same statement switched off at runtime, the cost of a disabled log */
+    level = QL_LOG_TAG_OBJ.Level;
+    QL_LOG_TAG_OBJ.Level = QL_LOG_WARN;
+    for (uint32_t i = 0; i < loop; i++)
+    {
+        start = DWT->CYCCNT;
+        QL_LOG_I("bench %u: %s %d", i, "ring", -1);
+        cycles = DWT->CYCCNT - start;
+        off_sum += cycles;
+        off_max  = (cycles > off_max) ? cycles : off_max;
+    }
+    QL_LOG_TAG_OBJ.Level = level;
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    for (uint32_t i = 0; i < loop; i++)
+    {
+        start = DWT->CYCCNT;
+        Ql_Printf("[I/log] bench %u: %s %d\r\n", i, "printf", -1);
+        cycles = DWT->CYCCNT - start;
+        prt_sum += cycles;
+        prt_max  = (cycles > prt_max) ? cycles : prt_max;
+    }
+
+    QL_LOG_I("cycles per call: QL_LOG avg %u max %u, disabled avg %u max %u, Ql_Printf avg %u max %u",
+             log_sum / loop, log_max, off_sum / loop, off_max, prt_sum / loop, prt_max);
+}
+
 int32_t Ql_Log_MutexTake(void)
 {
-    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    if ((xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) && (__get_IPSR() == 0))
     {
         if (Ql_Log_Mutex == NULL)
         {
@@ -52,7 +962,7 @@ int32_t Ql_Log_MutexTake(void)
 
 int32_t Ql_Log_MutexGive(void)
 {
-    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    if ((xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) && (__get_IPSR() == 0))
     {
         if (Ql_Log_Mutex == NULL)
         {
@@ -67,6 +977,11 @@ int32_t Ql_Log_MutexGive(void)
 
 int32_t Ql_Log_FuncInit(void)
 {
+    Ql_Log_Level_Load();
+#if QL_LOG_FLASH_ENABLE
+    Ql_Flash_Log_Init();
+#endif
+
     if (Ql_Log_Mutex == NULL)
     {
         Ql_Log_Mutex = xSemaphoreCreateMutex();
@@ -76,18 +991,41 @@ int32_t Ql_Log_FuncInit(void)
         }
     }
 
+    if (Ql_Log_TaskHandle == NULL)
+    {
+        if (xTaskCreate(Ql_Log_Task,
+                        "log",
+                        configMINIMAL_STACK_SIZE * 3,
+                        NULL,
+                        QL_LOG_TASK_PRIORITY,
+                        &Ql_Log_TaskHandle) != pdPASS)
+        {
+            return -1;
+        }
+    }
+
     return 0;
 }
 
-void Ql_Printf(const int8_t *format, ...)
+/*****************************************************************************
+* @brief  Synchronous console output, bypasses the rings
+* ex:
+* @par
+* For the banner, hex dumps and fault handlers. Blocks until the console
+* DMA is done, QL_LOG_x is the non-blocking path.
+* @retval
+*****************************************************************************/
+void Ql_Printf(const char *format, ...)
 {
     size_t log_len = 0;
     va_list args;
     int fmt_result;
 
+    /* no lock before Ql_Log_FuncInit, output as before */
+    Ql_Log_MutexTake();
+
     /* args point to the first variable parameter */
     va_start(args, format);
-    /* lock output */
     /* package other log data to buffer. '\0' must be added in the end by vsnprintf. */
     fmt_result = vsnprintf(Ql_Log_Buf, sizeof(Ql_Log_Buf), format, args);
     va_end(args);
@@ -105,6 +1043,8 @@ void Ql_Printf(const int8_t *format, ...)
 
     Ql_Log_Uart_Output((const uint8_t *)Ql_Log_Buf, log_len);
 
+    Ql_Log_MutexGive();
+
     return;
 }
 
@@ -28,6 +28,9 @@ limitations under the License.
 #include <string.h>
 #include <stdarg.h>
 
+#include "ql_flash.h"
+
+#define QL_LOG_NONE              (0U)
 #define QL_LOG_ERROR             (1U)
 #define QL_LOG_WARN              (2U)
 #define QL_LOG_INFO              (3U)
@@ -35,30 +38,97 @@ limitations under the License.
 
 #define QL_LOG_PRINTF            Ql_Printf
 
-
-
 #define QL_LOG_HDR(level)        QL_LOG_PRINTF("[" level "/" LOG_TAG "] ")
 #define QL_LOG_END               QL_LOG_PRINTF("\r\n")
 
+/* QL_LOG_x never blocks: the line goes to a lock-free ring, one per band
+   (ISRs, tasks at or above QL_LOG_HIGH_PRIORITY, the rest), and Ql_Log_Task
+   merges the rings in call order onto the console, an isr or high ring past
+   half full ahead of the low one. Ql_Printf stays the synchronous path for
+   the banner, hex dumps and fault handlers. */
+#define QL_LOG_RING_SIZE_ISR     (1024*1)   // power of 2
+#define QL_LOG_RING_SIZE_HIGH    (1024*2)   // power of 2
+#define QL_LOG_RING_SIZE_LOW     (1024*4)   // power of 2
+#define QL_LOG_LINE_MAX          (192U)     // formatted in the ring, reserved in full until the line is done
+#define QL_LOG_HIGH_PRIORITY     (tskIDLE_PRIORITY + 10)
+#define QL_LOG_TASK_PERIOD       (10U)      // ms
+#define QL_LOG_TASK_PRIORITY     (tskIDLE_PRIORITY + 1)
+
+/* Deferred binary mode. A log call only stores the address of its format
+   string and the raw arguments, Ql_Log_Task sends them out as binary
+   frames. tools/ql_log_decode.py rebuilds the text with the format strings
+   taken from the ql_log_fmt section of the .axf */
+#ifndef QL_LOG_DEFERRED_ENABLE
+#define QL_LOG_DEFERRED_ENABLE   0
+#endif
+
+#define QL_LOG_BIN_ARGS_MAX      (96U)      // packed argument bytes per call
+#define QL_LOG_BIN_STR_MAX       (32U)      // %s is copied, longer strings are cut
+#define QL_LOG_BIN_SYNC          (0xFEU)    // never part of a text line
+#define QL_LOG_FMT_SECTION       __attribute__((section("ql_log_fmt"), used))
+
+/* Runtime levels. "log <tag|*> <n|e|w|i|d>", "log save", "log reset" and
+   "log list" on the console, the overrides are kept in flash. Ql_Log_Task
+   reads the console RX for them, applications that forward it call
+   Ql_Log_Cmd_Enable(0) first */
+#ifndef QL_LOG_CMD_ENABLE
+#define QL_LOG_CMD_ENABLE        1
+#endif
+#define QL_LOG_LEVEL_UNSET       (0xFFU)
+#define QL_LOG_TAG_NAME_MAX      (16U)
+#define QL_LOG_OVERRIDE_MAX      (16U)
+#define QL_LOG_LEVEL_FLASH_ADDR  QL_FLASH_PARAM_ADDR
+#define QL_LOG_LEVEL_FLASH_MAGIC (0x564C4C51U)   // "QLLV"
+#define QL_LOG_TAG_ATTR          __attribute__((unused))
+
+/* W and E lines are also appended to the flash event log (ql_flash_log.h)
+   while it is switched on, ql_ff_user does that whenever no SD card is
+   mounted. On from boot until the first mount */
+#ifndef QL_LOG_FLASH_ENABLE
+#define QL_LOG_FLASH_ENABLE      1
+#endif
+
+typedef struct ql_log_tag
+{
+    const char         *Name;
+    volatile uint8_t    Level;      // QL_LOG_LEVEL_UNSET until the first call
+    uint8_t             Default;    // LOG_LVL of the file
+    struct ql_log_tag  *Next;
+} Ql_Log_Tag_TypeDef;
+
 int Ql_Log_MutexTake(void);
 int Ql_Log_MutexGive(void);
 
+#if QL_LOG_DEFERRED_ENABLE
 #define QL_LOG_LINE(Lvl, Fmt, ...)                                  \
         do {                                                        \
-            if (Ql_Log_MutexTake()) break;                         \
-            QL_LOG_HDR(Lvl);                                        \
-            QL_LOG_PRINTF(Fmt, ##__VA_ARGS__);                      \
-            QL_LOG_END;                                             \
-            Ql_Log_MutexGive();                                    \
+            static const char Ql_Log_Fmt[] QL_LOG_FMT_SECTION =     \
+                "[" Lvl "/" LOG_TAG "] " Fmt "\r\n";                \
+            Ql_Log_Bin(Ql_Log_Fmt, ##__VA_ARGS__);                  \
         } while (0)
+#else
+#define QL_LOG_LINE(Lvl, Fmt, ...)                                  \
+        Ql_Log_Text("[" Lvl "/" LOG_TAG "] " Fmt, ##__VA_ARGS__)
+#endif
 
-
-
-void Ql_Printf(const int8_t *format, ...);
+void Ql_Printf(const char *format, ...);
+void Ql_Log_Text(const char *Fmt, ...);
+void Ql_Log_Bench(void);
 int32_t Ql_Log_FuncInit(void);
+uint8_t Ql_Log_Tag_Register(Ql_Log_Tag_TypeDef *Tag, uint8_t Level);
+int32_t Ql_Log_Level_Set(const char *Tag, uint8_t Level);
+int32_t Ql_Log_Level_Save(void);
+int32_t Ql_Log_Cmd(const char *Line);
+void    Ql_Log_Cmd_Enable(uint8_t Enable);
+void    Ql_Log_Flash_Enable(uint8_t Enable);
+#if QL_LOG_DEFERRED_ENABLE
+void Ql_Log_Bin(const char *Fmt, ...);
+#endif
 
 #endif /*__QL_LOG_H__*/
 
+/* Build floor, statements above it are not compiled at all. Below it the
+   level is checked at runtime per LOG_TAG, starting from the file's LOG_LVL */
 #ifndef QL_LOG_LVL
 #define QL_LOG_LVL               QL_LOG_INFO
 #endif
@@ -67,26 +137,68 @@ int32_t Ql_Log_FuncInit(void);
 #define QL_LOG_TAG               "LOG"
 #endif
 
+/* One tag object per LOG_TAG and file. A file may switch tags through
+   ql_log_undef.h, every include takes the next free slot */
+#if defined(LOG_TAG)
+#ifndef LOG_LVL
+#define LOG_LVL                  QL_LOG_INFO
+#endif
+#undef QL_LOG_TAG_OBJ
+#if !defined(QL_LOG_TAG_SLOT_0)
+#define QL_LOG_TAG_SLOT_0
+static Ql_Log_Tag_TypeDef Ql_Log_Tag_0 QL_LOG_TAG_ATTR = { LOG_TAG, QL_LOG_LEVEL_UNSET, LOG_LVL, NULL };
+#define QL_LOG_TAG_OBJ           Ql_Log_Tag_0
+#elif !defined(QL_LOG_TAG_SLOT_1)
+#define QL_LOG_TAG_SLOT_1
+static Ql_Log_Tag_TypeDef Ql_Log_Tag_1 QL_LOG_TAG_ATTR = { LOG_TAG, QL_LOG_LEVEL_UNSET, LOG_LVL, NULL };
+#define QL_LOG_TAG_OBJ           Ql_Log_Tag_1
+#elif !defined(QL_LOG_TAG_SLOT_2)
+#define QL_LOG_TAG_SLOT_2
+static Ql_Log_Tag_TypeDef Ql_Log_Tag_2 QL_LOG_TAG_ATTR = { LOG_TAG, QL_LOG_LEVEL_UNSET, LOG_LVL, NULL };
+#define QL_LOG_TAG_OBJ           Ql_Log_Tag_2
+#elif !defined(QL_LOG_TAG_SLOT_3)
+#define QL_LOG_TAG_SLOT_3
+static Ql_Log_Tag_TypeDef Ql_Log_Tag_3 QL_LOG_TAG_ATTR = { LOG_TAG, QL_LOG_LEVEL_UNSET, LOG_LVL, NULL };
+#define QL_LOG_TAG_OBJ           Ql_Log_Tag_3
+#elif !defined(QL_LOG_TAG_SLOT_4)
+#define QL_LOG_TAG_SLOT_4
+static Ql_Log_Tag_TypeDef Ql_Log_Tag_4 QL_LOG_TAG_ATTR = { LOG_TAG, QL_LOG_LEVEL_UNSET, LOG_LVL, NULL };
+#define QL_LOG_TAG_OBJ           Ql_Log_Tag_4
+#elif !defined(QL_LOG_TAG_SLOT_5)
+#define QL_LOG_TAG_SLOT_5
+static Ql_Log_Tag_TypeDef Ql_Log_Tag_5 QL_LOG_TAG_ATTR = { LOG_TAG, QL_LOG_LEVEL_UNSET, LOG_LVL, NULL };
+#define QL_LOG_TAG_OBJ           Ql_Log_Tag_5
+#else
+#error "ql_log.h included with too many LOG_TAG in one file"
+#endif
+#endif
+
+/* A single load and compare while the statement is off. The first call
+   that passes (Level still QL_LOG_LEVEL_UNSET) registers the tag */
+#define QL_LOG_ON(Lvl)                                                              \
+        (((Lvl) <= QL_LOG_TAG_OBJ.Level) &&                                         \
+         ((QL_LOG_TAG_OBJ.Level != QL_LOG_LEVEL_UNSET) || Ql_Log_Tag_Register(&QL_LOG_TAG_OBJ, (Lvl))))
+
 #if (QL_LOG_LVL >= QL_LOG_DEBUG)
-#define QL_LOG_D(Fmt, ...)  QL_LOG_LINE("D", Fmt, ##__VA_ARGS__)
+#define QL_LOG_D(Fmt, ...)  do { if (QL_LOG_ON(QL_LOG_DEBUG)) QL_LOG_LINE("D", Fmt, ##__VA_ARGS__); } while (0)
 #else
 #define QL_LOG_D(...)
 #endif
 
 #if (QL_LOG_LVL >= QL_LOG_INFO)
-#define QL_LOG_I(Fmt, ...)  QL_LOG_LINE("I", Fmt, ##__VA_ARGS__)
+#define QL_LOG_I(Fmt, ...)  do { if (QL_LOG_ON(QL_LOG_INFO))  QL_LOG_LINE("I", Fmt, ##__VA_ARGS__); } while (0)
 #else
 #define QL_LOG_I(...)
 #endif
 
 #if (QL_LOG_LVL >= QL_LOG_WARN)
-#define QL_LOG_W(Fmt, ...)  QL_LOG_LINE("W", Fmt, ##__VA_ARGS__)
+#define QL_LOG_W(Fmt, ...)  do { if (QL_LOG_ON(QL_LOG_WARN))  QL_LOG_LINE("W", Fmt, ##__VA_ARGS__); } while (0)
 #else
 #define QL_LOG_W(...)
 #endif
 
 #if (QL_LOG_LVL >= QL_LOG_ERROR)
-#define QL_LOG_E(Fmt, ...)  QL_LOG_LINE("E", Fmt, ##__VA_ARGS__)
+#define QL_LOG_E(Fmt, ...)  do { if (QL_LOG_ON(QL_LOG_ERROR)) QL_LOG_LINE("E", Fmt, ##__VA_ARGS__); } while (0)
 #else
 #define QL_LOG_E(...)
 #endif
@@ -0,0 +1,460 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_nmea_bin.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+
+#include "ql_nmea.h"
+#include "ql_nmea_bin.h"
+#include "ql_check.h"
+
+#define QL_NMEA_BIN_ARGC_MAX        (24)
+
+static uint8_t *Ql_NMEA_Bin_Put16(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+
+    return p + 2;
+}
+
+static uint8_t *Ql_NMEA_Bin_Put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+
+    return p + 4;
+}
+
+/*****************************************************************************
+* @brief  Decimal field to fixed point, "-12.3" with Dec 3 gives -12300
+* ex:
+* @par
+* Digits past Dec are cut, no floating point on the hot path.
+* @retval
+*****************************************************************************/
+static int64_t Ql_NMEA_Bin_Fixed(const char *s, uint8_t Dec)
+{
+    int64_t v = 0;
+    uint8_t neg = 0;
+    uint8_t frac = 0;
+    uint8_t d = 0;
+
+    if (*s == '-')
+    {
+        neg = 1;
+        s++;
+    }
+
+    for ( ; *s != '\0'; s++)
+    {
+        if (*s == '.')
+        {
+            frac = 1;
+            continue;
+        }
+        if ((*s < '0') || (*s > '9'))
+        {
+            break;
+        }
+        if (frac)
+        {
+            if (d >= Dec)
+            {
+                continue;
+            }
+            d++;
+        }
+        v = v * 10 + (*s - '0');
+    }
+
+    for ( ; d < Dec; d++)
+    {
+        v *= 10;
+    }
+
+    return neg ? -v : v;
+}
+
+/* dddmm.mmmmmm and hemisphere to 1e-7 degree */
+static int32_t Ql_NMEA_Bin_Coord(const char *s, const char *Hemi)
+{
+    const int64_t v = Ql_NMEA_Bin_Fixed(s, 6);
+    const int32_t r = (int32_t)((v / 100000000) * 10000000 + ((v % 100000000) + 3) / 6);
+
+    return ((*Hemi == 'S') || (*Hemi == 'W')) ? -r : r;
+}
+
+/* ddmmyy to days since 2000-01-01 */
+static uint16_t Ql_NMEA_Bin_Date(const char *s)
+{
+    const uint32_t v = (uint32_t)Ql_NMEA_Bin_Fixed(s, 0);
+    int32_t y = 2000 + v % 100;
+    const uint32_t m = v / 100 % 100;
+    const uint32_t d = v / 10000;
+    uint32_t era;
+    uint32_t yoe;
+    uint32_t doy;
+
+    if ((m < 1) || (m > 12) || (d < 1))
+    {
+        return 0;
+    }
+
+    /* Days from civil with March based years, 730425 days from 0000-03-01 to 2000-01-01 */
+    y  -= (m <= 2);
+    era = y / 400;
+    yoe = y - era * 400;
+    doy = (153 * ((m > 2) ? (m - 3) : (m + 9)) + 2) / 5 + d - 1;
+
+    return (uint16_t)(era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 730425);
+}
+
+static uint8_t Ql_NMEA_Bin_System(const char *Talker)
+{
+    static const char *talker[] = { "GP", "GL", "GA", "GB", "GQ", "GI" };
+
+    for (uint8_t i = 0; i < sizeof(talker) / sizeof(talker[0]); i++)
+    {
+        if ((Talker[0] == talker[i][0]) && (Talker[1] == talker[i][1]))
+        {
+            return i + 1;
+        }
+    }
+
+    return ((Talker[0] == 'B') && (Talker[1] == 'D')) ? 4 : 0;
+}
+
+/*****************************************************************************
+* @brief  Pack one epoch record
+* ex:
+* @par
+* Len(1) Time_Ms(4) Date(2) Lat(4) Lon(4) Alt(4) Geoid(2) Speed(2)
+* Course(2) Quality Mode Used View HDOP(2) PDOP(2) VDOP(2) Sat_Num,
+* then Sat_Num * (Sys Prn Cn0) with QL_NMEA_BIN_FLAG_CN0.
+* @retval record length
+*****************************************************************************/
+uint32_t Ql_NMEA_Bin_Pack(const Ql_NMEA_Epoch_TypeDef *Epoch, uint8_t Flags, uint8_t *Buf)
+{
+    const uint8_t sats = (Flags & QL_NMEA_BIN_FLAG_CN0) ? Epoch->Sat_Num : 0;
+    uint8_t *p = Buf;
+
+    *p++ = QL_NMEA_BIN_REC_SIZE + sats * 3;
+    p = Ql_NMEA_Bin_Put32(p, Epoch->Time_Ms);
+    p = Ql_NMEA_Bin_Put16(p, Epoch->Date);
+    p = Ql_NMEA_Bin_Put32(p, (uint32_t)Epoch->Lat);
+    p = Ql_NMEA_Bin_Put32(p, (uint32_t)Epoch->Lon);
+    p = Ql_NMEA_Bin_Put32(p, (uint32_t)Epoch->Alt);
+    p = Ql_NMEA_Bin_Put16(p, (uint16_t)Epoch->Geoid);
+    p = Ql_NMEA_Bin_Put16(p, Epoch->Speed);
+    p = Ql_NMEA_Bin_Put16(p, Epoch->Course);
+    *p++ = Epoch->Quality;
+    *p++ = Epoch->Mode;
+    *p++ = Epoch->Used;
+    *p++ = Epoch->View;
+    p = Ql_NMEA_Bin_Put16(p, Epoch->HDOP);
+    p = Ql_NMEA_Bin_Put16(p, Epoch->PDOP);
+    p = Ql_NMEA_Bin_Put16(p, Epoch->VDOP);
+    *p++ = sats;
+
+    for (uint8_t i = 0; i < sats; i++)
+    {
+        *p++ = Epoch->Sat[i].Sys;
+        *p++ = Epoch->Sat[i].Prn;
+        *p++ = Epoch->Sat[i].Cn0;
+    }
+
+    return p - Buf;
+}
+
+/*****************************************************************************
+* @brief  Close the block and hand it to Out
+* ex:
+* @par
+* A block is always QL_NMEA_BIN_BLOCK_SIZE bytes, so block k of a file is
+* at k * QL_NMEA_BIN_BLOCK_SIZE.
+* @retval 0: ok
+*****************************************************************************/
+static int32_t Ql_NMEA_Bin_Emit(Ql_NMEA_Bin_TypeDef *Bin)
+{
+    uint8_t *p = Bin->Block;
+    uint32_t crc;
+    int32_t ret;
+
+    *p++ = 'Q';
+    *p++ = 'E';
+    *p++ = QL_NMEA_BIN_VERSION;
+    *p++ = Bin->Flags;
+    p = Ql_NMEA_Bin_Put16(p, Bin->Count);
+    p = Ql_NMEA_Bin_Put16(p, Bin->Used);
+    p = Ql_NMEA_Bin_Put32(p, Bin->Seq - Bin->Count);
+    memset(&Bin->Block[QL_NMEA_BIN_HDR_SIZE + Bin->Used], 0, QL_NMEA_BIN_BLOCK_SIZE - QL_NMEA_BIN_HDR_SIZE - Bin->Used);
+
+    crc = Ql_Check_CRC32(0, Bin->Block, 12);
+    crc = Ql_Check_CRC32(crc, &Bin->Block[QL_NMEA_BIN_HDR_SIZE], Bin->Used);
+    Ql_NMEA_Bin_Put32(p, crc);
+
+    ret = Bin->Out(Bin->Ctx, Bin->Block, QL_NMEA_BIN_BLOCK_SIZE);
+    if (ret != 0)
+    {
+        Bin->Errors++;
+    }
+    Bin->Blocks++;
+    Bin->Used  = 0;
+    Bin->Count = 0;
+
+    return ret;
+}
+
+/*****************************************************************************
+* @brief  Append one epoch, a full block goes to Out
+* ex:
+* @par
+* For a source other than NMEA, Ql_NMEA_Bin_Feed calls it per epoch.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_NMEA_Bin_Put(Ql_NMEA_Bin_TypeDef *Bin, const Ql_NMEA_Epoch_TypeDef *Epoch)
+{
+    const uint32_t len = QL_NMEA_BIN_REC_SIZE + ((Bin->Flags & QL_NMEA_BIN_FLAG_CN0) ? Epoch->Sat_Num * 3 : 0);
+    int32_t ret = 0;
+
+    if ((Bin->Used + len) > (QL_NMEA_BIN_BLOCK_SIZE - QL_NMEA_BIN_HDR_SIZE))
+    {
+        ret = Ql_NMEA_Bin_Emit(Bin);
+    }
+
+    Bin->Used += Ql_NMEA_Bin_Pack(Epoch, Bin->Flags, &Bin->Block[QL_NMEA_BIN_HDR_SIZE + Bin->Used]);
+    Bin->Count++;
+    Bin->Seq++;
+
+    return ret;
+}
+
+static int32_t Ql_NMEA_Bin_Close_Epoch(Ql_NMEA_Bin_TypeDef *Bin)
+{
+    const uint16_t date = Bin->Epoch.Date;
+    int32_t ret;
+
+    ret = Ql_NMEA_Bin_Put(Bin, &Bin->Epoch);
+    memset(&Bin->Epoch, 0, sizeof(Ql_NMEA_Epoch_TypeDef));
+    Bin->Epoch.Date = date;
+    Bin->Open = 0;
+
+    return ret;
+}
+
+/* A GGA or RMC with a new time ends the epoch before it */
+static void Ql_NMEA_Bin_Time(Ql_NMEA_Bin_TypeDef *Bin, const char *s)
+{
+    uint32_t t;
+
+    if (*s == '\0')
+    {
+        return;
+    }
+
+    t = (uint32_t)Ql_NMEA_Bin_Fixed(s, 3);
+    t = (t / 10000000) * 3600000 + (t / 100000 % 100) * 60000 + t % 100000;
+
+    if (Bin->Open && (t != Bin->Epoch.Time_Ms))
+    {
+        Ql_NMEA_Bin_Close_Epoch(Bin);
+    }
+
+    if (!Bin->Open)
+    {
+        Bin->Epoch.Time_Ms = t;
+        Bin->Open = 1;
+    }
+}
+
+static void Ql_NMEA_Bin_Sentence(Ql_NMEA_Bin_TypeDef *Bin, char *Str, uint32_t Len)
+{
+    Ql_NMEA_Epoch_TypeDef *e = &Bin->Epoch;
+    char *argv[QL_NMEA_BIN_ARGC_MAX];
+    int argc = QL_NMEA_BIN_ARGC_MAX;
+    uint8_t fix;
+    uint8_t sys;
+
+    if ((Len < 7) || (Str[1] == 'P'))
+    {
+        return;
+    }
+
+    sys = Ql_NMEA_Bin_System(&Str[1]);
+    Ql_NMEA_Option_Parse(Str, Len, &argc, argv);
+
+    if ((memcmp(&Str[3], "GGA", 3) == 0) && (argc >= 12))
+    {
+        /* $GNGGA,034056.000,3149.300743,N,11706.920011,E,1,40,0.48,87.6,M,-0.3,M,,*5F */
+        Ql_NMEA_Bin_Time(Bin, argv[1]);
+        e->Quality = (uint8_t)Ql_NMEA_Bin_Fixed(argv[6], 0);
+        e->Used    = (uint8_t)Ql_NMEA_Bin_Fixed(argv[7], 0);
+        if (e->HDOP == 0)
+        {
+            e->HDOP = (uint16_t)Ql_NMEA_Bin_Fixed(argv[8], 2);
+        }
+        if ((*argv[2] != '\0') && (*argv[4] != '\0'))
+        {
+            e->Lat   = Ql_NMEA_Bin_Coord(argv[2], argv[3]);
+            e->Lon   = Ql_NMEA_Bin_Coord(argv[4], argv[5]);
+            e->Alt   = (int32_t)Ql_NMEA_Bin_Fixed(argv[9], 3);
+            e->Geoid = (int16_t)Ql_NMEA_Bin_Fixed(argv[11], 2);
+            e->Mode |= QL_NMEA_MODE_POS;
+        }
+    }
+    else if ((memcmp(&Str[3], "RMC", 3) == 0) && (argc >= 10))
+    {
+        /* $GNRMC,050748.000,A,3149.303735,N,11706.919772,E,0.046,312.46,050424,,,A,V*3F */
+        Ql_NMEA_Bin_Time(Bin, argv[1]);
+        e->Mode |= (*argv[2] == 'A') ? QL_NMEA_MODE_RMC_VALID : 0;
+        if (*argv[7] != '\0')
+        {
+            /* knots x 1000 to cm/s */
+            e->Speed  = (uint16_t)(Ql_NMEA_Bin_Fixed(argv[7], 3) * 514444 / 10000000);
+            e->Course = (uint16_t)Ql_NMEA_Bin_Fixed(argv[8], 2);
+            e->Mode  |= QL_NMEA_MODE_VEL;
+        }
+        if (*argv[9] != '\0')
+        {
+            e->Date = Ql_NMEA_Bin_Date(argv[9]);
+        }
+        if (((e->Mode & QL_NMEA_MODE_POS) == 0) && (*argv[3] != '\0') && (*argv[5] != '\0'))
+        {
+            e->Lat = Ql_NMEA_Bin_Coord(argv[3], argv[4]);
+            e->Lon = Ql_NMEA_Bin_Coord(argv[5], argv[6]);
+        }
+    }
+    else if ((memcmp(&Str[3], "GSA", 3) == 0) && (argc >= 18))
+    {
+        /* $GNGSA,A,3,05,13,15,18,23,24,,,,,,,1.22,0.66,1.03,1*0B */
+        fix = (uint8_t)Ql_NMEA_Bin_Fixed(argv[2], 0);
+        if (fix > ((e->Mode & QL_NMEA_MODE_FIX_MASK) >> QL_NMEA_MODE_FIX_POS))
+        {
+            e->Mode = (e->Mode & ~QL_NMEA_MODE_FIX_MASK) | ((fix << QL_NMEA_MODE_FIX_POS) & QL_NMEA_MODE_FIX_MASK);
+        }
+        e->PDOP = (uint16_t)Ql_NMEA_Bin_Fixed(argv[15], 2);
+        e->HDOP = (uint16_t)Ql_NMEA_Bin_Fixed(argv[16], 2);
+        e->VDOP = (uint16_t)Ql_NMEA_Bin_Fixed(argv[17], 2);
+    }
+    else if ((memcmp(&Str[3], "GSV", 3) == 0) && (argc >= 4))
+    {
+        /* $GPGSV,3,1,12,05,40,120,33,13,...,1*6A, the signal ID is last in NMEA 4.11 */
+        const uint8_t sig = (((argc - 4) % 4) == 1) ? (uint8_t)Ql_NMEA_Bin_Fixed(argv[argc - 1], 0) : 1;
+
+        if ((Ql_NMEA_Bin_Fixed(argv[2], 0) == 1) && (sig <= 1))
+        {
+            e->View += (uint8_t)Ql_NMEA_Bin_Fixed(argv[3], 0);
+        }
+
+        for (int i = 4; ((i + 3) < argc) && (e->Sat_Num < QL_NMEA_BIN_SAT_MAX); i += 4)
+        {
+            if (*argv[i] == '\0')
+            {
+                continue;
+            }
+            e->Sat[e->Sat_Num].Sys = sys | (sig << 4);
+            e->Sat[e->Sat_Num].Prn = (uint8_t)Ql_NMEA_Bin_Fixed(argv[i], 0);
+            e->Sat[e->Sat_Num].Cn0 = (uint8_t)Ql_NMEA_Bin_Fixed(argv[i + 3], 0);
+            e->Sat_Num++;
+        }
+    }
+}
+
+int32_t Ql_NMEA_Bin_Init(Ql_NMEA_Bin_TypeDef *Bin, uint8_t Flags, Ql_NMEA_Bin_Out_TypeDef Out, void *Ctx)
+{
+    if ((Bin == NULL) || (Out == NULL))
+    {
+        return -1;
+    }
+
+    memset(Bin, 0, sizeof(Ql_NMEA_Bin_TypeDef));
+    Bin->Flags = Flags;
+    Bin->Out   = Out;
+    Bin->Ctx   = Ctx;
+
+    return 0;
+}
+
+/*****************************************************************************
+* @brief  Decode NMEA sentences into epoch records
+* ex:
+* Ql_NMEA_Init(&handle, NULL, Nmea_Bin_Global, 4096);   // GlobalFunc gets whole sentences
+* @par
+* Str holds one or more complete sentences, checked by Ql_NMEA_Parse.
+* GGA, RMC, GSA and GSV are used, an epoch ends when a GGA or RMC brings
+* a new UTC time.
+* @retval 0: ok, -1: a block could not be written
+*****************************************************************************/
+int32_t Ql_NMEA_Bin_Feed(Ql_NMEA_Bin_TypeDef *Bin, const char *Str, uint32_t Len)
+{
+    char line[QL_NMEA_OUT_MSG_BUFFER_SIZE];
+    const uint32_t errors = Bin->Errors;
+    uint32_t start = Len;
+    uint32_t n;
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        if (Str[i] == '$')
+        {
+            start = i;
+        }
+        else if ((Str[i] == '\n') && (start < i))
+        {
+            n = i - start + 1;
+            if ((n < sizeof(line)) && (n > 6) && (Str[i - 4] == '*'))
+            {
+                memcpy(line, &Str[start], n);
+                line[n] = '\0';
+                Ql_NMEA_Bin_Sentence(Bin, line, n);
+            }
+            start = Len;
+        }
+    }
+
+    return (Bin->Errors == errors) ? 0 : -1;
+}
+
+/*****************************************************************************
+* @brief  End the open epoch and write the partly filled block
+* ex:
+* @par
+* Call before closing the file, the next block starts a new one.
+* @retval 0: ok
+*****************************************************************************/
+int32_t Ql_NMEA_Bin_Flush(Ql_NMEA_Bin_TypeDef *Bin)
+{
+    int32_t ret = 0;
+
+    if (Bin->Open)
+    {
+        ret = Ql_NMEA_Bin_Close_Epoch(Bin);
+    }
+
+    if (Bin->Count > 0)
+    {
+        ret |= Ql_NMEA_Bin_Emit(Bin);
+    }
+
+    return ret;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_nmea_bin.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_NMEA_BIN_H__
+#define __QL_NMEA_BIN_H__
+
+#include <stdint.h>
+
+/* Binary epoch log. The file is a row of QL_NMEA_BIN_BLOCK_SIZE blocks, block
+   k starts at k * QL_NMEA_BIN_BLOCK_SIZE:
+     'Q' 'E' Version Flags Count(2) Used(2) First_Seq(4) CRC32(4), records, zero fill
+   CRC32 covers the first 12 header bytes and the Used payload bytes. A record
+   is one epoch, little endian, see Ql_NMEA_Bin_Pack(). The First_Seq of every
+   block is the index, built from the headers alone; any epoch is then one
+   block read.
+   Converter: quectel/tools/ql_nmea_bin.py */
+#define QL_NMEA_BIN_BLOCK_SIZE      (512U)
+#define QL_NMEA_BIN_HDR_SIZE        (16U)
+#define QL_NMEA_BIN_VERSION         (1U)
+#define QL_NMEA_BIN_REC_SIZE        (36U)       // record without satellites
+#define QL_NMEA_BIN_SAT_MAX         (64U)       // CN0 entries kept per epoch
+
+#define QL_NMEA_BIN_FLAG_CN0        (0x01U)     // records carry per satellite CN0
+
+/* Ql_NMEA_Epoch_TypeDef.Mode */
+#define QL_NMEA_MODE_RMC_VALID      (0x01U)     // RMC status A
+#define QL_NMEA_MODE_FIX_MASK       (0x06U)     // GSA fix type, 1: none, 2: 2D, 3: 3D
+#define QL_NMEA_MODE_FIX_POS        (1U)
+#define QL_NMEA_MODE_POS            (0x08U)     // Lat, Lon, Alt are set
+#define QL_NMEA_MODE_VEL            (0x10U)     // Speed, Course are set
+
+typedef struct
+{
+    uint8_t     Sys;        // NMEA 4.11 system ID, signal ID in the high nibble
+    uint8_t     Prn;
+    uint8_t     Cn0;        // dB-Hz, 0: not tracked
+} Ql_NMEA_Sat_TypeDef;
+
+typedef struct
+{
+    uint32_t    Time_Ms;    // UTC, ms of the day
+    uint16_t    Date;       // days since 2000-01-01, 0: no RMC date yet
+    int32_t     Lat;        // 1e-7 degree
+    int32_t     Lon;
+    int32_t     Alt;        // mm above mean sea level
+    int16_t     Geoid;      // cm, geoid separation
+    uint16_t    Speed;      // cm/s
+    uint16_t    Course;     // 0.01 degree
+    uint8_t     Quality;    // GGA fix quality
+    uint8_t     Mode;
+    uint8_t     Used;       // satellites used
+    uint8_t     View;       // satellites in view, all GSV talkers
+    uint16_t    HDOP;       // x100
+    uint16_t    PDOP;
+    uint16_t    VDOP;
+    uint8_t     Sat_Num;
+    Ql_NMEA_Sat_TypeDef Sat[QL_NMEA_BIN_SAT_MAX];
+} Ql_NMEA_Epoch_TypeDef;
+
+/* Receives every finished block, 0: written */
+typedef int32_t (*Ql_NMEA_Bin_Out_TypeDef)(void *Ctx, const uint8_t *Block, uint32_t Len);
+
+typedef struct
+{
+    Ql_NMEA_Epoch_TypeDef       Epoch;      // being assembled
+    uint8_t                     Open;       // Epoch holds a GGA or RMC
+    uint8_t                     Flags;
+    uint8_t                     Block[QL_NMEA_BIN_BLOCK_SIZE];
+    uint16_t                    Used;
+    uint16_t                    Count;
+    uint32_t                    Seq;        // next epoch number
+    Ql_NMEA_Bin_Out_TypeDef     Out;
+    void                       *Ctx;
+    uint32_t                    Blocks;
+    uint32_t                    Errors;
+} Ql_NMEA_Bin_TypeDef;
+
+int32_t  Ql_NMEA_Bin_Init(Ql_NMEA_Bin_TypeDef *Bin, uint8_t Flags, Ql_NMEA_Bin_Out_TypeDef Out, void *Ctx);
+int32_t  Ql_NMEA_Bin_Feed(Ql_NMEA_Bin_TypeDef *Bin, const char *Str, uint32_t Len);
+int32_t  Ql_NMEA_Bin_Put(Ql_NMEA_Bin_TypeDef *Bin, const Ql_NMEA_Epoch_TypeDef *Epoch);
+int32_t  Ql_NMEA_Bin_Flush(Ql_NMEA_Bin_TypeDef *Bin);
+uint32_t Ql_NMEA_Bin_Pack(const Ql_NMEA_Epoch_TypeDef *Epoch, uint8_t Flags, uint8_t *Buf);
+
+#endif
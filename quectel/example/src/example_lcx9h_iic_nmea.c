@@ -51,6 +51,9 @@ limitations under the License.
 
 #define MAX_ERROR_NUMBER                         3
 #define QL_LCx9H_IIC_DELAY                       15                            //unit ms
+#define QL_LCx9H_IIC_GAP_MIN_US                  1000                          //turnaround of the module, unit us
+#define QL_LCx9H_IIC_GAP_MAX_US                  (QL_LCx9H_IIC_DELAY * 1000)   //unit us
+#define QL_LCx9H_IIC_PACE_PRINT                  60                            //reads between two pacing logs
 
 #define QL_LCx29H_IIC_MODE                           (IIC_MODE_HW0_POLLING)
 #define QL_LCx29H_IIC_SPEED                          (IIC_SPEED_FAST)
@@ -59,6 +62,7 @@ limitations under the License.
 
 //-----static global variable-----
 static  SemaphoreHandle_t iic_port_sem;
+static  IIC_Pace_TypeDef  iic_port_pace;
 
 //-----static function declare-----
 static void Ql_LCx9H_IIC_ErrHandle(Ql_IIC_Status_TypeDef iic_state);
@@ -160,8 +164,7 @@ static int32_t Ql_LCx9H_IIC_ReadData(uint8_t *Data, uint32_t *Size,uint32_t time
         request_cmd[0] = (QL_LCx9H_IIC_SLAVE_CR_CMD << 16) | QL_LCx9H_IIC_SLAVE_TX_LEN_REG_OFFSET;
         request_cmd[1] = 4;
         
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        iic_state = Ql_IIC_Write(QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0,(uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN, timeout);
+        iic_state = Ql_IIC_PaceWrite(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0,(uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN, timeout);
         if(QL_IIC_STATUS_OK == iic_state)
         {
             error_number = 0;
@@ -178,8 +181,7 @@ static int32_t Ql_LCx9H_IIC_ReadData(uint8_t *Data, uint32_t *Size,uint32_t time
         }
 
         //step 1_b
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        iic_state = Ql_IIC_Read(QL_LCx9H_IIC_SLAVE_ADDR_R << 1, 0,(uint8_t*)&valid_data_size, 4, timeout);
+        iic_state = Ql_IIC_PaceRead(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_R << 1, 0,(uint8_t*)&valid_data_size, 4, timeout);
         if(QL_IIC_STATUS_OK == iic_state)
         {
             QL_LOG_D("read data step 1_b valid data size:%d",valid_data_size);
@@ -205,8 +207,7 @@ static int32_t Ql_LCx9H_IIC_ReadData(uint8_t *Data, uint32_t *Size,uint32_t time
         request_cmd[0] = (QL_LCx9H_IIC_SLAVE_CR_CMD << 16) | QL_LCx9H_IIC_SLAVE_TX_BUF_REG_OFFSET;
         request_cmd[1] = read_size;
        
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        iic_state = Ql_IIC_Write(QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0,(uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN, timeout);
+        iic_state = Ql_IIC_PaceWrite(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0,(uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN, timeout);
         if(QL_IIC_STATUS_OK == iic_state)
         {
             QL_LOG_D("read data step 2_a success, request cmd:0x%08x, read size: %d",request_cmd[0],request_cmd[1]);
@@ -219,8 +220,7 @@ static int32_t Ql_LCx9H_IIC_ReadData(uint8_t *Data, uint32_t *Size,uint32_t time
         }
         
         //step 2_b
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        iic_state = Ql_IIC_Read(QL_LCx9H_IIC_SLAVE_ADDR_R << 1,0, Data, read_size, timeout);
+        iic_state = Ql_IIC_PaceRead(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_R << 1,0, Data, read_size, timeout);
         if(QL_IIC_STATUS_OK == iic_state)
         {
             *Size = read_size;
@@ -276,8 +276,7 @@ static int32_t Ql_LCx9H_IIC_WriteData(uint8_t *pData, uint16_t dataLength,uint32
         request_cmd[0] = (QL_LCx9H_IIC_SLAVE_CR_CMD << 16) | QL_LCx9H_IIC_SLAVE_RX_LEN_REG_OFFSET;
         request_cmd[1] = 4;
         
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        status = Ql_IIC_Write(QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0, (uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN,timeout);
+        status = Ql_IIC_PaceWrite(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0, (uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN,timeout);
         if(QL_IIC_STATUS_OK == status)
         {
             //QL_LOG_D("write data step 1_a success, request cmd:0x%08x, write size: %d",request_cmd[0],request_cmd[1]);
@@ -290,8 +289,7 @@ static int32_t Ql_LCx9H_IIC_WriteData(uint8_t *pData, uint16_t dataLength,uint32
         }
         
         //step 1_b
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        status = Ql_IIC_Read(QL_LCx9H_IIC_SLAVE_ADDR_R << 1, 0, (uint8_t*)&rxBuffLength, 4,timeout);
+        status = Ql_IIC_PaceRead(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_R << 1, 0, (uint8_t*)&rxBuffLength, 4,timeout);
         if(QL_IIC_STATUS_OK == status)
         {
             QL_LOG_D("write length:%d,module receive buffer size:%d",dataLength,rxBuffLength);
@@ -317,8 +315,7 @@ static int32_t Ql_LCx9H_IIC_WriteData(uint8_t *pData, uint16_t dataLength,uint32
         //step 2_a
         request_cmd[0] = (QL_LCx9H_IIC_SLAVE_CW_CMD << 16) | QL_LCx9H_IIC_SLAVE_RX_BUF_REG_OFFSET;
         request_cmd[1] = len;
-         vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY)); 
-        status = Ql_IIC_Write(QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0, (uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN,timeout);
+        status = Ql_IIC_PaceWrite(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_CR_OR_CW << 1, 0, (uint8_t *)request_cmd, QL_LCx9H_IIC_SLAVE_CMD_LEN,timeout);
         if(QL_IIC_STATUS_OK == status)
         {
             //QL_LOG_D("write data step 2_a success, request cmd:0x%08x, write size: %d",request_cmd[0],request_cmd[1]);
@@ -331,8 +328,7 @@ static int32_t Ql_LCx9H_IIC_WriteData(uint8_t *pData, uint16_t dataLength,uint32
         }
 
         //step 2_b
-        vTaskDelay(pdMS_TO_TICKS(QL_LCx9H_IIC_DELAY));
-        status = Ql_IIC_Write(QL_LCx9H_IIC_SLAVE_ADDR_W << 1, 0, p, len,timeout);
+        status = Ql_IIC_PaceWrite(&iic_port_pace, QL_LCx9H_IIC_SLAVE_ADDR_W << 1, 0, p, len,timeout);
         if(QL_IIC_STATUS_OK == status)
         {
             if(true == is_divided)
@@ -378,6 +374,7 @@ int32_t Ql_LCx9H_PortIicInit( void *Param)
     // Initializing iic port
 
     ret = Ql_IIC_Init(QL_LCx29H_IIC_MODE, QL_LCx29H_IIC_SPEED, QL_LCx29H_IIC_TX_SIZE, QL_LCx29H_IIC_RX_SIZE);
+    Ql_IIC_PaceInit(&iic_port_pace, "lcx9h", QL_LCx9H_IIC_GAP_MIN_US, QL_LCx9H_IIC_GAP_MAX_US);
  
     iic_port_sem  = xSemaphoreCreateBinary();
     if (iic_port_sem == NULL)
@@ -475,6 +472,7 @@ void Ql_Example_Task(void *Param)
     static uint8_t rx_buf[NMEA_BUF_SIZE] = {0};
     char* tx_data = "$PQTMVERNO*58\r\n";
     int32_t Length = 0;
+    uint32_t reads = 0;
 
     (void)Param;
     
@@ -487,6 +485,10 @@ void Ql_Example_Task(void *Param)
         Length = NMEA_BUF_SIZE;
         Ql_LCx9H_IIC_ReadData(rx_buf, &Length,100);
         QL_LOG_I("read data from iic, len: %d", Length);
+        if(++reads % QL_LCx9H_IIC_PACE_PRINT == 0)
+        {
+            Ql_IIC_PacePrint(&iic_port_pace);
+        }
 
         if (Length <= 0)
         {
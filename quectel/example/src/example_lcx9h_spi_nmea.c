@@ -30,9 +30,9 @@ limitations under the License.
 #include "task.h"
 #include "ql_delay.h"
 #include "stdbool.h"
-#include "ql_log.h"
 #define LOG_TAG "spi_nmea"
 #define LOG_LVL QL_LOG_DEBUG
+#include "ql_log.h"
 #define LOG_UART_NUM (USART5)
 
 #define LCx9H_SPIS_CFG_RD_CMD         		0x0a
@@ -94,7 +94,7 @@ typedef struct SPI_Receive_Send_struct
 
 SemaphoreHandle_t xSPIMutex;
 int32_t Ql_LCx9H_PortSPIRead(uint8_t *buffer, uint32_t* size,int32_t timeout);
-int32_t Ql_LCx9H_PortSPIWrite(uint8_t *buffer, uint32_t size,int32_t timeout);
+int32_t Ql_LCx9H_PortSPIWrite(const uint8_t *buffer, uint32_t size,int32_t timeout);
 /**
  * @brief Initialize the SPI interface for LCx9H.
  *
@@ -190,16 +190,19 @@ void LCx9H_SPI_Read_Task(void *Param)
  */
 void LCx9H_SPI_Write_Task(void *Param)
 {
-	uint8_t send_buf[LCx9H_SPIS_TX_SIZE] = {0};
-	uint16_t send_len = 0;
+	const uint8_t *send_buf = NULL;
+	int32_t send_len = 0;
 	uint8_t status = 0;
 	while (1)
 	{
-		send_len = Ql_Uart_Read(LOG_UART_NUM,send_buf,LCx9H_SPIS_TX_SIZE,500);
-		//send_len = LCx9H_Uart_Read(send_buf);
+		/* Hand the UART RX ring to SPI in place, no task-level copy */
+		send_len = Ql_Uart_Peek(LOG_UART_NUM,&send_buf,500);
 		if(send_len > 0)
 		{
-			//QL_LOG_I("recv %d bytes:\r\n%s",send_len,send_buf);
+			if(send_len > LCx9H_SPIS_TX_SIZE - 1)
+			{
+				send_len = LCx9H_SPIS_TX_SIZE - 1;	// g_sendbuf holds the command byte too
+			}
 			if (xSemaphoreTake(xSPIMutex, portMAX_DELAY) == pdTRUE)
         	{
 				status = Ql_LCx9H_PortSPIWrite(send_buf,send_len,100);
@@ -212,17 +215,10 @@ void LCx9H_SPI_Write_Task(void *Param)
 					continue;
 				}
 
-				memset(send_buf,0,LCx9H_SPIS_TX_SIZE);
+				Ql_Uart_Consume(LOG_UART_NUM,send_len);
 				xSemaphoreGive(xSPIMutex);
-				vTaskDelay(pdMS_TO_TICKS(10));
 			}
-			// LCx9H_RDWR_Switch = 1;
-			// //QL_LOG_I("recv %d bytes:\r\n%s",send_len,send_buf);
-			// while (LCx9H_RDWR_Switch != 0x03)//wait read spi complete
-			// {
-			// 	;
-			// }
-			//LCx9H_RDWR_Switch = 0;
+			continue;
 		}
 		vTaskDelay(pdMS_TO_TICKS(10));
 	}
@@ -236,6 +232,8 @@ void LCx9H_SPI_Write_Task(void *Param)
 void Ql_Example_Task(void *Param)
 {
     LCx9H_SPI_Init();
+    /* The console RX is forwarded to the module, no log commands */
+    Ql_Log_Cmd_Enable(0);
 	xSPIMutex = xSemaphoreCreateMutex();
     if (xSPIMutex == NULL) {
         // Mutex creation failed, handle error
@@ -469,6 +467,28 @@ static int8_t LCx9HSPI_Send_Cfg_Cmd(uint8_t cmd,uint32_t reg,uint8_t *buf,uint32
 }
 uint8_t g_recvbuf[LCx9H_SPIS_RX_SIZE] = {0};
 uint8_t g_sendbuf[LCx9H_SPIS_TX_SIZE] = {0};
+/**
+ * @brief Send data via SPI interface, prefixed with the write command.
+ *
+ * SendBuf is only read, it can point into the UART RX ring (Ql_Uart_Peek).
+ *
+ * @param SendBuf   Pointer to the data to send
+ * @param RecvBuf   Pointer to the buffer where received data will be stored
+ * @param Length    Number of bytes to send (excluding the command byte), < LCx9H_SPIS_TX_SIZE
+ *
+ * @return int8_t   0 on success, -1 on invalid parameters
+ */
+static int8_t LCx9HSPI_Send_Data(const uint8_t *SendBuf,uint8_t* RecvBuf,uint32_t Length)
+{
+	if(SendBuf == NULL || Length == 0 || Length >= LCx9H_SPIS_TX_SIZE || RecvBuf == NULL)
+	{
+		return -1;
+	}
+	g_sendbuf[0] = LCx9H_SPIS_WR_CMD;
+	memcpy(&g_sendbuf[1],SendBuf,Length);
+	Ql_SPI_ReadWrite(g_sendbuf, RecvBuf, Length + 1, 10);
+	return 0;
+}
 /**
  * @brief Send data or command via SPI interface.
  *
@@ -496,9 +516,7 @@ static int8_t LCx9HSPI_Send_Data_Cmd(uint8_t Cmd,uint8_t *SendBuf,uint8_t* RecvB
 	}
 	else if (Cmd == LCx9H_SPIS_WR_CMD)
 	{
-		g_sendbuf[0] = Cmd;
-		memcpy(&g_sendbuf[1],SendBuf,Length);
-		Ql_SPI_ReadWrite(g_sendbuf, RecvBuf, Length, 10);
+		return LCx9HSPI_Send_Data(SendBuf, RecvBuf, Length - 1);
 	}
 	else
 	{
@@ -516,10 +534,10 @@ static int8_t LCx9HSPI_Send_Data_Cmd(uint8_t Cmd,uint8_t *SendBuf,uint8_t* RecvB
  * @param length Pointer to data length
  * @return uint8_t Returns the status of the operation
  */
-uint8_t write_cmd_addr_length(uint32_t offset, uint8_t *buf, uint32_t *length)
+uint8_t write_cmd_addr_length(uint32_t offset, const uint8_t *buf, uint32_t *length)
 {
 	uint8_t cfg_cmd[9];
-	uint8_t *temp_buf = buf;
+	const uint8_t *temp_buf = buf;
 	uint32_t receive_reg_value;
 	uint32_t temp_offset = offset;
 	uint32_t temp_length = 0;
@@ -704,7 +722,7 @@ _restart:
 					fail_counter = 0;
 				}
 			
-				if(LCx9HSPI_Send_Data_Cmd(LCx9H_SPIS_WR_CMD,temp_buf,g_recvbuf,temp_length) != 0)
+				if(LCx9HSPI_Send_Data(temp_buf,g_recvbuf,temp_length) != 0)
 				{
 					return HOST_MUX_STATUS_ERROR;
 				}
@@ -743,7 +761,7 @@ _restart:
  *                   - 2: Read command error.
  *                   - 0xFF: Unsupported command.
  */
-uint8_t Data_operation(uint8_t cmd,uint8_t* data_buf,uint32_t* length)
+uint8_t Data_operation(uint8_t cmd,const uint8_t* data_buf,uint32_t* length)
 {
 	switch(cmd)
 	{
@@ -787,14 +805,14 @@ uint8_t Data_operation(uint8_t cmd,uint8_t* data_buf,uint32_t* length)
  * 
  * @return Returns 0 on success, non-zero on failure.
  */
-int32_t Ql_LCx9H_PortSPIWrite(uint8_t* buffer,uint32_t size,int32_t timeout)
+int32_t Ql_LCx9H_PortSPIWrite(const uint8_t* buffer,uint32_t size,int32_t timeout)
 {
     uint8_t result = 0;
     uint32_t temp_length = size;
     result = Data_operation(LCx9H_SPIS_WR_CMD,buffer,&temp_length);
 	if(result == 0)
 	{
-		QL_LOG_D("write %s",buffer);
+		QL_LOG_D("write %d bytes",size);
 	}
     return result;
 }
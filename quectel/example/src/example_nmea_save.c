@@ -29,7 +29,8 @@ limitations under the License.
 #include "ql_uart.h"
 #include "ql_nmea.h"
 #include "time.h"
-#include "ql_ff_user.h"
+#include "ql_ff_task.h"
+#include "ql_nmea_bin.h"
 
 #define LOG_TAG "nmea_save"
 #define LOG_LVL QL_LOG_INFO
@@ -37,12 +38,56 @@ limitations under the License.
 
 #define NMEA_BUF_SIZE          (4096U)
 #define NMEA_PORT              UART3
+#define NMEA_SAVE_COMPRESS     0           // 1: ql_ff_lz blocks, decode with tools/ql_lz_decode.py
+#define NMEA_SAVE_EPOCH        0           // 1: binary epochs as well, convert with tools/ql_nmea_bin.py
+
+#if NMEA_SAVE_EPOCH
+static Ql_FatFs_Chan_TypeDef epoch_file;
+static Ql_NMEA_Bin_TypeDef epoch_bin;
+static Ql_NMEA_Handle_TypeDef epoch_nmea;
+
+static int32_t Nmea_Epoch_Out(void *Ctx, const uint8_t *Block, uint32_t Len)
+{
+    return (Ql_FatFs_Chan_Write((Ql_FatFs_Chan_TypeDef *)Ctx, Block, Len) == (int32_t)Len) ? 0 : -1;
+}
+
+static void Nmea_Epoch_Feed(const int8_t *Buf, uint32_t Len)
+{
+    Ql_NMEA_Bin_Feed(&epoch_bin, (const char *)Buf, Len);
+}
+
+static int32_t Nmea_Epoch_Open(void)
+{
+    /* 1:epoch/00000/epoch_00000000.qeb ..., 36 bytes per epoch plus 3 per satellite */
+    static Ql_FatFs_Rotate_TypeDef epoch_rot =
+    {
+        "1:epoch", "epoch", "qeb", 4 * 1024 * 1024, 0, 1, 0
+    };
+
+    if (Ql_FatFs_Chan_Open_Rotate(&epoch_file, &epoch_rot, QL_NMEA_BIN_BLOCK_SIZE * 2, QL_FF_CHAN_DROP, 0) != 0)
+    {
+        return -1;
+    }
+    Ql_NMEA_Bin_Init(&epoch_bin, QL_NMEA_BIN_FLAG_CN0, Nmea_Epoch_Out, &epoch_file);
+
+    return Ql_NMEA_Init(&epoch_nmea, NULL, Nmea_Epoch_Feed, NMEA_BUF_SIZE * 2);
+}
+#endif
 
 void Ql_Example_Task(void *Param)
 {
     static uint8_t rx_buf[NMEA_BUF_SIZE] = {0};
+    static Ql_FatFs_Chan_TypeDef nmea_file;
+    /* 1:nmea/00000/nmea_00000000.txt ..., a new file per 16 MB or day, the oldest
+       are deleted to keep QL_SD_REMAIN_MINIMUM_SIZE free */
+    static Ql_FatFs_Rotate_TypeDef nmea_rot =
+    {
+        "1:nmea", "nmea", NMEA_SAVE_COMPRESS ? "qz" : "txt", 16 * 1024 * 1024, 0, 1, QL_SD_REMAIN_MINIMUM_SIZE
+    };
+#if NMEA_SAVE_COMPRESS
+    static Ql_FatFs_Lz_TypeDef nmea_lz;
+#endif
     int32_t Length = 0;
-    char* nmea_file_path = "1:save_nmea_example.txt";
     uint32_t file_size = 0;
     int32_t ret = 0;
 
@@ -56,6 +101,22 @@ void Ql_Example_Task(void *Param)
     {
         QL_LOG_E("FatFs Mount Failed, ret: %d", ret);
     }
+    else
+    {
+        ret = Ql_FatFs_Chan_Open_Rotate(&nmea_file, &nmea_rot, NMEA_BUF_SIZE, QL_FF_CHAN_DROP, 0);
+#if NMEA_SAVE_COMPRESS
+        if (0 == ret)
+        {
+            ret = Ql_FatFs_Chan_Compress(&nmea_file, &nmea_lz);
+        }
+#endif
+#if NMEA_SAVE_EPOCH
+        if (0 == ret)
+        {
+            ret = Nmea_Epoch_Open();
+        }
+#endif
+    }
 
     while (1)
     {
@@ -69,7 +130,11 @@ void Ql_Example_Task(void *Param)
         rx_buf[Length] = '\0';
         if (0 == ret ) 
         {
-            ret = Ql_FatFs_Write(nmea_file_path, rx_buf, Length, &file_size);
+            ret = (Ql_FatFs_Chan_Write(&nmea_file, rx_buf, Length) < 0) ? -1 : 0;
+            file_size = nmea_file.Stats.Bytes_Written;
+#if NMEA_SAVE_EPOCH
+            Ql_NMEA_Parse(&epoch_nmea, (const int8_t *)rx_buf, Length);
+#endif
             QL_LOG_I("write data to file, len: %d,file size:%d,ret = %d", Length,file_size,ret);
         }
         else
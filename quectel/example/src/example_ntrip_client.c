@@ -27,6 +27,7 @@ limitations under the License.
 #include "sockets_wrapper.h"
 #include "ql_trng.h"
 #include "ql_uart.h"
+#include "ql_uart_baud.h"
 #include "ql_application.h"
 
 #include "ql_log_undef.h"
@@ -37,6 +38,10 @@ limitations under the License.
 #define NTRIP_TASK_PRIO                        (tskIDLE_PRIORITY + 9)
 #define NTRIP_STK_SIZE                         (configMINIMAL_STACK_SIZE * 8)
 
+/* 1: raise GNSS COM1 above 115200 before streaming, 10 Hz NMEA plus RTCM
+   injection keeps 115200 over 80% busy */
+#define NTRIP_GNSS_BAUD_NEGOTIATE              (0)
+
 #define HTTP_USER_AGENT_VALUE                  "QNTRIP Quectel-GNSS"
 
 // ntrip server info
@@ -101,7 +106,7 @@ static void Ql_NtripClientCloseRtkLink(NetworkContext_t *NetContext)
 {
     Ql_GetCellularActiveStatus();
 
-    QL_LOG_I(("close the connection"));
+    QL_LOG_I("close the connection");
     Plaintext_FreeRTOS_Disconnect(NetContext);
 
     return;
@@ -386,6 +391,14 @@ void Ql_Example_Task(void *Param)
     }
     Ql_Uart_Init("GNSS COM1", UART3, 115200, 8192, 2048);
 
+#if NTRIP_GNSS_BAUD_NEGOTIATE
+    {
+        const uint32_t rates[] = { 921600, 460800 };
+
+        QL_LOG_I("GNSS COM1 baud: %d", Ql_Uart_Baud_Negotiate(UART3, &Ql_Baud_Proto_PQTM, rates, 2));
+    }
+#endif
+
     while (false == Ql_SystemPtr->CellularNetReg)
     {
         QL_LOG_I("Waiting for Cellular Network Registration");
@@ -0,0 +1,278 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_uart_baud.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_uart.h"
+#include "ql_uart_baud.h"
+#include "ql_check.h"
+
+#define LOG_TAG "baud"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define QL_BAUD_CMD_SIZE            (64U)
+#define QL_BAUD_RECV_SIZE           (128U)      // on the caller's stack
+
+/*****************************************************************************
+* @brief  "$Body*CS\r\n"
+* ex:
+* @par
+* None
+* @retval
+*****************************************************************************/
+static int32_t Ql_Baud_Nmea_Build(char *Buf, uint32_t Size, const char *Body)
+{
+    uint8_t cs = Ql_CheckXOR((const uint8_t *)Body, strlen(Body));
+
+    return snprintf(Buf, Size, "$%s*%02X\r\n", Body, cs);
+}
+
+static int32_t Ql_Baud_PQTM_SetCmd(uint32_t Baud, char *Buf, uint32_t Size)
+{
+    char body[32];
+
+    snprintf(body, sizeof(body), "PQTMCFGUART,W,%u", Baud);
+    return Ql_Baud_Nmea_Build(Buf, Size, body);
+}
+
+static int32_t Ql_Baud_PAIR_SetCmd(uint32_t Baud, char *Buf, uint32_t Size)
+{
+    char body[32];
+
+    /* PortType 0: UART, PortIndex 0: UART0 */
+    snprintf(body, sizeof(body), "PAIR864,0,0,%u", Baud);
+    return Ql_Baud_Nmea_Build(Buf, Size, body);
+}
+
+static int32_t Ql_Baud_EC600U_SetCmd(uint32_t Baud, char *Buf, uint32_t Size)
+{
+    return snprintf(Buf, Size, "AT+IPR=%u\r\n", Baud);
+}
+
+const Ql_Baud_Proto_TypeDef Ql_Baud_Proto_PQTM =
+{
+    "PQTM",   Ql_Baud_PQTM_SetCmd,   "$PQTMCFGUART,OK", "$PQTMVERNO*58\r\n", "$PQTMVERNO,",
+              "$PQTMSAVEPAR*5A\r\n", "$PQTMSAVEPAR,OK", 100
+};
+
+const Ql_Baud_Proto_TypeDef Ql_Baud_Proto_PAIR =
+{
+    "PAIR",   Ql_Baud_PAIR_SetCmd,   "$PAIR001,864,0",  "$PAIR020*38\r\n",   "$PAIR020,",
+              "$PAIR513*3D\r\n",     "$PAIR001,513,0",  100
+};
+
+const Ql_Baud_Proto_TypeDef Ql_Baud_Proto_EC600U =
+{
+    "EC600U", Ql_Baud_EC600U_SetCmd, "OK",              "AT\r\n",            "OK",
+              "AT&W\r\n",            "OK",              50
+};
+
+/*****************************************************************************
+* @brief  Wait until Ack shows up in the RX stream
+* ex:
+* @par
+* None
+* @retval 0: found; -1: timeout
+*****************************************************************************/
+static int32_t Ql_Baud_WaitAck(uint32_t UsartPeriph, const char *Ack, uint32_t Timeout)
+{
+    char recv_buf[QL_BAUD_RECV_SIZE];
+    const TickType_t start = xTaskGetTickCount();
+    uint32_t recv_len = 0;
+    int32_t len = 0;
+
+    while ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(Timeout))
+    {
+        len = Ql_Uart_Read(UsartPeriph, recv_buf + recv_len, sizeof(recv_buf) - 1 - recv_len, 20);
+        if (len <= 0)
+        {
+            continue;
+        }
+
+        recv_len += len;
+        recv_buf[recv_len] = '\0';
+        if (strstr(recv_buf, Ack) != NULL)
+        {
+            return 0;
+        }
+
+        /* Keep the tail, the ack may be split across two reads */
+        if (recv_len > (sizeof(recv_buf) / 2))
+        {
+            memmove(recv_buf, recv_buf + recv_len - 32, 32);
+            recv_len = 32;
+        }
+    }
+
+    return -1;
+}
+
+/*****************************************************************************
+* @brief  Echo handshake at the current MCU rate
+* ex:
+* @par
+* None
+* @retval 0: module answered
+*****************************************************************************/
+static int32_t Ql_Baud_Probe(uint32_t UsartPeriph, const Ql_Baud_Proto_TypeDef *Proto)
+{
+    TickType_t start;
+
+    for (uint8_t i = 0; i < QL_BAUD_PROBE_RETRY; i++)
+    {
+        Ql_Uart_Flush(UsartPeriph);
+
+        start = xTaskGetTickCount();
+        Ql_Uart_Write(UsartPeriph, Proto->Probe_Cmd, strlen(Proto->Probe_Cmd), 100);
+        if (Ql_Baud_WaitAck(UsartPeriph, Proto->Probe_Ack, QL_BAUD_PROBE_TIMEOUT) == 0)
+        {
+            QL_LOG_I("%s @%u: echo ok, rtt %u ms", Proto->Name, Ql_Uart_Baud_Get(UsartPeriph),
+                     (xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+            return 0;
+        }
+    }
+
+    QL_LOG_W("%s @%u: no echo", Proto->Name, Ql_Uart_Baud_Get(UsartPeriph));
+
+    return -1;
+}
+
+/*****************************************************************************
+* @brief  Ask the module for To (sent at the current rate), follow with the
+*         MCU and verify
+* ex:
+* @par
+* The set ack is informative only. During a rollback the module may still
+* be at the old rate and will not understand the command at all, the probe
+* afterwards decides.
+* @retval 0: both sides at To
+*****************************************************************************/
+static int32_t Ql_Baud_Switch(uint32_t UsartPeriph, const Ql_Baud_Proto_TypeDef *Proto, uint32_t To)
+{
+    char cmd[QL_BAUD_CMD_SIZE];
+    int32_t len = 0;
+
+    len = Proto->Set_Cmd(To, cmd, sizeof(cmd));
+    if ((len <= 0) || ((uint32_t)len >= sizeof(cmd)))
+    {
+        return -1;
+    }
+
+    Ql_Uart_Flush(UsartPeriph);
+    Ql_Uart_Write(UsartPeriph, cmd, len, 100);
+    if ((Proto->Set_Ack != NULL) && (Ql_Baud_WaitAck(UsartPeriph, Proto->Set_Ack, QL_BAUD_ACK_TIMEOUT) != 0))
+    {
+        QL_LOG_D("%s: no ack for %u", Proto->Name, To);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(Proto->Settle_Ms));
+
+    if (Ql_Uart_Baud_Set(UsartPeriph, To) != 0)
+    {
+        return -1;
+    }
+
+    return Ql_Baud_Probe(UsartPeriph, Proto);
+}
+
+/*****************************************************************************
+* @brief  Make the module keep its current rate over a reset
+* ex:
+* @par
+* None
+* @retval 0: acked
+*****************************************************************************/
+static int32_t Ql_Baud_Save(uint32_t UsartPeriph, const Ql_Baud_Proto_TypeDef *Proto)
+{
+    Ql_Uart_Flush(UsartPeriph);
+    Ql_Uart_Write(UsartPeriph, Proto->Save_Cmd, strlen(Proto->Save_Cmd), 100);
+    if (Ql_Baud_WaitAck(UsartPeriph, Proto->Save_Ack, QL_BAUD_ACK_TIMEOUT) != 0)
+    {
+        QL_LOG_W("%s @%u: not saved, the module resets to its old rate", Proto->Name, Ql_Uart_Baud_Get(UsartPeriph));
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t Ql_Uart_Baud_Negotiate(uint32_t UsartPeriph, const Ql_Baud_Proto_TypeDef *Proto,
+                               const uint32_t *Rates, uint8_t Num)
+{
+    usart_cfg_t *cfg = Ql_Uart_Cfg(UsartPeriph);
+    const uint32_t origin = Ql_Uart_Baud_Get(UsartPeriph);
+    int32_t ret = -1;
+
+    if ((Proto == NULL) || (Rates == NULL) || (cfg == NULL) || (origin == 0))
+    {
+        return -1;
+    }
+
+    if (Ql_Uart_Open(UsartPeriph, portMAX_DELAY) != 0)
+    {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < Num; i++)
+    {
+        if (Rates[i] == origin)
+        {
+            ret = origin;
+            break;
+        }
+
+        if (Ql_Baud_Switch(UsartPeriph, Proto, Rates[i]) == 0)
+        {
+            ret = Rates[i];
+            break;
+        }
+
+        /* Roll back. The module may have switched while the echo got lost */
+        if (Ql_Baud_Switch(UsartPeriph, Proto, origin) != 0)
+        {
+            QL_LOG_E("%s: rollback to %u failed", Proto->Name, origin);
+            break;
+        }
+    }
+
+    if ((ret < 0) && (Ql_Uart_Baud_Get(UsartPeriph) == origin) && (Ql_Baud_Probe(UsartPeriph, Proto) == 0))
+    {
+        ret = origin;
+    }
+
+    if (ret > 0)
+    {
+        cfg->Reg.baudrate = ret;
+        if (ret != (int32_t)origin)
+        {
+            Ql_Baud_Save(UsartPeriph, Proto);
+        }
+    }
+
+    Ql_Uart_Release(UsartPeriph);
+
+    return ret;
+}
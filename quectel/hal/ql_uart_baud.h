@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_uart_baud.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_UART_BAUD_H__
+#define __QL_UART_BAUD_H__
+
+#include <stdint.h>
+
+#define QL_BAUD_PROBE_RETRY         (3U)
+#define QL_BAUD_PROBE_TIMEOUT       (300U)  // ms
+#define QL_BAUD_ACK_TIMEOUT         (500U)  // ms
+
+typedef struct
+{
+    const char  *Name;
+    /* Build the "switch to Baud" command, returns the length */
+    int32_t    (*Set_Cmd)(uint32_t Baud, char *Buf, uint32_t Size);
+    /* Reply to Set_Cmd at the old rate, NULL if the module switches silently */
+    const char  *Set_Ack;
+    /* Echo handshake sent at the new rate */
+    const char  *Probe_Cmd;
+    const char  *Probe_Ack;
+    /* Keep the rate over a module reset, sent at the new rate */
+    const char  *Save_Cmd;
+    const char  *Save_Ack;
+    /* Time the module needs to reprogram its UART */
+    uint32_t     Settle_Ms;
+} Ql_Baud_Proto_TypeDef;
+
+extern const Ql_Baud_Proto_TypeDef Ql_Baud_Proto_PQTM;
+extern const Ql_Baud_Proto_TypeDef Ql_Baud_Proto_PAIR;
+extern const Ql_Baud_Proto_TypeDef Ql_Baud_Proto_EC600U;
+
+/* Try Rates[] in order, the first one that passes the echo handshake is kept
+   and stored in usart_cfg_t, and saved on the module with Save_Cmd. If the
+   save is not acked the module comes back at its old rate after a reset,
+   the caller has to negotiate again then. Returns the rate in use or -1 if
+   the module is lost. */
+int32_t Ql_Uart_Baud_Negotiate(uint32_t UsartPeriph, const Ql_Baud_Proto_TypeDef *Proto,
+                               const uint32_t *Rates, uint8_t Num);
+
+#endif
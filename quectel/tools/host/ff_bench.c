@@ -0,0 +1,131 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ff_bench.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+/* Benches of ql_ff, FatFs and the loggers on a card image, see README.md:
+     ff_bench [-i image] [-m MB] [-c]
+   -c adds the host CPU time to DWT->CYCCNT for all benches, not only the
+   compression one. The image is formatted on every run */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_host_card.h"
+#include "ql_ff_user.h"
+#include "ql_ff_disk.h"
+#include "ql_ff_cache.h"
+#include "ql_ff_rotate.h"
+#include "ql_ff_lz.h"
+#include "ql_ff_task.h"
+#include "ql_flash.h"
+#include "ql_flash_log.h"
+
+#define LOG_TAG "ff_bench"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define FF_BENCH_EPOCHS             (600U)      // 1 min of 10 Hz NMEA for the logger
+#define FF_BENCH_EPOCH_MS           (100U)
+
+static void Ff_Bench_Logger(void)
+{
+    static Ql_FatFs_Chan_TypeDef chan;
+    const Ql_Host_Card_TypeDef *card = Ql_Host_Card();
+    const uint32_t writes = card->Writes;
+    char line[256];
+    int len;
+
+    if ((Ql_FatFs_Task_Init() != 0) || (Ql_FatFs_Chan_Open(&chan, "1:bench/nmea.log", 8192, QL_FF_CHAN_WAIT, 100) != 0))
+    {
+        QL_LOG_E("logger open fail");
+        return;
+    }
+    for (uint32_t i = 0; i < FF_BENCH_EPOCHS; i++)
+    {
+        len = snprintf(line, sizeof(line),
+                       "$GNGGA,%06u.%02u,3149.3011,N,11706.9217,E,1,24,0.6,42.1,M,-0.3,M,,*5B\r\n"
+                       "$GNRMC,%06u.%02u,A,3149.3011,N,11706.9217,E,0.01,0.00,181026,,,A,V*06\r\n",
+                       i / 10, (i % 10) * 10, i / 10, (i % 10) * 10);
+        Ql_FatFs_Chan_Write(&chan, (const uint8_t *)line, (uint32_t)len);
+        vTaskDelay(pdMS_TO_TICKS(FF_BENCH_EPOCH_MS));
+    }
+    Ql_FatFs_Chan_Close(&chan);
+    Ql_FatFs_Chan_Stats_Print(&chan);
+    QL_LOG_I("logger: %u card writes for %u epochs", card->Writes - writes, FF_BENCH_EPOCHS);
+}
+
+int main(int argc, char **argv)
+{
+    static BYTE work[FF_MAX_SS];
+    const MKFS_PARM fmt = { FM_FAT32, 0, 0, 0, 0 };
+    const char *image = "ff_bench.img";
+    uint32_t mb = 256;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:m:c")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': image = optarg; break;
+        case 'm': mb = (uint32_t)atoi(optarg); break;
+        case 'c': Ql_Host_Dwt_Cpu(1); break;
+        default:
+            fprintf(stderr, "usage: %s [-i image] [-m MB] [-c]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    unlink(image);
+    if ((IMG_disk_open(image, mb * 2048U) != 0) || (f_mkfs("1:", &fmt, work, sizeof(work)) != FR_OK))
+    {
+        fprintf(stderr, "cannot format %s\n", image);
+        return 1;
+    }
+    if (Ql_FatFs_Mount() != 0)
+    {
+        fprintf(stderr, "mount fail\n");
+        return 1;
+    }
+    Ql_FatFs_Mkdir_Path("1:bench/");
+
+    QL_LOG_I("card model: read %u us, write %u us per command, %u us per sector",
+             Ql_Host_Card()->Read_Cmd_Us, Ql_Host_Card()->Write_Cmd_Us, Ql_Host_Card()->Sector_Us);
+    Ql_FatFs_Disk_Bench("1:bench/disk.bin", 4096);
+    Ql_FatFs_Stream_Bench("1:bench/stream.log", 512, 256);
+    Ql_FatFs_Cache_Bench("1:bench/cache", 200);
+    Ql_FatFs_Rotate_Bench("1:bench/rot", 500);
+    Ff_Bench_Logger();
+
+    /* Compression and flash only compute, the CPU time is the figure */
+    Ql_Host_Dwt_Cpu(1);
+    Ql_FatFs_Lz_Bench(NULL, 64 * 1024);
+    Ql_Flash_Bench(QL_FLASH_LOG_ADDR);
+    Ql_Flash_Log_Init();
+    Ql_Flash_Log_Bench(2000, 64);
+
+    Ql_FatFs_UnMount();
+    IMG_disk_close();
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ff_crash.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+/* Power cut check of the stream journal (ql_ff_journal.c), see README.md:
+     ff_crash [-i image] [-n trials] [-s seed]
+   Every trial appends a pattern to a contiguous stream, the card loses
+   power at a random write transfer with a random prefix of it landing, the
+   RAM state is dropped and the volume is mounted again. With the journal
+   the file must hold at least the last committed size, in every mode the
+   bytes that are there must match the pattern. Exit 1 on a failure */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_host_card.h"
+#include "ql_ff_user.h"
+#include "ql_ff_disk.h"
+#include "ql_ff_journal.h"
+
+#define LOG_TAG "ff_crash"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define FF_CRASH_PATH               "1:log/day.txt"
+#define FF_CRASH_CHUNK              (256U * 1024U)
+#define FF_CRASH_LOSS_BYTES         (4096U)
+#define FF_CRASH_CUT_MAX            (600U)      // writes before the cut, at most
+#define FF_CRASH_LEN_MAX            (1000000U)  // bytes per trial, at most
+#define FF_CRASH_WRITE_MS           (10U)
+
+typedef enum
+{
+    FF_CRASH_PLAIN = 0,     // no sync policy, no journal
+    FF_CRASH_SYNC,          // f_sync every FF_CRASH_LOSS_BYTES
+    FF_CRASH_JOURNAL,       // journal commit every FF_CRASH_LOSS_BYTES
+    FF_CRASH_MODES
+} Ff_Crash_Mode_TypeDef;
+
+static const char *const Ff_Crash_Name[FF_CRASH_MODES] = { "plain", "sync", "journal" };
+
+typedef struct
+{
+    uint32_t    Ok;
+    uint32_t    Fail;
+    uint64_t    Written;
+    uint64_t    Lost;
+    uint64_t    Card_Writes;
+} Ff_Crash_Stats_TypeDef;
+
+static uint8_t Ff_Crash_Pattern(uint32_t Pos)
+{
+    return (uint8_t)((Pos * 2654435761U) >> 24) | 1U;
+}
+
+/* Size of the file after the remount, -1: a byte does not match */
+static int32_t Ff_Crash_Verify(uint32_t *pSize)
+{
+    static FIL fp;
+    static uint8_t rd[16384];
+    uint32_t off = 0;
+    UINT br;
+
+    *pSize = 0;
+    if (f_open(&fp, FF_CRASH_PATH, FA_READ) != FR_OK)
+    {
+        return 0;
+    }
+    *pSize = (uint32_t)f_size(&fp);
+    while ((f_read(&fp, rd, sizeof(rd), &br) == FR_OK) && (br != 0))
+    {
+        for (UINT i = 0; i < br; i++)
+        {
+            if (rd[i] != Ff_Crash_Pattern(off + i))
+            {
+                f_close(&fp);
+                return -1;
+            }
+        }
+        off += br;
+    }
+    f_close(&fp);
+    return 0;
+}
+
+static int32_t Ff_Crash_Trial(Ff_Crash_Mode_TypeDef Mode, uint32_t Trial, Ff_Crash_Stats_TypeDef *pStats)
+{
+    static Ql_FatFs_Stream_TypeDef stream;
+    static uint8_t buf[1024];
+    Ql_Host_Card_TypeDef *card = Ql_Host_Card();
+    uint32_t pos = 0, committed = 0, size, writes, n;
+    int32_t bad;
+
+    if (Ql_FatFs_Mount() != 0)
+    {
+        fprintf(stderr, "mount fail\n");
+        return -1;
+    }
+    f_unlink(FF_CRASH_PATH);
+    if ((Ql_FatFs_Stream_Open_Contig(&stream, FF_CRASH_PATH, FF_CRASH_CHUNK,
+                                     (Mode == FF_CRASH_SYNC) ? FF_CRASH_LOSS_BYTES : 0, 0) != 0) ||
+        ((Mode == FF_CRASH_JOURNAL) && (Ql_FatFs_Stream_Journal(&stream, FF_CRASH_PATH, FF_CRASH_LOSS_BYTES, 0) != 0)))
+    {
+        fprintf(stderr, "stream open fail\n");
+        return -1;
+    }
+
+    writes = card->Writes;
+    Ql_Host_Card_Cut(1U + (uint32_t)rand() % FF_CRASH_CUT_MAX);
+    while (pos < FF_CRASH_LEN_MAX)
+    {
+        n = 50U + (uint32_t)rand() % (sizeof(buf) - 300U);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            buf[i] = Ff_Crash_Pattern(pos + i);
+        }
+        vTaskDelay(pdMS_TO_TICKS(FF_CRASH_WRITE_MS));
+        if (Ql_FatFs_Stream_Write(&stream, buf, n) != 0)
+        {
+            break;
+        }
+        pos += n;
+        committed = stream.Journal_Pos;
+    }
+    pStats->Card_Writes += card->Writes - writes;
+
+    /* The power is gone: nothing in RAM survives, the stream is not closed */
+    vPortFree(stream.Buf);
+    memset(&stream, 0, sizeof(stream));
+    Ql_FatFs_UnMount();
+    Ql_Host_Card_Power_On();
+
+    if (Ql_FatFs_Mount() != 0)
+    {
+        fprintf(stderr, "trial %u: remount fail\n", Trial);
+        return -1;
+    }
+    bad = Ff_Crash_Verify(&size);
+    Ql_FatFs_UnMount();
+
+    pStats->Written += pos;
+    pStats->Lost += pos - ((size > pos) ? pos : size);
+    if ((bad != 0) || ((Mode == FF_CRASH_JOURNAL) && (size < committed)))
+    {
+        printf("%s trial %u: size %u, committed %u, written %u%s\n", Ff_Crash_Name[Mode], Trial,
+               size, committed, pos, (bad != 0) ? ", content mismatch" : "");
+        pStats->Fail++;
+    }
+    else
+    {
+        pStats->Ok++;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static BYTE work[FF_MAX_SS];
+    const MKFS_PARM fmt = { FM_FAT32, 0, 0, 0, 0 };
+    const char *image = "ff_crash.img";
+    uint32_t trials = 200, seed = 1, fail = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:n:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': image = optarg; break;
+        case 'n': trials = (uint32_t)atoi(optarg); break;
+        case 's': seed = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-i image] [-n trials] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    unlink(image);
+    if ((IMG_disk_open(image, 256U * 2048U) != 0) || (f_mkfs("1:", &fmt, work, sizeof(work)) != FR_OK))
+    {
+        fprintf(stderr, "cannot format %s\n", image);
+        return 1;
+    }
+    /* Every cut logs a failed write, the checks below are the result */
+    Ql_Log_Level_Set("*", QL_LOG_NONE);
+
+    for (uint32_t m = 0; m < FF_CRASH_MODES; m++)
+    {
+        Ff_Crash_Stats_TypeDef stats = { 0 };
+
+        srand(seed);
+        for (uint32_t t = 0; t < trials; t++)
+        {
+            if (Ff_Crash_Trial((Ff_Crash_Mode_TypeDef)m, t, &stats) != 0)
+            {
+                return 1;
+            }
+        }
+        printf("%-8s %u trials: %u ok, %u failed, %llu card writes, %llu of %llu bytes lost per trial\n",
+               Ff_Crash_Name[m], trials, stats.Ok, stats.Fail, (unsigned long long)(stats.Card_Writes / trials),
+               (unsigned long long)(stats.Lost / trials), (unsigned long long)(stats.Written / trials));
+        fail += stats.Fail;
+    }
+
+    IMG_disk_close();
+    return (fail != 0) ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ff_stall.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+/* Card stalls under the storage task channel (ql_ff_task.c), see README.md:
+     ff_stall [-i image] [-d ms]
+   A producer above the storage task writes 1 KB every 10 ms while every
+   card write transfer is delayed by -d ms for a while, once with
+   QL_FF_CHAN_DROP and once with QL_FF_CHAN_WAIT. No Ql_FatFs_Chan_Write
+   may block longer than the configured wait, the counters must add up and
+   the file must hold exactly the bytes each call accepted. Exit 1 on a
+   failure */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_ff_user.h"
+#include "ql_ff_disk.h"
+#include "ql_ff_task.h"
+
+#define LOG_TAG "ff_stall"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define FF_STALL_DRIVE              (1U)        // DEV_MMC of diskio.c, "1:"
+#define FF_STALL_BUF_SIZE           (4096U)
+#define FF_STALL_WRITE_SIZE         (1024U)
+#define FF_STALL_PERIOD_MS          (10U)
+#define FF_STALL_WRITES             (600U)      // 6 s
+#define FF_STALL_FROM               (100U)      // writes before the stall
+#define FF_STALL_TO                 (300U)      // write at which it ends
+#define FF_STALL_WAIT_MS            (100U)      // Wait_Ms of QL_FF_CHAN_WAIT
+#define FF_STALL_DROP_MAX_US        (100U)      // QL_FF_CHAN_DROP: a memcpy and the mutex
+
+typedef struct
+{
+    const char                     *Name;
+    const char                     *Path;
+    Ql_FatFs_Chan_Policy_TypeDef    Policy;
+    uint32_t                        Wait_Ms;
+} Ff_Stall_Case_TypeDef;
+
+static const Ff_Stall_Case_TypeDef Ff_Stall_Case[] =
+{
+    { "drop", "1:stall/drop.log", QL_FF_CHAN_DROP, 0 },
+    { "wait", "1:stall/wait.log", QL_FF_CHAN_WAIT, FF_STALL_WAIT_MS },
+};
+
+static uint32_t Ff_Stall_Delay_Ms = 300;
+static uint32_t Ff_Stall_Accepted[FF_STALL_WRITES];
+
+static uint8_t Ff_Stall_Pattern(uint32_t Offset)
+{
+    return (uint8_t)((Offset * 0x9E3779B9U) >> 24);
+}
+
+static int32_t Ff_Stall_Run(const Ff_Stall_Case_TypeDef *Case)
+{
+    static Ql_FatFs_Chan_TypeDef chan;
+    static uint8_t buf[FF_STALL_WRITE_SIZE];
+    const Ql_FatFs_Disk_Fault_TypeDef stall = { 0, Ff_Stall_Delay_Ms, 0, 0, 0 };
+    const uint32_t bound_us = (Case->Policy == QL_FF_CHAN_WAIT) ? (Case->Wait_Ms * 1000U) : FF_STALL_DROP_MAX_US;
+    Ql_FatFs_Chan_Stats_TypeDef stats;
+    uint32_t accepted = 0, blocked = 0, max_us = 0, bad = 0;
+    TickType_t next;
+    uint64_t start;
+    uint32_t us;
+    int32_t n;
+    FIL fil;
+    UINT got;
+    int32_t ret = 0;
+
+    if (Ql_FatFs_Chan_Open(&chan, Case->Path, FF_STALL_BUF_SIZE, Case->Policy, Case->Wait_Ms) != 0)
+    {
+        printf("%s: open fail\n", Case->Name);
+        return -1;
+    }
+
+    next = xTaskGetTickCount();
+    for (uint32_t i = 0; i < FF_STALL_WRITES; i++)
+    {
+        if (i == FF_STALL_FROM)
+        {
+            Ql_FatFs_Disk_Fault_Set(FF_STALL_DRIVE, &stall);
+        }
+        else if (i == FF_STALL_TO)
+        {
+            Ql_FatFs_Disk_Fault_Set(FF_STALL_DRIVE, NULL);
+        }
+
+        for (uint32_t k = 0; k < FF_STALL_WRITE_SIZE; k++)
+        {
+            buf[k] = Ff_Stall_Pattern(i * FF_STALL_WRITE_SIZE + k);
+        }
+        start = getus();
+        n = Ql_FatFs_Chan_Write(&chan, buf, FF_STALL_WRITE_SIZE);
+        us = (uint32_t)(getus() - start);
+        Ff_Stall_Accepted[i] = (n > 0) ? (uint32_t)n : 0;
+        accepted += Ff_Stall_Accepted[i];
+        max_us = (us > max_us) ? us : max_us;
+        blocked += (us > FF_STALL_DROP_MAX_US);
+        if (us > bound_us)
+        {
+            printf("%s: write %u blocked %u us, bound %u us\n", Case->Name, i, us, bound_us);
+            ret = -1;
+        }
+
+        next += pdMS_TO_TICKS(FF_STALL_PERIOD_MS);
+        if ((int32_t)(next - xTaskGetTickCount()) > 0)
+        {
+            vTaskDelay(next - xTaskGetTickCount());
+        }
+    }
+    if (Ql_FatFs_Chan_Close(&chan) != 0)
+    {
+        printf("%s: close fail\n", Case->Name);
+        return -1;
+    }
+    Ql_FatFs_Chan_Stats_Get(&chan, &stats);
+
+    /* The file is the accepted head of every write, in order */
+    if (f_open(&fil, Case->Path, FA_READ) != FR_OK)
+    {
+        printf("%s: cannot read back\n", Case->Name);
+        return -1;
+    }
+    for (uint32_t i = 0; (i < FF_STALL_WRITES) && (bad == 0); i++)
+    {
+        if ((f_read(&fil, buf, Ff_Stall_Accepted[i], &got) != FR_OK) || (got != Ff_Stall_Accepted[i]))
+        {
+            bad++;
+            break;
+        }
+        for (uint32_t k = 0; k < got; k++)
+        {
+            bad += (buf[k] != Ff_Stall_Pattern(i * FF_STALL_WRITE_SIZE + k));
+        }
+    }
+    bad += (f_size(&fil) != accepted);
+    f_close(&fil);
+
+    printf("%-5s %-8u %-8u %-8u %-8u %-6u %-7u %u\n", Case->Name, stats.Bytes_In, stats.Bytes_Written,
+           stats.Bytes_Dropped, accepted, blocked, max_us, stats.Flush_Max_Ms);
+
+    if ((stats.Bytes_In != (FF_STALL_WRITES * FF_STALL_WRITE_SIZE)) ||
+        (stats.Bytes_In != (stats.Bytes_Written + stats.Bytes_Dropped)) ||
+        (stats.Bytes_Written != accepted) || (stats.Errors != 0) || (bad != 0))
+    {
+        printf("%s: in %u, written %u, dropped %u, accepted %u, errors %u, bad %u\n", Case->Name, stats.Bytes_In,
+               stats.Bytes_Written, stats.Bytes_Dropped, accepted, stats.Errors, bad);
+        ret = -1;
+    }
+    // the stall has to overrun both buffers, and the wait policy has to wait
+    if ((stats.Bytes_Dropped == 0) || (stats.Flush_Max_Ms < Ff_Stall_Delay_Ms) ||
+        ((Case->Policy == QL_FF_CHAN_WAIT) && (blocked == 0)))
+    {
+        printf("%s: the stall did not reach the producer\n", Case->Name);
+        ret = -1;
+    }
+
+    return ret;
+}
+
+static void Ff_Stall_Task(void *Param)
+{
+    int32_t *ret = (int32_t *)Param;
+
+    printf("case  in       written  dropped  accepted blocked max us  flush max ms\n");
+    for (uint32_t i = 0; i < (sizeof(Ff_Stall_Case) / sizeof(Ff_Stall_Case[0])); i++)
+    {
+        *ret |= Ff_Stall_Run(&Ff_Stall_Case[i]);
+    }
+    *ret |= 0x100;
+    vTaskDelete(NULL);
+}
+
+int main(int argc, char **argv)
+{
+    static BYTE work[FF_MAX_SS];
+    const MKFS_PARM fmt = { FM_FAT32, 0, 0, 0, 0 };
+    const char *image = "ff_stall.img";
+    volatile int32_t ret = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:d:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': image = optarg; break;
+        case 'd': Ff_Stall_Delay_Ms = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-i image] [-d ms]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    unlink(image);
+    if ((IMG_disk_open(image, 256U * 2048U) != 0) || (f_mkfs("1:", &fmt, work, sizeof(work)) != FR_OK) ||
+        (Ql_FatFs_Mount() != 0) || (Ql_FatFs_Task_Init() != 0))
+    {
+        fprintf(stderr, "cannot format %s\n", image);
+        return 1;
+    }
+    Ql_FatFs_Mkdir_Path("1:stall/");
+
+    /* The producer runs above the storage task, as the NMEA receive task does */
+    xTaskCreate(Ff_Stall_Task, "producer", 1024, (void *)&ret, QL_FF_TASK_PRIORITY + 2, NULL);
+    while (!(ret & 0x100))
+    {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+
+    Ql_FatFs_UnMount();
+    IMG_disk_close();
+    return ((ret & 0xFF) != 0) ? 1 : 0;
+}
@@ -0,0 +1,872 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: fw_module.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_iic.h"
+#include "ql_uart.h"
+#include "ql_spi.h"
+#include "ql_check.h"
+#include "fw_module.h"
+
+#define LOG_TAG "iic"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+#define FW_MODULE_QUEUE_DEPTH       (64U)
+#define FW_MODULE_ITEM_MAX          (32U)
+#define FW_MODULE_RX_MAX            (FW_MODULE_BLOCK_SIZE + 64U)
+
+/* LCx9H and LCx6G bootloader, see ql_fwupg_lcx.c */
+#define FW_LCX_HEAD                 (0xAAU)
+#define FW_LCX_CLASS                (0x02U)
+#define FW_LCX_TAIL                 (0x55U)
+#define FW_LCX_REG_RESP             (0x080051AAU)
+#define FW_LCX_REG_ANNOUNCE         (0x040051AAU)
+#define FW_LCX_WORD1                (0x514C1309U)
+#define FW_LCX_WORD1_ANSWER         (0xAAFC3A4DU)
+#define FW_LCX_WORD2                (0x1203A504U)
+#define FW_LCX_WORD2_ANSWER         (0x55FD5BA0U)
+#define FW_LCX_MSG_FW_ADDR          (0x01U)
+#define FW_LCX_MSG_FW_INFO          (0x02U)
+#define FW_LCX_MSG_UPGRADE          (0x03U)     // LCx9H, LCx6G: erase
+#define FW_LCX_MSG_FW_DATA          (0x04U)
+#define FW_LCX_MSG_FORMAT           (0x21U)
+#define FW_LCX_MSG_REBOOT           (0x31U)
+#define FW_LCX_MSG_BL_VER           (0x71U)
+#define FW_LCX_STATUS_OK            (0x0000U)
+#define FW_LCX_STATUS_ERR           (0x0001U)
+#define FW_LCX_STATUS_CRC_ERR       (0x0002U)
+#define FW_LCX_FORMAT_STEP          (50U)       // % per progress report
+
+/* LCx9H boot ROM and download agent, see ql_fwupg_da.c */
+#define FW_DA_MARK                  (0x66U)
+#define FW_DA_HANDSHAKE             (0xA0U)
+#define FW_DA_RACE_FORMAT           (0x2104U)
+#define FW_DA_RACE_WRITE            (0x2100U)
+#define FW_DA_RACE_HEAD_LEN         (16U)
+#define FW_DA_ERASE_SIZE            (0x10000U)
+
+typedef enum
+{
+    FW_DA_CMD = 0,      // ROM, a command byte
+    FW_DA_FIELD,        // ROM, the fields of a command, each echoed
+    FW_DA_LOAD,         // ROM, the DA
+    FW_DA_SYNC,         // DA, the sync bytes
+    FW_DA_RACE,         // DA, race commands
+} Fw_Da_State_TypeDef;
+
+typedef struct
+{
+    uint8_t     Data[FW_MODULE_ITEM_MAX];
+    uint8_t     Len;
+} Fw_Module_Item_TypeDef;
+
+static Fw_Module_TypeDef Module;
+
+/* What the module has to send, one item per read */
+static Fw_Module_Item_TypeDef Fw_Queue[FW_MODULE_QUEUE_DEPTH];
+static uint32_t Fw_Queue_Head = 0;
+static uint32_t Fw_Queue_Tail = 0;
+static uint64_t Fw_Ready_Us = 0;        // busy until then
+
+static uint8_t  Fw_Rx[FW_MODULE_RX_MAX];
+static uint32_t Fw_Rx_Len = 0;
+static uint32_t Fw_Boot_Polls = 0;
+
+/* LCx: the length query, the announced frame and the image in progress */
+static uint8_t  Lcx_Len_Query = 0;
+static uint32_t Lcx_Announce = 0;
+static uint32_t Lcx_Addr = 0;
+static uint32_t Lcx_Size = 0;
+static uint32_t Lcx_Crc = 0;
+static uint32_t Lcx_Run_Crc = 0;
+static uint32_t Lcx_Next = 0;
+static uint8_t  Lcx_Rejected = 0;
+
+/* DA: the ROM command, its fields and the race command being received */
+static Fw_Da_State_TypeDef Da_State = FW_DA_CMD;
+static uint8_t  Da_Cmd = 0;
+static const uint8_t *Da_Fields = NULL;
+static uint32_t Da_Field_Count = 0;
+static uint32_t Da_Field = 0;
+static uint32_t Da_Got = 0;
+static uint8_t  Da_Buf[4];
+static uint32_t Da_Len = 0;
+static uint16_t Da_Sum = 0;
+static uint32_t Da_Sync = 0;
+
+static const uint8_t Da_Fields_D0[] = { 4, 4 };         // read register: address, count
+static const uint8_t Da_Fields_D2[] = { 4, 4, 2 };      // write register: address, count, value
+static const uint8_t Da_Fields_D5[] = { 4 };            // jump: address
+static const uint8_t Da_Fields_D7[] = { 4, 4, 4 };      // send DA: address, length, signature length
+static const uint8_t Da_Sync_In[] = { 0x3F, 0xF3, 0xC0, 0x0C, 0x01 };
+static const uint8_t Da_Sync_Out[] = { 0x0C, 0x3F, 0xF3, 0x5A, 0x69 };
+
+Fw_Module_TypeDef *Fw_Module(void)
+{
+    return &Module;
+}
+
+void Fw_Module_Reset(Fw_Module_Type_TypeDef Type)
+{
+    Module.Type = Type;
+    Module.Errors = 0;
+    Module.Commands = 0;
+    Module.Blocks = 0;
+    Module.Rejects = 0;
+    Module.Images = 0;
+    Module.Rebooted = 0;
+    Module.Reject_At = -1;
+    Module.Wedge_At = -1;
+    Module.Dead = 0;
+    Module.Mark_Block = 0;
+    Module.Mark_Us = 0;
+
+    Fw_Queue_Head = 0;
+    Fw_Queue_Tail = 0;
+    Fw_Ready_Us = 0;
+    Fw_Rx_Len = 0;
+    Fw_Boot_Polls = FW_MODULE_BOOT_POLLS;
+    Lcx_Len_Query = 0;
+    Lcx_Announce = 0;
+    Lcx_Next = 0;
+    Lcx_Rejected = 0;
+    Da_State = FW_DA_CMD;
+}
+
+void Fw_Module_Flash_Fill(uint8_t Value)
+{
+    memset(Module.Flash, Value, sizeof(Module.Flash));
+}
+
+static uint32_t Fw_Get_LE(const uint8_t *Data, uint32_t Len)
+{
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        value |= (uint32_t)Data[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t Fw_Get_BE32(const uint8_t *Data)
+{
+    return ((uint32_t)Data[0] << 24) | ((uint32_t)Data[1] << 16) | ((uint32_t)Data[2] << 8) | Data[3];
+}
+
+static void Fw_Put_BE32(uint8_t *Data, uint32_t Value)
+{
+    Data[0] = (Value >> 24) & 0xFF;
+    Data[1] = (Value >> 16) & 0xFF;
+    Data[2] = (Value >> 8) & 0xFF;
+    Data[3] = Value & 0xFF;
+}
+
+static void Fw_Module_Error(const char *What, uint32_t Value)
+{
+    Module.Errors++;
+    printf("module: %s 0x%X\n", What, Value);
+}
+
+static void Fw_Module_Put(const uint8_t *Data, uint32_t Len)
+{
+    Fw_Module_Item_TypeDef *item = &Fw_Queue[Fw_Queue_Tail % FW_MODULE_QUEUE_DEPTH];
+
+    if (((Fw_Queue_Tail - Fw_Queue_Head) >= FW_MODULE_QUEUE_DEPTH) || (Len > FW_MODULE_ITEM_MAX))
+    {
+        Fw_Module_Error("send queue overflow", Len);
+        return;
+    }
+    memcpy(item->Data, Data, Len);
+    item->Len = (uint8_t)Len;
+    Fw_Queue_Tail++;
+}
+
+static void Fw_Module_Put_LE(uint32_t Value, uint32_t Len)
+{
+    uint8_t data[4];
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        data[i] = (Value >> (8 * i)) & 0xFF;
+    }
+    Fw_Module_Put(data, Len);
+}
+
+/* The response to what was just received is ready after Us */
+static void Fw_Module_Busy(uint32_t Us)
+{
+    Fw_Ready_Us = Ql_Host_Now_Us() + Us;
+}
+
+static uint8_t *Fw_Module_Flash(uint32_t Addr, uint32_t Len)
+{
+    if ((Addr < FW_MODULE_FLASH_BASE) || ((Addr - FW_MODULE_FLASH_BASE) + Len > FW_MODULE_FLASH_SIZE))
+    {
+        Fw_Module_Error("flash address out of range", Addr);
+        return NULL;
+    }
+    return Module.Flash + (Addr - FW_MODULE_FLASH_BASE);
+}
+
+static void Fw_Module_Erase(uint32_t Addr, uint32_t Len)
+{
+    uint8_t *flash = Fw_Module_Flash(Addr, Len);
+
+    if (flash != NULL)
+    {
+        memset(flash, 0xFF, Len);
+    }
+    Module.Commands++;
+}
+
+/* NOR flash: programming clears bits only, the same data twice is fine,
+   data over what was not erased is not */
+static void Fw_Module_Program(uint32_t Addr, const uint8_t *Data, uint32_t Len)
+{
+    uint8_t *flash = Fw_Module_Flash(Addr, Len);
+
+    if (flash == NULL)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        flash[i] &= Data[i];
+    }
+    if (memcmp(flash, Data, Len) != 0)
+    {
+        Fw_Module_Error("programmed over data not erased at", Addr);
+    }
+    Module.Blocks++;
+}
+
+/*****************************************************************************
+* LCx9H and LCx6G bootloader
+*****************************************************************************/
+
+static void Fw_Lcx_Resp(uint8_t Msg, const uint8_t *Payload, uint32_t Len)
+{
+    uint8_t frame[FW_MODULE_ITEM_MAX];
+
+    frame[0] = FW_LCX_HEAD;
+    frame[1] = FW_LCX_CLASS;
+    frame[2] = Msg;
+    frame[3] = (Len >> 8) & 0xFF;
+    frame[4] = Len & 0xFF;
+    memcpy(frame + 5, Payload, Len);
+    Fw_Put_BE32(frame + 5 + Len, Ql_Check_CRC32(0, frame + 1, 4 + Len));
+    frame[9 + Len] = FW_LCX_TAIL;
+    Fw_Module_Put(frame, 10 + Len);
+}
+
+static void Fw_Lcx_Status(uint8_t Msg, uint16_t Status)
+{
+    const uint8_t payload[4] = { FW_LCX_CLASS, Msg, (uint8_t)(Status >> 8), (uint8_t)Status };
+
+    Fw_Lcx_Resp(Msg, payload, sizeof(payload));
+}
+
+static void Fw_Lcx_Progress(uint8_t Percent)
+{
+    const uint8_t payload[5] = { FW_LCX_CLASS, FW_LCX_MSG_FORMAT, Percent, 0, 0 };
+
+    Fw_Lcx_Resp(FW_LCX_MSG_FORMAT, payload, sizeof(payload));
+}
+
+static void Fw_Lcx_Data(const uint8_t *Payload, uint32_t Len)
+{
+    const uint32_t index = Fw_Get_BE32(Payload);
+    const uint32_t n = Len - 4;
+
+    if (index != Lcx_Next)
+    {
+        Fw_Module_Error("data packet out of order", index);
+        Fw_Lcx_Status(FW_LCX_MSG_FW_DATA, FW_LCX_STATUS_ERR);
+        return;
+    }
+    if ((Module.Reject_At >= 0) && ((uint32_t)Module.Reject_At == Module.Blocks) && !Lcx_Rejected)
+    {
+        // as if the packet came in with a bit error
+        Lcx_Rejected = 1;
+        Module.Rejects++;
+        Fw_Lcx_Status(FW_LCX_MSG_FW_DATA, FW_LCX_STATUS_CRC_ERR);
+        return;
+    }
+
+    Module.Commands++;
+    Fw_Module_Program(Lcx_Addr + index * FW_MODULE_BLOCK_SIZE, Payload + 4, n);
+    Lcx_Run_Crc = Ql_Check_CRC32(Lcx_Run_Crc, Payload + 4, n);
+    Lcx_Next++;
+    if (index * FW_MODULE_BLOCK_SIZE + n >= Lcx_Size)
+    {
+        if (Lcx_Run_Crc == Lcx_Crc)
+        {
+            Module.Images++;
+        }
+        else
+        {
+            Fw_Module_Error("image crc32 mismatch, announced", Lcx_Crc);
+        }
+    }
+    Fw_Module_Busy(FW_MODULE_PROGRAM_US);
+    Fw_Lcx_Status(FW_LCX_MSG_FW_DATA, FW_LCX_STATUS_OK);
+}
+
+static void Fw_Lcx_Frame(void)
+{
+    const uint32_t len = ((uint32_t)Fw_Rx[3] << 8) | Fw_Rx[4];
+    const uint8_t msg = Fw_Rx[2];
+    const uint8_t *payload = Fw_Rx + 5;
+    const uint8_t is_6g = (Module.Type == FW_MODULE_LCX6G);
+    const uint8_t version[7] = { FW_LCX_CLASS, FW_LCX_MSG_BL_VER, 0, 0, 0x01, 0x00, 0x05 };
+    uint32_t size;
+
+    Fw_Rx_Len = 0;
+    if (is_6g && (Lcx_Announce != 10 + len))
+    {
+        Fw_Module_Error("frame length not announced", Lcx_Announce);
+    }
+    Lcx_Announce = 0;
+    if ((Fw_Rx[0] != FW_LCX_HEAD) || (Fw_Rx[1] != FW_LCX_CLASS) || (Fw_Rx[9 + len] != FW_LCX_TAIL))
+    {
+        Fw_Module_Error("frame head or tail", msg);
+        return;
+    }
+    if (Fw_Get_BE32(Fw_Rx + 5 + len) != Ql_Check_CRC32(0, Fw_Rx + 1, 4 + len))
+    {
+        Fw_Module_Error("frame crc32", msg);
+        Fw_Lcx_Status(msg, FW_LCX_STATUS_CRC_ERR);
+        return;
+    }
+
+    Fw_Module_Busy(FW_MODULE_CMD_US);
+    switch (msg)
+    {
+        case FW_LCX_MSG_FW_ADDR:
+            Lcx_Addr = Fw_Get_BE32(payload);
+            Fw_Lcx_Status(msg, FW_LCX_STATUS_OK);
+            break;
+        case FW_LCX_MSG_FW_INFO:
+            if (!is_6g && (Fw_Get_BE32(payload + 8) != Lcx_Addr))
+            {
+                Fw_Module_Error("fw info address", Fw_Get_BE32(payload + 8));
+            }
+            Lcx_Size = Fw_Get_BE32(payload);
+            Lcx_Crc = Fw_Get_BE32(payload + 4);
+            Lcx_Addr = Fw_Get_BE32(payload + 8);
+            Lcx_Run_Crc = Ql_Check_CRC32(0, (const unsigned char *)&Lcx_Size, 4);
+            Lcx_Next = 0;
+            Fw_Lcx_Status(msg, FW_LCX_STATUS_OK);
+            break;
+        case FW_LCX_MSG_UPGRADE:
+            if (is_6g)
+            {
+                size = (Lcx_Size + FW_MODULE_BLOCK_SIZE - 1) / FW_MODULE_BLOCK_SIZE * FW_MODULE_BLOCK_SIZE;
+                Fw_Module_Erase(Lcx_Addr, size);
+                Fw_Module_Busy(FW_MODULE_ERASE_US * (size / FW_DA_ERASE_SIZE + 1));
+            }
+            Fw_Lcx_Status(msg, FW_LCX_STATUS_OK);
+            break;
+        case FW_LCX_MSG_FORMAT:
+            if (len == 8)
+            {
+                size = Fw_Get_BE32(payload + 4);
+                Fw_Module_Erase(Fw_Get_BE32(payload), size);
+                Fw_Module_Busy(FW_MODULE_ERASE_US * (size / FW_DA_ERASE_SIZE + 1) / (100 / FW_LCX_FORMAT_STEP));
+                Fw_Lcx_Progress(FW_LCX_FORMAT_STEP);
+            }
+            else if (payload[2] < 100)
+            {
+                Fw_Lcx_Progress(payload[2] + FW_LCX_FORMAT_STEP);
+            }
+            else
+            {
+                Fw_Lcx_Status(msg, FW_LCX_STATUS_OK);
+            }
+            break;
+        case FW_LCX_MSG_FW_DATA:
+            Fw_Lcx_Data(payload, len);
+            break;
+        case FW_LCX_MSG_BL_VER:
+            Fw_Lcx_Resp(msg, version, sizeof(version));
+            break;
+        case FW_LCX_MSG_REBOOT:
+            Module.Rebooted = 1;
+            Fw_Lcx_Status(msg, FW_LCX_STATUS_OK);
+            break;
+        default:
+            Fw_Module_Error("unknown message", msg);
+            break;
+    }
+    if (Module.Rebooted && (msg != FW_LCX_MSG_REBOOT))
+    {
+        Fw_Module_Error("message after the reboot", msg);
+    }
+}
+
+static void Fw_Lcx_Write(const uint8_t *Data, uint32_t Len)
+{
+    uint32_t word;
+
+    if ((Fw_Rx_Len == 0) && (Len == 4) && (Fw_Get_LE(Data, 4) == FW_LCX_REG_RESP))
+    {
+        Lcx_Len_Query = 1;
+        return;
+    }
+    if ((Fw_Rx_Len == 0) && (Len == 8) && (Fw_Get_LE(Data, 4) == FW_LCX_REG_ANNOUNCE))
+    {
+        Lcx_Announce = Fw_Get_LE(Data + 4, 4);
+        return;
+    }
+    if ((Fw_Rx_Len == 0) && (Len == 4) && (Data[0] != FW_LCX_HEAD))
+    {
+        word = Fw_Get_LE(Data, 4);
+        if ((word == FW_LCX_WORD1) && (Fw_Boot_Polls != 0))
+        {
+            Fw_Boot_Polls--;
+        }
+        else if (word == FW_LCX_WORD1)
+        {
+            Fw_Module_Put_LE(FW_LCX_WORD1_ANSWER, 4);
+        }
+        else if (word == FW_LCX_WORD2)
+        {
+            Fw_Module_Put_LE(FW_LCX_WORD2_ANSWER, 4);
+        }
+        else
+        {
+            Fw_Module_Error("handshake word", word);
+        }
+        Lcx_Announce = 0;
+        return;
+    }
+
+    if (Fw_Rx_Len + Len > sizeof(Fw_Rx))
+    {
+        Fw_Module_Error("frame too long", Fw_Rx_Len + Len);
+        Fw_Rx_Len = 0;
+        return;
+    }
+    memcpy(Fw_Rx + Fw_Rx_Len, Data, Len);
+    Fw_Rx_Len += Len;
+    if ((Fw_Rx_Len >= 5) && (Fw_Rx_Len >= 10U + (((uint32_t)Fw_Rx[3] << 8) | Fw_Rx[4])))
+    {
+        Fw_Lcx_Frame();
+    }
+}
+
+/*****************************************************************************
+* LCx9H boot ROM and download agent
+*****************************************************************************/
+
+static void Fw_Da_Race(void)
+{
+    const uint16_t id = (uint16_t)Fw_Get_LE(Fw_Rx + 4, 2);
+    const uint32_t addr = Fw_Get_LE(Fw_Rx + 6, 4);
+    uint8_t resp[11] = { 0x05, 0x5B, 7, 0, Fw_Rx[4], Fw_Rx[5], 0, Fw_Rx[6], Fw_Rx[7], Fw_Rx[8], Fw_Rx[9] };
+    uint32_t len;
+    uint32_t sum = 0;
+
+    if (id == FW_DA_RACE_FORMAT)
+    {
+        Fw_Module_Erase(addr, Fw_Get_LE(Fw_Rx + 10, 4));
+        Fw_Module_Busy(FW_MODULE_ERASE_US);
+    }
+    else if (id == FW_DA_RACE_WRITE)
+    {
+        len = Fw_Get_LE(Fw_Rx + 10, 2);
+        for (uint32_t i = 0; i < len; i++)
+        {
+            sum += Fw_Rx[FW_DA_RACE_HEAD_LEN + i];
+        }
+        if ((len != FW_MODULE_BLOCK_SIZE) || (sum != Fw_Get_LE(Fw_Rx + 12, 4)))
+        {
+            Fw_Module_Error("race write length or checksum at", addr);
+            resp[6] = 1;
+        }
+        else
+        {
+            Module.Commands++;
+            Fw_Module_Program(addr, Fw_Rx + FW_DA_RACE_HEAD_LEN, len);
+        }
+        Fw_Module_Busy(FW_MODULE_PROGRAM_US);
+    }
+    else
+    {
+        Fw_Module_Error("race command", id);
+        resp[6] = 1;
+    }
+    Fw_Module_Put(resp, sizeof(resp));
+    Fw_Rx_Len = 0;
+}
+
+/* The ROM echoes every field, some commands answer more after one */
+static void Fw_Da_Field(void)
+{
+    const uint32_t value = Fw_Get_LE(Da_Buf, Da_Got);
+
+    Fw_Module_Put(Da_Buf, Da_Got);
+    Da_Field++;
+    if ((Da_Cmd == 0xD0) && (Da_Field == 2))
+    {
+        Fw_Module_Put_LE(0, 2);             // status
+        Fw_Module_Put_LE(0x0003, 2);        // the register
+        Fw_Module_Put_LE(0, 2);
+    }
+    if ((Da_Cmd == 0xD2) && (Da_Field >= 2))
+    {
+        Fw_Module_Put_LE(0, 2);
+    }
+    if ((Da_Cmd == 0xD7) && (Da_Field == 2))
+    {
+        Da_Len = value;
+    }
+    if ((Da_Cmd == 0xD7) && (Da_Field == 3))
+    {
+        Fw_Module_Put_LE(0, 2);
+        Da_State = FW_DA_LOAD;
+        Da_Got = 0;
+        Da_Sum = 0;
+        return;
+    }
+    if ((Da_Cmd == 0xD5) && (Da_Field == 1))
+    {
+        Fw_Module_Put_LE(0, 2);
+        Fw_Module_Put_LE(0xC0, 1);          // the DA runs and syncs
+        Da_State = FW_DA_SYNC;
+        Da_Sync = 0;
+        return;
+    }
+
+    Da_Got = 0;
+    Da_State = (Da_Field >= Da_Field_Count) ? FW_DA_CMD : FW_DA_FIELD;
+}
+
+static void Fw_Da_Byte(uint8_t Byte)
+{
+    switch (Da_State)
+    {
+        case FW_DA_CMD:
+            Da_Cmd = Byte;
+            Da_Fields = NULL;
+            switch (Byte)
+            {
+                case 0xA0: Fw_Module_Put_LE(0x5F, 1); break;
+                case 0x0A: Fw_Module_Put_LE(0xF5, 1); break;
+                case 0x50: Fw_Module_Put_LE(0xAF, 1); break;
+                case 0x05: Fw_Module_Put_LE(0xFA, 1); break;
+                case 0xD0: Da_Fields = Da_Fields_D0; Da_Field_Count = sizeof(Da_Fields_D0); break;
+                case 0xD2: Da_Fields = Da_Fields_D2; Da_Field_Count = sizeof(Da_Fields_D2); break;
+                case 0xD5: Da_Fields = Da_Fields_D5; Da_Field_Count = sizeof(Da_Fields_D5); break;
+                case 0xD7: Da_Fields = Da_Fields_D7; Da_Field_Count = sizeof(Da_Fields_D7); break;
+                default: Fw_Module_Error("rom command", Byte); break;
+            }
+            if (Da_Fields != NULL)
+            {
+                Fw_Module_Put_LE(Byte, 1);
+                Da_Field = 0;
+                Da_Got = 0;
+                Da_State = FW_DA_FIELD;
+            }
+            break;
+        case FW_DA_FIELD:
+            Da_Buf[Da_Got++] = Byte;
+            if (Da_Got == Da_Fields[Da_Field])
+            {
+                Fw_Da_Field();
+            }
+            break;
+        case FW_DA_LOAD:
+            Da_Sum ^= (Da_Got & 1) ? (uint16_t)(Byte << 8) : Byte;
+            if (++Da_Got == Da_Len)
+            {
+                Fw_Module_Put_LE(Da_Sum, 2);
+                Fw_Module_Put_LE(0, 2);
+                Da_State = FW_DA_CMD;
+            }
+            break;
+        case FW_DA_SYNC:
+            if (Byte != Da_Sync_In[Da_Sync])
+            {
+                Fw_Module_Error("da sync byte", Byte);
+            }
+            Fw_Module_Put_LE(Da_Sync_Out[Da_Sync], 1);
+            if (++Da_Sync == sizeof(Da_Sync_In))
+            {
+                Fw_Module_Put_LE(0x00C2, 2);                    // flash manufacturer
+                Fw_Module_Put_LE(0x2016, 2);
+                Fw_Module_Put_LE(0x0016, 2);
+                Fw_Module_Put_LE(FW_MODULE_FLASH_BASE, 4);
+                Fw_Module_Put_LE(FW_MODULE_FLASH_SIZE, 4);
+                Da_State = FW_DA_RACE;
+                Fw_Rx_Len = 0;
+            }
+            break;
+        case FW_DA_RACE:
+            if (Fw_Rx_Len >= sizeof(Fw_Rx))
+            {
+                Fw_Module_Error("race command too long", Fw_Rx_Len);
+                Fw_Rx_Len = 0;
+            }
+            Fw_Rx[Fw_Rx_Len++] = Byte;
+            if ((Fw_Rx_Len >= 4) && (Fw_Rx_Len == 4U + Fw_Get_LE(Fw_Rx + 2, 2)))
+            {
+                Fw_Da_Race();
+            }
+            break;
+    }
+}
+
+/*****************************************************************************
+* I2C driver of the module: ql_iic.h
+*****************************************************************************/
+
+static uint8_t Fw_Module_Wedged(void)
+{
+    if ((Module.Wedge_At >= 0) && (Module.Commands >= (uint32_t)Module.Wedge_At))
+    {
+        Module.Dead = 1;
+    }
+    return Module.Dead;
+}
+
+Ql_IIC_Status_TypeDef Ql_IIC_Init(IIC_Mode_TypeDef mode, IIC_Speed_TypeDef IIC_Mode, uint32_t tx_size, uint32_t rx_size)
+{
+    (void)mode;
+    (void)IIC_Mode;
+    (void)tx_size;
+    (void)rx_size;
+    return QL_IIC_STATUS_OK;
+}
+
+void Ql_IIC_DeInit(void)
+{
+}
+
+void Ql_IIC_CheckBusSatus(void)
+{
+}
+
+Ql_IIC_Status_TypeDef Ql_IIC_Write(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    (void)Sla_Addr;
+    (void)Reg_Addr;
+    if (Fw_Module_Wedged())
+    {
+        Ql_Host_Busy_Us(timeout * 1000U);
+        return QL_IIC_STATUS_TIMEOUT;
+    }
+    Ql_Host_Busy_Us(FW_MODULE_IIC_START_US + Length * FW_MODULE_IIC_BYTE_US);
+
+    if (Module.Type != FW_MODULE_LCX9H_DA)
+    {
+        Fw_Lcx_Write(pData, Length);
+        return QL_IIC_STATUS_OK;
+    }
+    if ((Da_State == FW_DA_CMD) && (Length == 1) && (pData[0] == FW_DA_HANDSHAKE) && (Fw_Boot_Polls != 0))
+    {
+        Fw_Boot_Polls--;
+        return QL_IIC_STATUS_NOACK;
+    }
+    for (uint32_t i = 0; i < Length; i++)
+    {
+        Fw_Da_Byte(pData[i]);
+    }
+    return QL_IIC_STATUS_OK;
+}
+
+Ql_IIC_Status_TypeDef Ql_IIC_Read(uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    const Fw_Module_Item_TypeDef *item = &Fw_Queue[Fw_Queue_Head % FW_MODULE_QUEUE_DEPTH];
+    const uint8_t ready = (Fw_Queue_Head != Fw_Queue_Tail) && (Ql_Host_Now_Us() >= Fw_Ready_Us);
+    const uint8_t is_da = (Module.Type == FW_MODULE_LCX9H_DA);
+    uint32_t len;
+
+    (void)Sla_Addr;
+    (void)Reg_Addr;
+    if (Fw_Module_Wedged())
+    {
+        Ql_Host_Busy_Us(timeout * 1000U);
+        return QL_IIC_STATUS_TIMEOUT;
+    }
+    Ql_Host_Busy_Us(FW_MODULE_IIC_START_US + Length * FW_MODULE_IIC_BYTE_US);
+
+    if (!is_da && Lcx_Len_Query)
+    {
+        Lcx_Len_Query = 0;
+        len = ready ? item->Len : 0;
+        memset(pData, 0, Length);
+        memcpy(pData, &len, (Length < 4) ? Length : 4);
+        return QL_IIC_STATUS_OK;
+    }
+    if (!ready)
+    {
+        return QL_IIC_STATUS_NOACK;
+    }
+
+    // the DA ends every read with its mark
+    len = is_da ? (Length - 1) : Length;
+    if (len != item->Len)
+    {
+        Fw_Module_Error("read length", Length);
+    }
+    memset(pData, 0, Length);
+    memcpy(pData, item->Data, (len < item->Len) ? len : item->Len);
+    if (is_da)
+    {
+        pData[Length - 1] = FW_DA_MARK;
+    }
+    Fw_Queue_Head++;
+    if ((Module.Mark_Block != 0) && (Module.Blocks == Module.Mark_Block) && (Module.Mark_Us == 0))
+    {
+        Module.Mark_Us = Ql_Host_Now_Us();
+    }
+    return QL_IIC_STATUS_OK;
+}
+
+/* No learning: every transfer waits the turnaround, a NACK is handed up */
+void Ql_IIC_PaceInit(IIC_Pace_TypeDef* pace, const char* name, uint32_t min_us, uint32_t max_us)
+{
+    memset(pace, 0, sizeof(IIC_Pace_TypeDef));
+    pace->name = name;
+    pace->min_us = min_us;
+    pace->max_us = (max_us > min_us) ? max_us : min_us;
+    pace->gap_us = min_us;
+    pace->safe_us = min_us;
+    pace->last_us = (uint32_t)Ql_Host_Now_Us() - pace->max_us;
+}
+
+static Ql_IIC_Status_TypeDef Fw_Module_Pace(IIC_Pace_TypeDef* pace, uint8_t Read, uint8_t Sla_Addr, uint8_t Reg_Addr,
+                                            uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    const uint32_t idle_us = (uint32_t)Ql_Host_Now_Us() - pace->last_us;
+    Ql_IIC_Status_TypeDef status;
+
+    if (idle_us < pace->gap_us)
+    {
+        pace->wait_us += pace->gap_us - idle_us;
+        Ql_Host_Busy_Us(pace->gap_us - idle_us);
+    }
+    status = Read ? Ql_IIC_Read(Sla_Addr, Reg_Addr, pData, Length, timeout)
+                  : Ql_IIC_Write(Sla_Addr, Reg_Addr, pData, Length, timeout);
+    pace->last_us = (uint32_t)Ql_Host_Now_Us();
+    pace->transfers++;
+    if (status == QL_IIC_STATUS_NOACK)
+    {
+        pace->nacks++;
+    }
+    else if (status != QL_IIC_STATUS_OK)
+    {
+        pace->failures++;
+    }
+    return status;
+}
+
+Ql_IIC_Status_TypeDef Ql_IIC_PaceWrite(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    return Fw_Module_Pace(pace, 0, Sla_Addr, Reg_Addr, pData, Length, timeout);
+}
+
+Ql_IIC_Status_TypeDef Ql_IIC_PaceRead(IIC_Pace_TypeDef* pace, uint8_t Sla_Addr, uint8_t Reg_Addr, uint8_t *pData, const uint32_t Length, uint32_t timeout)
+{
+    return Fw_Module_Pace(pace, 1, Sla_Addr, Reg_Addr, pData, Length, timeout);
+}
+
+void Ql_IIC_PacePrint(const IIC_Pace_TypeDef* pace)
+{
+    QL_LOG_I("%s pace: gap %d us, %d transfers, %d nacks, %d failures, wait %d us", pace->name, pace->gap_us,
+             pace->transfers, pace->nacks, pace->failures, (uint32_t)pace->wait_us);
+}
+
+/*****************************************************************************
+* UART and SPI: no module behind them
+*****************************************************************************/
+
+int32_t Ql_Uart_Init(const char *Name, uint32_t UsartPeriph, uint32_t Baud, uint32_t RecvBufSize, uint32_t SendBufSize)
+{
+    (void)Name;
+    (void)UsartPeriph;
+    (void)Baud;
+    (void)RecvBufSize;
+    (void)SendBufSize;
+    return -1;
+}
+
+int32_t Ql_Uart_DeInit(uint32_t UsartPeriph)
+{
+    (void)UsartPeriph;
+    return 0;
+}
+
+int32_t Ql_Uart_Read(uint32_t UsartPeriph, void* Src, uint16_t Size, uint32_t Timeout)
+{
+    (void)UsartPeriph;
+    (void)Src;
+    (void)Size;
+    vTaskDelay(Timeout);
+    return 0;
+}
+
+int32_t Ql_Uart_Write(uint32_t UsartPeriph, const void* Src, uint16_t Len, uint32_t Timeout)
+{
+    (void)UsartPeriph;
+    (void)Src;
+    (void)Len;
+    (void)Timeout;
+    return -1;
+}
+
+SPI_Status_TypeDef Ql_SPI_Init(SPI_Mode_TypeDef mode, uint32_t tx_size, uint32_t rx_size)
+{
+    (void)mode;
+    (void)tx_size;
+    (void)rx_size;
+    return SPI_STATUS_BUSY;
+}
+
+SPI_Status_TypeDef Ql_SPI_DeInit(void)
+{
+    return SPI_STATUS_OK;
+}
+
+SPI_Status_TypeDef Ql_SPI_Write(uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)pData;
+    (void)Size;
+    (void)Timeout;
+    return SPI_STATUS_BUSY;
+}
+
+SPI_Status_TypeDef Ql_SPI_Read(uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)pData;
+    (void)Size;
+    (void)Timeout;
+    return SPI_STATUS_BUSY;
+}
@@ -0,0 +1,78 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: fw_module.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __FW_MODULE_H_
+#define __FW_MODULE_H_
+
+#include <stdint.h>
+
+/* Simulated GNSS module behind the I2C driver (Ql_IIC_* of ql_iic.h) for
+   the firmware upgrade harness: the LCx9H and LCx6G bootloaders and the
+   LCx9H boot ROM with its download agent, as ql_fwupg_lcx.c and
+   ql_fwupg_da.c drive them. The module checks every frame, keeps the
+   flash it was given and counts what it did not expect in Errors. The
+   UART and SPI drivers are stand-ins that fail to open. */
+#define FW_MODULE_FLASH_BASE        (0x08000000U)
+#define FW_MODULE_FLASH_SIZE        (0x00400000U)
+#define FW_MODULE_BLOCK_SIZE        (4096U)
+
+#define FW_MODULE_IIC_BYTE_US       (23U)       // 400 kHz
+#define FW_MODULE_IIC_START_US      (50U)       // address and turnaround per transfer
+#define FW_MODULE_BOOT_POLLS        (30U)       // handshake polls before the bootloader answers
+#define FW_MODULE_CMD_US            (20000U)    // a command
+#define FW_MODULE_PROGRAM_US        (20000U)    // a 4 KB block
+#define FW_MODULE_ERASE_US          (30000U)    // 64 KB
+
+typedef enum
+{
+    FW_MODULE_LCX9H = 0,
+    FW_MODULE_LCX6G,
+    FW_MODULE_LCX9H_DA,
+} Fw_Module_Type_TypeDef;
+
+typedef struct
+{
+    Fw_Module_Type_TypeDef  Type;
+    uint8_t     Flash[FW_MODULE_FLASH_SIZE];    // at FW_MODULE_FLASH_BASE, kept over a reset
+    uint32_t    Errors;         // frames, orders or data the bootloader did not expect
+    uint32_t    Commands;       // data blocks and erases, DA: race commands
+    uint32_t    Blocks;         // data blocks programmed
+    uint32_t    Rejects;        // data blocks answered with a CRC error
+    uint32_t    Images;         // LCx: images whose CRC matched the announced one
+    uint8_t     Rebooted;       // LCx6G reboot command seen
+    int32_t     Reject_At;      // data block answered once with a CRC error, -1: none
+    int32_t     Wedge_At;       // after this many commands every transfer times out, -1: never
+    uint8_t     Dead;           // every transfer times out, as a module held in reset
+    uint32_t    Mark_Block;     // data block, counted from 1, whose response time is kept, 0: none
+    uint64_t    Mark_Us;        // virtual time the response to Mark_Block was read
+} Fw_Module_TypeDef;
+
+Fw_Module_TypeDef *Fw_Module(void);
+
+/* Power on into the bootloader of Type. The flash is kept, the faults and
+   counters are cleared */
+void Fw_Module_Reset(Fw_Module_Type_TypeDef Type);
+
+/* Fill the flash with Value, as a module with an old firmware */
+void Fw_Module_Flash_Fill(uint8_t Value);
+
+#endif
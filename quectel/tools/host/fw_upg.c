@@ -0,0 +1,460 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: fw_upg.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_host_card.h"
+#include "ql_ff_user.h"
+#include "ql_ff_disk.h"
+#include "ql_fwupg.h"
+#include "fw_module.h"
+
+#define LOG_TAG "fw_upg"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+/* The fw package on the card: the images of the LCx9H with the cfg file and
+   the DA, the LCx6G image next to them */
+#define FW_UPG_DIR                  "/fw/"         // Ql_FatFs paths, the drive is added
+#define FW_UPG_DRIVE_DIR            "1:/fw/"
+#define FW_UPG_BLOCK                (4096U)
+#define FW_UPG_DA_LENGTH            (0x6A44U)
+#define FW_UPG_APP_BLOCKS           (256U)      // a multiple of the checkpoint interval
+#define FW_UPG_REJECT_AT            (5U)        // LCx9H data block answered with a CRC error
+#define FW_UPG_RESET_AFTER_MS       (50U)       // after the last block of the app, the 048 case
+
+typedef struct
+{
+    const char *File;
+    uint32_t    Addr;
+    uint32_t    Size;
+    uint8_t    *Data;
+} Fw_Upg_File_TypeDef;
+
+static Fw_Upg_File_TypeDef Fw_Upg_Files[] =
+{
+    { "part.bin",   0x08000000, FW_UPG_BLOCK, NULL },
+    { "app.bin",    0x08013000, FW_UPG_APP_BLOCKS * FW_UPG_BLOCK - 1000U, NULL },
+    { "gnss.bin",   0x083DF000, FW_UPG_BLOCK - 100U, NULL },
+    { "lc76g.bin",  0x08009000, 100U * FW_UPG_BLOCK + 123U, NULL },
+    { "da_i2c.bin", 0, FW_UPG_DA_LENGTH, NULL },
+};
+
+#define FW_UPG_LCX9H_IMAGES         (3U)        // the first files
+#define FW_UPG_LCX6G_FILE           (3U)
+
+static const Ql_FwUpg_Image_TypeDef Fw_Upg_Lcx9h_Images[] =
+{
+    {"part.bin", "PartitionTable", 0x08000000, FW_UPG_BLOCK},
+    {"app.bin", "MCU_FW", 0x08013000, 0x083DF000 - 0x08013000},
+    {"gnss.bin", "GNSS_CFG", 0x083DF000, FW_UPG_BLOCK},
+};
+
+static const Ql_FwUpg_Image_TypeDef Fw_Upg_Lcx6g_Images[] =
+{
+    {"lc76g.bin", "MCU_FW", 0x08009000, 0x081F7000 - 0x08009000},
+};
+
+static Ql_FwUpg_IIC_TypeDef Fw_Upg_Lcx9h_Port =
+{
+    IIC_MODE_HW0_POLLING, IIC_SPEED_FAST, 2 * 1024U, 2 * 1024U, 0x08 << 1, "lcx9h", 200U, 10000U
+};
+
+static Ql_FwUpg_IIC_TypeDef Fw_Upg_Lcx6g_Port =
+{
+    IIC_MODE_SW_SIMULATE, IIC_SPEED_STANDARD, 2 * 1024U, 2 * 1024U, 0x08 << 1, "lcx6g", 1000U, 10000U
+};
+
+static Ql_FwUpg_IIC_TypeDef Fw_Upg_Da_Port =
+{
+    IIC_MODE_HW0_POLLING, IIC_SPEED_FAST, 2 * 1024U, 2 * 1024U, 0x08 << 1, "lcx9h da", 1000U, 10000U
+};
+
+static Ql_FwUpg_Ctx_TypeDef Fw_Upg_Ctx;
+static Ql_FwUpg_Image_TypeDef Fw_Upg_Cfg_Images[8];
+static uint32_t Fw_Upg_Cfg_Count = 0;
+
+/* Board reset: the card and the module lose power at once */
+static volatile uint32_t Fw_Upg_Reset_Ms = 0;
+static volatile uint8_t Fw_Upg_Reset_Done = 0;
+
+static int32_t Fw_Upg_Put_File(const char *Name, const uint8_t *Data, uint32_t Len)
+{
+    static FIL fp;
+    char path[64];
+    UINT bw = 0;
+
+    snprintf(path, sizeof(path), "%s%s", FW_UPG_DRIVE_DIR, Name);
+    if (f_open(&fp, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+    {
+        return -1;
+    }
+    if ((f_write(&fp, Data, Len, &bw) != FR_OK) || (bw != Len))
+    {
+        f_close(&fp);
+        return -1;
+    }
+    return (f_close(&fp) == FR_OK) ? 0 : -1;
+}
+
+static int32_t Fw_Upg_Package(void)
+{
+    char cfg[512];
+    int len = 0;
+
+    f_mkdir("1:/fw");
+    for (uint32_t i = 0; i < sizeof(Fw_Upg_Files) / sizeof(Fw_Upg_Files[0]); i++)
+    {
+        Fw_Upg_File_TypeDef *file = &Fw_Upg_Files[i];
+
+        file->Data = malloc(file->Size);
+        for (uint32_t j = 0; j < file->Size; j++)
+        {
+            file->Data[j] = (uint8_t)rand();
+        }
+        if (Fw_Upg_Put_File(file->File, file->Data, file->Size) != 0)
+        {
+            return -1;
+        }
+    }
+
+    len += snprintf(cfg + len, sizeof(cfg) - len, "general:\n    config_version: v2.0\n    platform: AG3335\n");
+    for (uint32_t i = 0; i < FW_UPG_LCX9H_IMAGES; i++)
+    {
+        len += snprintf(cfg + len, sizeof(cfg) - len, "main_region:\n    rom:\n        file: %s\n        name: %s\n"
+                        "        begin_address: 0x%08X\n", Fw_Upg_Files[i].File, Fw_Upg_Lcx9h_Images[i].Name,
+                        Fw_Upg_Files[i].Addr);
+    }
+    return Fw_Upg_Put_File(QL_FWUPG_CFG_NAME, (const uint8_t *)cfg, (uint32_t)len);
+}
+
+/* Every image in the module flash, the last block filled up with 0xFF when
+   the protocol pads */
+static int32_t Fw_Upg_Check_Flash(uint32_t First, uint32_t Count, uint8_t Pad)
+{
+    const Fw_Module_TypeDef *module = Fw_Module();
+
+    for (uint32_t i = First; i < First + Count; i++)
+    {
+        const Fw_Upg_File_TypeDef *file = &Fw_Upg_Files[i];
+        const uint8_t *flash = module->Flash + (file->Addr - FW_MODULE_FLASH_BASE);
+        const uint32_t padded = (file->Size + FW_UPG_BLOCK - 1) / FW_UPG_BLOCK * FW_UPG_BLOCK;
+
+        if (memcmp(flash, file->Data, file->Size) != 0)
+        {
+            printf("%s: flash differs from the image\n", file->File);
+            return -1;
+        }
+        for (uint32_t j = file->Size; Pad && (j < padded); j++)
+        {
+            if (flash[j] != 0xFF)
+            {
+                printf("%s: padding at 0x%X is 0x%02X\n", file->File, j, flash[j]);
+                return -1;
+            }
+        }
+    }
+    if (module->Errors != 0)
+    {
+        printf("module: %u errors\n", module->Errors);
+        return -1;
+    }
+    return 0;
+}
+
+static int32_t Fw_Upg_Run(const Ql_FwUpg_Protocol_TypeDef *Proto, Ql_FwUpg_IIC_TypeDef *Port,
+                          const Ql_FwUpg_Image_TypeDef *Images, uint32_t Count, uint32_t *pMs)
+{
+    Ql_FwUpg_Transport_TypeDef bus;
+    const uint64_t start_us = Ql_Host_Now_Us();
+    int32_t ret;
+
+    Ql_FwUpg_IIC_Transport(&bus, Port);
+    ret = Ql_FwUpg_Run(&Fw_Upg_Ctx, &bus, Proto, FW_UPG_DIR, Images, Count);
+    if (pMs != NULL)
+    {
+        *pMs = (uint32_t)((Ql_Host_Now_Us() - start_us) / 1000U);
+    }
+    return ret;
+}
+
+static int32_t Fw_Upg_Lcx9h(void)
+{
+    const Ql_FwUpg_Stats_TypeDef *stats = &Fw_Upg_Ctx.Stats;
+    uint32_t ms[2];
+
+    for (uint32_t run = 0; run < 2; run++)
+    {
+        Fw_Module_Reset(FW_MODULE_LCX9H);
+        Fw_Module_Flash_Fill(0x00);
+        Fw_Module()->Reject_At = (run == 0) ? (int32_t)FW_UPG_REJECT_AT : -1;
+        if (Fw_Upg_Run(&Ql_FwUpg_LCX9H, &Fw_Upg_Lcx9h_Port, Fw_Upg_Lcx9h_Images, FW_UPG_LCX9H_IMAGES, &ms[run]) != 0)
+        {
+            printf("lcx9h run %u failed\n", run + 1);
+            return -1;
+        }
+        if ((Fw_Upg_Check_Flash(0, FW_UPG_LCX9H_IMAGES, 1) != 0) || (Fw_Module()->Images != FW_UPG_LCX9H_IMAGES) ||
+            (stats->Retries != Fw_Module()->Rejects))
+        {
+            printf("lcx9h run %u: %u images, %u retries, %u rejects\n", run + 1, Fw_Module()->Images,
+                   stats->Retries, Fw_Module()->Rejects);
+            return -1;
+        }
+    }
+    printf("lcx9h    %u blocks, 1 rejected and sent again: %u ms, crc32 from the cache: %u ms\n",
+           Fw_Module()->Blocks, ms[0], ms[1]);
+    return 0;
+}
+
+static int32_t Fw_Upg_Lcx6g(void)
+{
+    uint32_t ms;
+
+    Fw_Module_Reset(FW_MODULE_LCX6G);
+    Fw_Module_Flash_Fill(0x00);
+    if ((Fw_Upg_Run(&Ql_FwUpg_LCX6G, &Fw_Upg_Lcx6g_Port, Fw_Upg_Lcx6g_Images, 1, &ms) != 0) ||
+        (Fw_Upg_Check_Flash(FW_UPG_LCX6G_FILE, 1, 0) != 0) || (Fw_Module()->Images != 1) || !Fw_Module()->Rebooted)
+    {
+        printf("lcx6g run failed, %u images, rebooted %u\n", Fw_Module()->Images, Fw_Module()->Rebooted);
+        return -1;
+    }
+    printf("lcx6g    %u blocks, rebooted: %u ms\n", Fw_Module()->Blocks, ms);
+    return 0;
+}
+
+static void Fw_Upg_Reset_Task(void *Param)
+{
+    (void)Param;
+    vTaskDelay(pdMS_TO_TICKS(Fw_Upg_Reset_Ms));
+    Ql_Host_Card()->Dead = 1;
+    Fw_Module()->Dead = 1;
+    Fw_Upg_Reset_Done = 1;
+    vTaskDelete(NULL);
+}
+
+static int32_t Fw_Upg_Da_Run(uint32_t *pMs)
+{
+    return Fw_Upg_Run(&Ql_FwUpg_LCX9H_DA, &Fw_Upg_Da_Port, Fw_Upg_Cfg_Images, Fw_Upg_Cfg_Count, pMs);
+}
+
+/* Read the checkpoint the interrupted run left */
+static int32_t Fw_Upg_Ckpt(Ql_FwUpg_Ckpt_TypeDef *pCkpt)
+{
+    static FIL fp;
+    UINT br = 0;
+
+    memset(pCkpt, 0, sizeof(Ql_FwUpg_Ckpt_TypeDef));
+    if (f_open(&fp, FW_UPG_DRIVE_DIR QL_FWUPG_CKPT_NAME, FA_READ) != FR_OK)
+    {
+        return -1;
+    }
+    f_read(&fp, pCkpt, sizeof(Ql_FwUpg_Ckpt_TypeDef), &br);
+    f_close(&fp);
+    return (br == sizeof(Ql_FwUpg_Ckpt_TypeDef)) ? 0 : -1;
+}
+
+/*****************************************************************************
+* One interrupted DA upgrade: Wedge_At >= 0 wedges the bus after that many
+* commands, else the board resets after Reset_Ms. The second run has to
+* finish with every image in the module flash.
+*****************************************************************************/
+static int32_t Fw_Upg_Da_Trial(int32_t Wedge_At, uint32_t Reset_Ms, uint32_t *pResumed, Ql_FwUpg_Ckpt_TypeDef *pCkpt)
+{
+    int32_t ret;
+
+    Fw_Module_Reset(FW_MODULE_LCX9H_DA);
+    Fw_Module_Flash_Fill(0x00);
+    Fw_Module()->Wedge_At = Wedge_At;
+    if (Wedge_At < 0)
+    {
+        Fw_Upg_Reset_Ms = Reset_Ms;
+        Fw_Upg_Reset_Done = 0;
+        xTaskCreate(Fw_Upg_Reset_Task, "reset", 512, NULL, QL_HOST_MAIN_PRIORITY + 1, NULL);
+    }
+
+    ret = Fw_Upg_Da_Run(NULL);
+    if (Fw_Module()->Errors != 0)
+    {
+        printf("module: %u errors before the interruption\n", Fw_Module()->Errors);
+        return -1;
+    }
+    if (Wedge_At < 0)
+    {
+        while (!Fw_Upg_Reset_Done)
+        {
+            vTaskDelay(1);
+        }
+        Ql_FatFs_UnMount();
+        Ql_Host_Card_Power_On();
+        if (Ql_FatFs_Mount() != 0)
+        {
+            printf("mount after the reset failed\n");
+            return -1;
+        }
+        if (pCkpt != NULL)
+        {
+            Fw_Upg_Ckpt(pCkpt);
+        }
+    }
+    else if (ret == 0)
+    {
+        printf("wedge after %d commands: the run did not fail\n", Wedge_At);
+        return -1;
+    }
+
+    // the module is power cycled, the flash keeps what it got
+    Fw_Module_Reset(FW_MODULE_LCX9H_DA);
+    if (Fw_Upg_Da_Run(NULL) != 0)
+    {
+        printf("run after the interruption failed\n");
+        return -1;
+    }
+    *pResumed = Fw_Upg_Ctx.Stats.Resumed;
+    return Fw_Upg_Check_Flash(0, FW_UPG_LCX9H_IMAGES, 1);
+}
+
+static int32_t Fw_Upg_Da(uint32_t Trials)
+{
+    Ql_FwUpg_Ckpt_TypeDef ckpt;
+    uint64_t start_us;
+    uint32_t ref_ms = 0, commands, mark_ms, resumed, resumed_sum;
+
+    if (Ql_FwUpg_Load_Cfg(FW_UPG_DIR, Fw_Upg_Cfg_Images, 8, &Fw_Upg_Cfg_Count) != 0)
+    {
+        printf("load cfg failed\n");
+        return -1;
+    }
+
+    // twice: the first run caches the image CRCs of the checkpoint fingerprint
+    for (uint32_t run = 0; run < 2; run++)
+    {
+        Fw_Module_Reset(FW_MODULE_LCX9H_DA);
+        Fw_Module_Flash_Fill(0x00);
+        Fw_Module()->Mark_Block = 1 + FW_UPG_APP_BLOCKS;
+        start_us = Ql_Host_Now_Us();
+        if ((Fw_Upg_Da_Run(&ref_ms) != 0) || (Fw_Upg_Check_Flash(0, FW_UPG_LCX9H_IMAGES, 1) != 0))
+        {
+            printf("da run %u failed\n", run + 1);
+            return -1;
+        }
+    }
+    commands = Fw_Module()->Commands;
+    mark_ms = (uint32_t)((Fw_Module()->Mark_Us - start_us) / 1000U);
+    printf("da       %u commands, %u blocks: %u ms\n", commands, Fw_Module()->Blocks, ref_ms);
+
+    resumed_sum = 0;
+    for (uint32_t t = 0; t < Trials; t++)
+    {
+        const int32_t k = 1 + rand() % (int32_t)(commands - 1);
+
+        if (Fw_Upg_Da_Trial(k, 0, &resumed, NULL) != 0)
+        {
+            printf("da bus wedge after %d commands failed\n", k);
+            return -1;
+        }
+        resumed_sum += resumed;
+    }
+    printf("da       %u bus wedges: all recovered, %u blocks resumed per trial\n", Trials, resumed_sum / Trials);
+
+    resumed_sum = 0;
+    for (uint32_t t = 0; t < Trials; t++)
+    {
+        const uint32_t reset_ms = (uint32_t)rand() % ref_ms;
+
+        if (Fw_Upg_Da_Trial(-1, reset_ms, &resumed, NULL) != 0)
+        {
+            printf("da board reset at %u ms failed\n", reset_ms);
+            return -1;
+        }
+        resumed_sum += resumed;
+    }
+    printf("da       %u board resets: all recovered, %u blocks resumed per trial\n", Trials, resumed_sum / Trials);
+
+    // reset while the DA pauses after the last block of the app
+    if ((Fw_Upg_Da_Trial(-1, mark_ms + FW_UPG_RESET_AFTER_MS, &resumed, &ckpt) != 0) ||
+        (ckpt.Image != 1) || (ckpt.Block != FW_UPG_APP_BLOCKS) || (Fw_Module()->Blocks != 1))
+    {
+        printf("da reset after the app: checkpoint image %u block %u, %u blocks sent again\n", ckpt.Image,
+               ckpt.Block, Fw_Module()->Blocks);
+        return -1;
+    }
+    printf("da       reset %u ms after the app: checkpoint image %u block %u, %u blocks resumed, %u sent\n",
+           FW_UPG_RESET_AFTER_MS, ckpt.Image, ckpt.Block, resumed, Fw_Module()->Blocks);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static BYTE work[FF_MAX_SS];
+    const MKFS_PARM fmt = { FM_FAT32, 0, 0, 0, 0 };
+    const char *image = "fw_upg.img";
+    uint32_t trials = 20, seed = 1;
+    uint8_t verbose = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:n:s:v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i': image = optarg; break;
+        case 'n': trials = (uint32_t)atoi(optarg); break;
+        case 's': seed = (uint32_t)atoi(optarg); break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-i image] [-n trials] [-s seed] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    unlink(image);
+    if ((IMG_disk_open(image, 256U * 2048U) != 0) || (f_mkfs("1:", &fmt, work, sizeof(work)) != FR_OK))
+    {
+        fprintf(stderr, "cannot format %s\n", image);
+        return 1;
+    }
+    /* The interrupted runs log their errors, the checks below are the result */
+    if (!verbose)
+    {
+        Ql_Log_Level_Set("*", QL_LOG_NONE);
+    }
+
+    srand(seed);
+    if ((Ql_FatFs_Mount() != 0) || (Fw_Upg_Package() != 0))
+    {
+        fprintf(stderr, "cannot write the fw package\n");
+        return 1;
+    }
+    if ((Fw_Upg_Lcx9h() != 0) || (Fw_Upg_Lcx6g() != 0) || (Fw_Upg_Da(trials) != 0))
+    {
+        return 1;
+    }
+
+    Ql_FatFs_UnMount();
+    IMG_disk_close();
+    return 0;
+}
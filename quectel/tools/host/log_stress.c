@@ -0,0 +1,331 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: log_stress.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_host_uart.h"
+#include "ql_uart.h"
+
+#define LOG_TAG "stress"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+/* The real ql_log.c under contention: a task marked as an ISR, high band
+   tasks and low band tasks that flood their ring, all logging at once onto
+   the console at 921600. The far end parses every line, each producer's
+   lines must come out whole and in order, and per band the calls must add
+   up to the lines received plus the drops Ql_Log_Task reports */
+
+#define STRESS_BAUD                 (921600U)
+#define STRESS_PORT                 USART5
+#define STRESS_RX_SIZE              (4096U)
+#define STRESS_TX_SIZE              (4096U)
+#define STRESS_EXCL_US              (2U)        // CPU between LDREX and STREX, room for a preemption
+#define STRESS_CALL_MAX_US          (50U)       // bound of a QL_LOG_I call in the isr and high bands
+#define STRESS_DRAIN_MS             (1000U)
+#define STRESS_LINE_MAX             (256U)
+
+typedef enum
+{
+    STRESS_BAND_ISR = 0,
+    STRESS_BAND_HIGH,
+    STRESS_BAND_LOW,
+    STRESS_BAND_NUM
+} Stress_Band_TypeDef;
+
+typedef struct
+{
+    Stress_Band_TypeDef Band;
+    UBaseType_t         Priority;
+    uint32_t            Period_Ms;
+    uint32_t            Burst;          // lines per period
+    uint32_t            Calls;
+    uint32_t            Received;
+    uint32_t            Bad;            // garbled, cut or out of order
+    uint32_t            Last_Seq;
+    uint32_t           *Latency_Us;
+    uint32_t            Latency_Num;
+    uint32_t            Latency_Max;
+} Stress_Producer_TypeDef;
+
+static Stress_Producer_TypeDef Stress_Producer[] =
+{
+    { STRESS_BAND_ISR,  configMAX_PRIORITIES - 2U,      5U,  1U  },
+    { STRESS_BAND_HIGH, QL_LOG_HIGH_PRIORITY + 1U,      4U,  1U  },
+    { STRESS_BAND_HIGH, QL_LOG_HIGH_PRIORITY,           6U,  2U  },
+    { STRESS_BAND_LOW,  QL_HOST_MAIN_PRIORITY + 3U,     10U, 20U },
+    { STRESS_BAND_LOW,  QL_HOST_MAIN_PRIORITY + 2U,     7U,  20U },
+    { STRESS_BAND_LOW,  QL_HOST_MAIN_PRIORITY + 1U,     13U, 30U },
+};
+#define STRESS_PRODUCER_NUM         (sizeof(Stress_Producer) / sizeof(Stress_Producer[0]))
+
+static const char *Stress_Band_Name[STRESS_BAND_NUM] = { "isr", "high", "low" };
+static const char Stress_Pattern[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+static volatile uint8_t Stress_On = 0;
+static uint32_t Stress_Dropped[STRESS_BAND_NUM];
+static uint32_t Stress_Other = 0;            // garbled lines
+
+/* Payload of line Seq of producer Id, 8 to 55 characters */
+static uint32_t Stress_Len(uint32_t Id, uint32_t Seq)
+{
+    return ((Seq * 7U) + (Id * 13U)) % 48U + 8U;
+}
+
+static int Stress_Cmp(const void *A, const void *B)
+{
+    const uint32_t a = *(const uint32_t *)A;
+    const uint32_t b = *(const uint32_t *)B;
+
+    return (a > b) - (a < b);
+}
+
+static void Stress_Producer_Task(void *Param)
+{
+    const uint32_t id = (uint32_t)(uintptr_t)Param;
+    Stress_Producer_TypeDef *p = &Stress_Producer[id];
+    uint64_t start;
+    uint32_t us;
+    uint32_t len;
+
+    while (!Stress_On)
+    {
+        vTaskDelay(1);
+    }
+    while (Stress_On)
+    {
+        for (uint32_t i = 0; i < p->Burst; i++)
+        {
+            len = Stress_Len(id, p->Calls);
+            start = getus();
+            QL_LOG_I("p%u s%u %.*s", id, p->Calls, (int)len, Stress_Pattern + (p->Calls % 10U));
+            us = (uint32_t)(getus() - start);
+            p->Calls++;
+            if (p->Latency_Num < p->Latency_Max)
+            {
+                p->Latency_Us[p->Latency_Num++] = us;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(p->Period_Ms));
+    }
+    vTaskDelete(NULL);
+}
+
+static void Stress_Line(const char *Line)
+{
+    char band[8];
+    char tag[16];
+    uint32_t id;
+    uint32_t seq;
+    uint32_t n;
+    int at = 0;
+
+    if (sscanf(Line, "[I/" LOG_TAG "] p%u s%u %n", &id, &seq, &at) == 2)
+    {
+        Stress_Producer_TypeDef *p;
+
+        if (id >= STRESS_PRODUCER_NUM)
+        {
+            Stress_Other++;
+            return;
+        }
+        p = &Stress_Producer[id];
+        n = Stress_Len(id, seq);
+        if (((p->Received != 0) && ((int32_t)(seq - p->Last_Seq) <= 0)) || (seq >= p->Calls) ||
+            (strlen(Line + at) != n) || (memcmp(Line + at, Stress_Pattern + (seq % 10U), n) != 0))
+        {
+            p->Bad++;
+        }
+        p->Last_Seq = seq;
+        p->Received++;
+        return;
+    }
+
+    if (sscanf(Line, "[W/log] %7s ring full, %u lines dropped", band, &n) == 2)
+    {
+        for (uint32_t i = 0; i < STRESS_BAND_NUM; i++)
+        {
+            if (strcmp(band, Stress_Band_Name[i]) == 0)
+            {
+                Stress_Dropped[i] += n;
+                return;
+            }
+        }
+    }
+
+    // lines of the other tags, the flash log formatting on the first boot
+    if ((sscanf(Line, "[%*c/%15[^]]] %n", tag, &at) != 1) || (at == 0) || (strcmp(tag, LOG_TAG) == 0))
+    {
+        Stress_Other++;
+    }
+}
+
+/* The PC on the console: splits the bytes into lines */
+static void Stress_Sink_Task(void *Param)
+{
+    static uint8_t buf[1024];
+    static char line[STRESS_LINE_MAX];
+    uint32_t len = 0;
+    uint32_t n;
+
+    (void)Param;
+    for (;;)
+    {
+        n = Ql_Host_Uart_Far_Read(STRESS_PORT, buf, sizeof(buf), pdMS_TO_TICKS(100), NULL);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (buf[i] == '\n')
+            {
+                if ((len > 0) && (line[len - 1] == '\r'))
+                {
+                    len--;
+                }
+                line[len] = '\0';
+                Stress_Line(line);
+                len = 0;
+            }
+            else if (len < (sizeof(line) - 1))
+            {
+                line[len++] = (char)buf[i];
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = 5;
+    uint32_t calls[STRESS_BAND_NUM] = { 0 };
+    uint32_t received[STRESS_BAND_NUM] = { 0 };
+    uint32_t bad[STRESS_BAND_NUM] = { 0 };
+    uint32_t *latency[STRESS_BAND_NUM];
+    uint32_t latency_num[STRESS_BAND_NUM] = { 0 };
+    TaskHandle_t task;
+    int32_t ret = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': seconds = (uint32_t)atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n seconds]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if ((Ql_Uart_Init("Console", STRESS_PORT, STRESS_BAUD, STRESS_RX_SIZE, STRESS_TX_SIZE) != 0) ||
+        (Ql_Log_FuncInit() != 0))
+    {
+        fprintf(stderr, "cannot init the console\n");
+        return 1;
+    }
+    Ql_Host_Uart_Far_Baud(STRESS_PORT, STRESS_BAUD);
+    Ql_Host_Excl_Us(STRESS_EXCL_US);
+
+    xTaskCreate(Stress_Sink_Task, "pc", 512, NULL, configMAX_PRIORITIES - 2U, NULL);
+    for (uint32_t i = 0; i < STRESS_PRODUCER_NUM; i++)
+    {
+        Stress_Producer_TypeDef *p = &Stress_Producer[i];
+
+        p->Latency_Max = (seconds * 1000U / p->Period_Ms + 1U) * p->Burst;
+        p->Latency_Us  = malloc(p->Latency_Max * sizeof(uint32_t));
+        xTaskCreate(Stress_Producer_Task, "producer", 512, (void *)(uintptr_t)i, p->Priority, &task);
+        if (p->Band == STRESS_BAND_ISR)
+        {
+            Ql_Host_Task_Isr(task, 1);
+        }
+    }
+
+    Stress_On = 1;
+    vTaskDelay(pdMS_TO_TICKS(seconds * 1000U));
+    Stress_On = 0;
+    vTaskDelay(pdMS_TO_TICKS(STRESS_DRAIN_MS));
+
+    for (uint32_t i = 0; i < STRESS_PRODUCER_NUM; i++)
+    {
+        latency_num[Stress_Producer[i].Band] += Stress_Producer[i].Latency_Num;
+    }
+    for (uint32_t i = 0; i < STRESS_BAND_NUM; i++)
+    {
+        latency[i] = malloc((latency_num[i] + 1U) * sizeof(uint32_t));
+        latency_num[i] = 0;
+    }
+    for (uint32_t i = 0; i < STRESS_PRODUCER_NUM; i++)
+    {
+        const Stress_Producer_TypeDef *p = &Stress_Producer[i];
+
+        calls[p->Band]    += p->Calls;
+        received[p->Band] += p->Received;
+        bad[p->Band]      += p->Bad;
+        memcpy(latency[p->Band] + latency_num[p->Band], p->Latency_Us, p->Latency_Num * sizeof(uint32_t));
+        latency_num[p->Band] += p->Latency_Num;
+    }
+
+    printf("band  calls   received dropped bad  call us p50/p99/max\n");
+    for (uint32_t i = 0; i < STRESS_BAND_NUM; i++)
+    {
+        const uint32_t n = latency_num[i];
+        uint32_t max;
+
+        qsort(latency[i], n, sizeof(uint32_t), Stress_Cmp);
+        max = (n > 0) ? latency[i][n - 1U] : 0;
+        printf("%-5s %-7u %-8u %-7u %-4u %u/%u/%u\n", Stress_Band_Name[i], calls[i], received[i], Stress_Dropped[i], bad[i],
+               (n > 0) ? latency[i][n / 2U] : 0, (n > 0) ? latency[i][(n * 99U) / 100U] : 0, max);
+
+        // every call is either on the console or counted as dropped
+        if ((calls[i] != (received[i] + Stress_Dropped[i])) || (bad[i] != 0))
+        {
+            printf("%s: %u calls, %u received, %u dropped, %u bad\n", Stress_Band_Name[i], calls[i], received[i], Stress_Dropped[i], bad[i]);
+            ret = -1;
+        }
+        // the low band floods its own ring only
+        if ((i != STRESS_BAND_LOW) && ((Stress_Dropped[i] != 0) || (max > STRESS_CALL_MAX_US)))
+        {
+            printf("%s: %u dropped, call max %u us, bound %u us\n", Stress_Band_Name[i], Stress_Dropped[i], max, STRESS_CALL_MAX_US);
+            ret = -1;
+        }
+        free(latency[i]);
+    }
+    if (Stress_Dropped[STRESS_BAND_LOW] == 0)
+    {
+        printf("low: no drops, the ring was not flooded\n");
+        ret = -1;
+    }
+
+    printf("strex failed %u, other lines %u, console garbled %u dropped %u\n", Ql_Host_Strex_Failed(), Stress_Other,
+           Ql_Host_Uart_Far_Garbled(STRESS_PORT), Ql_Host_Uart_Far_Dropped(STRESS_PORT));
+    if ((Ql_Host_Strex_Failed() == 0) || (Stress_Other != 0) ||
+        (Ql_Host_Uart_Far_Garbled(STRESS_PORT) != 0) || (Ql_Host_Uart_Far_Dropped(STRESS_PORT) != 0))
+    {
+        ret = -1;
+    }
+
+    return (ret != 0) ? 1 : 0;
+}
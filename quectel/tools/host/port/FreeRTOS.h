@@ -0,0 +1,143 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: FreeRTOS.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_HOST_FREERTOS_H_
+#define __QL_HOST_FREERTOS_H_
+
+/* FreeRTOS stand-in of the host build, the part of the API the components
+   use. ql_host_rtos.c runs the tasks as threads of which one runs at a
+   time, on a virtual clock: see ql_host.h */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+typedef uint32_t        TickType_t;
+typedef long            BaseType_t;
+typedef unsigned long   UBaseType_t;
+typedef uint32_t        StackType_t;
+typedef BaseType_t      portBASE_TYPE;
+
+typedef struct ql_host_task  *TaskHandle_t;
+typedef struct ql_host_queue *QueueHandle_t;
+typedef QueueHandle_t         SemaphoreHandle_t;
+typedef struct ql_host_group *EventGroupHandle_t;     // in driver structs only, no API
+typedef struct ql_host_timer *TimerHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define pdPASS                      pdTRUE
+#define pdFAIL                      pdFALSE
+
+#define configTICK_RATE_HZ          (1000U)
+#define configMAX_PRIORITIES        (16U)
+#define configMINIMAL_STACK_SIZE    (128U)
+#define configTIMER_TASK_PRIORITY   (configMAX_PRIORITIES - 1U)
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY    5
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY          15
+
+#define portMAX_DELAY               ((TickType_t)0xFFFFFFFFU)
+#define portTICK_PERIOD_MS          ((TickType_t)1000U / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs)    ((TickType_t)(((uint64_t)(xTimeInMs) * configTICK_RATE_HZ) / 1000U))
+
+#define tskIDLE_PRIORITY            ((UBaseType_t)0U)
+
+#define taskSCHEDULER_SUSPENDED     ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED   ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING       ((BaseType_t)2)
+
+/* One task runs at a time and is only switched out where it blocks, or
+   where it wakes a higher priority one. Inside a critical section that
+   switch waits for taskEXIT_CRITICAL, the device models of the port run
+   their interrupts from such a task */
+#define taskENTER_CRITICAL()                vPortEnterCritical()
+#define taskEXIT_CRITICAL()                 vPortExitCritical()
+#define taskENTER_CRITICAL_FROM_ISR()       (0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)       ((void)(x))
+#define taskDISABLE_INTERRUPTS()
+#define taskENABLE_INTERRUPTS()
+#define taskYIELD()                         vTaskDelay(0)
+#define portYIELD_FROM_ISR(x)               ((void)(x))
+#define portEND_SWITCHING_ISR(x)            ((void)(x))
+#define configASSERT(x)                     do { if (!(x)) abort(); } while (0)
+
+#define pvPortMalloc                malloc
+#define vPortFree                   free
+
+/* task.h */
+BaseType_t  xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                        void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask);
+void        vTaskDelete(TaskHandle_t xTaskToDelete);
+void        vTaskDelay(TickType_t xTicksToDelay);
+void        vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+TickType_t  xTaskGetTickCount(void);
+TickType_t  xTaskGetTickCountFromISR(void);
+BaseType_t  xTaskGetSchedulerState(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask);
+void        vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority);
+void        vTaskSuspendAll(void);
+BaseType_t  xTaskResumeAll(void);
+BaseType_t  xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void        vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken);
+uint32_t    ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+void        vPortEnterCritical(void);
+void        vPortExitCritical(void);
+
+/* queue.h */
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize);
+void        vQueueDelete(QueueHandle_t xQueue);
+BaseType_t  xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait);
+BaseType_t  xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t  xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait);
+BaseType_t  xQueueReceiveFromISR(QueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken);
+BaseType_t  xQueueReset(QueueHandle_t xQueue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue);
+#define xQueueSendToBack            xQueueSend
+#define xQueueSendToBackFromISR     xQueueSendFromISR
+
+/* semphr.h: a semaphore is a queue of empty items, a mutex one that starts
+   full. There is no priority inheritance */
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+#define vSemaphoreDelete(xSemaphore)                            vQueueDelete(xSemaphore)
+#define xSemaphoreTake(xSemaphore, xBlockTime)                  xQueueReceive((xSemaphore), NULL, (xBlockTime))
+#define xSemaphoreGive(xSemaphore)                              xQueueSend((xSemaphore), NULL, 0)
+#define xSemaphoreTakeFromISR(xSemaphore, pxWoken)              xQueueReceiveFromISR((xSemaphore), NULL, (pxWoken))
+#define xSemaphoreGiveFromISR(xSemaphore, pxWoken)              xQueueSendFromISR((xSemaphore), NULL, (pxWoken))
+#define uxSemaphoreGetCount(xSemaphore)                         uxQueueMessagesWaiting(xSemaphore)
+
+/* timers.h: the callbacks run in a daemon task at configTIMER_TASK_PRIORITY,
+   created with the first timer. The command queue is not modelled,
+   xTicksToWait is ignored */
+TimerHandle_t xTimerCreate(const char *pcTimerName, TickType_t xTimerPeriodInTicks, UBaseType_t uxAutoReload,
+                           void *pvTimerID, TimerCallbackFunction_t pxCallbackFunction);
+BaseType_t  xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t  xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait);
+BaseType_t  xTimerIsTimerActive(TimerHandle_t xTimer);
+void       *pvTimerGetTimerID(TimerHandle_t xTimer);
+
+#include "ql_host.h"
+
+#endif
@@ -0,0 +1,299 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: gd32f4xx.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_HOST_GD32F4XX_H_
+#define __QL_HOST_GD32F4XX_H_
+
+/* gd32f4xx.h stand-in of the host build: the core registers the
+   components read, and the USART and DMA of the UART driver, modelled by
+   ql_host_uart.c */
+#include <stdint.h>
+#include <string.h>
+
+#include "ql_host.h"
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } EventStatus, ControlStatus;
+typedef enum { ERROR = 0, SUCCESS = !ERROR } ErrStatus;
+
+typedef struct
+{
+    volatile uint32_t   CTRL;
+    volatile uint32_t   CYCCNT;
+} Ql_Host_Dwt_TypeDef;
+
+typedef struct
+{
+    volatile uint32_t   DEMCR;
+} Ql_Host_CoreDebug_TypeDef;
+
+/* Every read of DWT refreshes CYCCNT from the virtual clock */
+Ql_Host_Dwt_TypeDef       *Ql_Host_Dwt(void);
+extern Ql_Host_CoreDebug_TypeDef Ql_Host_CoreDebug;
+extern uint32_t SystemCoreClock;
+
+/* DMA names the driver structs hold */
+typedef enum { DMA_CH0 = 0, DMA_CH1, DMA_CH2, DMA_CH3, DMA_CH4, DMA_CH5, DMA_CH6, DMA_CH7 } dma_channel_enum;
+typedef enum
+{
+    DMA_SUBPERI0 = 0, DMA_SUBPERI1, DMA_SUBPERI2, DMA_SUBPERI3, DMA_SUBPERI4, DMA_SUBPERI5, DMA_SUBPERI6, DMA_SUBPERI7
+} dma_subperipheral_enum;
+
+#ifndef BIT
+#define BIT(x)                          ((uint32_t)((uint32_t)0x01U << (x)))
+#endif
+
+/* Interrupt numbers of gd32f4xx.h, the ones of the UART driver */
+typedef enum
+{
+    DMA0_Channel0_IRQn  = 11,
+    DMA0_Channel1_IRQn  = 12,
+    DMA0_Channel2_IRQn  = 13,
+    DMA0_Channel3_IRQn  = 14,
+    DMA0_Channel4_IRQn  = 15,
+    DMA0_Channel5_IRQn  = 16,
+    DMA0_Channel6_IRQn  = 17,
+    USART0_IRQn         = 37,
+    USART1_IRQn         = 38,
+    USART2_IRQn         = 39,
+    DMA0_Channel7_IRQn  = 47,
+    UART3_IRQn          = 52,
+    UART4_IRQn          = 53,
+    DMA1_Channel0_IRQn  = 56,
+    DMA1_Channel1_IRQn  = 57,
+    DMA1_Channel2_IRQn  = 58,
+    DMA1_Channel3_IRQn  = 59,
+    DMA1_Channel4_IRQn  = 60,
+    DMA1_Channel5_IRQn  = 68,
+    DMA1_Channel6_IRQn  = 69,
+    DMA1_Channel7_IRQn  = 70,
+    USART5_IRQn         = 71,
+    UART6_IRQn          = 82,
+} IRQn_Type;
+
+/* USART: the base addresses of the target identify the ports. STAT0 and
+   DATA are registers of the model, a DATA access after STAT0 clears IDLEF
+   and the error flags as on the target */
+#define USART_BASE                      (0x40004400U)
+#define USART1                          USART_BASE
+#define USART2                          (USART_BASE + 0x00000400U)
+#define UART3                           (USART_BASE + 0x00000800U)
+#define UART4                           (USART_BASE + 0x00000C00U)
+#define UART6                           (USART_BASE + 0x00003400U)
+#define USART0                          (USART_BASE + 0x0000CC00U)
+#define USART5                          (USART_BASE + 0x0000D000U)
+
+#define USART_STAT0(usartx)             (*Ql_Host_Usart_Reg((usartx), 0x00U))
+#define USART_DATA(usartx)              (*Ql_Host_Usart_Reg((usartx), 0x04U))
+
+#define USART_STAT0_PERR                BIT(0)
+#define USART_STAT0_FERR                BIT(1)
+#define USART_STAT0_NERR                BIT(2)
+#define USART_STAT0_ORERR               BIT(3)
+#define USART_STAT0_IDLEF               BIT(4)
+#define USART_STAT0_RBNE                BIT(5)
+#define USART_STAT0_TC                  BIT(6)
+#define USART_STAT0_TBE                 BIT(7)
+
+/* Flag: STAT0 bit. Interrupt: enable bit of the model. Interrupt flag: both */
+typedef enum
+{
+    USART_FLAG_PERR = 0, USART_FLAG_FERR, USART_FLAG_NERR, USART_FLAG_ORERR,
+    USART_FLAG_IDLE, USART_FLAG_RBNE, USART_FLAG_TC, USART_FLAG_TBE
+} usart_flag_enum;
+
+typedef enum
+{
+    USART_INT_IDLE = BIT(4),
+    USART_INT_RBNE = BIT(5),
+    USART_INT_TC   = BIT(6),
+    USART_INT_TBE  = BIT(7),
+    USART_INT_PERR = BIT(8),
+    USART_INT_ERR  = BIT(16),
+} usart_interrupt_enum;
+
+typedef enum
+{
+    USART_INT_FLAG_PERR = (8 << 8) | 0,
+    USART_INT_FLAG_IDLE = (4 << 8) | 4,
+    USART_INT_FLAG_RBNE = (5 << 8) | 5,
+    USART_INT_FLAG_TC   = (6 << 8) | 6,
+} usart_interrupt_flag_enum;
+
+#define USART_RECEIVE_ENABLE            BIT(2)
+#define USART_RECEIVE_DISABLE           (0U)
+#define USART_TRANSMIT_ENABLE           BIT(3)
+#define USART_TRANSMIT_DISABLE          (0U)
+#define USART_DENR_ENABLE               BIT(6)
+#define USART_DENR_DISABLE              (0U)
+#define USART_DENT_ENABLE               BIT(7)
+#define USART_DENT_DISABLE              (0U)
+
+volatile uint32_t *Ql_Host_Usart_Reg(uint32_t usart_periph, uint32_t offset);
+void       usart_deinit(uint32_t usart_periph);
+void       usart_baudrate_set(uint32_t usart_periph, uint32_t baudval);
+void       usart_enable(uint32_t usart_periph);
+void       usart_disable(uint32_t usart_periph);
+void       usart_transmit_config(uint32_t usart_periph, uint32_t txconfig);
+void       usart_receive_config(uint32_t usart_periph, uint32_t rxconfig);
+void       usart_dma_receive_config(uint32_t usart_periph, uint32_t dmacmd);
+void       usart_dma_transmit_config(uint32_t usart_periph, uint32_t dmacmd);
+void       usart_data_transmit(uint32_t usart_periph, uint32_t data);
+FlagStatus usart_flag_get(uint32_t usart_periph, usart_flag_enum flag);
+void       usart_interrupt_enable(uint32_t usart_periph, usart_interrupt_enum interrupt);
+void       usart_interrupt_disable(uint32_t usart_periph, usart_interrupt_enum interrupt);
+FlagStatus usart_interrupt_flag_get(uint32_t usart_periph, usart_interrupt_flag_enum int_flag);
+void       usart_interrupt_flag_clear(uint32_t usart_periph, usart_interrupt_flag_enum int_flag);
+
+/* DMA: single data mode, byte wide. The addresses are uint32_t as on the
+   target, the programs that link the model are built with -no-pie */
+#define DMA0                            (0x40026000U)
+#define DMA1                            (DMA0 + 0x00000400U)
+
+#define DMA_CHXCTL_HTFIE                BIT(3)
+#define DMA_CHXCTL_FTFIE                BIT(4)
+#define DMA_INT_FLAG_HTF                BIT(4)
+#define DMA_INT_FLAG_FTF                BIT(5)
+#define DMA_FLAG_HTF                    DMA_INT_FLAG_HTF
+#define DMA_FLAG_FTF                    DMA_INT_FLAG_FTF
+
+#define DMA_PERIPH_TO_MEMORY            (0U)
+#define DMA_MEMORY_TO_PERIPH            (1U)
+#define DMA_MEMORY_0                    (0U)
+#define DMA_MEMORY_INCREASE_ENABLE      (0U)
+#define DMA_PERIPH_INCREASE_DISABLE     (1U)
+#define DMA_PERIPH_WIDTH_8BIT           (0U)
+#define DMA_PRIORITY_ULTRA_HIGH         (3U)
+#define DMA_CIRCULAR_MODE_DISABLE       (0U)
+
+typedef struct
+{
+    uint32_t periph_addr;
+    uint32_t periph_inc;
+    uint32_t memory0_addr;
+    uint32_t memory_inc;
+    uint32_t periph_memory_width;
+    uint32_t circular_mode;
+    uint32_t direction;
+    uint32_t number;
+    uint32_t priority;
+} dma_single_data_parameter_struct;
+
+void       dma_deinit(uint32_t dma_periph, dma_channel_enum channelx);
+void       dma_single_data_para_struct_init(dma_single_data_parameter_struct *init_struct);
+void       dma_single_data_mode_init(uint32_t dma_periph, dma_channel_enum channelx, dma_single_data_parameter_struct *init_struct);
+void       dma_circulation_disable(uint32_t dma_periph, dma_channel_enum channelx);
+void       dma_channel_subperipheral_select(uint32_t dma_periph, dma_channel_enum channelx, dma_subperipheral_enum sub_periph);
+void       dma_channel_enable(uint32_t dma_periph, dma_channel_enum channelx);
+void       dma_channel_disable(uint32_t dma_periph, dma_channel_enum channelx);
+void       dma_memory_address_config(uint32_t dma_periph, dma_channel_enum channelx, uint8_t memory_flag, uint32_t address);
+void       dma_transfer_number_config(uint32_t dma_periph, dma_channel_enum channelx, uint32_t number);
+uint32_t   dma_transfer_number_get(uint32_t dma_periph, dma_channel_enum channelx);
+void       dma_flag_clear(uint32_t dma_periph, dma_channel_enum channelx, uint32_t flag);
+void       dma_interrupt_enable(uint32_t dma_periph, dma_channel_enum channelx, uint32_t source);
+void       dma_interrupt_disable(uint32_t dma_periph, dma_channel_enum channelx, uint32_t source);
+FlagStatus dma_interrupt_flag_get(uint32_t dma_periph, dma_channel_enum channelx, uint32_t interrupt);
+void       dma_interrupt_flag_clear(uint32_t dma_periph, dma_channel_enum channelx, uint32_t interrupt);
+
+/* NVIC: enabled lines are dispatched by the model, priorities are not */
+void       nvic_irq_enable(uint8_t nvic_irq, uint8_t nvic_irq_pre_priority, uint8_t nvic_irq_sub_priority);
+void       nvic_irq_disable(uint8_t nvic_irq);
+
+/* GPIO and RCU: nothing to model */
+typedef enum
+{
+    RCU_GPIOA, RCU_GPIOB, RCU_GPIOC, RCU_GPIOD, RCU_GPIOF, RCU_DMA0, RCU_DMA1,
+    RCU_USART0, RCU_USART1, RCU_USART2, RCU_UART3, RCU_UART4, RCU_USART5, RCU_UART6
+} rcu_periph_enum;
+
+#define GPIOA                           (0x40020000U)
+#define GPIOB                           (0x40020400U)
+#define GPIOC                           (0x40020800U)
+#define GPIOD                           (0x40020C00U)
+#define GPIOF                           (0x40021400U)
+#define GPIO_PIN_0                      BIT(0)
+#define GPIO_PIN_1                      BIT(1)
+#define GPIO_PIN_2                      BIT(2)
+#define GPIO_PIN_3                      BIT(3)
+#define GPIO_PIN_5                      BIT(5)
+#define GPIO_PIN_6                      BIT(6)
+#define GPIO_PIN_7                      BIT(7)
+#define GPIO_PIN_9                      BIT(9)
+#define GPIO_PIN_10                     BIT(10)
+#define GPIO_PIN_11                     BIT(11)
+#define GPIO_PIN_12                     BIT(12)
+#define GPIO_AF_7                       (7U)
+#define GPIO_AF_8                       (8U)
+#define GPIO_MODE_AF                    (2U)
+#define GPIO_PUPD_NONE                  (0U)
+#define GPIO_PUPD_PULLUP                (1U)
+#define GPIO_OTYPE_PP                   (0U)
+#define GPIO_OSPEED_50MHZ               (2U)
+
+static inline void rcu_periph_clock_enable(rcu_periph_enum periph)  { (void)periph; }
+static inline void rcu_periph_clock_disable(rcu_periph_enum periph) { (void)periph; }
+static inline void gpio_af_set(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin)
+{
+    (void)gpio_periph; (void)alt_func_num; (void)pin;
+}
+static inline void gpio_mode_set(uint32_t gpio_periph, uint32_t mode, uint32_t pull_up_down, uint32_t pin)
+{
+    (void)gpio_periph; (void)mode; (void)pull_up_down; (void)pin;
+}
+static inline void gpio_output_options_set(uint32_t gpio_periph, uint8_t otype, uint32_t speed, uint32_t pin)
+{
+    (void)gpio_periph; (void)otype; (void)speed; (void)pin;
+}
+
+#define DWT                             (Ql_Host_Dwt())
+#define CoreDebug                       (&Ql_Host_CoreDebug)
+#define DWT_CTRL_CYCCNTENA_Msk          (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk      (1UL << 24)
+
+#define __DMB()                         __sync_synchronize()
+#define __DSB()                         __sync_synchronize()
+#define __ISB()                         __sync_synchronize()
+#define __NOP()                         do { } while (0)
+#define __LDREXW(Addr)                  Ql_Host_Ldrex((volatile uint32_t *)(Addr))
+#define __STREXW(Val, Addr)             Ql_Host_Strex((Val), (volatile uint32_t *)(Addr))
+#define __CLREX()                       Ql_Host_Clrex()
+#define __get_IPSR()                    Ql_Host_Ipsr()
+#define __get_PRIMASK()                 Ql_Host_Primask_Get()
+#define __set_PRIMASK(x)                Ql_Host_Primask_Set(x)
+#define __disable_irq()                 Ql_Host_Primask_Set(1U)
+#define __enable_irq()                  Ql_Host_Primask_Set(0U)
+#define __CLZ(x)                        ((uint8_t)(((x) == 0U) ? 32U : (uint32_t)__builtin_clz(x)))
+#define __RBIT(x)                       Ql_Host_Rbit(x)
+#define __REV(x)                        __builtin_bswap32(x)
+
+static inline uint32_t Ql_Host_Rbit(uint32_t x)
+{
+    uint32_t r = 0;
+
+    for (uint32_t i = 0; i < 32U; i++)
+    {
+        r = (r << 1) | ((x >> i) & 1U);
+    }
+    return r;
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_HOST_H_
+#define __QL_HOST_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Host build of the components: the tasks are threads of which one runs at
+   a time, the highest priority ready one, and it is only switched out where
+   it blocks or gives a higher priority task something to do.
+
+   Time is virtual, 1 tick = 1 ms, kept in us. It moves when every task
+   waits, to the next wake up, and when a task spends simulated CPU time.
+   The host's own run time does not count unless Ql_Host_Dwt_Cpu is on, so
+   a run gives the same figures on any machine. */
+#define QL_HOST_TASKS_MAX           (32U)
+#define QL_HOST_MAIN_PRIORITY       (1U)        // of main(), registered on its first call
+
+uint64_t Ql_Host_Now_Us(void);
+uint64_t getus(void);                           // ql_delay.h
+void     delay_us(uint32_t us);
+
+/* ulTaskNotifyTake(pdTRUE) with a deadline in us of the virtual clock
+   instead of ticks, for the device models of the port */
+uint32_t Ql_Host_Notify_Take_Until(uint64_t Us);
+
+/* Wait Us for a device: the caller blocks, other tasks run meanwhile */
+void     Ql_Host_Busy_Us(uint32_t Us);
+
+/* Spend Us of CPU: higher priority tasks that wake up in between run
+   first, lower ones wait. Counted per task */
+void     Ql_Host_Cpu_Us(uint32_t Us);
+uint64_t Ql_Host_Cpu_Total_Us(void *Task);     // NULL: the calling task
+
+/* DWT->CYCCNT of gd32f4xx.h is the virtual clock at SystemCoreClock. With
+   Enable the host CPU time of the process is added, for benches of code
+   that only computes */
+void     Ql_Host_Dwt_Cpu(uint8_t Enable);
+uint32_t Ql_Host_Cycles(void);
+
+/* Core registers of gd32f4xx.h. A task marked Isr stands for an interrupt
+   handler: __get_IPSR() is not 0 while it runs. PRIMASK defers the switches
+   as taskENTER_CRITICAL does. Every switch clears the exclusive monitor, a
+   STREX after it fails; with Ql_Host_Excl_Us each LDREX spends that much
+   CPU, so higher priority tasks get in between LDREX and STREX */
+struct ql_host_task;
+void     Ql_Host_Task_Isr(struct ql_host_task *Task, uint8_t Isr);
+uint32_t Ql_Host_Ipsr(void);
+uint32_t Ql_Host_Primask_Get(void);
+void     Ql_Host_Primask_Set(uint32_t Primask);
+void     Ql_Host_Excl_Us(uint32_t Us);
+uint32_t Ql_Host_Ldrex(volatile uint32_t *Addr);
+uint32_t Ql_Host_Strex(uint32_t Val, volatile uint32_t *Addr);
+void     Ql_Host_Clrex(void);
+uint32_t Ql_Host_Strex_Failed(void);             // STREX that failed so far
+
+/* vsnprintf that spends the CPU of the formatting, for the files built with
+   -Dvsnprintf=Ql_Host_Vsnprintf */
+int      Ql_Host_Vsnprintf(char *Buf, size_t Size, const char *Fmt, va_list Args);
+
+#endif
@@ -0,0 +1,90 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host_card.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "ql_host_card.h"
+
+int __real_IMG_disk_read(uint8_t *buff, uint32_t sector, uint32_t count);
+int __real_IMG_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count);
+
+static Ql_Host_Card_TypeDef Host_Card =
+{
+    QL_HOST_CARD_READ_CMD_US, QL_HOST_CARD_WRITE_CMD_US, QL_HOST_CARD_SECTOR_US, -1, 0, 0, 0, 0, 0
+};
+
+Ql_Host_Card_TypeDef *Ql_Host_Card(void)
+{
+    return &Host_Card;
+}
+
+void Ql_Host_Card_Cut(uint32_t Writes)
+{
+    Host_Card.Cut_After = (int32_t)Writes;
+}
+
+void Ql_Host_Card_Power_On(void)
+{
+    Host_Card.Dead = 0;
+    Host_Card.Cut_After = -1;
+}
+
+int __wrap_IMG_disk_read(uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    if (Host_Card.Dead)
+    {
+        return 1;
+    }
+    Host_Card.Reads++;
+    Host_Card.Read_Sectors += count;
+    Ql_Host_Busy_Us(Host_Card.Read_Cmd_Us + Host_Card.Sector_Us * count);
+    return __real_IMG_disk_read(buff, sector, count);
+}
+
+int __wrap_IMG_disk_write(const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    uint32_t n;
+
+    if (Host_Card.Dead)
+    {
+        return 1;
+    }
+    if (Host_Card.Cut_After == 0)
+    {
+        n = (uint32_t)rand() % (count + 1);
+        if (n != 0)
+        {
+            __real_IMG_disk_write(buff, sector, n);
+        }
+        Host_Card.Dead = 1;
+        return 1;
+    }
+    if (Host_Card.Cut_After > 0)
+    {
+        Host_Card.Cut_After--;
+    }
+    Host_Card.Writes++;
+    Host_Card.Write_Sectors += count;
+    Ql_Host_Busy_Us(Host_Card.Write_Cmd_Us + Host_Card.Sector_Us * count);
+    return __real_IMG_disk_write(buff, sector, count);
+}
@@ -0,0 +1,57 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host_card.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_HOST_CARD_H_
+#define __QL_HOST_CARD_H_
+
+#include <stdint.h>
+
+/* SD card model over the image backend of ql_ff_disk.c (QL_DISK_HOST).
+   Linked with -Wl,--wrap=IMG_disk_read,--wrap=IMG_disk_write: every
+   transfer waits the command and per sector time on the virtual clock, and
+   the power can be cut at a write */
+typedef struct
+{
+    uint32_t    Read_Cmd_Us;        // per read transfer
+    uint32_t    Write_Cmd_Us;       // per write transfer, incl. the programming
+    uint32_t    Sector_Us;          // per 512 byte sector on the bus
+    int32_t     Cut_After;          // write transfers until the power fails, -1: never
+    uint8_t     Dead;               // power gone: every transfer fails
+    uint32_t    Reads;
+    uint32_t    Writes;
+    uint32_t    Read_Sectors;
+    uint32_t    Write_Sectors;
+} Ql_Host_Card_TypeDef;
+
+/* 4 bit bus at 25 MHz and a class 10 card, typical figures */
+#define QL_HOST_CARD_READ_CMD_US    (200U)
+#define QL_HOST_CARD_WRITE_CMD_US   (1000U)
+#define QL_HOST_CARD_SECTOR_US      (45U)
+
+Ql_Host_Card_TypeDef *Ql_Host_Card(void);
+
+/* The write transfer after Writes more lands a random prefix of its
+   sectors, nothing after it reaches the image */
+void Ql_Host_Card_Cut(uint32_t Writes);
+void Ql_Host_Card_Power_On(void);
+
+#endif
@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host_log.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+/* ql_log.c stand-in of the host build: ql_log.h is the real one, the lines
+   go straight to stdout with the virtual time in front. No ring, no UART
+   and no copy of W and E lines to the flash event log */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "ql_log.h"
+
+static Ql_Log_Tag_TypeDef *Host_Log_Tags = NULL;
+static uint8_t Host_Log_Level = QL_LOG_LEVEL_UNSET;    // "*" of Ql_Log_Level_Set
+
+int Ql_Log_MutexTake(void)
+{
+    return 0;
+}
+
+int Ql_Log_MutexGive(void)
+{
+    return 0;
+}
+
+void Ql_Printf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+void Ql_Log_Text(const char *Fmt, ...)
+{
+    const uint64_t us = Ql_Host_Now_Us();
+    va_list args;
+
+    printf("%6u.%03u ", (uint32_t)(us / 1000000U), (uint32_t)(us / 1000U % 1000U));
+    va_start(args, Fmt);
+    vprintf(Fmt, args);
+    va_end(args);
+    printf("\n");
+}
+
+uint8_t Ql_Log_Tag_Register(Ql_Log_Tag_TypeDef *Tag, uint8_t Level)
+{
+    if (Tag->Level == QL_LOG_LEVEL_UNSET)
+    {
+        Tag->Level = (Host_Log_Level != QL_LOG_LEVEL_UNSET) ? Host_Log_Level : Tag->Default;
+        Tag->Next = Host_Log_Tags;
+        Host_Log_Tags = Tag;
+    }
+    return (Level <= Tag->Level);
+}
+
+int32_t Ql_Log_Level_Set(const char *Tag, uint8_t Level)
+{
+    const uint8_t all = (strcmp(Tag, "*") == 0);
+
+    if (Level > QL_LOG_DEBUG)
+    {
+        return -1;
+    }
+    if (all)
+    {
+        Host_Log_Level = Level;
+    }
+    for (Ql_Log_Tag_TypeDef *tag = Host_Log_Tags; tag != NULL; tag = tag->Next)
+    {
+        if (all || (strcmp(tag->Name, Tag) == 0))
+        {
+            tag->Level = Level;
+        }
+    }
+    return 0;
+}
+
+int32_t Ql_Log_Level_Save(void)
+{
+    return 0;
+}
+
+void Ql_Log_Flash_Enable(uint8_t Enable)
+{
+    (void)Enable;
+}
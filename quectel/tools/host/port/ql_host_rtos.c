@@ -0,0 +1,962 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host_rtos.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "gd32f4xx.h"
+
+#define QL_HOST_NO_WAKE             UINT64_MAX
+#define QL_HOST_TIMERS_MAX          (16U)
+
+typedef enum
+{
+    QL_HOST_FREE = 0,
+    QL_HOST_READY,
+    QL_HOST_RUNNING,
+    QL_HOST_DELAYED,            // vTaskDelay or Ql_Host_Busy_Us, until Wake_Us
+    QL_HOST_BLOCKED,            // on Wait_Obj, until Wake_Us at the latest
+    QL_HOST_DELETED,            // by another task, its thread never runs again
+} Ql_Host_State_TypeDef;
+
+struct ql_host_task
+{
+    pthread_cond_t      Cond;
+    uint8_t             State;
+    uint8_t             Timed_Out;
+    UBaseType_t         Priority;
+    uint64_t            Ready_Seq;  // FIFO among equal priorities
+    uint64_t            Wake_Us;
+    const void         *Wait_Obj;   // a queue, or the task itself for its notification
+    uint32_t            Notify;
+    uint64_t            Cpu_Us;
+    uint32_t            Critical;   // taskENTER_CRITICAL nesting
+    uint8_t             Preempted;  // a switch waits for taskEXIT_CRITICAL
+    uint8_t             Isr;        // __get_IPSR() != 0 while it runs, see Ql_Host_Task_Isr
+    TaskFunction_t      Code;
+    void               *Param;
+    const char         *Name;
+};
+
+struct ql_host_timer
+{
+    const char             *Name;
+    TickType_t              Period;
+    UBaseType_t             Auto_Reload;
+    void                   *Id;
+    TimerCallbackFunction_t Callback;
+    uint8_t                 Active;
+    uint64_t                Expiry_Us;
+};
+
+struct ql_host_queue
+{
+    uint8_t            *Buf;
+    UBaseType_t         Length;
+    UBaseType_t         Item_Size;
+    UBaseType_t         Head;
+    UBaseType_t         Count;
+};
+
+static pthread_mutex_t Host_Lock = PTHREAD_MUTEX_INITIALIZER;
+static struct ql_host_task Host_Task[QL_HOST_TASKS_MAX];
+static struct ql_host_task *Host_Cur = NULL;
+static __thread struct ql_host_task *Host_Self = NULL;
+static uint64_t Host_Clock_Us = 0;
+static uint64_t Host_Ready_Seq = 0;
+static uint8_t  Host_Dwt_Cpu = 0;
+static uint64_t Host_Dwt_Cpu_Base = 0;
+static Ql_Host_Dwt_TypeDef Host_Dwt;
+static struct ql_host_timer Host_Timer[QL_HOST_TIMERS_MAX];
+static uint32_t Host_Timer_Num = 0;
+static TaskHandle_t Host_Timer_Task = NULL;
+static volatile uint32_t *Host_Excl_Addr = NULL;   // exclusive monitor of LDREX/STREX
+static uint32_t Host_Excl_Us = 0;
+static uint32_t Host_Strex_Failed = 0;
+static uint32_t Host_Primask = 0;
+
+Ql_Host_CoreDebug_TypeDef Ql_Host_CoreDebug;
+uint32_t SystemCoreClock = 240000000U;
+
+static void Host_Make_Ready(struct ql_host_task *Task)
+{
+    Task->State     = QL_HOST_READY;
+    Task->Ready_Seq = ++Host_Ready_Seq;
+    Task->Wait_Obj  = NULL;
+}
+
+/* The thread calling in first, main(), becomes a task */
+static struct ql_host_task *Host_Self_Get(void)
+{
+    if (Host_Self == NULL)
+    {
+        for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+        {
+            if (Host_Task[i].State == QL_HOST_FREE)
+            {
+                Host_Self = &Host_Task[i];
+                break;
+            }
+        }
+        configASSERT(Host_Self != NULL);
+        memset(Host_Self, 0, sizeof(*Host_Self));
+        pthread_cond_init(&Host_Self->Cond, NULL);
+        Host_Self->Priority = QL_HOST_MAIN_PRIORITY;
+        Host_Self->Name     = "main";
+        Host_Self->State    = QL_HOST_RUNNING;
+        configASSERT(Host_Cur == NULL);
+        Host_Cur = Host_Self;
+    }
+    return Host_Self;
+}
+
+static void Host_Wake_Due(void)
+{
+    for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+    {
+        struct ql_host_task *task = &Host_Task[i];
+
+        if (((task->State == QL_HOST_DELAYED) || (task->State == QL_HOST_BLOCKED)) && (task->Wake_Us <= Host_Clock_Us))
+        {
+            task->Timed_Out = (task->State == QL_HOST_BLOCKED);
+            Host_Make_Ready(task);
+        }
+    }
+}
+
+static struct ql_host_task *Host_Pick(void)
+{
+    struct ql_host_task *best = NULL;
+
+    for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+    {
+        struct ql_host_task *task = &Host_Task[i];
+
+        if ((task->State == QL_HOST_READY) &&
+            ((best == NULL) || (task->Priority > best->Priority) ||
+             ((task->Priority == best->Priority) && (task->Ready_Seq < best->Ready_Seq))))
+        {
+            best = task;
+        }
+    }
+    return best;
+}
+
+/* Earliest wake up of the waiting tasks above Priority, QL_HOST_NO_WAKE if none */
+static uint64_t Host_Next_Wake(UBaseType_t Priority, uint8_t Any)
+{
+    uint64_t wake = QL_HOST_NO_WAKE;
+
+    for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+    {
+        const struct ql_host_task *task = &Host_Task[i];
+
+        if (((task->State == QL_HOST_DELAYED) || (task->State == QL_HOST_BLOCKED)) &&
+            (Any || (task->Priority > Priority)) && (task->Wake_Us < wake))
+        {
+            wake = task->Wake_Us;
+        }
+    }
+    return wake;
+}
+
+static void Host_Deadlock(void)
+{
+    fprintf(stderr, "host rtos: every task waits forever at %llu us\n", (unsigned long long)Host_Clock_Us);
+    for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+    {
+        if (Host_Task[i].State == QL_HOST_BLOCKED)
+        {
+            fprintf(stderr, "  %s blocked\n", Host_Task[i].Name);
+        }
+    }
+    exit(3);
+}
+
+/* The caller has left QL_HOST_RUNNING: run the next task, back when it is
+   the turn of the caller again. Called and left with Host_Lock held */
+static void Host_Switch(struct ql_host_task *Self)
+{
+    struct ql_host_task *next;
+
+    for (;;)
+    {
+        Host_Wake_Due();
+        next = Host_Pick();
+        if (next != NULL)
+        {
+            break;
+        }
+        Host_Clock_Us = Host_Next_Wake(0, 1);
+        if (Host_Clock_Us == QL_HOST_NO_WAKE)
+        {
+            Host_Deadlock();
+        }
+    }
+
+    next->State = QL_HOST_RUNNING;
+    Host_Cur = next;
+    if (next == Self)
+    {
+        return;
+    }
+    /* Exception entry and return clear the local monitor on the target */
+    Host_Excl_Addr = NULL;
+    pthread_cond_signal(&next->Cond);
+    if (Self->State == QL_HOST_FREE)
+    {
+        return;
+    }
+    while (Host_Cur != Self)
+    {
+        pthread_cond_wait(&Self->Cond, &Host_Lock);
+    }
+}
+
+/* A higher priority task made ready runs first, as on the target */
+static void Host_Preempt(struct ql_host_task *Self)
+{
+    const struct ql_host_task *next = Host_Pick();
+
+    if ((next != NULL) && (next->Priority > Self->Priority))
+    {
+        if (Self->Critical != 0)
+        {
+            Self->Preempted = 1;
+            return;
+        }
+        Host_Make_Ready(Self);
+        Host_Switch(Self);
+    }
+}
+
+static void Host_Wake_Waiters(const void *Obj)
+{
+    for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+    {
+        if ((Host_Task[i].State == QL_HOST_BLOCKED) && (Host_Task[i].Wait_Obj == Obj))
+        {
+            Host_Task[i].Timed_Out = 0;
+            Host_Make_Ready(&Host_Task[i]);
+        }
+    }
+}
+
+static uint64_t Host_Deadline(TickType_t Ticks)
+{
+    if (Ticks == portMAX_DELAY)
+    {
+        return QL_HOST_NO_WAKE;
+    }
+    return (Host_Clock_Us / 1000U + Ticks) * 1000U;
+}
+
+/* Wait on Obj until Deadline, 0 once it has passed */
+static int Host_Block(struct ql_host_task *Self, const void *Obj, uint64_t Deadline)
+{
+    if (Deadline <= Host_Clock_Us)
+    {
+        return 0;
+    }
+    Self->State     = QL_HOST_BLOCKED;
+    Self->Wait_Obj  = Obj;
+    Self->Wake_Us   = Deadline;
+    Self->Timed_Out = 0;
+    Host_Switch(Self);
+    return !Self->Timed_Out;
+}
+
+static void *Host_Thread(void *Arg)
+{
+    struct ql_host_task *task = (struct ql_host_task *)Arg;
+
+    pthread_mutex_lock(&Host_Lock);
+    Host_Self = task;
+    while (Host_Cur != task)
+    {
+        pthread_cond_wait(&task->Cond, &Host_Lock);
+    }
+    pthread_mutex_unlock(&Host_Lock);
+
+    task->Code(task->Param);
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                       void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+    struct ql_host_task *self;
+    struct ql_host_task *task = NULL;
+    pthread_t thread;
+
+    (void)usStackDepth;
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    for (uint32_t i = 0; i < QL_HOST_TASKS_MAX; i++)
+    {
+        if (Host_Task[i].State == QL_HOST_FREE)
+        {
+            task = &Host_Task[i];
+            break;
+        }
+    }
+    if (task == NULL)
+    {
+        pthread_mutex_unlock(&Host_Lock);
+        return pdFAIL;
+    }
+
+    memset(task, 0, sizeof(*task));
+    pthread_cond_init(&task->Cond, NULL);
+    task->Code     = pxTaskCode;
+    task->Param    = pvParameters;
+    task->Priority = uxPriority;
+    task->Name     = pcName;
+    Host_Make_Ready(task);
+    if (pthread_create(&thread, NULL, Host_Thread, task) != 0)
+    {
+        task->State = QL_HOST_FREE;
+        pthread_mutex_unlock(&Host_Lock);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (pxCreatedTask != NULL)
+    {
+        *pxCreatedTask = task;
+    }
+    Host_Preempt(self);
+    pthread_mutex_unlock(&Host_Lock);
+
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    if ((xTaskToDelete != NULL) && (xTaskToDelete != self))
+    {
+        /* Its thread stays parked, the slot is never used again */
+        xTaskToDelete->State = QL_HOST_DELETED;
+        pthread_mutex_unlock(&Host_Lock);
+        return;
+    }
+    self->State = QL_HOST_FREE;
+    Host_Switch(self);
+    pthread_mutex_unlock(&Host_Lock);
+    pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    if (xTicksToDelay == 0)
+    {
+        Host_Make_Ready(self);
+    }
+    else
+    {
+        self->State   = QL_HOST_DELAYED;
+        self->Wake_Us = Host_Deadline(xTicksToDelay);
+    }
+    Host_Switch(self);
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    *pxPreviousWakeTime += xTimeIncrement;
+    self->State   = QL_HOST_DELAYED;
+    self->Wake_Us = (uint64_t)*pxPreviousWakeTime * 1000U;
+    Host_Switch(self);
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(Host_Clock_Us / 1000U);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    TaskHandle_t self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    pthread_mutex_unlock(&Host_Lock);
+    return self;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask)
+{
+    UBaseType_t priority;
+
+    pthread_mutex_lock(&Host_Lock);
+    priority = ((xTask != NULL) ? xTask : Host_Self_Get())->Priority;
+    pthread_mutex_unlock(&Host_Lock);
+    return priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    ((xTask != NULL) ? xTask : self)->Priority = uxNewPriority;
+    Host_Preempt(self);
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    xTaskToNotify->Notify++;
+    Host_Wake_Waiters(xTaskToNotify);
+    Host_Preempt(self);
+    pthread_mutex_unlock(&Host_Lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    xTaskNotifyGive(xTaskToNotify);
+}
+
+void vPortEnterCritical(void)
+{
+    pthread_mutex_lock(&Host_Lock);
+    Host_Self_Get()->Critical++;
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+void vPortExitCritical(void)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    configASSERT(self->Critical != 0);
+    if ((--self->Critical == 0) && self->Preempted)
+    {
+        self->Preempted = 0;
+        Host_Preempt(self);
+    }
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+static uint32_t Host_Notify_Take(BaseType_t Clear, uint64_t Deadline)
+{
+    struct ql_host_task *self;
+    uint32_t value;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    while ((self->Notify == 0) && Host_Block(self, self, Deadline))
+    {
+    }
+    value = self->Notify;
+    if (value != 0)
+    {
+        self->Notify = Clear ? 0 : (value - 1);
+    }
+    pthread_mutex_unlock(&Host_Lock);
+    return value;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    uint64_t deadline;
+
+    pthread_mutex_lock(&Host_Lock);
+    deadline = Host_Deadline(xTicksToWait);
+    pthread_mutex_unlock(&Host_Lock);
+    return Host_Notify_Take(xClearCountOnExit, deadline);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    struct ql_host_queue *queue = calloc(1, sizeof(*queue));
+
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue->Length    = uxQueueLength;
+    queue->Item_Size = uxItemSize;
+    if (uxItemSize != 0)
+    {
+        queue->Buf = calloc(uxQueueLength, uxItemSize);
+        if (queue->Buf == NULL)
+        {
+            free(queue);
+            return NULL;
+        }
+    }
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+    if (xQueue != NULL)
+    {
+        free(xQueue->Buf);
+        free(xQueue);
+    }
+}
+
+static BaseType_t Host_Queue_Send(QueueHandle_t Queue, const void *Item, TickType_t Ticks)
+{
+    struct ql_host_task *self;
+    uint64_t deadline;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    deadline = Host_Deadline(Ticks);
+    while (Queue->Count == Queue->Length)
+    {
+        if (!Host_Block(self, Queue, deadline))
+        {
+            pthread_mutex_unlock(&Host_Lock);
+            return pdFAIL;
+        }
+    }
+    if ((Queue->Item_Size != 0) && (Item != NULL))
+    {
+        memcpy(Queue->Buf + ((Queue->Head + Queue->Count) % Queue->Length) * Queue->Item_Size, Item, Queue->Item_Size);
+    }
+    Queue->Count++;
+    Host_Wake_Waiters(Queue);
+    Host_Preempt(self);
+    pthread_mutex_unlock(&Host_Lock);
+    return pdPASS;
+}
+
+static BaseType_t Host_Queue_Receive(QueueHandle_t Queue, void *Buf, TickType_t Ticks)
+{
+    struct ql_host_task *self;
+    uint64_t deadline;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    deadline = Host_Deadline(Ticks);
+    while (Queue->Count == 0)
+    {
+        if (!Host_Block(self, Queue, deadline))
+        {
+            pthread_mutex_unlock(&Host_Lock);
+            return pdFAIL;
+        }
+    }
+    if ((Queue->Item_Size != 0) && (Buf != NULL))
+    {
+        memcpy(Buf, Queue->Buf + Queue->Head * Queue->Item_Size, Queue->Item_Size);
+    }
+    Queue->Head = (Queue->Head + 1) % Queue->Length;
+    Queue->Count--;
+    Host_Wake_Waiters(Queue);
+    Host_Preempt(self);
+    pthread_mutex_unlock(&Host_Lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+    return Host_Queue_Send(xQueue, pvItemToQueue, xTicksToWait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return Host_Queue_Send(xQueue, pvItemToQueue, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+    return Host_Queue_Receive(xQueue, pvBuffer, xTicksToWait);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+    {
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    }
+    return Host_Queue_Receive(xQueue, pvBuffer, 0);
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+    pthread_mutex_lock(&Host_Lock);
+    xQueue->Head  = 0;
+    xQueue->Count = 0;
+    Host_Wake_Waiters(xQueue);
+    pthread_mutex_unlock(&Host_Lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+    return xQueue->Count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+
+    if (mutex != NULL)
+    {
+        mutex->Count = 1;
+    }
+    return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+    SemaphoreHandle_t sem = xQueueCreate(uxMaxCount, 0);
+
+    if (sem != NULL)
+    {
+        sem->Count = uxInitialCount;
+    }
+    return sem;
+}
+
+/* The daemon of the timers: runs the callbacks that are due, then sleeps
+   until the next expiry or until a timer is started */
+static void Host_Timer_Daemon(void *Param)
+{
+    uint64_t next;
+
+    (void)Param;
+    for (;;)
+    {
+        next = QL_HOST_NO_WAKE;
+        for (uint32_t i = 0; i < Host_Timer_Num; i++)
+        {
+            struct ql_host_timer *timer = &Host_Timer[i];
+
+            if (timer->Active && (timer->Expiry_Us <= Host_Clock_Us))
+            {
+                if (timer->Auto_Reload)
+                {
+                    timer->Expiry_Us += (uint64_t)timer->Period * 1000U;
+                }
+                else
+                {
+                    timer->Active = 0;
+                }
+                timer->Callback(timer);
+            }
+            if (timer->Active && (timer->Expiry_Us < next))
+            {
+                next = timer->Expiry_Us;
+            }
+        }
+        Ql_Host_Notify_Take_Until(next);
+    }
+}
+
+TimerHandle_t xTimerCreate(const char *pcTimerName, TickType_t xTimerPeriodInTicks, UBaseType_t uxAutoReload,
+                           void *pvTimerID, TimerCallbackFunction_t pxCallbackFunction)
+{
+    struct ql_host_timer *timer;
+
+    if ((xTimerPeriodInTicks == 0) || (Host_Timer_Num >= QL_HOST_TIMERS_MAX))
+    {
+        return NULL;
+    }
+    if ((Host_Timer_Task == NULL) &&
+        (xTaskCreate(Host_Timer_Daemon, "Tmr Svc", configMINIMAL_STACK_SIZE * 2U, NULL,
+                     configTIMER_TASK_PRIORITY, &Host_Timer_Task) != pdPASS))
+    {
+        return NULL;
+    }
+
+    timer = &Host_Timer[Host_Timer_Num++];
+    memset(timer, 0, sizeof(*timer));
+    timer->Name        = pcTimerName;
+    timer->Period      = xTimerPeriodInTicks;
+    timer->Auto_Reload = uxAutoReload;
+    timer->Id          = pvTimerID;
+    timer->Callback    = pxCallbackFunction;
+    return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t xTimer, TickType_t xTicksToWait)
+{
+    (void)xTicksToWait;
+    xTimer->Expiry_Us = (Host_Clock_Us / 1000U + xTimer->Period) * 1000U;
+    xTimer->Active    = 1;
+    xTaskNotifyGive(Host_Timer_Task);
+    return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t xTimer, TickType_t xTicksToWait)
+{
+    (void)xTicksToWait;
+    xTimer->Active = 0;
+    return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t xTimer)
+{
+    return xTimer->Active ? pdTRUE : pdFALSE;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t xTimer)
+{
+    return xTimer->Id;
+}
+
+uint64_t Ql_Host_Now_Us(void)
+{
+    return Host_Clock_Us;
+}
+
+uint32_t Ql_Host_Notify_Take_Until(uint64_t Us)
+{
+    return Host_Notify_Take(pdTRUE, Us);
+}
+
+uint64_t getus(void)
+{
+    return Host_Clock_Us;
+}
+
+/* The loop of ql_delay.c spins the CPU */
+void delay_us(uint32_t us)
+{
+    Ql_Host_Cpu_Us(us);
+}
+
+void Ql_Host_Busy_Us(uint32_t Us)
+{
+    struct ql_host_task *self;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    self->State   = QL_HOST_DELAYED;
+    self->Wake_Us = Host_Clock_Us + Us;
+    Host_Switch(self);
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+void Ql_Host_Cpu_Us(uint32_t Us)
+{
+    struct ql_host_task *self;
+    uint64_t left = Us;
+    uint64_t wake;
+    uint64_t step;
+
+    pthread_mutex_lock(&Host_Lock);
+    self = Host_Self_Get();
+    while (left != 0)
+    {
+        wake = Host_Next_Wake(self->Priority, 0);
+        step = ((wake == QL_HOST_NO_WAKE) || (wake >= Host_Clock_Us + left)) ? left :
+               ((wake > Host_Clock_Us) ? (wake - Host_Clock_Us) : 0);
+        Host_Clock_Us += step;
+        self->Cpu_Us  += step;
+        left          -= step;
+        if (left != 0)
+        {
+            Host_Wake_Due();
+            Host_Preempt(self);
+        }
+    }
+    pthread_mutex_unlock(&Host_Lock);
+}
+
+void Ql_Host_Task_Isr(TaskHandle_t Task, uint8_t Isr)
+{
+    Task->Isr = Isr;
+}
+
+uint32_t Ql_Host_Ipsr(void)
+{
+    uint32_t ipsr;
+
+    pthread_mutex_lock(&Host_Lock);
+    ipsr = Host_Self_Get()->Isr ? 16U : 0U;
+    pthread_mutex_unlock(&Host_Lock);
+    return ipsr;
+}
+
+/* PRIMASK masks the interrupts, here the switches to another task */
+uint32_t Ql_Host_Primask_Get(void)
+{
+    return Host_Primask;
+}
+
+void Ql_Host_Primask_Set(uint32_t Primask)
+{
+    if (Primask && !Host_Primask)
+    {
+        Host_Primask = 1;
+        vPortEnterCritical();
+    }
+    else if (!Primask && Host_Primask)
+    {
+        Host_Primask = 0;
+        vPortExitCritical();
+    }
+}
+
+void Ql_Host_Excl_Us(uint32_t Us)
+{
+    Host_Excl_Us = Us;
+}
+
+uint32_t Ql_Host_Ldrex(volatile uint32_t *Addr)
+{
+    const uint32_t val = *Addr;
+
+    Host_Excl_Addr = Addr;
+    if (Host_Excl_Us != 0)
+    {
+        Ql_Host_Cpu_Us(Host_Excl_Us);
+    }
+    return val;
+}
+
+uint32_t Ql_Host_Strex(uint32_t Val, volatile uint32_t *Addr)
+{
+    if (Host_Excl_Addr != Addr)
+    {
+        Host_Strex_Failed++;
+        return 1;
+    }
+    *Addr = Val;
+    Host_Excl_Addr = NULL;
+    return 0;
+}
+
+void Ql_Host_Clrex(void)
+{
+    Host_Excl_Addr = NULL;
+}
+
+uint32_t Ql_Host_Strex_Failed(void)
+{
+    return Host_Strex_Failed;
+}
+
+/* vsnprintf of the files built with -Dvsnprintf=Ql_Host_Vsnprintf, costs
+   about 500 cycles plus 30 per character at 240 MHz */
+int Ql_Host_Vsnprintf(char *Buf, size_t Size, const char *Fmt, va_list Args)
+{
+    const int len = vsnprintf(Buf, Size, Fmt, Args);
+
+    Ql_Host_Cpu_Us(2U + ((len > 0) ? ((uint32_t)len / 8U) : 0U));
+    return len;
+}
+
+uint64_t Ql_Host_Cpu_Total_Us(void *Task)
+{
+    uint64_t us;
+
+    pthread_mutex_lock(&Host_Lock);
+    us = ((Task != NULL) ? (struct ql_host_task *)Task : Host_Self_Get())->Cpu_Us;
+    pthread_mutex_unlock(&Host_Lock);
+    return us;
+}
+
+static uint64_t Host_Process_Cpu_Ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+void Ql_Host_Dwt_Cpu(uint8_t Enable)
+{
+    Host_Dwt_Cpu = Enable;
+    Host_Dwt_Cpu_Base = Host_Process_Cpu_Ns();
+}
+
+uint32_t Ql_Host_Cycles(void)
+{
+    const uint64_t mhz = SystemCoreClock / 1000000U;
+    uint64_t cycles = Host_Clock_Us * mhz;
+
+    if (Host_Dwt_Cpu)
+    {
+        cycles += (Host_Process_Cpu_Ns() - Host_Dwt_Cpu_Base) * mhz / 1000U;
+    }
+    return (uint32_t)cycles;
+}
+
+Ql_Host_Dwt_TypeDef *Ql_Host_Dwt(void)
+{
+    Host_Dwt.CYCCNT = Ql_Host_Cycles();
+    return &Host_Dwt;
+}
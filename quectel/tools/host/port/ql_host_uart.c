@@ -0,0 +1,971 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host_uart.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+/* USART and DMA of the GD32F4 for the real ql_uart.c: the registers the
+   driver touches, the DMA channels in single data mode, and a wire per
+   port that moves the bytes on the virtual clock. The model catches up on
+   every register access, the interrupt task sleeps until the next flag an
+   interrupt could be waiting for and calls the handlers of ql_uart.c */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "gd32f4xx.h"
+#include "ql_host_uart.h"
+
+#define HOST_UART_NUM               (7U)
+#define HOST_DMA_CHANNELS           (8U)
+#define HOST_IRQ_STORM              (64U)       // handler rounds at one instant before it is a storm
+#define HOST_NO_EVENT               UINT64_MAX
+
+#define HOST_USART_UEN              BIT(13)
+#define HOST_USART_RX_ON            (HOST_USART_UEN | USART_RECEIVE_ENABLE)
+#define HOST_USART_TX_ON            (HOST_USART_UEN | USART_TRANSMIT_ENABLE | USART_DENT_ENABLE)
+#define HOST_STAT0_CLEARED          (USART_STAT0_PERR | USART_STAT0_FERR | USART_STAT0_NERR | USART_STAT0_ORERR | USART_STAT0_IDLEF)
+#define HOST_DMA_CHEN               BIT(0)
+
+typedef struct
+{
+    uint64_t    End_Ns;         // stop bit done
+    uint32_t    Baud;           // of the sender
+    uint8_t     Data;
+} Host_Wire_Byte_TypeDef;
+
+typedef struct
+{
+    Host_Wire_Byte_TypeDef Byte[QL_HOST_UART_WIRE_SIZE];
+    uint32_t    Head;
+    uint32_t    Count;
+} Host_Wire_TypeDef;
+
+typedef struct
+{
+    uint32_t    Ctl;            // HOST_DMA_CHEN, DMA_CHXCTL_HTFIE, DMA_CHXCTL_FTFIE
+    uint32_t    Flags;          // DMA_INT_FLAG_HTF, DMA_INT_FLAG_FTF
+    uint32_t    Direction;
+    uint32_t    Periph;
+    uint32_t    Memory;
+    uint32_t    Number;
+    uint32_t    Count;
+} Host_Dma_TypeDef;
+
+typedef struct
+{
+    const uint32_t      Periph;
+    const IRQn_Type     Irqn;
+    void              (*const Handler)(void);
+    volatile uint32_t   Stat0;
+    volatile uint32_t   Data;
+    uint32_t            Ctl;        // HOST_USART_UEN and the REN, TEN, DENR, DENT bits
+    uint32_t            Int_En;     // usart_interrupt_enum
+    uint32_t            Baud;
+    uint8_t             Stat0_Read;
+    uint32_t            Noise;
+
+    /* Transmitter, fed by Tx_Dma */
+    Host_Dma_TypeDef   *Tx_Dma;
+    uint8_t             Tx_Busy;
+    uint32_t            Tx_Baud;
+    uint32_t            Tx_Sent;
+    uint64_t            Tx_Start_Ns;
+    uint64_t            Tx_Free_Ns;
+
+    /* Receiver, into Rx_Dma, from the far end */
+    Host_Dma_TypeDef   *Rx_Dma;
+    Host_Wire_TypeDef   Rx_Wire;
+    uint64_t            Rx_Last_Ns;
+    uint8_t             Rx_Idle_Armed;  // a byte came in since IDLEF
+
+    /* Far end */
+    uint32_t            Far_Baud;
+    uint64_t            Far_Free_Ns;
+    Host_Wire_TypeDef   Far_Wire;
+    SemaphoreHandle_t   Far_Sem;
+    uint8_t             Far_Wake;
+    uint32_t            Far_Garbled;
+    uint32_t            Far_Dropped;
+} Host_Usart_TypeDef;
+
+/* The handlers of ql_uart.c, the ports it leaves out are NULL */
+#define HOST_WEAK                   __attribute__((weak))
+void USART0_IRQHandler(void) HOST_WEAK;
+void USART1_IRQHandler(void) HOST_WEAK;
+void USART2_IRQHandler(void) HOST_WEAK;
+void UART3_IRQHandler(void) HOST_WEAK;
+void UART4_IRQHandler(void) HOST_WEAK;
+void USART5_IRQHandler(void) HOST_WEAK;
+void UART6_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel0_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel1_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel2_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel3_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel4_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel5_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel6_IRQHandler(void) HOST_WEAK;
+void DMA0_Channel7_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel0_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel1_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel2_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel3_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel4_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel5_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel6_IRQHandler(void) HOST_WEAK;
+void DMA1_Channel7_IRQHandler(void) HOST_WEAK;
+
+static Host_Usart_TypeDef Host_Usart[HOST_UART_NUM] =
+{
+    { .Periph = USART0, .Irqn = USART0_IRQn, .Handler = USART0_IRQHandler },
+    { .Periph = USART1, .Irqn = USART1_IRQn, .Handler = USART1_IRQHandler },
+    { .Periph = USART2, .Irqn = USART2_IRQn, .Handler = USART2_IRQHandler },
+    { .Periph = UART3,  .Irqn = UART3_IRQn,  .Handler = UART3_IRQHandler  },
+    { .Periph = UART4,  .Irqn = UART4_IRQn,  .Handler = UART4_IRQHandler  },
+    { .Periph = USART5, .Irqn = USART5_IRQn, .Handler = USART5_IRQHandler },
+    { .Periph = UART6,  .Irqn = UART6_IRQn,  .Handler = UART6_IRQHandler  },
+};
+
+static Host_Dma_TypeDef Host_Dma[2][HOST_DMA_CHANNELS];
+
+static const IRQn_Type Host_Dma_Irqn[2][HOST_DMA_CHANNELS] =
+{
+    { DMA0_Channel0_IRQn, DMA0_Channel1_IRQn, DMA0_Channel2_IRQn, DMA0_Channel3_IRQn,
+      DMA0_Channel4_IRQn, DMA0_Channel5_IRQn, DMA0_Channel6_IRQn, DMA0_Channel7_IRQn },
+    { DMA1_Channel0_IRQn, DMA1_Channel1_IRQn, DMA1_Channel2_IRQn, DMA1_Channel3_IRQn,
+      DMA1_Channel4_IRQn, DMA1_Channel5_IRQn, DMA1_Channel6_IRQn, DMA1_Channel7_IRQn },
+};
+
+static void (*const Host_Dma_Handler[2][HOST_DMA_CHANNELS])(void) =
+{
+    { DMA0_Channel0_IRQHandler, DMA0_Channel1_IRQHandler, DMA0_Channel2_IRQHandler, DMA0_Channel3_IRQHandler,
+      DMA0_Channel4_IRQHandler, DMA0_Channel5_IRQHandler, DMA0_Channel6_IRQHandler, DMA0_Channel7_IRQHandler },
+    { DMA1_Channel0_IRQHandler, DMA1_Channel1_IRQHandler, DMA1_Channel2_IRQHandler, DMA1_Channel3_IRQHandler,
+      DMA1_Channel4_IRQHandler, DMA1_Channel5_IRQHandler, DMA1_Channel6_IRQHandler, DMA1_Channel7_IRQHandler },
+};
+
+static uint32_t     Host_Nvic[4];
+static TaskHandle_t Host_Irq_Task = NULL;
+
+/* The driver keeps the DMA addresses in uint32_t: every buffer it allocates
+   must come from the brk heap of the -no-pie program, for every thread */
+__attribute__((constructor)) static void Host_Uart_Heap(void)
+{
+    mallopt(M_ARENA_MAX, 1);
+    mallopt(M_MMAP_MAX, 0);
+}
+
+/* Ql_IIC_DMA0_CH0/CH7_IRQHandler of ql_iic.c: I2C0 never holds DMA0 here */
+HOST_WEAK void Ql_IIC_DMA0_CH0_IRQHandler(void)
+{
+}
+
+HOST_WEAK void Ql_IIC_DMA0_CH7_IRQHandler(void)
+{
+}
+
+static uint64_t Host_Now_Ns(void)
+{
+    return Ql_Host_Now_Us() * 1000U;
+}
+
+/* Stop bit of byte Index (from 0) of a run starting at Start_Ns */
+static uint64_t Host_Frame_End(uint64_t Start_Ns, uint32_t Index, uint32_t Baud)
+{
+    return Start_Ns + (uint64_t)(Index + 1U) * QL_HOST_UART_FRAME_NS(1U) / Baud;
+}
+
+static Host_Usart_TypeDef *Host_Usart_Get(uint32_t Periph)
+{
+    for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+    {
+        if (Host_Usart[i].Periph == Periph)
+        {
+            return &Host_Usart[i];
+        }
+    }
+    fprintf(stderr, "host uart: no USART at 0x%08X\n", Periph);
+    exit(3);
+}
+
+static Host_Dma_TypeDef *Host_Dma_Get(uint32_t Periph, dma_channel_enum Channel)
+{
+    if (((Periph != DMA0) && (Periph != DMA1)) || (Channel >= HOST_DMA_CHANNELS))
+    {
+        fprintf(stderr, "host uart: no DMA channel 0x%08X/%u\n", Periph, Channel);
+        exit(3);
+    }
+    return &Host_Dma[(Periph == DMA1) ? 1 : 0][Channel];
+}
+
+static uint8_t Host_Nvic_On(IRQn_Type Irqn)
+{
+    return (Host_Nvic[Irqn / 32U] >> (Irqn % 32U)) & 1U;
+}
+
+static Host_Wire_Byte_TypeDef *Host_Wire_At(Host_Wire_TypeDef *Wire, uint32_t Index)
+{
+    return &Wire->Byte[(Wire->Head + Index) % QL_HOST_UART_WIRE_SIZE];
+}
+
+static uint8_t Host_Wire_Push(Host_Wire_TypeDef *Wire, uint8_t Data, uint32_t Baud, uint64_t End_Ns)
+{
+    Host_Wire_Byte_TypeDef *byte;
+
+    if (Wire->Count == QL_HOST_UART_WIRE_SIZE)
+    {
+        return 0;
+    }
+    byte = Host_Wire_At(Wire, Wire->Count++);
+    byte->End_Ns = End_Ns;
+    byte->Baud   = Baud;
+    byte->Data   = Data;
+    return 1;
+}
+
+static Host_Wire_Byte_TypeDef Host_Wire_Pop(Host_Wire_TypeDef *Wire)
+{
+    const Host_Wire_Byte_TypeDef byte = Wire->Byte[Wire->Head];
+
+    Wire->Head = (Wire->Head + 1U) % QL_HOST_UART_WIRE_SIZE;
+    Wire->Count--;
+    return byte;
+}
+
+/* A frame at the wrong rate: some byte, the receiver sees a framing error */
+static uint8_t Host_Noise(Host_Usart_TypeDef *Usart)
+{
+    Usart->Noise = Usart->Noise * 1103515245U + 12345U;
+    return (uint8_t)(Usart->Noise >> 16);
+}
+
+static void Host_Far_Put(Host_Usart_TypeDef *Usart, uint8_t Data, uint32_t Baud, uint64_t End_Ns)
+{
+    if (Usart->Far_Baud == 0)
+    {
+        return;
+    }
+    if (Baud != Usart->Far_Baud)
+    {
+        Data = Host_Noise(Usart);
+        Usart->Far_Garbled++;
+    }
+    if (!Host_Wire_Push(&Usart->Far_Wire, Data, Baud, End_Ns))
+    {
+        Usart->Far_Dropped++;
+    }
+    Usart->Far_Wake = 1;
+}
+
+static void Host_Tx_Check(Host_Usart_TypeDef *Usart)
+{
+    const Host_Dma_TypeDef *dma = Usart->Tx_Dma;
+    const uint64_t now = Host_Now_Ns();
+
+    if (Usart->Tx_Busy || (dma == NULL) || !(dma->Ctl & HOST_DMA_CHEN) || (dma->Count == 0) ||
+        ((Usart->Ctl & HOST_USART_TX_ON) != HOST_USART_TX_ON) || (Usart->Baud == 0))
+    {
+        return;
+    }
+    Usart->Tx_Busy     = 1;
+    Usart->Tx_Baud     = Usart->Baud;
+    Usart->Tx_Sent     = 0;
+    Usart->Tx_Start_Ns = (Usart->Tx_Free_Ns > now) ? Usart->Tx_Free_Ns : now;
+}
+
+static void Host_Tx_Run(Host_Usart_TypeDef *Usart, uint64_t Now_Ns)
+{
+    while (Usart->Tx_Busy)
+    {
+        Host_Dma_TypeDef *dma = Usart->Tx_Dma;
+        const uint64_t end = Host_Frame_End(Usart->Tx_Start_Ns, Usart->Tx_Sent, Usart->Tx_Baud);
+
+        if (end > Now_Ns)
+        {
+            break;
+        }
+        Host_Far_Put(Usart, *(const uint8_t *)(uintptr_t)(dma->Memory + dma->Number - dma->Count), Usart->Tx_Baud, end);
+        Usart->Tx_Sent++;
+        Usart->Tx_Free_Ns = end;
+        if (--dma->Count == (dma->Number / 2U))
+        {
+            dma->Flags |= DMA_INT_FLAG_HTF;
+        }
+        if (dma->Count == 0)
+        {
+            dma->Flags |= DMA_INT_FLAG_FTF;
+            dma->Ctl   &= ~HOST_DMA_CHEN;
+            Usart->Tx_Busy = 0;
+            Usart->Stat0  |= USART_STAT0_TC;
+        }
+    }
+}
+
+static void Host_Rx_Byte(Host_Usart_TypeDef *Usart, Host_Wire_Byte_TypeDef Byte)
+{
+    Host_Dma_TypeDef *dma = Usart->Rx_Dma;
+
+    Usart->Rx_Last_Ns = Byte.End_Ns;
+    if ((Usart->Ctl & HOST_USART_RX_ON) != HOST_USART_RX_ON)
+    {
+        return;
+    }
+    Usart->Rx_Idle_Armed = 1;
+    if (Byte.Baud != Usart->Baud)
+    {
+        Byte.Data = Host_Noise(Usart);
+        Usart->Stat0 |= USART_STAT0_FERR;
+    }
+
+    if ((Usart->Ctl & USART_DENR_ENABLE) && (dma != NULL) && (dma->Ctl & HOST_DMA_CHEN) && (dma->Count != 0))
+    {
+        *(uint8_t *)(uintptr_t)(dma->Memory + dma->Number - dma->Count) = Byte.Data;
+        if (--dma->Count == (dma->Number / 2U))
+        {
+            dma->Flags |= DMA_INT_FLAG_HTF;
+        }
+        if (dma->Count == 0)
+        {
+            dma->Flags |= DMA_INT_FLAG_FTF;
+            dma->Ctl   &= ~HOST_DMA_CHEN;
+        }
+    }
+    else if (Usart->Stat0 & USART_STAT0_RBNE)
+    {
+        Usart->Stat0 |= USART_STAT0_ORERR;
+    }
+    else
+    {
+        Usart->Data   = Byte.Data;
+        Usart->Stat0 |= USART_STAT0_RBNE;
+    }
+}
+
+/* IDLEF comes up one frame of the receiver after the last stop bit, unless
+   the next start bit is on the wire by then */
+static void Host_Rx_Run(Host_Usart_TypeDef *Usart, uint64_t Now_Ns)
+{
+    for (;;)
+    {
+        const Host_Wire_Byte_TypeDef *byte = (Usart->Rx_Wire.Count != 0) ? Host_Wire_At(&Usart->Rx_Wire, 0) : NULL;
+        const uint64_t idle = (Usart->Rx_Idle_Armed && (Usart->Baud != 0)) ?
+                              (Usart->Rx_Last_Ns + QL_HOST_UART_FRAME_NS(Usart->Baud)) : HOST_NO_EVENT;
+
+        if ((byte != NULL) && ((byte->End_Ns - QL_HOST_UART_FRAME_NS(byte->Baud)) < idle))
+        {
+            if (byte->End_Ns > Now_Ns)
+            {
+                break;
+            }
+            Host_Rx_Byte(Usart, Host_Wire_Pop(&Usart->Rx_Wire));
+        }
+        else if (idle <= Now_Ns)
+        {
+            Usart->Stat0 |= USART_STAT0_IDLEF;
+            Usart->Rx_Idle_Armed = 0;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+static void Host_Uart_Run(void)
+{
+    const uint64_t now = Host_Now_Ns();
+
+    for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+    {
+        Host_Tx_Run(&Host_Usart[i], now);
+        Host_Rx_Run(&Host_Usart[i], now);
+    }
+}
+
+/* Earliest time a flag can come up: the end of a transfer, the half and
+   full marks of an RX DMA, a byte without DMA or at the wrong rate, IDLEF */
+static uint64_t Host_Uart_Next_Ns(void)
+{
+    uint64_t next = HOST_NO_EVENT;
+
+    for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+    {
+        Host_Usart_TypeDef *usart = &Host_Usart[i];
+        const Host_Dma_TypeDef *dma = usart->Rx_Dma;
+        Host_Wire_TypeDef *wire = &usart->Rx_Wire;
+        uint64_t last = usart->Rx_Idle_Armed ? usart->Rx_Last_Ns : HOST_NO_EVENT;
+        uint64_t at = HOST_NO_EVENT;
+
+        if (usart->Tx_Busy)
+        {
+            at = Host_Frame_End(usart->Tx_Start_Ns, usart->Tx_Sent + usart->Tx_Dma->Count - 1U, usart->Tx_Baud);
+            next = (at < next) ? at : next;
+        }
+        if (usart->Baud == 0)
+        {
+            continue;
+        }
+
+        if ((dma != NULL) && (dma->Ctl & HOST_DMA_CHEN) && (dma->Count != 0))
+        {
+            if ((dma->Count > (dma->Number / 2U)) && ((dma->Count - dma->Number / 2U) <= wire->Count))
+            {
+                at   = Host_Wire_At(wire, dma->Count - dma->Number / 2U - 1U)->End_Ns;
+                next = (at < next) ? at : next;
+            }
+            if (dma->Count <= wire->Count)
+            {
+                at   = Host_Wire_At(wire, dma->Count - 1U)->End_Ns;
+                next = (at < next) ? at : next;
+            }
+        }
+        else if (wire->Count != 0)
+        {
+            at   = Host_Wire_At(wire, 0)->End_Ns;
+            next = (at < next) ? at : next;
+        }
+
+        for (uint32_t k = 0; k < wire->Count; k++)
+        {
+            const Host_Wire_Byte_TypeDef *byte = Host_Wire_At(wire, k);
+
+            if ((last != HOST_NO_EVENT) && ((byte->End_Ns - QL_HOST_UART_FRAME_NS(byte->Baud)) >= (last + QL_HOST_UART_FRAME_NS(usart->Baud))))
+            {
+                break;
+            }
+            if (byte->Baud != usart->Baud)
+            {
+                next = (byte->End_Ns < next) ? byte->End_Ns : next;
+                last = HOST_NO_EVENT;
+                break;
+            }
+            last = byte->End_Ns;
+        }
+        if (last != HOST_NO_EVENT)
+        {
+            at   = last + QL_HOST_UART_FRAME_NS(usart->Baud);
+            next = (at < next) ? at : next;
+        }
+    }
+    return next;
+}
+
+static uint8_t Host_Usart_Irq_Pending(const Host_Usart_TypeDef *Usart)
+{
+    const uint32_t stat = Usart->Stat0;
+    const uint32_t en   = Usart->Int_En;
+
+    return ((stat & USART_STAT0_IDLEF) && (en & USART_INT_IDLE)) ||
+           ((stat & USART_STAT0_TC)    && (en & USART_INT_TC))   ||
+           ((stat & (USART_STAT0_RBNE | USART_STAT0_ORERR)) && (en & USART_INT_RBNE)) ||
+           ((stat & USART_STAT0_PERR)  && (en & USART_INT_PERR)) ||
+           ((stat & (USART_STAT0_FERR | USART_STAT0_NERR | USART_STAT0_ORERR)) && (en & USART_INT_ERR) &&
+            (Usart->Ctl & USART_DENR_ENABLE));
+}
+
+static uint8_t Host_Dma_Irq_Pending(const Host_Dma_TypeDef *Dma)
+{
+    return ((Dma->Flags & DMA_INT_FLAG_HTF) && (Dma->Ctl & DMA_CHXCTL_HTFIE)) ||
+           ((Dma->Flags & DMA_INT_FLAG_FTF) && (Dma->Ctl & DMA_CHXCTL_FTFIE));
+}
+
+static void Host_Uart_Dispatch(void)
+{
+    for (uint32_t round = 0; ; round++)
+    {
+        uint8_t fired = 0;
+
+        if (round == HOST_IRQ_STORM)
+        {
+            fprintf(stderr, "host uart: interrupt storm at %llu us\n", (unsigned long long)Ql_Host_Now_Us());
+            exit(3);
+        }
+
+        for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+        {
+            const Host_Usart_TypeDef *usart = &Host_Usart[i];
+
+            if ((usart->Handler != NULL) && Host_Nvic_On(usart->Irqn) && Host_Usart_Irq_Pending(usart))
+            {
+                usart->Handler();
+                fired = 1;
+            }
+        }
+        for (uint32_t d = 0; d < 2U; d++)
+        {
+            for (uint32_t c = 0; c < HOST_DMA_CHANNELS; c++)
+            {
+                if ((Host_Dma_Handler[d][c] != NULL) && Host_Nvic_On(Host_Dma_Irqn[d][c]) && Host_Dma_Irq_Pending(&Host_Dma[d][c]))
+                {
+                    Host_Dma_Handler[d][c]();
+                    fired = 1;
+                }
+            }
+        }
+        if (!fired)
+        {
+            return;
+        }
+    }
+}
+
+/* Wake the far end readers, only from the interrupt task and the far end
+   calls: a register access of the driver must not switch tasks */
+static void Host_Far_Wake(void)
+{
+    for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+    {
+        if (Host_Usart[i].Far_Wake && (Host_Usart[i].Far_Sem != NULL))
+        {
+            Host_Usart[i].Far_Wake = 0;
+            xSemaphoreGive(Host_Usart[i].Far_Sem);
+        }
+    }
+}
+
+static void Host_Uart_Irq_Task(void *Param)
+{
+    uint64_t next;
+
+    (void)Param;
+    for (;;)
+    {
+        Host_Uart_Run();
+        Host_Uart_Dispatch();
+        Host_Far_Wake();
+        next = Host_Uart_Next_Ns();
+        Ql_Host_Notify_Take_Until((next == HOST_NO_EVENT) ? HOST_NO_EVENT : ((next + 999U) / 1000U));
+    }
+}
+
+/* Something may fire earlier than the interrupt task sleeps for */
+static void Host_Uart_Kick(void)
+{
+    if ((Host_Irq_Task != NULL) && (xTaskGetCurrentTaskHandle() != Host_Irq_Task))
+    {
+        xTaskNotifyGive(Host_Irq_Task);
+    }
+}
+
+/*****************************************************************************
+* gd32f4xx_usart.c
+*****************************************************************************/
+volatile uint32_t *Ql_Host_Usart_Reg(uint32_t usart_periph, uint32_t offset)
+{
+    Host_Usart_TypeDef *usart = Host_Usart_Get(usart_periph);
+
+    Host_Uart_Run();
+    if (offset == 0x00U)
+    {
+        usart->Stat0_Read = 1;
+        return &usart->Stat0;
+    }
+    if (usart->Stat0_Read)
+    {
+        usart->Stat0 &= ~HOST_STAT0_CLEARED;
+    }
+    usart->Stat0_Read = 0;
+    usart->Stat0 &= ~USART_STAT0_RBNE;
+    return &usart->Data;
+}
+
+void usart_deinit(uint32_t usart_periph)
+{
+    Host_Usart_TypeDef *usart = Host_Usart_Get(usart_periph);
+
+    Host_Uart_Run();
+    usart->Ctl     = 0;
+    usart->Int_En  = 0;
+    usart->Baud    = 0;
+    usart->Stat0   = USART_STAT0_TC | USART_STAT0_TBE;
+    usart->Tx_Busy = 0;
+}
+
+void usart_baudrate_set(uint32_t usart_periph, uint32_t baudval)
+{
+    Host_Uart_Run();
+    Host_Usart_Get(usart_periph)->Baud = baudval;
+    Host_Uart_Kick();
+}
+
+static void Host_Usart_Ctl(uint32_t Periph, uint32_t Mask, uint32_t Value)
+{
+    Host_Usart_TypeDef *usart = Host_Usart_Get(Periph);
+
+    Host_Uart_Run();
+    usart->Ctl = (usart->Ctl & ~Mask) | (Value & Mask);
+    if (!(usart->Ctl & HOST_USART_UEN))
+    {
+        usart->Tx_Busy = 0;
+    }
+    Host_Tx_Check(usart);
+    Host_Uart_Kick();
+}
+
+void usart_enable(uint32_t usart_periph)
+{
+    Host_Usart_Ctl(usart_periph, HOST_USART_UEN, HOST_USART_UEN);
+}
+
+void usart_disable(uint32_t usart_periph)
+{
+    Host_Usart_Ctl(usart_periph, HOST_USART_UEN, 0);
+}
+
+void usart_transmit_config(uint32_t usart_periph, uint32_t txconfig)
+{
+    Host_Usart_Ctl(usart_periph, USART_TRANSMIT_ENABLE, txconfig);
+}
+
+void usart_receive_config(uint32_t usart_periph, uint32_t rxconfig)
+{
+    Host_Usart_Ctl(usart_periph, USART_RECEIVE_ENABLE, rxconfig);
+}
+
+void usart_dma_receive_config(uint32_t usart_periph, uint32_t dmacmd)
+{
+    Host_Usart_Ctl(usart_periph, USART_DENR_ENABLE, dmacmd);
+}
+
+void usart_dma_transmit_config(uint32_t usart_periph, uint32_t dmacmd)
+{
+    Host_Usart_Ctl(usart_periph, USART_DENT_ENABLE, dmacmd);
+}
+
+/* Polled output, fputc and friends: on the wire, TC is not modelled */
+void usart_data_transmit(uint32_t usart_periph, uint32_t data)
+{
+    Host_Usart_TypeDef *usart = Host_Usart_Get(usart_periph);
+    const uint64_t now = Host_Now_Ns();
+
+    Host_Uart_Run();
+    if (usart->Baud == 0)
+    {
+        return;
+    }
+    usart->Tx_Free_Ns = Host_Frame_End((usart->Tx_Free_Ns > now) ? usart->Tx_Free_Ns : now, 0, usart->Baud);
+    Host_Far_Put(usart, (uint8_t)data, usart->Baud, usart->Tx_Free_Ns);
+}
+
+FlagStatus usart_flag_get(uint32_t usart_periph, usart_flag_enum flag)
+{
+    Host_Uart_Run();
+    return (Host_Usart_Get(usart_periph)->Stat0 & BIT(flag)) ? SET : RESET;
+}
+
+void usart_interrupt_enable(uint32_t usart_periph, usart_interrupt_enum interrupt)
+{
+    Host_Usart_Get(usart_periph)->Int_En |= interrupt;
+    Host_Uart_Kick();
+}
+
+void usart_interrupt_disable(uint32_t usart_periph, usart_interrupt_enum interrupt)
+{
+    Host_Usart_Get(usart_periph)->Int_En &= ~(uint32_t)interrupt;
+}
+
+FlagStatus usart_interrupt_flag_get(uint32_t usart_periph, usart_interrupt_flag_enum int_flag)
+{
+    const Host_Usart_TypeDef *usart = Host_Usart_Get(usart_periph);
+
+    Host_Uart_Run();
+    return ((usart->Int_En & BIT((uint32_t)int_flag >> 8)) && (usart->Stat0 & BIT((uint32_t)int_flag & 0xFFU))) ? SET : RESET;
+}
+
+void usart_interrupt_flag_clear(uint32_t usart_periph, usart_interrupt_flag_enum int_flag)
+{
+    Host_Usart_Get(usart_periph)->Stat0 &= ~BIT((uint32_t)int_flag & 0xFFU);
+}
+
+/*****************************************************************************
+* gd32f4xx_dma.c
+*****************************************************************************/
+static Host_Usart_TypeDef *Host_Dma_Usart(const Host_Dma_TypeDef *Dma)
+{
+    for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+    {
+        if ((Host_Usart[i].Tx_Dma == Dma) || (Host_Usart[i].Rx_Dma == Dma))
+        {
+            return &Host_Usart[i];
+        }
+    }
+    return NULL;
+}
+
+void dma_deinit(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    Host_Dma_TypeDef *dma = Host_Dma_Get(dma_periph, channelx);
+    Host_Usart_TypeDef *usart = Host_Dma_Usart(dma);
+
+    Host_Uart_Run();
+    if ((usart != NULL) && (usart->Tx_Dma == dma))
+    {
+        usart->Tx_Busy = 0;
+    }
+    memset(dma, 0, sizeof(*dma));
+}
+
+void dma_single_data_para_struct_init(dma_single_data_parameter_struct *init_struct)
+{
+    memset(init_struct, 0, sizeof(*init_struct));
+}
+
+void dma_single_data_mode_init(uint32_t dma_periph, dma_channel_enum channelx, dma_single_data_parameter_struct *init_struct)
+{
+    Host_Dma_TypeDef *dma = Host_Dma_Get(dma_periph, channelx);
+    Host_Usart_TypeDef *usart = NULL;
+
+    for (uint32_t i = 0; i < HOST_UART_NUM; i++)
+    {
+        if ((uint32_t)(uintptr_t)&Host_Usart[i].Data == init_struct->periph_addr)
+        {
+            usart = &Host_Usart[i];
+        }
+    }
+    if ((usart == NULL) || ((uintptr_t)&usart->Data != init_struct->periph_addr))
+    {
+        fprintf(stderr, "host uart: DMA on 0x%08X is no USART DATA, is the program linked -no-pie?\n", init_struct->periph_addr);
+        exit(3);
+    }
+
+    Host_Uart_Run();
+    dma->Direction = init_struct->direction;
+    dma->Periph    = init_struct->periph_addr;
+    dma->Memory    = init_struct->memory0_addr;
+    dma->Number    = init_struct->number;
+    dma->Count     = init_struct->number;
+    dma->Flags     = 0;
+    dma->Ctl      &= ~HOST_DMA_CHEN;
+    if (dma->Direction == DMA_MEMORY_TO_PERIPH)
+    {
+        usart->Tx_Dma  = dma;
+        usart->Tx_Busy = 0;
+    }
+    else
+    {
+        usart->Rx_Dma = dma;
+    }
+}
+
+void dma_circulation_disable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    (void)Host_Dma_Get(dma_periph, channelx);
+}
+
+void dma_channel_subperipheral_select(uint32_t dma_periph, dma_channel_enum channelx, dma_subperipheral_enum sub_periph)
+{
+    (void)Host_Dma_Get(dma_periph, channelx);
+    (void)sub_periph;
+}
+
+void dma_channel_enable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    Host_Dma_TypeDef *dma = Host_Dma_Get(dma_periph, channelx);
+    Host_Usart_TypeDef *usart = Host_Dma_Usart(dma);
+
+    Host_Uart_Run();
+    dma->Ctl |= HOST_DMA_CHEN;
+    if ((usart != NULL) && (usart->Tx_Dma == dma))
+    {
+        Host_Tx_Check(usart);
+    }
+    Host_Uart_Kick();
+}
+
+void dma_channel_disable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    Host_Dma_TypeDef *dma = Host_Dma_Get(dma_periph, channelx);
+    Host_Usart_TypeDef *usart = Host_Dma_Usart(dma);
+
+    Host_Uart_Run();
+    dma->Ctl &= ~HOST_DMA_CHEN;
+    if ((usart != NULL) && (usart->Tx_Dma == dma))
+    {
+        usart->Tx_Busy = 0;
+    }
+}
+
+void dma_memory_address_config(uint32_t dma_periph, dma_channel_enum channelx, uint8_t memory_flag, uint32_t address)
+{
+    (void)memory_flag;
+    Host_Dma_Get(dma_periph, channelx)->Memory = address;
+}
+
+void dma_transfer_number_config(uint32_t dma_periph, dma_channel_enum channelx, uint32_t number)
+{
+    Host_Dma_TypeDef *dma = Host_Dma_Get(dma_periph, channelx);
+
+    dma->Number = number;
+    dma->Count  = number;
+}
+
+uint32_t dma_transfer_number_get(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    Host_Uart_Run();
+    return Host_Dma_Get(dma_periph, channelx)->Count;
+}
+
+void dma_flag_clear(uint32_t dma_periph, dma_channel_enum channelx, uint32_t flag)
+{
+    Host_Dma_Get(dma_periph, channelx)->Flags &= ~flag;
+}
+
+void dma_interrupt_enable(uint32_t dma_periph, dma_channel_enum channelx, uint32_t source)
+{
+    Host_Dma_Get(dma_periph, channelx)->Ctl |= source;
+    Host_Uart_Kick();
+}
+
+void dma_interrupt_disable(uint32_t dma_periph, dma_channel_enum channelx, uint32_t source)
+{
+    Host_Dma_Get(dma_periph, channelx)->Ctl &= ~source;
+}
+
+/* The flag counts when its interrupt is enabled, as in the GD library */
+FlagStatus dma_interrupt_flag_get(uint32_t dma_periph, dma_channel_enum channelx, uint32_t interrupt)
+{
+    const Host_Dma_TypeDef *dma = Host_Dma_Get(dma_periph, channelx);
+
+    Host_Uart_Run();
+    return ((dma->Flags & interrupt) && (dma->Ctl & (interrupt >> 1))) ? SET : RESET;
+}
+
+void dma_interrupt_flag_clear(uint32_t dma_periph, dma_channel_enum channelx, uint32_t interrupt)
+{
+    Host_Dma_Get(dma_periph, channelx)->Flags &= ~interrupt;
+}
+
+/*****************************************************************************
+* gd32f4xx_misc.c
+*****************************************************************************/
+void nvic_irq_enable(uint8_t nvic_irq, uint8_t nvic_irq_pre_priority, uint8_t nvic_irq_sub_priority)
+{
+    (void)nvic_irq_pre_priority;
+    (void)nvic_irq_sub_priority;
+
+    if (Host_Irq_Task == NULL)
+    {
+        xTaskCreate(Host_Uart_Irq_Task, "irq", configMINIMAL_STACK_SIZE, NULL, QL_HOST_UART_IRQ_PRIORITY, &Host_Irq_Task);
+        Ql_Host_Task_Isr(Host_Irq_Task, 1);
+    }
+    Host_Nvic[nvic_irq / 32U] |= BIT(nvic_irq % 32U);
+    Host_Uart_Kick();
+}
+
+void nvic_irq_disable(uint8_t nvic_irq)
+{
+    Host_Nvic[nvic_irq / 32U] &= ~BIT(nvic_irq % 32U);
+}
+
+/*****************************************************************************
+* Far end
+*****************************************************************************/
+void Ql_Host_Uart_Far_Baud(uint32_t UsartPeriph, uint32_t Baud)
+{
+    Host_Uart_Run();
+    Host_Usart_Get(UsartPeriph)->Far_Baud = Baud;
+    Host_Uart_Kick();
+}
+
+uint32_t Ql_Host_Uart_Far_Write(uint32_t UsartPeriph, const void *Data, uint32_t Len, uint64_t *End_Ns)
+{
+    Host_Usart_TypeDef *usart = Host_Usart_Get(UsartPeriph);
+    const uint64_t now = Host_Now_Ns();
+    uint64_t start;
+    uint64_t end = 0;
+    uint32_t n = 0;
+
+    Host_Uart_Run();
+    if (usart->Far_Baud == 0)
+    {
+        return 0;
+    }
+    start = (usart->Far_Free_Ns > now) ? usart->Far_Free_Ns : now;
+    for (n = 0; n < Len; n++)
+    {
+        end = Host_Frame_End(start, n, usart->Far_Baud);
+        if (!Host_Wire_Push(&usart->Rx_Wire, ((const uint8_t *)Data)[n], usart->Far_Baud, end))
+        {
+            break;
+        }
+        if (End_Ns != NULL)
+        {
+            End_Ns[n] = end;
+        }
+        usart->Far_Free_Ns = end;
+    }
+    Host_Uart_Kick();
+    return n;
+}
+
+uint32_t Ql_Host_Uart_Far_Pending(uint32_t UsartPeriph)
+{
+    Host_Uart_Run();
+    return Host_Usart_Get(UsartPeriph)->Rx_Wire.Count;
+}
+
+static uint32_t Host_Far_Pop(Host_Usart_TypeDef *Usart, uint8_t *Buf, uint32_t Size, uint64_t *End_Ns)
+{
+    uint32_t n = 0;
+
+    Host_Uart_Run();
+    while ((n < Size) && (Usart->Far_Wire.Count != 0))
+    {
+        const Host_Wire_Byte_TypeDef byte = Host_Wire_Pop(&Usart->Far_Wire);
+
+        Buf[n] = byte.Data;
+        if (End_Ns != NULL)
+        {
+            End_Ns[n] = byte.End_Ns;
+        }
+        n++;
+    }
+    return n;
+}
+
+uint32_t Ql_Host_Uart_Far_Read(uint32_t UsartPeriph, void *Buf, uint32_t Size, TickType_t Ticks, uint64_t *End_Ns)
+{
+    Host_Usart_TypeDef *usart = Host_Usart_Get(UsartPeriph);
+    uint32_t n;
+
+    if (usart->Far_Sem == NULL)
+    {
+        usart->Far_Sem = xSemaphoreCreateBinary();
+    }
+    n = Host_Far_Pop(usart, Buf, Size, End_Ns);
+    if ((n == 0) && (Ticks != 0) && (xSemaphoreTake(usart->Far_Sem, Ticks) == pdPASS))
+    {
+        n = Host_Far_Pop(usart, Buf, Size, End_Ns);
+    }
+    return n;
+}
+
+uint32_t Ql_Host_Uart_Far_Garbled(uint32_t UsartPeriph)
+{
+    return Host_Usart_Get(UsartPeriph)->Far_Garbled;
+}
+
+uint32_t Ql_Host_Uart_Far_Dropped(uint32_t UsartPeriph)
+{
+    return Host_Usart_Get(UsartPeriph)->Far_Dropped;
+}
@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_host_uart.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_HOST_UART_H_
+#define __QL_HOST_UART_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/* USART and DMA model under the real ql_uart.c. Each port has a wire to a
+   far end, the module or a tester, that the program drives with the calls
+   below. A byte takes 10 bits at the baud rate of its sender, and comes
+   out garbled with FERR when the receiver is at another rate. The
+   interrupts run from a task above every other one, at the virtual time
+   the flag comes up */
+#define QL_HOST_UART_WIRE_SIZE      (16384U)    // bytes queued per direction
+#define QL_HOST_UART_IRQ_PRIORITY   (configMAX_PRIORITIES - 1)
+
+/* ns per frame of 10 bits */
+#define QL_HOST_UART_FRAME_NS(Baud) (10000000000ULL / (Baud))
+
+/* Rate the far end sends and receives at, 0: not connected */
+void     Ql_Host_Uart_Far_Baud(uint32_t UsartPeriph, uint32_t Baud);
+
+/* Queue Len bytes on the wire to the MCU behind what is already queued.
+   Returns the bytes taken, less when the queue is full. End_Ns gets the
+   time each byte has arrived, NULL if not needed */
+uint32_t Ql_Host_Uart_Far_Write(uint32_t UsartPeriph, const void *Data, uint32_t Len, uint64_t *End_Ns);
+
+/* Bytes written by the far end that have not arrived yet */
+uint32_t Ql_Host_Uart_Far_Pending(uint32_t UsartPeriph);
+
+/* Bytes the MCU has sent, waiting up to Ticks for the first. End_Ns gets
+   the time each byte had arrived, NULL if not needed */
+uint32_t Ql_Host_Uart_Far_Read(uint32_t UsartPeriph, void *Buf, uint32_t Size, TickType_t Ticks, uint64_t *End_Ns);
+
+/* Bytes the far end received garbled, and dropped as it did not read */
+uint32_t Ql_Host_Uart_Far_Garbled(uint32_t UsartPeriph);
+uint32_t Ql_Host_Uart_Far_Dropped(uint32_t UsartPeriph);
+
+#endif
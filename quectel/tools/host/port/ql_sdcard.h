@@ -0,0 +1,44 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: ql_sdcard.h
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#ifndef __QL_HOST_SDCARD_H_
+#define __QL_HOST_SDCARD_H_
+
+/* ql_sdcard.h stand-in of the host build. The card is the image file of
+   ql_ff_disk.c (QL_DISK_HOST), only the bus report is left here */
+#include <stdint.h>
+
+typedef struct
+{
+    uint8_t     BusWidth;       // 1 or 4 data lines
+    uint8_t     HighSpeed;
+    uint32_t    ClockKHz;
+} SD_BusInfo;
+
+static inline void SD_GetBusInfo(SD_BusInfo *Info)
+{
+    Info->BusWidth  = 4;
+    Info->HighSpeed = 0;
+    Info->ClockKHz  = 0;
+}
+
+#endif
@@ -0,0 +1,734 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: uart_baud.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_host_uart.h"
+#include "ql_uart.h"
+#include "ql_uart_baud.h"
+#include "ql_check.h"
+
+#define LOG_TAG "uart_baud"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+/* Ql_Uart_Baud_Negotiate() and ql_uart.c against a module simulated at the
+   far end of the port: the negotiation cases with rollback, then 10 Hz NMEA
+   in and 1 Hz RTCM out at each rate with the load and the latencies */
+
+/* GNSS COM1 as in example_ntrip_client.c */
+#define BAUD_PORT                   UART3
+#define BAUD_RX_SIZE                (8192U)
+#define BAUD_TX_SIZE                (2048U)
+#define BAUD_ORIGIN                 (115200U)
+
+#define BAUD_EPOCH_MS               (100U)      // 10 Hz
+#define BAUD_GSV_MIN                (6U)        // GSV sentences per epoch, 6..12
+#define BAUD_GSV_SPREAD             (7U)
+#define BAUD_MODULE_FIFO            (4096U)     // UART TX buffer of the module
+#define BAUD_MODULE_SWITCH_MS       (20U)       // after its ack is out, shorter than Settle_Ms
+#define BAUD_MODULE_GAP_US          (5000U)     // a frame with a longer gap is dropped
+#define BAUD_RTCM_PERIOD_MS         (1000U)
+#define BAUD_HISTORY                (1024U)     // epochs and RTCM messages kept
+
+typedef enum
+{
+    BAUD_DIALECT_PQTM,
+    BAUD_DIALECT_PAIR,
+    BAUD_DIALECT_AT,
+} Baud_Dialect_TypeDef;
+
+/* The module at the far end of BAUD_PORT */
+typedef struct
+{
+    Baud_Dialect_TypeDef Dialect;
+    uint32_t    Max_Baud;
+    uint32_t    Baud;
+    uint32_t    Saved_Baud;         // comes up at after a reset
+    uint8_t     Stream;             // NMEA at 10 Hz
+
+    uint32_t    Epoch;              // next one
+    uint64_t    Epoch_Us;
+    uint64_t    Start_Us[BAUD_HISTORY];
+    uint64_t    Gst_End_Ns[BAUD_HISTORY];
+    uint32_t    Tx_Bytes;
+    uint32_t    Dropped;            // sentences that did not fit the TX buffer
+    uint32_t    Set_Cmds;
+
+    char        Line[256];
+    uint32_t    Line_Len;
+    uint8_t     Frame[1024 + 6];
+    uint32_t    Frame_Len;
+    uint64_t    Last_Ns;
+    uint32_t    Rtcm_Bytes;
+    uint32_t    Rtcm_Bad;
+    uint64_t    Rtcm_End_Ns[BAUD_HISTORY];
+} Baud_Module_TypeDef;
+
+typedef struct
+{
+    uint32_t    Rate;
+    uint32_t    Epochs;
+    uint32_t    Rx_Load;            // 0.1 %
+    uint32_t    Tx_Load;
+    uint32_t    Epoch_Ms[3];        // p50, p99, max
+    uint32_t    Read_Us[3];
+    uint32_t    Rtcm_Ms[3];
+    uint32_t    Dropped;
+    usart_stats_t Stats;
+} Baud_Report_TypeDef;
+
+static Baud_Module_TypeDef Baud_Module;
+
+static volatile uint8_t Baud_Rtcm_On = 0;
+static uint32_t Baud_Rtcm_Seq = 0;
+static uint32_t Baud_Rtcm_Sent = 0;
+static uint64_t Baud_Rtcm_Start_Us[BAUD_HISTORY];
+
+/* 1005, 1077, 1087, 1097, 1127 of a 1 Hz MSM7 feed, ~1.2 KB per second */
+static const uint16_t Baud_Rtcm_Len[] = { 19, 412, 306, 296, 178 };
+
+static int Baud_Cmp(const void *A, const void *B)
+{
+    const uint32_t a = *(const uint32_t *)A;
+    const uint32_t b = *(const uint32_t *)B;
+
+    return (a > b) - (a < b);
+}
+
+/* p50, p99 and max of Num samples, sorted in place */
+static void Baud_Percentiles(uint32_t *Val, uint32_t Num, uint32_t Out[3])
+{
+    if (Num == 0)
+    {
+        memset(Out, 0, 3 * sizeof(uint32_t));
+        return;
+    }
+    qsort(Val, Num, sizeof(uint32_t), Baud_Cmp);
+    Out[0] = Val[(Num - 1) * 50U / 100U];
+    Out[1] = Val[(Num - 1) * 99U / 100U];
+    Out[2] = Val[Num - 1];
+}
+
+static uint32_t Baud_Crc24q(const uint8_t *Data, uint32_t Len)
+{
+    uint32_t crc = 0;
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        crc ^= (uint32_t)Data[i] << 16;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc <<= 1;
+            if (crc & 0x1000000U)
+            {
+                crc ^= 0x1864CFBU;
+            }
+        }
+    }
+    return crc & 0xFFFFFFU;
+}
+
+static uint8_t Baud_Rate_Valid(uint32_t Baud)
+{
+    return (Baud == 115200U) || (Baud == 230400U) || (Baud == 460800U) || (Baud == 921600U);
+}
+
+/*****************************************************************************
+* Module output
+*****************************************************************************/
+/* Last_Ns gets the arrival of the last byte, 0 if the buffer was full */
+static void Baud_Module_Send(Baud_Module_TypeDef *Module, const char *Str, uint32_t Len, uint64_t *Last_Ns)
+{
+    static uint64_t end[128];
+    uint32_t n;
+
+    if (Last_Ns != NULL)
+    {
+        *Last_Ns = 0;
+    }
+    if ((Len > sizeof(end) / sizeof(end[0])) || (Ql_Host_Uart_Far_Pending(BAUD_PORT) + Len > BAUD_MODULE_FIFO))
+    {
+        Module->Dropped++;
+        return;
+    }
+    n = Ql_Host_Uart_Far_Write(BAUD_PORT, Str, Len, end);
+    Module->Tx_Bytes += n;
+    if ((Last_Ns != NULL) && (n == Len))
+    {
+        *Last_Ns = end[n - 1];
+    }
+}
+
+static void Baud_Module_Nmea(Baud_Module_TypeDef *Module, uint64_t *Last_Ns, const char *Format, ...)
+{
+    char body[100];
+    char line[112];
+    va_list args;
+    int len;
+
+    va_start(args, Format);
+    vsnprintf(body, sizeof(body), Format, args);
+    va_end(args);
+    len = snprintf(line, sizeof(line), "$%s*%02X\r\n", body, Ql_CheckXOR((const uint8_t *)body, strlen(body)));
+    Baud_Module_Send(Module, line, (uint32_t)len, Last_Ns);
+}
+
+/* One epoch, GST last with the epoch in its time field */
+static void Baud_Module_Epoch(Baud_Module_TypeDef *Module)
+{
+    static const char *const talker[] = { "GP", "GL", "GA", "GB" };
+    const uint32_t k = Module->Epoch;
+    const uint32_t gsv = BAUD_GSV_MIN + (uint32_t)rand() % BAUD_GSV_SPREAD;
+    const uint32_t cs = k * (BAUD_EPOCH_MS / 10U);     // centiseconds of the day
+    char utc[16];
+
+    snprintf(utc, sizeof(utc), "%02u%02u%02u.%02u", (cs / 360000U) % 24U, (cs / 6000U) % 60U, (cs / 100U) % 60U, cs % 100U);
+    Module->Start_Us[k % BAUD_HISTORY] = Ql_Host_Now_Us();
+
+    Baud_Module_Nmea(Module, NULL, "GNRMC,%s,A,3149.330812,N,11706.916015,E,0.012,287.51,181026,,,D,V", utc);
+    Baud_Module_Nmea(Module, NULL, "GNGGA,%s,3149.330812,N,11706.916015,E,4,34,0.52,35.412,M,-0.300,M,1.0,0001", utc);
+    Baud_Module_Nmea(Module, NULL, "GNGSA,A,3,01,02,03,08,10,14,21,22,27,32,,,0.99,0.52,0.84,1");
+    Baud_Module_Nmea(Module, NULL, "GNGSA,A,3,65,66,72,73,81,82,87,88,,,,,0.99,0.52,0.84,2");
+    for (uint32_t i = 0; i < gsv; i++)
+    {
+        Baud_Module_Nmea(Module, NULL, "%sGSV,3,%u,12,%02u,23,045,42,%02u,56,123,45,%02u,12,300,38,%02u,67,200,47,1",
+                         talker[i / 3U], i % 3U + 1U, i * 4U + 1U, i * 4U + 2U, i * 4U + 3U, i * 4U + 4U);
+    }
+    Baud_Module_Nmea(Module, &Module->Gst_End_Ns[k % BAUD_HISTORY], "GNGST,%s,0.9,0.012,0.010,35.1,0.012,0.010,0.021", utc);
+
+    /* A reconfiguration in between skips the epochs it covered */
+    do
+    {
+        Module->Epoch++;
+        Module->Epoch_Us += BAUD_EPOCH_MS * 1000U;
+    } while (Module->Epoch_Us <= Ql_Host_Now_Us());
+}
+
+static void Baud_Module_Reply(Baud_Module_TypeDef *Module, const char *Body)
+{
+    if (Module->Dialect == BAUD_DIALECT_AT)
+    {
+        Baud_Module_Send(Module, Body, strlen(Body), NULL);
+    }
+    else
+    {
+        Baud_Module_Nmea(Module, NULL, "%s", Body);
+    }
+}
+
+/* Ack at the old rate, reprogram the UART once the ack is out */
+static void Baud_Module_Switch(Baud_Module_TypeDef *Module, uint32_t Baud, const char *Ok, const char *Error)
+{
+    Module->Set_Cmds++;
+    if (!Baud_Rate_Valid(Baud) || (Baud > Module->Max_Baud))
+    {
+        Baud_Module_Reply(Module, Error);
+        return;
+    }
+    Baud_Module_Reply(Module, Ok);
+    while (Ql_Host_Uart_Far_Pending(BAUD_PORT) != 0)
+    {
+        vTaskDelay(1);
+    }
+    vTaskDelay(pdMS_TO_TICKS(BAUD_MODULE_SWITCH_MS));
+    Module->Baud = Baud;
+    Ql_Host_Uart_Far_Baud(BAUD_PORT, Baud);
+}
+
+/*****************************************************************************
+* Module input: commands in lines, RTCM frames by their length
+*****************************************************************************/
+static void Baud_Module_Command(Baud_Module_TypeDef *Module)
+{
+    char *cmd = NULL;
+    char *star = NULL;
+
+    if (Module->Dialect == BAUD_DIALECT_AT)
+    {
+        for (int32_t i = (int32_t)Module->Line_Len - 2; i >= 0; i--)
+        {
+            if ((Module->Line[i] == 'A') && (Module->Line[i + 1] == 'T'))
+            {
+                cmd = &Module->Line[i];
+                break;
+            }
+        }
+        if (cmd == NULL)
+        {
+            return;
+        }
+        cmd[strcspn(cmd, "\r\n")] = '\0';
+        if (strncmp(cmd, "AT+IPR=", 7) == 0)
+        {
+            Baud_Module_Switch(Module, (uint32_t)strtoul(cmd + 7, NULL, 10), "\r\nOK\r\n", "\r\nERROR\r\n");
+        }
+        else if (strcmp(cmd, "AT&W") == 0)
+        {
+            Module->Saved_Baud = Module->Baud;
+            Baud_Module_Reply(Module, "\r\nOK\r\n");
+        }
+        else if (strcmp(cmd, "AT") == 0)
+        {
+            Baud_Module_Reply(Module, "\r\nOK\r\n");
+        }
+        return;
+    }
+
+    for (int32_t i = (int32_t)Module->Line_Len - 1; i >= 0; i--)
+    {
+        if (Module->Line[i] == '$')
+        {
+            cmd = &Module->Line[i + 1];
+            break;
+        }
+    }
+    if ((cmd == NULL) || ((star = strchr(cmd, '*')) == NULL) ||
+        (Ql_CheckXOR((const uint8_t *)cmd, (uint32_t)(star - cmd)) != (uint8_t)strtoul(star + 1, NULL, 16)))
+    {
+        return;
+    }
+    *star = '\0';
+
+    if (Module->Dialect == BAUD_DIALECT_PQTM)
+    {
+        if (strncmp(cmd, "PQTMCFGUART,W,", 14) == 0)
+        {
+            Baud_Module_Switch(Module, (uint32_t)strtoul(cmd + 14, NULL, 10), "PQTMCFGUART,OK", "PQTMCFGUART,ERROR,1");
+        }
+        else if (strcmp(cmd, "PQTMSAVEPAR") == 0)
+        {
+            Module->Saved_Baud = Module->Baud;
+            Baud_Module_Reply(Module, "PQTMSAVEPAR,OK");
+        }
+        else if (strcmp(cmd, "PQTMVERNO") == 0)
+        {
+            Baud_Module_Reply(Module, "PQTMVERNO,LC29HEANR11A03S_RSA,2025/06/10,10:12:45");
+        }
+    }
+    else
+    {
+        if (strncmp(cmd, "PAIR864,0,0,", 12) == 0)
+        {
+            Baud_Module_Switch(Module, (uint32_t)strtoul(cmd + 12, NULL, 10), "PAIR001,864,0", "PAIR001,864,3");
+        }
+        else if (strcmp(cmd, "PAIR513") == 0)
+        {
+            Module->Saved_Baud = Module->Baud;
+            Baud_Module_Reply(Module, "PAIR001,513,0");
+        }
+        else if (strcmp(cmd, "PAIR020") == 0)
+        {
+            Baud_Module_Reply(Module, "PAIR020,AG3335MN_V2.5.0.AG3335_20250610,S,N,5c4d2b1,2506101012,1,,,,");
+        }
+    }
+}
+
+static void Baud_Module_Rtcm(Baud_Module_TypeDef *Module, uint64_t End_Ns)
+{
+    const uint32_t len = ((uint32_t)(Module->Frame[1] & 0x03U) << 8) | Module->Frame[2];
+    const uint8_t *crc = &Module->Frame[3 + len];
+
+    if (Baud_Crc24q(Module->Frame, 3 + len) != (((uint32_t)crc[0] << 16) | ((uint32_t)crc[1] << 8) | crc[2]))
+    {
+        Module->Rtcm_Bad++;
+        return;
+    }
+    Module->Rtcm_Bytes += len + 6U;
+    Module->Rtcm_End_Ns[(((uint32_t)Module->Frame[5] << 8) | Module->Frame[6]) % BAUD_HISTORY] = End_Ns;
+}
+
+static void Baud_Module_Input(Baud_Module_TypeDef *Module, uint8_t Byte, uint64_t End_Ns)
+{
+    if (End_Ns - Module->Last_Ns > BAUD_MODULE_GAP_US * 1000ULL)
+    {
+        Module->Line_Len  = 0;
+        Module->Frame_Len = 0;
+    }
+    Module->Last_Ns = End_Ns;
+
+    if ((Module->Frame_Len != 0) || (Byte == 0xD3U))
+    {
+        Module->Frame[Module->Frame_Len++] = Byte;
+        if ((Module->Frame_Len >= 3U) &&
+            (Module->Frame_Len == ((((uint32_t)(Module->Frame[1] & 0x03U) << 8) | Module->Frame[2]) + 6U)))
+        {
+            Baud_Module_Rtcm(Module, End_Ns);
+            Module->Frame_Len = 0;
+        }
+        Module->Line_Len = 0;
+        return;
+    }
+
+    if (Module->Line_Len < sizeof(Module->Line) - 1U)
+    {
+        Module->Line[Module->Line_Len++] = (char)Byte;
+    }
+    if (Byte == '\n')
+    {
+        Module->Line[Module->Line_Len] = '\0';
+        Baud_Module_Command(Module);
+        Module->Line_Len = 0;
+    }
+}
+
+static void Baud_Module_Task(void *Param)
+{
+    Baud_Module_TypeDef *module = (Baud_Module_TypeDef *)Param;
+    static uint8_t buf[256];
+    static uint64_t end[256];
+    TickType_t wait;
+    uint32_t n;
+
+    for (;;)
+    {
+        wait = pdMS_TO_TICKS(10);
+        if (module->Stream)
+        {
+            const uint64_t now = Ql_Host_Now_Us();
+
+            if (now >= module->Epoch_Us)
+            {
+                Baud_Module_Epoch(module);
+                continue;
+            }
+            wait = (TickType_t)((module->Epoch_Us - now + 999U) / 1000U);
+        }
+
+        n = Ql_Host_Uart_Far_Read(BAUD_PORT, buf, sizeof(buf), wait, end);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            Baud_Module_Input(module, buf[i], end[i]);
+        }
+    }
+}
+
+/* Power on at Baud, streaming from the next epoch */
+static void Baud_Module_Reset(Baud_Dialect_TypeDef Dialect, uint32_t Max_Baud, uint8_t Stream)
+{
+    Baud_Module_TypeDef *module = &Baud_Module;
+
+    module->Dialect   = Dialect;
+    module->Max_Baud  = Max_Baud;
+    module->Baud      = BAUD_ORIGIN;
+    module->Saved_Baud = BAUD_ORIGIN;
+    module->Stream    = Stream;
+    module->Epoch_Us  = (Ql_Host_Now_Us() / (BAUD_EPOCH_MS * 1000U) + 1U) * (BAUD_EPOCH_MS * 1000U);
+    module->Set_Cmds  = 0;
+    module->Line_Len  = 0;
+    module->Frame_Len = 0;
+    Ql_Host_Uart_Far_Baud(BAUD_PORT, BAUD_ORIGIN);
+}
+
+/*****************************************************************************
+* RTCM correction feed of the MCU, 5 messages once a second
+*****************************************************************************/
+static void Baud_Rtcm_Task(void *Param)
+{
+    static uint8_t frame[1024 + 6];
+    TickType_t start;
+    uint32_t crc;
+
+    (void)Param;
+    for (;;)
+    {
+        if (!Baud_Rtcm_On)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        start = xTaskGetTickCount();
+        for (uint32_t i = 0; (i < sizeof(Baud_Rtcm_Len) / sizeof(Baud_Rtcm_Len[0])) && Baud_Rtcm_On; i++)
+        {
+            const uint32_t len = Baud_Rtcm_Len[i];
+            const uint32_t seq = Baud_Rtcm_Seq++;
+
+            frame[0] = 0xD3;
+            frame[1] = (uint8_t)(len >> 8);
+            frame[2] = (uint8_t)len;
+            for (uint32_t j = 0; j < len; j++)
+            {
+                frame[3 + j] = (uint8_t)rand();
+            }
+            frame[5] = (uint8_t)(seq >> 8);     // payload 2..3: the sequence
+            frame[6] = (uint8_t)seq;
+            crc = Baud_Crc24q(frame, 3 + len);
+            frame[3 + len] = (uint8_t)(crc >> 16);
+            frame[4 + len] = (uint8_t)(crc >> 8);
+            frame[5 + len] = (uint8_t)crc;
+
+            Baud_Module.Rtcm_End_Ns[seq % BAUD_HISTORY] = 0;
+            Baud_Rtcm_Start_Us[seq % BAUD_HISTORY] = Ql_Host_Now_Us();
+            Ql_Uart_Write(BAUD_PORT, frame, len + 6U, 100);
+            Baud_Rtcm_Sent++;
+        }
+        if ((xTaskGetTickCount() - start) < pdMS_TO_TICKS(BAUD_RTCM_PERIOD_MS))
+        {
+            vTaskDelay(pdMS_TO_TICKS(BAUD_RTCM_PERIOD_MS) - (xTaskGetTickCount() - start));
+        }
+    }
+}
+
+/*****************************************************************************
+* Negotiation
+*****************************************************************************/
+typedef struct
+{
+    const char                   *Name;
+    const Ql_Baud_Proto_TypeDef  *Proto;
+    Baud_Dialect_TypeDef          Dialect;
+    uint32_t                      Max_Baud;     // of the module
+    uint8_t                       Stream;
+    uint32_t                      Rates[2];
+    uint8_t                       Num;
+    uint32_t                      Expect;
+} Baud_Case_TypeDef;
+
+static const Baud_Case_TypeDef Baud_Cases[] =
+{
+    { "PQTM",   &Ql_Baud_Proto_PQTM,   BAUD_DIALECT_PQTM, 921600, 1, { 921600, 0 },      1, 921600 },
+    { "PAIR",   &Ql_Baud_Proto_PAIR,   BAUD_DIALECT_PAIR, 921600, 1, { 460800, 0 },      1, 460800 },
+    { "EC600U", &Ql_Baud_Proto_EC600U, BAUD_DIALECT_AT,   921600, 0, { 921600, 0 },      1, 921600 },
+    { "PQTM",   &Ql_Baud_Proto_PQTM,   BAUD_DIALECT_PQTM, 460800, 1, { 921600, 460800 }, 2, 460800 },
+    { "PAIR",   &Ql_Baud_Proto_PAIR,   BAUD_DIALECT_PAIR, 115200, 1, { 921600, 460800 }, 2, 115200 },
+};
+
+/* From BAUD_ORIGIN on both sides, returns the rate in use or -1 */
+static int32_t Baud_Negotiate(const Ql_Baud_Proto_TypeDef *Proto, Baud_Dialect_TypeDef Dialect, uint32_t Max_Baud,
+                              uint8_t Stream, const uint32_t *Rates, uint8_t Num, uint32_t *pMs)
+{
+    const uint64_t start_us = Ql_Host_Now_Us();
+    int32_t ret;
+
+    Ql_Uart_Baud_Set(BAUD_PORT, BAUD_ORIGIN);
+    Baud_Module_Reset(Dialect, Max_Baud, Stream);
+    Ql_Uart_Cfg(BAUD_PORT)->Reg.baudrate = 0;
+
+    ret = Ql_Uart_Baud_Negotiate(BAUD_PORT, Proto, Rates, Num);
+    *pMs = (uint32_t)((Ql_Host_Now_Us() - start_us) / 1000U);
+    return ret;
+}
+
+static int32_t Baud_Negotiate_Cases(void)
+{
+    for (uint32_t i = 0; i < sizeof(Baud_Cases) / sizeof(Baud_Cases[0]); i++)
+    {
+        const Baud_Case_TypeDef *c = &Baud_Cases[i];
+        char rates[32];
+        uint32_t ms;
+        int32_t ret;
+
+        ret = Baud_Negotiate(c->Proto, c->Dialect, c->Max_Baud, c->Stream, c->Rates, c->Num, &ms);
+        snprintf(rates, sizeof(rates), (c->Num > 1) ? "%u,%u" : "%u", c->Rates[0], c->Rates[1]);
+        printf("negotiate %-6s module up to %6u, try %-14s -> %6d in %4u ms, %u set commands\n",
+               c->Name, c->Max_Baud, rates, ret, ms, Baud_Module.Set_Cmds);
+        if ((ret != (int32_t)c->Expect) || (Ql_Uart_Baud_Get(BAUD_PORT) != c->Expect) ||
+            (Baud_Module.Baud != c->Expect) || (Baud_Module.Saved_Baud != c->Expect) ||
+            (Ql_Uart_Cfg(BAUD_PORT)->Reg.baudrate != c->Expect))
+        {
+            printf("negotiate %s: expected %u, MCU at %u, module at %u saved %u, usart_cfg_t %u\n", c->Name, c->Expect,
+                   Ql_Uart_Baud_Get(BAUD_PORT), Baud_Module.Baud, Baud_Module.Saved_Baud,
+                   Ql_Uart_Cfg(BAUD_PORT)->Reg.baudrate);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*****************************************************************************
+* 10 Hz NMEA with RTCM at one rate, the parser reads as the applications do
+*****************************************************************************/
+static int32_t Baud_Report(uint32_t Rate, uint32_t Seconds, Baud_Report_TypeDef *pReport)
+{
+    static uint8_t buf[2048];
+    static char line[256];
+    static uint32_t epoch_ms[BAUD_HISTORY], read_us[BAUD_HISTORY], rtcm_ms[BAUD_HISTORY];
+    Baud_Module_TypeDef *module = &Baud_Module;
+    uint32_t line_len = 0, bad = 0, epochs = 0, rtcm = 0, first_epoch, first_rtcm, ms;
+    uint64_t start_us, now;
+    int32_t n;
+
+    memset(pReport, 0, sizeof(Baud_Report_TypeDef));
+    pReport->Rate = Rate;
+    if (Baud_Negotiate(&Ql_Baud_Proto_PQTM, BAUD_DIALECT_PQTM, 921600, 1, &Rate, 1, &ms) != (int32_t)Rate)
+    {
+        printf("report at %u: negotiation failed\n", Rate);
+        return -1;
+    }
+
+    Ql_Uart_Flush(BAUD_PORT);
+    Ql_Uart_Stats_Reset(BAUD_PORT);
+    module->Tx_Bytes   = 0;
+    module->Dropped    = 0;
+    module->Rtcm_Bytes = 0;
+    module->Rtcm_Bad   = 0;
+    first_epoch = module->Epoch + 1U;       // the one in progress may be cut
+    first_rtcm  = Baud_Rtcm_Seq;
+    Baud_Rtcm_Sent = 0;
+    Baud_Rtcm_On = 1;
+    start_us = Ql_Host_Now_Us();
+
+    while (Ql_Host_Now_Us() - start_us < Seconds * 1000000ULL)
+    {
+        n = Ql_Uart_Read(BAUD_PORT, buf, sizeof(buf), 100);
+        now = Ql_Host_Now_Us();
+        while (n > 0)
+        {
+            for (int32_t i = 0; i < n; i++)
+            {
+                if (buf[i] == '$')
+                {
+                    line_len = 0;
+                }
+                if (line_len < sizeof(line) - 1U)
+                {
+                    line[line_len++] = (char)buf[i];
+                }
+                if ((buf[i] != '\n') || (line[0] != '$'))
+                {
+                    continue;
+                }
+
+                char *star = strchr(line, '*');
+                uint32_t k, hh, mm, ss, cs;
+
+                line[line_len] = '\0';
+                line_len = 0;
+                if ((star == NULL) ||
+                    (Ql_CheckXOR((const uint8_t *)line + 1, (uint32_t)(star - line - 1)) != (uint8_t)strtoul(star + 1, NULL, 16)))
+                {
+                    bad++;
+                    continue;
+                }
+                if ((strncmp(line, "$GNGST,", 7) != 0) || (sscanf(line + 7, "%2u%2u%2u.%2u", &hh, &mm, &ss, &cs) != 4))
+                {
+                    continue;
+                }
+                k = ((hh * 3600U + mm * 60U + ss) * 100U + cs) / (BAUD_EPOCH_MS / 10U);
+                if ((k >= first_epoch) && (k < module->Epoch) && (epochs < BAUD_HISTORY))
+                {
+                    epoch_ms[epochs] = (uint32_t)((now - module->Start_Us[k % BAUD_HISTORY]) / 1000U);
+                    read_us[epochs]  = (uint32_t)(now - module->Gst_End_Ns[k % BAUD_HISTORY] / 1000U);
+                    epochs++;
+                }
+            }
+            n = (n == (int32_t)sizeof(buf)) ? Ql_Uart_Read(BAUD_PORT, buf, sizeof(buf), 0) : 0;
+        }
+    }
+    Baud_Rtcm_On = 0;
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    for (uint32_t seq = first_rtcm; (seq < Baud_Rtcm_Seq) && (rtcm < BAUD_HISTORY); seq++)
+    {
+        if (module->Rtcm_End_Ns[seq % BAUD_HISTORY] == 0)
+        {
+            printf("report at %u: RTCM message %u lost\n", Rate, seq);
+            return -1;
+        }
+        rtcm_ms[rtcm++] = (uint32_t)((module->Rtcm_End_Ns[seq % BAUD_HISTORY] / 1000U - Baud_Rtcm_Start_Us[seq % BAUD_HISTORY]) / 1000U);
+    }
+
+    pReport->Epochs  = epochs;
+    pReport->Rx_Load = (uint32_t)((uint64_t)module->Tx_Bytes * 10U * 1000U * 1000U / Rate / (Seconds * 1000U));
+    pReport->Tx_Load = (uint32_t)((uint64_t)module->Rtcm_Bytes * 10U * 1000U * 1000U / Rate / (Seconds * 1000U));
+    pReport->Dropped = module->Dropped;
+    Baud_Percentiles(epoch_ms, epochs, pReport->Epoch_Ms);
+    Baud_Percentiles(read_us, epochs, pReport->Read_Us);
+    Baud_Percentiles(rtcm_ms, rtcm, pReport->Rtcm_Ms);
+    Ql_Uart_Stats_Get(BAUD_PORT, &pReport->Stats);
+
+    if ((bad != 0) || (module->Rtcm_Bad != 0) || (pReport->Stats.Ring_Lapped != 0) || (epochs < Seconds * 10U * 9U / 10U))
+    {
+        printf("report at %u: %u bad sentences, %u bad RTCM, %u laps, %u epochs\n", Rate, bad, module->Rtcm_Bad,
+               pReport->Stats.Ring_Lapped, epochs);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t rates[] = { 115200, 460800, 921600 };
+    Baud_Report_TypeDef report;
+    uint32_t seconds = 10, seed = 1;
+    uint8_t verbose = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': seconds = (uint32_t)atoi(optarg); break;
+        case 's': seed = (uint32_t)atoi(optarg); break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-n seconds] [-s seed] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!verbose)
+    {
+        Ql_Log_Level_Set("*", QL_LOG_NONE);
+    }
+    srand(seed);
+
+    if (Ql_Uart_Init("GNSS COM1", BAUD_PORT, BAUD_ORIGIN, BAUD_RX_SIZE, BAUD_TX_SIZE) != 0)
+    {
+        fprintf(stderr, "cannot init the port\n");
+        return 1;
+    }
+    Ql_Host_Uart_Far_Baud(BAUD_PORT, BAUD_ORIGIN);
+    xTaskCreate(Baud_Module_Task, "module", 512, &Baud_Module, QL_HOST_MAIN_PRIORITY + 3, NULL);
+    xTaskCreate(Baud_Rtcm_Task, "rtcm", 512, NULL, QL_HOST_MAIN_PRIORITY + 1, NULL);
+
+    if (Baud_Negotiate_Cases() != 0)
+    {
+        return 1;
+    }
+
+    printf("rate     rx load  tx load  epoch ms         gst read us        rtcm ms        dropped  ring hwm  read p99\n"
+           "                           p50/p99/max      p50/p99/max        p50/p99/max\n");
+    for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+    {
+        char epoch[24], read[24], rtcm[24];
+
+        if (Baud_Report(rates[i], seconds, &report) != 0)
+        {
+            return 1;
+        }
+        snprintf(epoch, sizeof(epoch), "%u/%u/%u", report.Epoch_Ms[0], report.Epoch_Ms[1], report.Epoch_Ms[2]);
+        snprintf(read, sizeof(read), "%u/%u/%u", report.Read_Us[0], report.Read_Us[1], report.Read_Us[2]);
+        snprintf(rtcm, sizeof(rtcm), "%u/%u/%u", report.Rtcm_Ms[0], report.Rtcm_Ms[1], report.Rtcm_Ms[2]);
+        printf("%-8u %3u.%u %%  %3u.%u %%  %-16s %-18s %-14s %7u  %8u  < %u us\n",
+               report.Rate, report.Rx_Load / 10U, report.Rx_Load % 10U, report.Tx_Load / 10U, report.Tx_Load % 10U,
+               epoch, read, rtcm, report.Dropped, report.Stats.Ring_High_Water, Ql_Uart_Stats_Latency(&report.Stats, 99));
+    }
+    return 0;
+}
@@ -0,0 +1,438 @@
+/*
+Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************
+  Name: uart_bridge.c
+  History:
+    Version  Date         Author   Description
+    v1.0     2026-1018    Hayden   Create file
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ql_host_uart.h"
+#include "ql_uart.h"
+
+#define LOG_TAG "uart_bridge"
+#define LOG_LVL QL_LOG_INFO
+#include "ql_log.h"
+
+/* Ql_Uart_Bridge_Start() between GNSS COM1 and the console port of
+   ql_application.c, both at 921600, against a task that copies with
+   Ql_Uart_Read/Ql_Uart_Write. The far ends stamp every byte, the added
+   latency is the arrival at the far end out minus the arrival at the MCU */
+
+#define BRIDGE_BAUD                 (921600U)
+#define BRIDGE_MODULE_PORT          UART3
+#define BRIDGE_MODULE_RX_SIZE       (8192U)
+#define BRIDGE_MODULE_TX_SIZE       (2048U)
+#define BRIDGE_PC_PORT              USART5
+#define BRIDGE_PC_RX_SIZE           (4096U)
+#define BRIDGE_PC_TX_SIZE           (4096U)
+
+#define BRIDGE_WINDOW               (65536U)    // bytes in flight a stream keeps the stamps of
+#define BRIDGE_FAR_QUEUE            (2048U)     // a saturating far end keeps this much queued
+#define BRIDGE_EPOCH_MS             (100U)
+#define BRIDGE_EPOCH_BYTES          (1000U)     // NMEA per epoch of the module
+#define BRIDGE_RTCM_BYTES           (1200U)     // RTCM per second from the PC
+#define BRIDGE_COPY_SIZE            (2048U)     // fits the smaller Send_Buf
+#define BRIDGE_COPY_TIMEOUT         (10U)       // ticks, Ql_Uart_Read of the copy task and the tap reader
+
+typedef enum
+{
+    BRIDGE_LOAD_OFF,
+    BRIDGE_LOAD_SATURATED,
+    BRIDGE_LOAD_BURST,
+} Bridge_Load_TypeDef;
+
+/* One direction: From writes at the far end of one port, To reads at the
+   far end of the other */
+typedef struct
+{
+    const char *Name;
+    uint32_t    From;
+    uint32_t    To;
+    uint32_t    Seed;
+    uint32_t    Sent;
+    uint32_t    Received;
+    uint32_t    Bad;
+    uint64_t    In_End_Ns[BRIDGE_WINDOW];
+    uint32_t   *Latency_Ns;
+    uint32_t    Latency_Num;
+    uint32_t    Latency_Max;
+} Bridge_Stream_TypeDef;
+
+typedef struct
+{
+    uint32_t    Thru;                   // 0.1 % of the line
+    uint32_t    Latency_Us[3];          // p50, p99, max
+    uint32_t    Ring_Lapped;            // only counted by Ql_Uart_Read, so by the tap or the copy task
+} Bridge_Result_TypeDef;
+
+static Bridge_Stream_TypeDef Bridge_Up =
+{
+    "module->pc", BRIDGE_MODULE_PORT, BRIDGE_PC_PORT, 0x9E3779B9U
+};
+
+static Bridge_Stream_TypeDef Bridge_Down =
+{
+    "pc->module", BRIDGE_PC_PORT, BRIDGE_MODULE_PORT, 0x85EBCA6BU
+};
+
+static volatile Bridge_Load_TypeDef Bridge_Load = BRIDGE_LOAD_OFF;
+static volatile uint8_t Bridge_Copy_On = 0;
+static volatile uint8_t Bridge_Tap_On = 0;
+static uint32_t Bridge_Tap_Received = 0;
+static uint32_t Bridge_Tap_Bad = 0;
+
+static uint8_t Bridge_Pattern(const Bridge_Stream_TypeDef *Stream, uint32_t Offset)
+{
+    return (uint8_t)(((Offset + 1U) * Stream->Seed) >> 24);
+}
+
+static int Bridge_Cmp(const void *A, const void *B)
+{
+    const uint32_t a = *(const uint32_t *)A;
+    const uint32_t b = *(const uint32_t *)B;
+
+    return (a > b) - (a < b);
+}
+
+/*****************************************************************************
+* Far ends
+*****************************************************************************/
+static void Bridge_Source_Write(Bridge_Stream_TypeDef *Stream, uint32_t Len)
+{
+    static uint8_t buf[2][BRIDGE_FAR_QUEUE];
+    static uint64_t end[2][BRIDGE_FAR_QUEUE];
+    const uint32_t k = (Stream == &Bridge_Up) ? 0 : 1;
+    uint32_t n;
+
+    for (uint32_t i = 0; i < Len; i++)
+    {
+        buf[k][i] = Bridge_Pattern(Stream, Stream->Sent + i);
+    }
+    n = Ql_Host_Uart_Far_Write(Stream->From, buf[k], Len, end[k]);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Stream->In_End_Ns[(Stream->Sent + i) % BRIDGE_WINDOW] = end[k][i];
+    }
+    Stream->Sent += n;
+}
+
+static void Bridge_Source_Task(void *Param)
+{
+    Bridge_Stream_TypeDef *stream = (Bridge_Stream_TypeDef *)Param;
+    const uint32_t period_ms = (stream == &Bridge_Up) ? BRIDGE_EPOCH_MS : 1000U;
+    const uint32_t burst = (stream == &Bridge_Up) ? BRIDGE_EPOCH_BYTES : BRIDGE_RTCM_BYTES;
+    TickType_t next = 0;
+    uint32_t pending;
+
+    for (;;)
+    {
+        if (Bridge_Load == BRIDGE_LOAD_SATURATED)
+        {
+            pending = Ql_Host_Uart_Far_Pending(stream->From);
+            if (pending < BRIDGE_FAR_QUEUE)
+            {
+                Bridge_Source_Write(stream, BRIDGE_FAR_QUEUE - pending);
+            }
+            vTaskDelay(1);
+        }
+        else if (Bridge_Load == BRIDGE_LOAD_BURST)
+        {
+            if ((int32_t)(next - xTaskGetTickCount()) > 0)
+            {
+                vTaskDelay(next - xTaskGetTickCount());
+            }
+            Bridge_Source_Write(stream, burst);
+            next = xTaskGetTickCount() + pdMS_TO_TICKS(period_ms);
+        }
+        else
+        {
+            next = xTaskGetTickCount();
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+}
+
+static void Bridge_Sink_Task(void *Param)
+{
+    Bridge_Stream_TypeDef *stream = (Bridge_Stream_TypeDef *)Param;
+    static uint8_t buf[2][512];
+    static uint64_t end[2][512];
+    const uint32_t k = (stream == &Bridge_Up) ? 0 : 1;
+    uint32_t n;
+
+    for (;;)
+    {
+        n = Ql_Host_Uart_Far_Read(stream->To, buf[k], sizeof(buf[k]), pdMS_TO_TICKS(100), end[k]);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const uint32_t offset = stream->Received++;
+
+            if ((buf[k][i] != Bridge_Pattern(stream, offset)) || (offset >= stream->Sent))
+            {
+                stream->Bad++;
+                continue;
+            }
+            if (stream->Latency_Num < stream->Latency_Max)
+            {
+                stream->Latency_Ns[stream->Latency_Num++] = (uint32_t)(end[k][i] - stream->In_End_Ns[offset % BRIDGE_WINDOW]);
+            }
+        }
+    }
+}
+
+/*****************************************************************************
+* MCU side: the parser on the tap, and the task copy to compare with
+*****************************************************************************/
+static void Bridge_Tap_Task(void *Param)
+{
+    static uint8_t buf[BRIDGE_MODULE_RX_SIZE];
+    int32_t n;
+
+    (void)Param;
+    for (;;)
+    {
+        if (!Bridge_Tap_On)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        n = Ql_Uart_Read(BRIDGE_MODULE_PORT, buf, sizeof(buf), BRIDGE_COPY_TIMEOUT);
+        for (int32_t i = 0; i < n; i++)
+        {
+            if (buf[i] != Bridge_Pattern(&Bridge_Up, Bridge_Tap_Received++))
+            {
+                Bridge_Tap_Bad++;
+            }
+        }
+    }
+}
+
+static void Bridge_Copy_Task(void *Param)
+{
+    const Bridge_Stream_TypeDef *stream = (const Bridge_Stream_TypeDef *)Param;
+    static uint8_t buf[2][BRIDGE_COPY_SIZE];
+    const uint32_t k = (stream == &Bridge_Up) ? 0 : 1;
+    int32_t n = 0;
+
+    for (;;)
+    {
+        if (!Bridge_Copy_On)
+        {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        // no IDLE under a saturated stream, so do not wait after a full read
+        n = Ql_Uart_Read(stream->From, buf[k], sizeof(buf[k]), (n == sizeof(buf[k])) ? 0 : BRIDGE_COPY_TIMEOUT);
+        if (n > 0)
+        {
+            Ql_Uart_Write(stream->To, buf[k], (uint16_t)n, 100);
+        }
+    }
+}
+
+/*****************************************************************************
+* One case
+*****************************************************************************/
+static void Bridge_Stream_Reset(Bridge_Stream_TypeDef *Stream, uint32_t Seconds)
+{
+    Stream->Sent        = 0;
+    Stream->Received    = 0;
+    Stream->Bad         = 0;
+    Stream->Latency_Num = 0;
+    Stream->Latency_Max = Seconds * (BRIDGE_BAUD / 10U) + BRIDGE_WINDOW;
+    free(Stream->Latency_Ns);
+    Stream->Latency_Ns  = malloc(Stream->Latency_Max * sizeof(uint32_t));
+}
+
+static void Bridge_Stream_Result(Bridge_Stream_TypeDef *Stream, uint32_t Received, uint32_t Seconds,
+                                 Bridge_Result_TypeDef *pResult)
+{
+    usart_stats_t stats;
+    const uint32_t num = Stream->Latency_Num;
+
+    pResult->Thru = (uint32_t)((uint64_t)Received * 10U * 1000U / BRIDGE_BAUD / Seconds);
+    memset(pResult->Latency_Us, 0, sizeof(pResult->Latency_Us));
+    if (num != 0)
+    {
+        qsort(Stream->Latency_Ns, num, sizeof(uint32_t), Bridge_Cmp);
+        pResult->Latency_Us[0] = Stream->Latency_Ns[(num - 1) * 50U / 100U] / 1000U;
+        pResult->Latency_Us[1] = Stream->Latency_Ns[(num - 1) * 99U / 100U] / 1000U;
+        pResult->Latency_Us[2] = Stream->Latency_Ns[num - 1] / 1000U;
+    }
+    Ql_Uart_Stats_Get(Stream->From, &stats);
+    pResult->Ring_Lapped = stats.Ring_Lapped;
+}
+
+static int32_t Bridge_Case(uint8_t Copy, Bridge_Load_TypeDef Load, uint32_t Seconds, Bridge_Result_TypeDef *pResult)
+{
+    Bridge_Stream_TypeDef *const streams[2] = { &Bridge_Up, &Bridge_Down };
+    Bridge_Result_TypeDef result[2];
+    uint32_t received[2];
+    int32_t ret = 0;
+
+    Bridge_Stream_Reset(&Bridge_Up, Seconds);
+    Bridge_Stream_Reset(&Bridge_Down, Seconds);
+    Ql_Uart_Flush(BRIDGE_MODULE_PORT);
+    Ql_Uart_Flush(BRIDGE_PC_PORT);
+    Ql_Uart_Stats_Reset(BRIDGE_MODULE_PORT);
+    Ql_Uart_Stats_Reset(BRIDGE_PC_PORT);
+    Bridge_Tap_Received = 0;
+    Bridge_Tap_Bad = 0;
+
+    if (Copy)
+    {
+        Bridge_Copy_On = 1;
+    }
+    else if ((Ql_Uart_Bridge_Start(BRIDGE_MODULE_PORT, BRIDGE_PC_PORT, 1) != 0) ||
+             (Ql_Uart_Bridge_Start(BRIDGE_PC_PORT, BRIDGE_MODULE_PORT, 0) != 0))
+    {
+        printf("bridge start failed\n");
+        return -1;
+    }
+    Bridge_Tap_On = !Copy;
+
+    Bridge_Load = Load;
+    vTaskDelay(pdMS_TO_TICKS(Seconds * 1000U));
+    received[0] = Bridge_Up.Received;
+    received[1] = Bridge_Down.Received;
+    Bridge_Load = BRIDGE_LOAD_OFF;
+    vTaskDelay(pdMS_TO_TICKS(200));     // drain
+
+    Bridge_Tap_On = 0;
+    Bridge_Copy_On = 0;
+    Ql_Uart_Bridge_Stop(BRIDGE_MODULE_PORT);
+    Ql_Uart_Bridge_Stop(BRIDGE_PC_PORT);
+    vTaskDelay(pdMS_TO_TICKS(2U * BRIDGE_COPY_TIMEOUT));
+
+    for (uint32_t i = 0; i < 2U; i++)
+    {
+        Bridge_Stream_TypeDef *stream = streams[i];
+
+        Bridge_Stream_Result(stream, received[i], Seconds, &result[i]);
+        printf("%-9s %-9s %-10s %5u.%u %%  %6u/%6u/%6u\n", Copy ? "task copy" : "bridge",
+               (Load == BRIDGE_LOAD_SATURATED) ? "saturated" : "10 Hz", stream->Name,
+               result[i].Thru / 10U, result[i].Thru % 10U, result[i].Latency_Us[0], result[i].Latency_Us[1],
+               result[i].Latency_Us[2]);
+        if ((stream->Bad != 0) || (stream->Received != stream->Sent) || (result[i].Ring_Lapped != 0))
+        {
+            printf("%s: %u of %u bytes out, %u bad, %u laps\n", stream->Name, stream->Received, stream->Sent,
+                   stream->Bad, result[i].Ring_Lapped);
+            ret = -1;
+        }
+    }
+    if (!Copy && ((Bridge_Tap_Bad != 0) || (Bridge_Tap_Received != Bridge_Up.Sent)))
+    {
+        printf("tap: %u of %u bytes read, %u bad\n", Bridge_Tap_Received, Bridge_Up.Sent, Bridge_Tap_Bad);
+        ret = -1;
+    }
+    if ((Ql_Host_Uart_Far_Dropped(BRIDGE_MODULE_PORT) != 0) || (Ql_Host_Uart_Far_Dropped(BRIDGE_PC_PORT) != 0) ||
+        (Ql_Host_Uart_Far_Garbled(BRIDGE_MODULE_PORT) != 0) || (Ql_Host_Uart_Far_Garbled(BRIDGE_PC_PORT) != 0))
+    {
+        printf("far ends: bytes dropped or garbled\n");
+        ret = -1;
+    }
+    if (pResult != NULL)
+    {
+        memcpy(pResult, result, sizeof(result));
+    }
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = 10;
+    uint8_t verbose = 0;
+    Bridge_Result_TypeDef bridge[2][2];
+    Bridge_Result_TypeDef copy[2][2];
+    int32_t ret = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:v")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': seconds = (uint32_t)atoi(optarg); break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-n seconds] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!verbose)
+    {
+        Ql_Log_Level_Set("*", QL_LOG_NONE);
+    }
+
+    if ((Ql_Uart_Init("GNSS COM1", BRIDGE_MODULE_PORT, BRIDGE_BAUD, BRIDGE_MODULE_RX_SIZE, BRIDGE_MODULE_TX_SIZE) != 0) ||
+        (Ql_Uart_Init("Console", BRIDGE_PC_PORT, BRIDGE_BAUD, BRIDGE_PC_RX_SIZE, BRIDGE_PC_TX_SIZE) != 0))
+    {
+        fprintf(stderr, "cannot init the ports\n");
+        return 1;
+    }
+    Ql_Host_Uart_Far_Baud(BRIDGE_MODULE_PORT, BRIDGE_BAUD);
+    Ql_Host_Uart_Far_Baud(BRIDGE_PC_PORT, BRIDGE_BAUD);
+
+    xTaskCreate(Bridge_Source_Task, "module", 512, &Bridge_Up, QL_HOST_MAIN_PRIORITY + 4, NULL);
+    xTaskCreate(Bridge_Source_Task, "pc", 512, &Bridge_Down, QL_HOST_MAIN_PRIORITY + 4, NULL);
+    xTaskCreate(Bridge_Sink_Task, "pc out", 512, &Bridge_Up, QL_HOST_MAIN_PRIORITY + 4, NULL);
+    xTaskCreate(Bridge_Sink_Task, "module out", 512, &Bridge_Down, QL_HOST_MAIN_PRIORITY + 4, NULL);
+    xTaskCreate(Bridge_Copy_Task, "copy up", 512, &Bridge_Up, QL_HOST_MAIN_PRIORITY + 2, NULL);
+    xTaskCreate(Bridge_Copy_Task, "copy down", 512, &Bridge_Down, QL_HOST_MAIN_PRIORITY + 2, NULL);
+    xTaskCreate(Bridge_Tap_Task, "tap", 512, NULL, QL_HOST_MAIN_PRIORITY + 1, NULL);
+
+    printf("mode      load      direction  thru      added us p50/p99/max\n");
+    ret |= Bridge_Case(0, BRIDGE_LOAD_SATURATED, seconds, bridge[0]);
+    ret |= Bridge_Case(0, BRIDGE_LOAD_BURST, seconds, bridge[1]);
+    ret |= Bridge_Case(1, BRIDGE_LOAD_SATURATED, seconds, copy[0]);
+    ret |= Bridge_Case(1, BRIDGE_LOAD_BURST, seconds, copy[1]);
+
+    // the bridge is there to replace the copy task, it must add less latency
+    for (uint32_t i = 0; i < 4U; i++)
+    {
+        const uint32_t bridge_p99 = bridge[i / 2U][i % 2U].Latency_Us[1];
+        const uint32_t copy_p99 = copy[i / 2U][i % 2U].Latency_Us[1];
+
+        if (bridge_p99 >= copy_p99)
+        {
+            printf("%s %s: bridge p99 %u us, task copy %u us\n", (i < 2U) ? "saturated" : "10 Hz",
+                   (i % 2U) ? Bridge_Down.Name : Bridge_Up.Name, bridge_p99, copy_p99);
+            ret = -1;
+        }
+    }
+
+    // the firmware upgrade transport closes and reopens its port on every run
+    printf("closed and reopened:\n");
+    Ql_Uart_DeInit(BRIDGE_MODULE_PORT);
+    Ql_Uart_DeInit(BRIDGE_PC_PORT);
+    if ((Ql_Uart_Init("GNSS COM1", BRIDGE_MODULE_PORT, BRIDGE_BAUD, BRIDGE_MODULE_RX_SIZE, BRIDGE_MODULE_TX_SIZE) != 0) ||
+        (Ql_Uart_Init("Console", BRIDGE_PC_PORT, BRIDGE_BAUD, BRIDGE_PC_RX_SIZE, BRIDGE_PC_TX_SIZE) != 0))
+    {
+        printf("cannot reopen the ports\n");
+        return 1;
+    }
+    ret |= Bridge_Case(0, BRIDGE_LOAD_BURST, 1, NULL);
+    ret |= Bridge_Case(1, BRIDGE_LOAD_BURST, 1, NULL);
+    return (ret != 0) ? 1 : 0;
+}
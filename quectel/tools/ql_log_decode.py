@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# ************************************************************************
+#   Name: ql_log_decode.py
+#   History:
+#     Version  Date         Author   Description
+#     v1.0     2026-1018    Hayden   Create file
+#
+# Decoder for the deferred binary console (QL_LOG_DEFERRED_ENABLE = 1).
+#
+# The format strings are read from the ql_log_fmt section of the .axf the
+# firmware was built from, the ID of a log call is the address of its format.
+# Frame: 0xFE, Args_Len, Fmt(4), Tick(4), Args, XOR of Args_Len..Args.
+# Everything that is not a frame is plain text and is passed through.
+#
+#   python ql_log_decode.py GNSS_MODULE_OPENEVB.axf capture.bin
+#   python ql_log_decode.py GNSS_MODULE_OPENEVB.axf COM5 --baud 921600   (needs pyserial)
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xFE
+FMT_SECTION = "ql_log_fmt"
+SPEC = re.compile(rb"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcsp%])")
+
+
+def load_formats(axf):
+    data = open(axf, "rb").read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        raise SystemExit("%s: not an ELF32 file" % axf)
+
+    e_shoff, = struct.unpack_from("<I", data, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    def section(i):
+        return struct.unpack_from("<IIIIIIIIII", data, e_shoff + i * e_shentsize)
+
+    strtab = section(e_shstrndx)
+    formats = {}
+    for i in range(e_shnum):
+        name, _, _, addr, offset, size = section(i)[:6]
+        end = data.index(b"\0", strtab[4] + name)
+        if data[strtab[4] + name:end].decode() != FMT_SECTION:
+            continue
+
+        blob = data[offset:offset + size]
+        pos = 0
+        while pos < len(blob):
+            if blob[pos] == 0:
+                pos += 1
+                continue
+            end = blob.index(b"\0", pos)
+            formats[addr + pos] = blob[pos:end]
+            pos = end + 1
+
+    if not formats:
+        raise SystemExit("%s: no %s section, built with QL_LOG_DEFERRED_ENABLE = 0?" % (axf, FMT_SECTION))
+    return formats
+
+
+def render(fmt, args):
+    """Same walk as Ql_Log_Bin_Pack() on the target"""
+    out = b""
+    pos = 0
+    last = 0
+
+    def take(size, code):
+        nonlocal pos
+        if pos + size > len(args):
+            raise IndexError
+        value, = struct.unpack_from("<" + code, args, pos)
+        pos += size
+        return value
+
+    for m in SPEC.finditer(fmt):
+        out += fmt[last:m.start()]
+        last = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == b"%":
+            out += b"%"
+            continue
+
+        try:
+            if width == b"*":
+                width = b"%d" % take(4, "i")
+            if prec == b"*":
+                prec = b"%d" % take(4, "i")
+
+            wide = length in (b"ll", b"j")
+            if conv in b"eEfFgGaA":
+                value = take(8, "d")
+                conv = b"e" if conv in b"aA" else conv
+            elif conv == b"s":
+                end = args.index(b"\0", pos)
+                value = args[pos:end]
+                pos = end + 1
+            elif conv in b"di":
+                value = take(8, "q") if wide else take(4, "i")
+                conv = b"d"
+            elif conv == b"p":
+                value = take(4, "I")
+                flags, conv = b"#", b"x"
+            else:
+                value = take(8, "Q") if wide else take(4, "I")
+                conv = b"d" if conv == b"u" else conv
+        except (IndexError, ValueError):
+            out += b"<?>"
+            continue
+
+        spec = b"%" + (flags or b"") + (width or b"") + (b"." + prec if prec else b"") + conv
+        out += spec % value
+
+    return out + fmt[last:]
+
+
+def decode(stream, formats, out):
+    buf = b""
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+
+        while buf:
+            sync = buf.find(bytes([SYNC]))
+            if sync != 0:
+                text = buf if sync < 0 else buf[:sync]
+                out.write(text.decode("utf-8", "replace"))
+                buf = b"" if sync < 0 else buf[sync:]
+                continue
+
+            if len(buf) < 2 or len(buf) < 11 + buf[1]:
+                break
+
+            args_len = buf[1]
+            frame = buf[:11 + args_len]
+            cs = 0
+            for b in frame[1:-1]:
+                cs ^= b
+            if cs != frame[-1]:
+                buf = buf[1:]
+                continue
+
+            fmt_addr, tick = struct.unpack_from("<II", frame, 2)
+            fmt = formats.get(fmt_addr)
+            if fmt is None:
+                line = b"<unknown format 0x%08X>\r\n" % fmt_addr
+            else:
+                line = render(fmt, frame[10:-1])
+            out.write("%10u.%03u " % (tick // 1000, tick % 1000) + line.decode("utf-8", "replace"))
+            buf = buf[len(frame):]
+        out.flush()
+
+
+class SerialStream:
+    """Blocking read(), an empty read would end decode()"""
+
+    def __init__(self, name, baud):
+        import serial
+        self.port = serial.Serial(name, baud, timeout=0.1)
+
+    def read(self, size):
+        while True:
+            data = self.port.read(size)
+            if data:
+                return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the ql_log deferred binary console")
+    parser.add_argument("axf", help="image the firmware was built from")
+    parser.add_argument("input", nargs="?", help="capture file or serial port, stdin if omitted")
+    parser.add_argument("--baud", type=int, default=921600)
+    args = parser.parse_args()
+
+    formats = load_formats(args.axf)
+
+    if args.input is None:
+        stream = sys.stdin.buffer
+    elif re.match(r"^(COM\d+|/dev/)", args.input):
+        stream = SerialStream(args.input, args.baud)
+    else:
+        stream = open(args.input, "rb")
+
+    decode(stream, formats, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
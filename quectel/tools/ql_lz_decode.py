@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# ************************************************************************
+#   Name: ql_lz_decode.py
+#   History:
+#     Version  Date         Author   Description
+#     v1.0     2026-1018    Hayden   Create file
+#
+# Decoder for log files written through ql_ff_lz (Ql_FatFs_Chan_Compress).
+#
+# Block: 'Q' 'Z' Flags Rsv Raw_Len(2) Comp_Len(2) CRC32(4), payload.
+# A truncated file decodes up to its last complete block. After a damaged
+# block the decoder skips to the next block flagged RESET (new session or
+# segment), the blocks in between need the lost history.
+#
+#   python ql_lz_decode.py nmea_00000001.txt > nmea.txt
+#   python ql_lz_decode.py --compress capture.nmea     (ratio and MB/s of the same codec on the host)
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"QZ"
+HDR = struct.Struct("<2sBBHHI")
+FLAG_STORED = 0x01
+FLAG_RESET = 0x02
+
+WINDOW = 4096
+BLOCK_SIZE = 1024
+HASH_BITS = 10
+MIN_MATCH = 3
+MAX_MATCH = MIN_MATCH + 15 + 255
+
+
+def unpack(payload, raw_len, out):
+    """Expand one block onto out, the history is what out already holds"""
+    pos = 0
+    start = len(out)
+    while len(out) - start < raw_len:
+        flag = payload[pos]
+        pos += 1
+        for bit in range(8):
+            if len(out) - start >= raw_len:
+                break
+            if flag & (1 << bit):
+                b0, b1 = payload[pos], payload[pos + 1]
+                pos += 2
+                off = ((b0 << 4) | (b1 >> 4)) + 1
+                n = (b1 & 0x0F) + MIN_MATCH
+                if (b1 & 0x0F) == 0x0F:
+                    n += payload[pos]
+                    pos += 1
+                if off > len(out):
+                    raise IndexError
+                for _ in range(n):
+                    out.append(out[-off])
+            else:
+                out.append(payload[pos])
+                pos += 1
+    if len(out) - start != raw_len or pos != len(payload):
+        raise IndexError
+
+
+def decode(data, out, verbose):
+    history = bytearray()
+    pos = 0
+    blocks = bad = 0
+    synced = True
+
+    while pos + HDR.size <= len(data):
+        magic, flags, _, raw_len, comp_len, crc = HDR.unpack_from(data, pos)
+        end = pos + HDR.size + comp_len
+        if magic != MAGIC or raw_len > BLOCK_SIZE or comp_len > raw_len:
+            nxt = data.find(MAGIC, pos + 1)
+            pos = len(data) if nxt < 0 else nxt
+            synced = False
+            continue
+        if end > len(data):
+            if verbose:
+                sys.stderr.write("truncated block at %u\n" % pos)
+            break
+
+        if flags & FLAG_RESET:
+            history = bytearray()
+            synced = True
+
+        raw = None
+        if synced:
+            payload = data[pos + HDR.size:end]
+            mark = len(history)
+            try:
+                if flags & FLAG_STORED:
+                    history += payload
+                else:
+                    unpack(payload, raw_len, history)
+                raw = bytes(history[mark:])
+            except IndexError:
+                del history[mark:]
+            if raw is None or (zlib.crc32(raw) & 0xFFFFFFFF) != crc:
+                del history[mark:]
+                raw = None
+
+        if raw is None:
+            bad += 1
+            synced = False
+            nxt = data.find(MAGIC, pos + 1)
+            pos = len(data) if nxt < 0 else nxt
+            continue
+
+        out.write(raw)
+        del history[:-WINDOW]
+        blocks += 1
+        pos = end
+
+    if verbose:
+        sys.stderr.write("%u blocks, %u damaged, %u bytes read\n" % (blocks, bad, pos))
+
+
+def compress(data):
+    """Same encoder as Ql_FatFs_Lz_Write(), returns the framed output"""
+    out = bytearray()
+    buf = bytearray()
+    head = [-1] * (1 << HASH_BITS)
+    reset = FLAG_RESET
+
+    def hash3(p):
+        return (((buf[p] << 16) | (buf[p + 1] << 8) | buf[p + 2]) * 2654435761 & 0xFFFFFFFF) >> (32 - HASH_BITS)
+
+    for blk in range(0, len(data), BLOCK_SIZE):
+        hist = len(buf)
+        buf += data[blk:blk + BLOCK_SIZE]
+        end = len(buf)
+        pos = hist
+        comp = bytearray()
+        bit = 8
+        flag = 0
+        while pos < end:
+            if bit == 8:
+                flag = len(comp)
+                comp.append(0)
+                bit = 0
+            n = 0
+            if pos + MIN_MATCH <= end:
+                h = hash3(pos)
+                cand = head[h]
+                head[h] = pos
+                if cand >= 0:
+                    limit = min(end - pos, MAX_MATCH)
+                    while n < limit and buf[cand + n] == buf[pos + n]:
+                        n += 1
+            if n >= MIN_MATCH:
+                comp[flag] |= 1 << bit
+                off = pos - cand - 1
+                if n - MIN_MATCH < 15:
+                    comp += bytes([off >> 4, ((off & 0x0F) << 4) | (n - MIN_MATCH)])
+                else:
+                    comp += bytes([off >> 4, ((off & 0x0F) << 4) | 0x0F, n - MIN_MATCH - 15])
+                for i in range(1, n):
+                    if pos + i + MIN_MATCH > end:
+                        break
+                    head[hash3(pos + i)] = pos + i
+                pos += n
+            else:
+                comp.append(buf[pos])
+                pos += 1
+            bit += 1
+
+        raw = bytes(buf[hist:end])
+        flags = reset
+        if len(comp) >= len(raw):
+            comp = bytearray(raw)
+            flags |= FLAG_STORED
+        out += HDR.pack(MAGIC, flags, 0, len(raw), len(comp), zlib.crc32(raw) & 0xFFFFFFFF) + comp
+        reset = 0
+
+        shift = len(buf) - (WINDOW - BLOCK_SIZE)
+        if shift > 0:
+            del buf[:shift]
+            head = [-1 if v < shift else v - shift for v in head]
+
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode log files written through ql_ff_lz")
+    parser.add_argument("input", help="compressed file, raw log with --compress")
+    parser.add_argument("-o", "--output", help="output file, stdout if omitted")
+    parser.add_argument("--compress", action="store_true", help="compress input, report ratio and speed")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    args = parser.parse_args()
+
+    data = open(args.input, "rb").read()
+    out = open(args.output, "wb") if args.output else sys.stdout.buffer
+
+    if args.compress:
+        start = time.perf_counter()
+        comp = compress(data)
+        secs = time.perf_counter() - start
+        sys.stderr.write("%u -> %u bytes, ratio %.2f, %.3f MB/s (python)\n" %
+                         (len(data), len(comp), len(data) / max(len(comp), 1), len(data) / 1e6 / max(secs, 1e-9)))
+        if args.output:
+            out.write(comp)
+        return
+
+    decode(data, out, args.verbose)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025, Quectel Wireless Solutions Co., Ltd.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# ************************************************************************
+#   Name: ql_nmea_bin.py
+#   History:
+#     Version  Date         Author   Description
+#     v1.0     2026-1018    Hayden   Create file
+#
+# Converter for binary epoch logs written by ql_nmea_bin.c.
+#
+# Block (512 bytes): 'Q' 'E' Version Flags Count(2) Used(2) First_Seq(4) CRC32(4),
+# records, zero fill. The index is the First_Seq of every block, read from the
+# headers only, so --epoch needs one block read after that.
+#
+#   python ql_nmea_bin.py epoch_00000001.qeb                     (NMEA, GGA + RMC)
+#   python ql_nmea_bin.py epoch_00000001.qeb -f csv -o track.csv
+#   python ql_nmea_bin.py epoch_00000001.qeb -f gpx -o track.gpx
+#   python ql_nmea_bin.py epoch_00000001.qeb --epoch 86400 --count 10
+
+import argparse
+import bisect
+import datetime
+import struct
+import sys
+import zlib
+
+BLOCK_SIZE = 512
+HDR = struct.Struct("<2sBBHHII")
+REC = struct.Struct("<BIHiiihHHBBBBHHHB")
+VERSION = 1
+
+MODE_RMC_VALID = 0x01
+MODE_POS = 0x08
+MODE_VEL = 0x10
+
+FIELDS = ("time_ms", "date", "lat", "lon", "alt", "geoid", "speed", "course",
+          "quality", "mode", "used", "view", "hdop", "pdop", "vdop", "sat_num")
+EPOCH_2000 = datetime.date(2000, 1, 1)
+
+
+class Epoch:
+    __slots__ = FIELDS + ("seq", "sats")
+
+    def __init__(self, seq, values, sats):
+        self.seq = seq
+        for name, value in zip(FIELDS, values):
+            setattr(self, name, value)
+        self.sats = sats
+
+
+def block_ok(data, off):
+    magic, version, _, count, used, _, crc = HDR.unpack_from(data, off)
+    if magic != b"QE" or version > VERSION or used > BLOCK_SIZE - HDR.size:
+        return False
+    body = data[off + HDR.size:off + HDR.size + used]
+    return zlib.crc32(body, zlib.crc32(data[off:off + 12])) & 0xFFFFFFFF == crc
+
+
+def index(data):
+    """[(first_seq, offset)] of the good blocks, headers only. A block out of
+    the 512 raster (a dropped partial write) is found by scanning for 'QE'"""
+    blocks = []
+    off = 0
+    while off + BLOCK_SIZE <= len(data):
+        if block_ok(data, off):
+            blocks.append((HDR.unpack_from(data, off)[5], off))
+            off += BLOCK_SIZE
+            continue
+        nxt = data.find(b"QE", off + 1)
+        off = len(data) if nxt < 0 else nxt
+    return blocks
+
+
+def records(data, off):
+    _, _, _, count, used, first, _ = HDR.unpack_from(data, off)
+    pos = off + HDR.size
+    for i in range(count):
+        values = REC.unpack_from(data, pos)
+        length, values = values[0], values[1:]
+        sats = [struct.unpack_from("<BBB", data, pos + REC.size + k * 3) for k in range(values[-1])]
+        yield Epoch(first + i, values, sats)
+        pos += length
+
+
+def epochs(data, blocks, start=0, count=None):
+    keys = [b[0] for b in blocks]
+    k = max(bisect.bisect_right(keys, start) - 1, 0)
+    for _, off in blocks[k:]:
+        for e in records(data, off):
+            if e.seq < start:
+                continue
+            if count is not None and e.seq >= start + count:
+                return
+            yield e
+
+
+def utc(e):
+    day = EPOCH_2000 + datetime.timedelta(days=e.date) if e.date else None
+    return day, e.time_ms // 3600000, e.time_ms // 60000 % 60, e.time_ms // 1000 % 60, e.time_ms % 1000
+
+
+def dm(value, width):
+    deg, rem = divmod(abs(value), 10000000)
+    return "%0*d%09.6f" % (width, deg, rem * 60 / 1e7)
+
+
+def sentence(body):
+    cs = 0
+    for ch in body.encode():
+        cs ^= ch
+    return "$%s*%02X\r\n" % (body, cs)
+
+
+def to_nmea(e):
+    day, hh, mm, ss, ms = utc(e)
+    t = "%02d%02d%02d.%03d" % (hh, mm, ss, ms)
+    if e.mode & MODE_POS:
+        pos = "%s,%s,%s,%s" % (dm(e.lat, 2), "S" if e.lat < 0 else "N", dm(e.lon, 3), "W" if e.lon < 0 else "E")
+        alt = "%.3f,M,%.2f,M" % (e.alt / 1000, e.geoid / 100)
+    else:
+        pos = ",,,"
+        alt = ",M,,M"
+    out = sentence("GNGGA,%s,%s,%d,%02d,%.2f,%s,," % (t, pos, e.quality, e.used, e.hdop / 100, alt))
+    vel = "%.3f,%.2f" % (e.speed / 51.4444, e.course / 100) if e.mode & MODE_VEL else ","
+    date = day.strftime("%d%m%y") if day else ""
+    out += sentence("GNRMC,%s,%s,%s,%s,%s,,,%s" % (t, "A" if e.mode & MODE_RMC_VALID else "V", pos, vel, date,
+                                                 "A" if e.mode & MODE_RMC_VALID else "N"))
+    return out
+
+
+def to_csv(e):
+    day, hh, mm, ss, ms = utc(e)
+    stamp = "%sT%02d:%02d:%02d.%03dZ" % (day.isoformat() if day else "", hh, mm, ss, ms)
+    cn0 = " ".join("%d:%d:%d" % s for s in e.sats)
+    return "%u,%s,%.7f,%.7f,%.3f,%.2f,%.2f,%d,%d,%d,%d,%.2f,%.2f,%.2f,%s\n" % (
+        e.seq, stamp, e.lat / 1e7, e.lon / 1e7, e.alt / 1000, e.speed / 100, e.course / 100,
+        e.quality, (e.mode >> 1) & 3, e.used, e.view, e.hdop / 100, e.pdop / 100, e.vdop / 100, cn0)
+
+
+def to_gpx(e):
+    if not e.mode & MODE_POS:
+        return ""
+    day, hh, mm, ss, ms = utc(e)
+    when = "<time>%sT%02d:%02d:%02d.%03dZ</time>" % (day.isoformat(), hh, mm, ss, ms) if day else ""
+    return '<trkpt lat="%.7f" lon="%.7f"><ele>%.3f</ele>%s<sat>%d</sat><hdop>%.2f</hdop></trkpt>\n' % (
+        e.lat / 1e7, e.lon / 1e7, e.alt / 1000, when, e.used, e.hdop / 100)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert ql_nmea_bin epoch logs")
+    parser.add_argument("input", nargs="+", help="epoch log files, in order")
+    parser.add_argument("-f", "--format", choices=("nmea", "csv", "gpx"), default="nmea")
+    parser.add_argument("-o", "--output", help="output file, stdout if omitted")
+    parser.add_argument("--epoch", type=int, default=0, help="first epoch number")
+    parser.add_argument("--count", type=int, help="number of epochs")
+    args = parser.parse_args()
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    conv = {"nmea": to_nmea, "csv": to_csv, "gpx": to_gpx}[args.format]
+
+    if args.format == "csv":
+        out.write("seq,utc,lat,lon,alt_m,speed_mps,course,quality,fix,used,view,hdop,pdop,vdop,cn0\n")
+    elif args.format == "gpx":
+        out.write('<?xml version="1.0" encoding="UTF-8"?>\n'
+                  '<gpx version="1.1" creator="ql_nmea_bin"><trk><trkseg>\n')
+
+    for name in args.input:
+        data = open(name, "rb").read()
+        out.write("".join(conv(e) for e in epochs(data, index(data), args.epoch, args.count)))
+
+    if args.format == "gpx":
+        out.write("</trkseg></trk></gpx>\n")
+
+
+if __name__ == "__main__":
+    main()
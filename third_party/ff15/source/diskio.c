@@ -10,14 +10,75 @@
 #include "ff.h"			/* Obtains integer types */
 #include "diskio.h"		/* Declarations of disk functions */
 
+#if defined(QL_DISK_HOST)
+#include <time.h>
+#else
 #include "ql_sdcard.h"
 #include "ql_rtc.h"
+#endif
+#include "ql_ff_cache.h"
+#include "ql_ff_disk.h"
+#include "ql_ff_user.h"
 /* Definitions of physical drive number for each drive */
 #define DEV_RAM		0	/* Example: Map Ramdisk to physical drive 0 */
 #define DEV_MMC		1	/* Example: Map MMC/SD card to physical drive 1 */
 #define DEV_USB		2	/* Example: Map USB MSD to physical drive 2 */
 
 
+/*-----------------------------------------------------------------------*/
+/* SD card slot below the sector cache: the card, or an image file on a  */
+/* host build. Fault injection applies here, cache hits are not delayed. */
+/*-----------------------------------------------------------------------*/
+
+static int SD_Read (uint8_t *buff, uint32_t sector, uint32_t count)
+{
+	if (Ql_FatFs_Disk_Fault(DEV_MMC, 0)) return 1;
+#if defined(QL_DISK_HOST)
+	return IMG_disk_read(buff, sector, count);
+#else
+	return MMC_disk_read(buff, sector, count);
+#endif
+}
+
+static int SD_Write (const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+	if (Ql_FatFs_Disk_Fault(DEV_MMC, 1)) return 1;
+#if defined(QL_DISK_HOST)
+	return IMG_disk_write(buff, sector, count);
+#else
+	return MMC_disk_write(buff, sector, count);
+#endif
+}
+
+static int SD_Status (void)
+{
+	if (Ql_FatFs_Disk_Removed(DEV_MMC)) return 1;
+#if defined(QL_DISK_HOST)
+	return IMG_disk_status();
+#else
+	return MMC_disk_status();
+#endif
+}
+
+static int SD_Sync (void)
+{
+#if defined(QL_DISK_HOST)
+	return IMG_disk_sync();
+#else
+	return MMC_disk_sync();
+#endif
+}
+
+static uint32_t SD_Sector_Count (void)
+{
+#if defined(QL_DISK_HOST)
+	return IMG_sector_count();
+#else
+	return MMC_sector_count();
+#endif
+}
+
+
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
 /*-----------------------------------------------------------------------*/
@@ -31,18 +92,31 @@ DSTATUS disk_status (
 
 	switch (pdrv) {
 	case DEV_RAM :
-		// result = RAM_disk_status();
+		result = RAM_disk_status();
 
 		// translate the reslut code here
 
+		if (Ql_FatFs_Disk_Removed(DEV_RAM))
+		{
+			stat = STA_NOINIT | STA_NODISK;
+		}
+		else if (result == 0)
+		{
+			stat = 0;
+		}
+
 		return stat;
 
 	case DEV_MMC :
-		result = MMC_disk_status();
+		result = SD_Status();
 
 		// translate the reslut code here
 
-		if (result == 0)
+		if (Ql_FatFs_Disk_Removed(DEV_MMC))
+		{
+			stat = STA_NOINIT | STA_NODISK;
+		}
+		else if (result == 0)
 		{
 			stat = 0;
 		}
@@ -74,20 +148,30 @@ DSTATUS disk_initialize (
 
 	switch (pdrv) {
 	case DEV_RAM :
-		// result = RAM_disk_initialize();
+		result = Ql_FatFs_Disk_Removed(DEV_RAM) ? 1 : RAM_disk_initialize();
 
 		// translate the reslut code here
 
+		if (result == 0)
+		{
+			stat = 0;
+		}
+
 		return stat;
 
 	case DEV_MMC :
-		result = MMC_disk_initialize();
+#if defined(QL_DISK_HOST)
+		result = SD_Status();	// the image is opened by the host program
+#else
+		result = Ql_FatFs_Disk_Removed(DEV_MMC) ? 1 : MMC_disk_initialize();
+#endif
 
 		// translate the reslut code here
 
 		if (result == 0)
 		{
 			stat = 0;
+			Ql_FatFs_Cache_Init(&Ql_FatFs_Sd_Cache, QL_FF_CACHE_KB, SD_Read, SD_Write, SD_Sector_Count());
 		}
 
 		return stat;
@@ -122,16 +206,18 @@ DRESULT disk_read (
 	case DEV_RAM :
 		// translate the arguments here
 
-		// result = RAM_disk_read(buff, sector, count);
+		result = Ql_FatFs_Disk_Fault(DEV_RAM, 0) ? 1 : RAM_disk_read(buff, sector, count);
 
 		// translate the reslut code here
 
+		res = (result == 0) ? RES_OK : RES_ERROR;
+
 		return res;
 
 	case DEV_MMC :
 		// translate the arguments here
 
-		result = MMC_disk_read(buff, sector, count);
+		result = Ql_FatFs_Cache_Read(&Ql_FatFs_Sd_Cache, buff, sector, count);
 
 		// translate the reslut code here
 
@@ -177,16 +263,19 @@ DRESULT disk_write (
 	case DEV_RAM :
 		// translate the arguments here
 
-		// result = RAM_disk_write(buff, sector, count);
+		result = Ql_FatFs_Disk_Fault(DEV_RAM, 1) ? 1 : RAM_disk_write(buff, sector, count);
 
 		// translate the reslut code here
 
+		res = (result == 0) ? RES_OK : RES_ERROR;
+
 		return res;
 
 	case DEV_MMC :
 		// translate the arguments here
 
-		result = MMC_disk_write(buff, sector, count);
+		result = Ql_FatFs_Cache_Write(&Ql_FatFs_Sd_Cache, buff, sector, count);
+		Ql_FatFs_Free_Touch(sector, count);
 
 		// translate the reslut code here
 
@@ -231,6 +320,29 @@ DRESULT disk_ioctl (
 
 		// Process of the command for the RAM drive
 
+		switch (cmd) {
+			case CTRL_SYNC:
+				res = RES_OK;
+				break;
+
+			case GET_SECTOR_COUNT:
+				*(DWORD*)buff = RAM_sector_count();
+				res = RES_OK;
+				break;
+
+			case GET_SECTOR_SIZE:
+				*(WORD*)buff = FF_MAX_SS;
+				res = RES_OK;
+				break;
+
+			case GET_BLOCK_SIZE:
+				*(DWORD*)buff = 1;
+				res = RES_OK;
+				break;
+
+			default: break;
+		}
+
 		return res;
 
 	case DEV_MMC :
@@ -239,21 +351,26 @@ DRESULT disk_ioctl (
 
 		switch (cmd) {
 			case CTRL_SYNC:
-				res = RES_OK;
+				// Write back cached metadata, then wait for the card to finish programming
+				res = (Ql_FatFs_Cache_Flush(&Ql_FatFs_Sd_Cache) || SD_Sync()) ? RES_ERROR : RES_OK;
 				break;
 
 			case GET_SECTOR_COUNT:
-				*(DWORD*)buff = MMC_sector_count();
+				*(DWORD*)buff = SD_Sector_Count();
 				res = RES_OK;
 				break;
 
 			case GET_SECTOR_SIZE: 
-				*(DWORD*)buff = MMC_sector_size();
+				*(WORD*)buff = FF_MAX_SS;
 				res = RES_OK;
 				break;
 
 			case GET_BLOCK_SIZE:
+#if defined(QL_DISK_HOST)
+				*(DWORD*)buff = 1;
+#else
 				*(DWORD*)buff = MMC_block_size();
+#endif
 				res = RES_OK;
 				break;
 
@@ -273,6 +390,20 @@ DRESULT disk_ioctl (
 	return RES_PARERR;
 }
 
+#if defined(QL_DISK_HOST)
+DWORD get_fattime(void)
+{
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+
+    return ( ((DWORD)(t->tm_year - 80) << 25)
+           | ((DWORD)(t->tm_mon + 1)   << 21)
+           | ((DWORD)t->tm_mday        << 16)
+           | ((DWORD)t->tm_hour        << 11)
+           | ((DWORD)t->tm_min         <<  5)
+           | ((DWORD)t->tm_sec         >>  1) );
+}
+#else
 DWORD get_fattime(void)
 {
     rtc_parameter_struct rtc_sd;
@@ -287,3 +418,4 @@ DWORD get_fattime(void)
            | (BCD2DEC(rtc_sd.minute) <<  5)     /* Min   */
            | (BCD2DEC(rtc_sd.second) >>  1) );  /* Sec, Support only even numbers */
 }
+#endif